@@ -0,0 +1,91 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  abstract_plan_processor.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_ABSTRACT_CORE__ABSTRACT_PLAN_PROCESSOR_H_
+#define MBF_ABSTRACT_CORE__ABSTRACT_PLAN_PROCESSOR_H_
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include <boost/shared_ptr.hpp>
+#include <geometry_msgs/PoseStamped.h>
+
+namespace mbf_abstract_core
+{
+  /**
+   * @class AbstractPlanProcessor
+   * @brief Provides an interface for plan post-processing stages, e.g. smoothing or resampling, applied in a chain
+   *        to each plan before it is handed to the controller. Stages are loaded as plugins from the
+   *        "plan_processors" parameter, a list of structs with the name and the type of each stage.
+   */
+  class AbstractPlanProcessor{
+
+    public:
+      typedef boost::shared_ptr< ::mbf_abstract_core::AbstractPlanProcessor > Ptr;
+
+      /**
+       * @brief Virtual destructor for the interface
+       */
+      virtual ~AbstractPlanProcessor(){}
+
+      /**
+       * @brief Initializes the stage; called once, right after loading it.
+       * @param name The name of the stage, i.e. the private namespace of its parameters.
+       * @return True if the stage is ready to process plans, false otherwise.
+       */
+      virtual bool initialize(const std::string &name) = 0;
+
+      /**
+       * @brief Processes the given plan. Called from different threads, but never concurrently.
+       * @param plan The plan to process, with at least one pose.
+       * @param processed The processed plan.
+       * @param message Optional more detailed outcome as a string.
+       * @return True on success; false if the plan cannot be processed, and so it must not be followed.
+       */
+      virtual bool process(const std::vector<geometry_msgs::PoseStamped> &plan,
+                           std::vector<geometry_msgs::PoseStamped> &processed,
+                           std::string &message) = 0;
+
+    protected:
+      AbstractPlanProcessor(){}
+  };
+};  /* namespace mbf_abstract_core */
+
+#endif  /* MBF_ABSTRACT_CORE__ABSTRACT_PLAN_PROCESSOR_H_ */
@@ -43,6 +43,7 @@
 #include <string>
 #include <stdint.h>
 #include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
 #include <geometry_msgs/PoseStamped.h>
 
 namespace mbf_abstract_core
@@ -53,6 +54,9 @@ namespace mbf_abstract_core
     public:
       typedef boost::shared_ptr< ::mbf_abstract_core::AbstractPlanner > Ptr;
 
+      //! Function receiving an intermediate plan and its cost
+      typedef boost::function<void(const std::vector<geometry_msgs::PoseStamped>&, double)> IntermediatePlanFn;
+
       /**
        * @brief Destructor
        */
@@ -93,11 +97,38 @@ namespace mbf_abstract_core
        */
       virtual bool cancel() = 0;
 
+      /**
+       * @brief Sets the function to receive the intermediate plans found by anytime planners while makePlan runs.
+       *        Planners that don't find intermediate solutions can simply ignore it.
+       * @remark New on MBF API
+       * @param intermediate_plan_fn The function to receive the intermediate plans.
+       */
+      virtual void setIntermediatePlanFn(const IntermediatePlanFn &intermediate_plan_fn)
+      {
+        intermediate_plan_fn_ = intermediate_plan_fn;
+      }
+
     protected:
       /**
        * @brief Constructor
        */
       AbstractPlanner(){};
+
+      /**
+       * @brief To be called by anytime planners from makePlan every time they find a better solution. If planning is
+       *        cut short by the planner patience, Move Base Flex uses the best intermediate plan.
+       * @param plan The intermediate plan
+       * @param cost The cost of the intermediate plan
+       */
+      void publishIntermediatePlan(const std::vector<geometry_msgs::PoseStamped> &plan, double cost)
+      {
+        if (intermediate_plan_fn_)
+          intermediate_plan_fn_(plan, cost);
+      }
+
+    private:
+      //! function receiving the intermediate plans
+      IntermediatePlanFn intermediate_plan_fn_;
   };
 } /* namespace mbf_abstract_core */
 
@@ -41,15 +41,22 @@
 #ifndef MBF_ABSTRACT_NAV__ABSTRACT_CONTROLLER_EXECUTION_H_
 #define MBF_ABSTRACT_NAV__ABSTRACT_CONTROLLER_EXECUTION_H_
 
+#include <map>
 #include <pluginlib/class_loader.h>
-#include <boost/chrono/thread_clock.hpp>
+#include <boost/atomic.hpp>
+#include <boost/chrono/system_clocks.hpp>
 #include <boost/chrono/duration.hpp>
+#include <boost/thread/condition_variable.hpp>
 #include <tf/transform_listener.h>
 #include <geometry_msgs/PoseStamped.h>
 #include <geometry_msgs/Twist.h>
 #include <mbf_abstract_core/abstract_controller.h>
 
 #include "navigation_utility.h"
+#include "abstract_execution_base.h"
+#include "worker_thread.h"
+#include "execution_stats.h"
+#include "robot_state_cache.h"
 #include "mbf_abstract_nav/MoveBaseFlexConfig.h"
 
 namespace mbf_abstract_nav
@@ -63,12 +70,16 @@ namespace mbf_abstract_nav
 /**
  * @brief The AbstractControllerExecution class loads and binds the local planner plugin. It contains a thread
  *        running the plugin in a cycle to move the robot. An internal state is saved and will be pulled by server,
- *        which controls the local planner execution. Due to a state change it wakes up all threads connected to the
- *        condition variable.
+ *        which controls the local planner execution. Every state change wakes up the thread waiting in
+ *        waitForStateUpdate(), so the server can react on it immediately. The state is published together with the
+ *        plugin outcome, the last valid velocity command, the timestamps and the patience as one immutable snapshot,
+ *        so readers get a consistent view from a single read, without ever blocking the controller thread. A new
+ *        snapshot is published on every state change, every plugin call and every new velocity command; the latter
+ *        also wakes up the waiting thread, as the state stays the same while the controller keeps getting commands.
  *
  * @ingroup abstract_server controller_execution
  */
-  class AbstractControllerExecution
+  class AbstractControllerExecution : public AbstractExecutionBase
   {
   public:
 
@@ -76,17 +87,21 @@ namespace mbf_abstract_nav
 
     /**
      * @brief Constructor
-     * @param condition Thread sleep condition variable, to wake up connected threads
      * @param tf_listener_ptr Shared pointer to a common tf listener
      */
-    AbstractControllerExecution(boost::condition_variable &condition,
-                                const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr);
+    AbstractControllerExecution(const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr);
 
     /**
      * @brief Destructor
      */
     virtual ~AbstractControllerExecution();
 
+    /**
+     * @brief Stops moving and joins the worker threads. The derived classes must call it in their destructors, as
+     *        the worker threads run their overridden methods, which must not run once their members are destroyed.
+     */
+    void terminate();
+
     /**
      * @brief Starts the controller, a valid plan should be given in advance.
      * @return false if the thread is already running, true if starting the controller succeeded!
@@ -99,10 +114,10 @@ namespace mbf_abstract_nav
     void stopMoving();
 
     /**
-     * @brief Sets a new plan to the controller execution
-     * @param plan A vector of stamped poses.
+     * @brief Sets a new plan to the controller execution. The plan is shared, not copied.
+     * @param plan Shared pointer to a vector of stamped poses.
      */
-    void setNewPlan(const std::vector<geometry_msgs::PoseStamped> &plan);
+    void setNewPlan(const PlanConstPtr &plan);
 
     /**
      * @brief Internal states
@@ -123,12 +138,53 @@ namespace mbf_abstract_nav
       STOPPED,      ///< The controller has been stopped!
     };
 
+    //! A consistent view of the controller execution, published as a whole on every state change
+    struct Snapshot
+    {
+      ControllerState state;                 //!< the current controller state
+      unsigned int seq;                      //!< state sequence number, incremented on each state change
+      uint32_t plugin_code;                  //!< the last received plugin code
+      std::string plugin_msg;                //!< the last received plugin message
+      geometry_msgs::TwistStamped vel_cmd;   //!< the last valid velocity command; stamped when it was received
+      ros::Time last_call_time;              //!< the start time of the last plugin call
+      ros::Time start_time;                  //!< the time the controller has been started
+      ros::Duration patience;                //!< the patience duration; zero to disable it
+
+      /**
+       * @brief Checks whether the last plugin call has taken longer than the patience.
+       * @return true, if the patience has been exceeded.
+       */
+      bool isPatienceExceeded() const;
+    };
+
+    typedef boost::shared_ptr<const Snapshot> SnapshotConstPtr;
+
+    /**
+     * @brief Returns the latest snapshot of the controller execution with a single wait-free read.
+     * @return Shared pointer to the latest snapshot.
+     */
+    SnapshotConstPtr getSnapshot();
+
     /**
      * Return the current state of the controller execution. Thread communication safe.
      * @return current state, enum value of ControllerState
      */
     ControllerState getState();
 
+
+    /**
+     * @brief Gets the timing statistics of the controller cycles.
+     * @return Reference to the statistics, which can be read and reset from any thread.
+     */
+    ExecutionStats &getStats();
+
+    /**
+     * @brief Sets the robot state cache providing the robot pose and velocity to the plugin. Must be called before
+     *        starting to move; without it, the plugin gets empty pose and velocity messages.
+     * @param robot_state_ptr Shared pointer to the robot state cache.
+     */
+    void setRobotStateCache(const RobotStateCache::Ptr &robot_state_ptr);
+
     /**
      * @brief pulls the current plugin information, plugin code and plugin message!
      * @param plugin_code Returns the last read code provided py the plugin
@@ -137,37 +193,55 @@ namespace mbf_abstract_nav
     void getPluginInfo(uint32_t &plugin_code, std::string &plugin_msg);
 
     /**
-     * @brief Returns the time of the last plugin call
+     * @brief Returns the time of the last plugin call, from the latest snapshot
      * @return Time of the last plugin call
      */
     ros::Time getLastPluginCallTime();
 
     /**
-     * @brief Returns the time, the last time a valid velocity command has been received
+     * @brief Returns the time, the last time a valid velocity command has been received, from the latest snapshot
      * @return Time, the last time a valid cmd_vel has been received.
      */
     ros::Time getLastValidCmdVelTime();
 
     /**
-     * @brief Returns the last valid velocity command set by setVelocityCmd method
+     * @brief Returns the last valid velocity command set by setVelocityCmd method, from the latest snapshot
      * @param vel_cmd_stamped Returns the last valid velocity command.
      */
     void getLastValidCmdVel(geometry_msgs::TwistStamped &vel_cmd_stamped);
 
     /**
-     * @brief Checks whether the patience duration time has been exceeded, ot not
+     * @brief Checks whether the patience duration time has been exceeded, ot not, on the latest snapshot
      * @return true, if the patience has been exceeded.
      */
     bool isPatienceExceeded();
 
     /**
-     * @brief Loads the plugin given by the parameter "local_planner"
+     * @brief Loads all the controller plugins given by the parameter "local_planners", or the single one given by
+     *        "local_planner", and selects the default one.
+     * @return false, if the parameters are invalid or the default plugin could not be loaded.
      */
-    void initialize();
+    bool initialize();
+
+    /**
+     * @brief Selects one of the loaded controller plugins for the next movement; it's used until another one is
+     *        selected.
+     * @param name Name or type of the controller plugin; if empty, the default plugin is selected.
+     * @return false, if no plugin with that name or type has been loaded.
+     */
+    bool selectPlugin(const std::string &name);
+
+    /**
+     * @brief Returns the names of all loaded controller plugins.
+     * @return Plugin names, sorted alphabetically.
+     */
+    std::vector<std::string> listPlugins();
 
     /**
      * @brief Is called by the server thread to reconfigure the controller execution,
-     *        if a user uses dynamic reconfigure to reconfigure the current state.
+     *        if a user uses dynamic reconfigure to reconfigure the current state. A new controller plugin is loaded
+     *        in the background and swapped in between two controller cycles; if it cannot be loaded, the current one
+     *        is kept.
      * @param config MoveBaseFlexConfig object
      */
     void reconfigure(mbf_abstract_nav::MoveBaseFlexConfig &config);
@@ -183,42 +257,56 @@ namespace mbf_abstract_nav
     /**
      * @brief Request plugin for a new velocity command. We use this virtual method to give concrete implementations
      *        as move_base the chance to override it and do additional stuff, for example locking the costmap.
+     * @param robot_pose current robot pose, from the robot state cache
+     * @param robot_velocity current robot velocity, from the robot state cache
      * @param vel_cmd_stamped current velocity command
+     * @param message the plugin message, if any
      */
-    virtual uint32_t computeVelocityCmd(geometry_msgs::TwistStamped& vel_cmd_stamped, std::string& message);
+    virtual uint32_t computeVelocityCmd(const geometry_msgs::PoseStamped& robot_pose,
+                                        const geometry_msgs::TwistStamped& robot_velocity,
+                                        geometry_msgs::TwistStamped& vel_cmd_stamped,
+                                        std::string& message);
 
     /**
-     * @brief Sets the velocity command, to make it available for another thread
+     * @brief Sets the velocity command, publishes it with a new snapshot, and wakes up the threads waiting for a
+     *        state update to read it
      * @param vel_cmd_stamped current velocity command
      */
     void setVelocityCmd(const geometry_msgs::TwistStamped &vel_cmd_stamped);
 
     /**
-     * @brief Sets the plugin code and the plugin msg. This method is for thread communication
+     * @brief Sets the plugin code and the plugin msg, to make them available with the next state change
      * @param plugin_code
      * @param plugin_msg
      */
     void setPluginInfo(const uint32_t &plugin_code, const std::string &plugin_msg);
 
-    //! the name of the loaded plugin
+    //! the name of the plugin in use; changes together with controller_, under the configuration mutex
     std::string plugin_name_;
 
+    //! all loaded controller plugins, by name
+    std::map<std::string, mbf_abstract_core::AbstractController::Ptr> controllers_;
+
+    //! the types of the loaded controller plugins, by name
+    std::map<std::string, std::string> controller_types_;
+
+    //! name of the plugin used when a goal doesn't select one; it's the one chosen with dynamic reconfigure
+    std::string default_plugin_name_;
+
     //! the local planer to calculate the velocity command
     boost::shared_ptr<mbf_abstract_core::AbstractController> controller_;
 
     //! shared pointer to the shared tf listener
     const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr;
 
-    //! The current cycle start time of the last cycle run. Will by updated each cycle.
-    ros::Time last_call_time_;
-
-    //! The time the controller has been started.
+    //! The time the controller has been started; written and read only by the controller thread.
     ros::Time start_time_;
 
     //! The maximum number of retries
     int max_retries_;
 
-    //! The time / duration of patience, before changing the state.
+    //! The time / duration of patience, before changing the state; guarded by the configuration mutex, and
+    //! published with the snapshots for the readers.
     ros::Duration patience_;
 
   private:
@@ -230,6 +318,12 @@ namespace mbf_abstract_nav
      */
     virtual void run();
 
+    /**
+     * @brief Loads all parameters from the parameter server.
+     * @return false, if the controller plugins or the controller frequency are not properly given.
+     */
+    bool loadParams();
+
     /**
      * @brief Loads the plugin associated with the given controller type parameter
      * @param controller_type The type of the controller plugin
@@ -240,9 +334,41 @@ namespace mbf_abstract_nav
 
     /**
      * @brief Pure virtual method, the derived class has to implement. Depending on the plugin base class,
-     *        some plugins need to be initialized!
+     *        some plugins need to be initialized! It runs on the plugin loader thread, while the execution can be
+     *        running the previous plugin.
+     * @param name The name of the controller plugin.
+     * @param controller_ptr The controller plugin to initialize.
+     * @return false, if the plugin could not be initialized.
+     */
+    virtual bool initPlugin(const std::string &name, const mbf_abstract_core::AbstractController::Ptr &controller_ptr) = 0;
+
+    /**
+     * @brief Loads and initializes a controller plugin, without touching the one in use.
+     * @param name The name given to the controller plugin.
+     * @param type The type of the controller plugin to load.
+     * @return The initialized plugin, or an empty pointer if it could not be loaded.
+     */
+    mbf_abstract_core::AbstractController::Ptr loadPlugin(const std::string &name, const std::string &type);
+
+    /**
+     * @brief Looks up a loaded controller plugin by name or by type.
+     * @param name_or_type Name or type of the controller plugin.
+     * @return The plugin name, or an empty string if none matches.
+     */
+    std::string findPlugin(const std::string &name_or_type);
+
+    /**
+     * @brief Puts the given loaded controller plugin in use and makes it take the current plan;
+     *        the configuration mutex must be held.
+     * @param name The name of the controller plugin.
      */
-    virtual void initPlugin() = 0;
+    void swapPlugin(const std::string &name);
+
+    /**
+     * @brief Switches to the last requested controller plugin, loading it first if needed, and makes it the default;
+     *        run by the plugin loader thread.
+     */
+    void loadRequestedPlugin();
 
     /**
      * publishes a velocity command with zero values to stop the robot.
@@ -250,25 +376,47 @@ namespace mbf_abstract_nav
     void publishZeroVelocity();
 
     /**
-     * @brief Sets the controller state. This method makes the communication of the state thread safe.
+     * @brief Sets the controller state and, if it has changed, publishes it together with the values staged since
+     *        the last snapshot as a new snapshot.
      * @param state The current controller state.
      */
     void setState(ControllerState state);
 
-    //! mutex to handle safe thread communication for the current value of the state
-    boost::mutex state_mtx_;
+    /**
+     * @brief Stages the start time of a plugin call and publishes it right away, without changing the state, so
+     *        the readers check the patience against it.
+     * @param time The start time of the plugin call.
+     */
+    void setLastPluginCallTime(const ros::Time &time);
 
-    //! mutex to handle safe thread communication for the current plan
-    boost::mutex plan_mtx_;
+    /**
+     * @brief Stages the controller start time, published with the next snapshot.
+     * @param time The time the controller has been started.
+     */
+    void setStartTime(const ros::Time &time);
+
+    /**
+     * @brief Stages the patience and publishes it right away, without changing the state.
+     * @param patience The new patience duration.
+     */
+    void setPatience(const ros::Duration &patience);
 
-    //! mutex to handle safe thread communication for the current velocity command
-    boost::mutex vel_cmd_mtx_;
+    /**
+     * @brief Publishes the staged values as a new snapshot; the snapshot mutex must be held.
+     */
+    void publishSnapshot();
+
+    //! mutex serializing the snapshot writers; readers never take it
+    boost::mutex snapshot_mtx_;
 
-    //! mutex to handle safe thread communication for the last plugin call time
-    boost::mutex lct_mtx_;
+    //! values for the next snapshot, staged by the writers
+    Snapshot staged_;
 
-    //! mutex to handle safe thread communication for the current plugin code
-    boost::mutex pcode_mtx_;
+    //! the latest snapshot; only accessed with the shared_ptr atomic functions
+    SnapshotConstPtr snapshot_;
+
+    //! mutex to handle safe thread communication for the current plan
+    boost::mutex plan_mtx_;
 
     //! true, if a new plan is available. See hasNewPlan()!
     bool new_plan_;
@@ -281,25 +429,20 @@ namespace mbf_abstract_nav
 
     /**
      * @brief Gets the new available plan. This method is thread safe.
-     * @param plan A reference to a plan which will then be filled with the new plan
+     * @return Shared pointer to the new plan.
      */
-    void getNewPlan(std::vector<geometry_msgs::PoseStamped> &plan);
-
-    //! the last calculated velocity command
-    geometry_msgs::TwistStamped vel_cmd_stamped_;
+    PlanConstPtr getNewPlan();
 
     //! the last set plan which is currently processed by the controller
-    std::vector<geometry_msgs::PoseStamped> plan_;
+    PlanConstPtr plan_;
 
-    //! condition variable to wake up control thread
-    boost::condition_variable &condition_;
-
-    //! the controlling thread object
-    boost::thread thread_;
 
     //! the duration which corresponds with the controller frequency.
     boost::chrono::microseconds calling_duration_;
 
+    //! false, if the parameters read on construction are invalid; initialize() fails then
+    bool params_valid_;
+
     //! the frame of the robot, which will be used to determine its position.
     std::string robot_frame_;
 
@@ -309,14 +452,8 @@ namespace mbf_abstract_nav
     //! publisher for the current velocity command
     ros::Publisher vel_pub_;
 
-    //! the current controller state
-    AbstractControllerExecution::ControllerState state_;
-
-    //! the last received plugin code
-    uint32_t plugin_code_;
-
-    //! the last received plugin message
-    std::string plugin_msg_;
+    //! latest robot pose and velocity, passed to the plugin on every cycle
+    RobotStateCache::Ptr robot_state_ptr_;
 
     //! time before a timeout used for tf requests
     double tf_timeout_;
@@ -324,14 +461,32 @@ namespace mbf_abstract_nav
     //! dynamic reconfigure config mutex, thread safe param reading and writing
     boost::recursive_mutex configuration_mutex_;
 
-    //! main controller loop variable, true if the controller is running, false otherwise
-    bool moving_;
+    //! main controller loop variable, true if the controller is running, false otherwise; shared between threads
+    boost::atomic<bool> moving_;
 
     //! distance tolerance to the given goal pose
     double dist_tolerance_;
 
     //! angle tolerance to the given goal pose
     double angle_tolerance_;
+
+    //! timing statistics of the controller cycles
+    ExecutionStats stats_;
+
+    //! mutex serializing the plugin loads
+    boost::mutex plugin_load_mtx_;
+
+    //! mutex protecting the requested plugin name
+    boost::mutex plugin_request_mtx_;
+
+    //! name or type of the last requested default controller plugin
+    std::string requested_plugin_name_;
+
+    //! thread loading new controller plugins in the background
+    WorkerThread plugin_loader_;
+
+    //! long-lived worker thread running the controller cycles; declared last, so it's destroyed first
+    WorkerThread worker_;
   };
 
 } /* namespace mbf_abstract_nav */
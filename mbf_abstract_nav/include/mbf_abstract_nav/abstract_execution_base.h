@@ -0,0 +1,110 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  abstract_execution_base.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_ABSTRACT_NAV__ABSTRACT_EXECUTION_BASE_H_
+#define MBF_ABSTRACT_NAV__ABSTRACT_EXECUTION_BASE_H_
+
+#include <boost/chrono/chrono.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace mbf_abstract_nav
+{
+
+/**
+ * @brief The AbstractExecutionBase class holds the state update notification shared by all the executions. Every
+ *        state change is numbered, and wakes up the threads waiting in waitForStateUpdate(), so the server can react
+ *        on it immediately.
+ *
+ * @ingroup abstract_server
+ */
+class AbstractExecutionBase
+{
+public:
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~AbstractExecutionBase();
+
+  /**
+   * @brief Returns the sequence number of the last state update. Callers read it before reading the state, and pass
+   *        it to waitForStateUpdate(), so they don't miss any update between reading the state and going to sleep.
+   * @return The sequence number of the last state update.
+   */
+  unsigned int getUpdateSeq();
+
+  /**
+   * @brief Blocks until the internal state changes or the given duration elapses. Each caller keeps its own
+   *        sequence number, so any number of threads can wait concurrently.
+   * @param seq Sequence number of the last state update seen by the caller. See getUpdateSeq().
+   * @param duration Maximum time to wait for a state update
+   * @return true, if the state has changed, false if the duration elapsed without any state update.
+   */
+  bool waitForStateUpdate(unsigned int seq, const boost::chrono::microseconds &duration);
+
+protected:
+
+  /**
+   * @brief Constructor
+   */
+  AbstractExecutionBase();
+
+  /**
+   * @brief Increments the update sequence number and wakes up the threads waiting for a state update; to be called
+   *        after every state change.
+   */
+  void notifyStateUpdate();
+
+private:
+
+  //! mutex protecting the update sequence number
+  boost::mutex update_mtx_;
+
+  //! condition variable to wake up the threads waiting for a state update
+  boost::condition_variable update_cond_;
+
+  //! sequence number of the last state update
+  unsigned int update_seq_;
+};
+
+} /* namespace mbf_abstract_nav */
+
+#endif /* MBF_ABSTRACT_NAV__ABSTRACT_EXECUTION_BASE_H_ */
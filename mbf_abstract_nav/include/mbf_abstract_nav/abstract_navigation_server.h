@@ -52,15 +52,24 @@
 #include <tf/transform_listener.h>
 #include <dynamic_reconfigure/server.h>
 #include <actionlib/server/simple_action_server.h>
-#include <actionlib/client/simple_action_client.h>
+#include <ros/callback_queue.h>
+#include <boost/chrono/system_clocks.hpp>
 
 #include <mbf_msgs/GetPathAction.h>
 #include <mbf_msgs/ExePathAction.h>
 #include <mbf_msgs/RecoveryAction.h>
 #include <mbf_msgs/MoveBaseAction.h>
+#include <mbf_msgs/GetPaths.h>
+#include <mbf_msgs/GetExecutionStats.h>
+#include <mbf_msgs/StartupReport.h>
 
 #include "navigation_utility.h"
-#include "abstract_navigation_server.h"
+#include "planner_pool.h"
+#include "robot_state_cache.h"
+#include "feedback_throttle.h"
+#include "path_publisher.h"
+#include "plan_processing_chain.h"
+#include "execution_arbiter.h"
 
 namespace mbf_abstract_nav
 {
@@ -91,11 +100,6 @@ typedef boost::shared_ptr<ActionServerRecovery> ActionServerRecoveryPtr;
 typedef actionlib::SimpleActionServer<mbf_msgs::MoveBaseAction> ActionServerMoveBase;
 typedef boost::shared_ptr<ActionServerMoveBase> ActionServerMoveBasePtr;
 
-//! Action clients for the MoveBase action
-typedef actionlib::SimpleActionClient<mbf_msgs::GetPathAction> ActionClientGetPath;
-typedef actionlib::SimpleActionClient<mbf_msgs::ExePathAction> ActionClientExePath;
-typedef actionlib::SimpleActionClient<mbf_msgs::RecoveryAction> ActionClientRecovery;
-
 //! ExePath action topic name
 const std::string name_action_exe_path = "exe_path";
 //! GetPath action topic name
@@ -161,18 +165,58 @@ typedef boost::shared_ptr<dynamic_reconfigure::Server<mbf_abstract_nav::MoveBase
     virtual void callActionRecovery(const mbf_msgs::RecoveryGoalConstPtr &goal);
 
     /**
-     * @brief MoveBase action execution method. This method will be called if the action server receives a goal
+     * @brief MoveBase action execution method. This method will be called if the action server receives a goal.
+     *        It drives the planner, controller and recovery executions in-process through runGetPath(), runExePath()
+     *        and runRecovery(), so no messages are exchanged with the other actions. It claims all the executions
+     *        beforehand, so it preempts any GetPath, ExePath or Recovery goal, and is preempted by newer ones.
      * @param goal SimpleActionServer goal containing all necessary parameters for the action execution. See the action
      *        definitions in move_base_flex_msgs.
      */
     virtual void callActionMoveBase(const mbf_msgs::MoveBaseGoalConstPtr &goal);
 
     /**
-     * @brief Callback function of the MoveBase action, while is executes the GetPath action part to compute a path
-     * @param feedback SimpleActionServer feedback containing all feedback information for the MoveBase action. See the
+     * @brief GetPaths service callback. Plans all the queries of the request in parallel on the planner pool. It's
+     *        served from its own callback queue, so long batches don't block other callbacks.
+     * @param request GetPaths service request, containing the start and target poses.
+     * @param response GetPaths service response, containing a path, a cost and an outcome for each query.
+     * @return true, if the request was valid and all the queries have been answered, false otherwise.
+     */
+    virtual bool callServiceGetPaths(mbf_msgs::GetPaths::Request &request, mbf_msgs::GetPaths::Response &response);
+
+    /**
+     * @brief GetExecutionStats service callback, reporting the timing statistics of the planner and controller cycles.
+     * @param request GetExecutionStats service request; the statistics are reset after reading if requested.
+     * @param response GetExecutionStats service response, containing the statistics of each execution.
+     * @return true, always
+     */
+    bool callServiceGetExecutionStats(mbf_msgs::GetExecutionStats::Request &request,
+                                      mbf_msgs::GetExecutionStats::Response &response);
+
+    /**
+     * @brief Timer-triggered publishing of the planner and controller timing statistics, if anyone is listening.
+     */
+    void publishExecutionStats(const ros::TimerEvent &event);
+
+    /**
+     * @brief Callback function of the ExePath action, publishing the feedback computed while following the path
+     * @param feedback ExePath feedback containing all feedback information for the ExePath action. See the
      *        action definitions in move_base_flex_msgs.
      */
-    virtual void actionMoveBaseExePathFeedback(const mbf_msgs::ExePathFeedbackConstPtr &feedback);
+    virtual void actionExePathFeedback(const mbf_msgs::ExePathFeedback &feedback);
+
+    /**
+     * @brief Callback function of the GetPath action, publishing the intermediate plans of anytime planners
+     * @param feedback GetPath feedback containing the best path found so far. See the action definitions in
+     *        move_base_flex_msgs.
+     */
+    virtual void actionGetPathFeedback(const mbf_msgs::GetPathFeedback &feedback);
+
+    /**
+     * @brief Callback function of the MoveBase action, while is executes the ExePath action part to follow the path
+     * @param feedback ExePath feedback to be republished as feedback of the MoveBase action. See the
+     *        action definitions in move_base_flex_msgs.
+     */
+    virtual void actionMoveBaseExePathFeedback(const mbf_msgs::ExePathFeedback &feedback);
 
     /**
      * @brief starts all action server.
@@ -182,32 +226,174 @@ typedef boost::shared_ptr<dynamic_reconfigure::Server<mbf_abstract_nav::MoveBase
     /**
      * @brief initializes all server components. Initializing the plugins of the @ref planner_execution "Planner", the
      *        @ref controller_execution "Controller", and the @ref recovery_execution "Recovery Behavior".
+     * @return false, if the planner or the controller could not be initialized; the server can't work then.
      */
-    virtual void initializeServerComponents();
+    virtual bool initializeServerComponents();
 
     /**
-     * @brief Computes the current robot pose (robot_frame_) in the global frame (global_frame_).
+     * @brief Initializes the planner pool and advertises the GetPaths service, if a planner_pool_size is given.
+     * @return Always true; without the planner pool, only the get_paths service is not available.
+     */
+    bool initializePlannerPool();
+
+    /**
+     * @brief Gets the current robot pose (robot_frame_) in the global frame (global_frame_) from the robot state
+     *        cache. It never waits for TF.
      * @param robot_pose Reference to the robot_pose message object to be filled.
-     * @return true, if the current robot pose could be computed, false otherwise.
+     * @return true, if the current robot pose is available and not older than robot_pose_max_age, false otherwise.
      */
     bool getRobotPose(geometry_msgs::PoseStamped &robot_pose);
 
   protected:
 
     /**
-     * @brief Publishes the given path / plan
+     * @brief Creates a new, not yet initialized, planner execution of the concrete type used by this server. It's
+     *        used to fill the planner pool. The default implementation returns an empty pointer, so the planner pool
+     *        is not supported.
+     * @return shared pointer to the new planner execution.
+     */
+    virtual AbstractPlannerExecution::Ptr newPlannerExecution();
+
+    //! Named startup step, e.g. loading and initializing a plugin
+    typedef std::pair<std::string, boost::function<bool()> > StartupStep;
+
+    /**
+     * @brief Runs the given independent startup steps, each on its own thread if parallel_startup is true, or one
+     *        after the other otherwise, and records their durations in the startup report.
+     * @param steps The steps to run.
+     * @return false, if any startup step has failed so far.
+     */
+    bool runStartupSteps(const std::vector<StartupStep> &steps);
+
+    /**
+     * @brief Runs a single startup step and records its duration in the startup report, and its failure if any.
+     * @param name Name of the step.
+     * @param step Function doing the step; it returns false on failure.
+     */
+    void timeStartupStep(const std::string &name, const boost::function<bool()> &step);
+
+    /**
+     * @brief Terminal states of a navigation step run by runGetPath(), runExePath() and runRecovery(). It tells to
+     *        which terminal state the corresponding action goal has to be set.
+     */
+    enum ActionOutcome
+    {
+      SUCCEEDED, ///< The step has been finished successfully.
+      ABORTED,   ///< The step failed; the result outcome and message contain the details.
+      PREEMPTED  ///< The step has been preempted by the caller.
+    };
+
+    //! Function returning true, if the caller requests to preempt the running navigation step.
+    typedef boost::function<bool()> PreemptRequestedFn;
+
+    //! Function receiving the feedback produced while following a path.
+    typedef boost::function<void(const mbf_msgs::ExePathFeedback&)> ExePathFeedbackFn;
+
+    //! Function receiving the intermediate paths found while planning.
+    typedef boost::function<void(const mbf_msgs::GetPathFeedback&)> GetPathFeedbackFn;
+
+    /**
+     * @brief Combines the preemption requests of an action server with the ones coming from newer goals claiming the
+     *        same executions through the execution arbiter.
+     * @param action_preempt_requested Function checking whether the action server requests to preempt.
+     * @param ticket The ticket of the goal, as returned by the execution arbiter.
+     * @return true, if the running goal has to preempt.
+     */
+    bool isGoalPreempted(const PreemptRequestedFn &action_preempt_requested, unsigned int ticket);
+
+    /**
+     * @brief Computes a path by running the @ref planner_execution "planner execution" until it finishes. This is
+     *        the GetPath action logic, independent of any action server, so it can be used in-process as well. The
+     *        caller must hold the planner execution and have selected the planner plugin to use.
+     * @param goal GetPath goal containing the parameters for the planning.
+     * @param result GetPath result, filled with the path header and the outcome details; the path poses are not
+     *        copied into it, but returned by the plan parameter.
+     * @param plan The found plan, transformed to the global frame; only set on success.
+     * @param preempt_requested Function polled to check whether the caller requests to preempt the planning.
+     * @param publish_feedback Function receiving the intermediate paths of anytime planners; can be empty.
+     * @return The terminal state to which the calling action has to be set.
+     */
+    ActionOutcome runGetPath(const mbf_msgs::GetPathGoal &goal, mbf_msgs::GetPathResult &result, PlanConstPtr &plan,
+                             const PreemptRequestedFn &preempt_requested,
+                             const GetPathFeedbackFn &publish_feedback = GetPathFeedbackFn());
+
+    /**
+     * @brief Follows a path by running the @ref controller_execution "controller execution" until it finishes. This
+     *        is the ExePath action logic, independent of any action server, so it can be used in-process as well. The
+     *        caller must hold the controller execution and have selected the controller plugin to use.
+     * @param plan The plan to follow; it goes through the plan processing stages, if any, and is otherwise shared
+     *        with the controller execution, not copied.
+     * @param result ExePath result, filled with the final robot pose and the outcome details.
+     * @param preempt_requested Function polled to check whether the caller requests to preempt the controlling.
+     * @param publish_feedback Function called with every feedback update; can be empty.
+     * @param feedback_throttle Decides which feedback updates are published; if null, all of them are.
+     * @return The terminal state to which the calling action has to be set.
+     */
+    ActionOutcome runExePath(const PlanConstPtr &plan, mbf_msgs::ExePathResult &result,
+                             const PreemptRequestedFn &preempt_requested, const ExePathFeedbackFn &publish_feedback,
+                             FeedbackThrottle *feedback_throttle = NULL);
+
+    /**
+     * @brief Fills in and publishes an ExePath feedback, if the feedback throttle lets it through. The distance and
+     *        angle to the goal are only computed for the feedback actually published.
+     * @param robot_pose The current robot pose.
+     * @param goal_pose The goal pose.
+     * @param cmd_vel The last valid velocity command.
+     * @param feedback The feedback message to fill in.
+     * @param publish_feedback Function publishing the feedback; can be empty.
+     * @param feedback_throttle Decides whether to publish the feedback; if null, it's always published.
+     */
+    void publishExePathFeedback(const geometry_msgs::PoseStamped &robot_pose,
+                                const geometry_msgs::PoseStamped &goal_pose,
+                                const geometry_msgs::TwistStamped &cmd_vel,
+                                mbf_msgs::ExePathFeedback &feedback,
+                                const ExePathFeedbackFn &publish_feedback,
+                                FeedbackThrottle *feedback_throttle);
+
+    /**
+     * @brief Runs a recovery behavior through the @ref recovery_execution "recovery execution" until it finishes.
+     *        This is the Recovery action logic, independent of any action server, so it can be used in-process as well.
+     *        The caller must hold the recovery execution.
+     * @param goal Recovery goal containing the name of the behavior to run.
+     * @param result Recovery result, filled with the outcome details.
+     * @param preempt_requested Function polled to check whether the caller requests to preempt the recovering.
+     * @return The terminal state to which the calling action has to be set.
+     */
+    ActionOutcome runRecovery(const mbf_msgs::RecoveryGoal &goal, mbf_msgs::RecoveryResult &result,
+                              const PreemptRequestedFn &preempt_requested);
+
+    /**
+     * @brief Plans, follows the path and recovers from failures until the MoveBase goal is reached or fails, and sets
+     *        the MoveBase goal terminal state. The caller must hold all the executions and have selected the planner
+     *        and controller plugins to use.
+     * @param goal MoveBase goal containing all necessary parameters for the navigation.
+     * @param preempt_requested Function polled to check whether the goal has to preempt.
+     */
+    void runMoveBase(const mbf_msgs::MoveBaseGoal &goal, const PreemptRequestedFn &preempt_requested);
+
+    /**
+     * @brief Publishes the given path / plan, simplified and only if it changed and someone is listening
      * @param plan The plan, a list of stamped poses, to be published
      */
-    void publishPath(std::vector<geometry_msgs::PoseStamped> &plan);
+    void publishPath(const Plan &plan);
+
+    /**
+     * @brief Receives the plans found by the planner execution while replanning continuously during a MoveBase
+     *        action. Each plan is published, transformed to the global frame, post-processed and handed to the
+     *        running controller execution. Called from the planning thread.
+     * @param plan The new plan.
+     * @param cost The cost of the new plan.
+     */
+    void handleReplannedPlan(const PlanConstPtr &plan, double cost);
 
     /**
      * @brief Transforms a plan to the global frame (global_frame_) coord system.
      * @param plan Input plan to be transformed.
-     * @param global_plan Output plan, which is then transformed to the global frame.
+     * @param global_plan Output plan, which is then transformed to the global frame. If all the poses are already
+     *        in the global frame, it points to the input plan, so no copy is made.
      * @return true, if the transformation succeeded, false otherwise
      */
-    bool transformPlanToGlobalFrame(std::vector<geometry_msgs::PoseStamped> &plan,
-                                    std::vector<geometry_msgs::PoseStamped> &global_plan);
+    bool transformPlanToGlobalFrame(const PlanConstPtr &plan, PlanConstPtr &global_plan);
 
     /**
      * @brief Start a dynamic reconfigure server.
@@ -252,9 +438,6 @@ typedef boost::shared_ptr<dynamic_reconfigure::Server<mbf_abstract_nav::MoveBase
     //! true, if the dynamic reconfigure has been setup.
     bool setup_reconfigure_;
 
-    //! condition variable to wake up control thread
-    boost::condition_variable condition_;
-
     //! the robot frame, to get the current robot pose in the global_frame_
     std::string robot_frame_;
 
@@ -279,6 +462,51 @@ typedef boost::shared_ptr<dynamic_reconfigure::Server<mbf_abstract_nav::MoveBase
     //! shared pointer to the @ref recovery_execution "RecoveryExecution"
     AbstractRecoveryExecution::Ptr recovery_ptr_;
 
+    //! latest robot pose and velocity, shared with the controller
+    RobotStateCache::Ptr robot_state_ptr_;
+
+    //! maximum age of the cached robot pose to be considered valid
+    ros::Duration robot_pose_max_age_;
+
+    //! whether the independent startup steps run in parallel
+    bool parallel_startup_;
+
+    //! time at which the server construction started
+    boost::chrono::steady_clock::time_point startup_begin_;
+
+    //! durations of the startup steps, published once the action servers are started
+    mbf_msgs::StartupReport startup_report_;
+
+    //! mutex protecting the startup report, as steps can run in parallel
+    boost::mutex startup_report_mtx_;
+
+    //! number of failed startup steps; protected by the startup report mutex
+    unsigned int startup_failures_;
+
+    //! latched publisher of the startup report
+    ros::Publisher startup_report_pub_;
+
+    //! pool of planners used by the GetPaths service; empty if planner_pool_size is 0
+    PlannerPool::Ptr planner_pool_ptr_;
+
+    //! callback queue dedicated to the GetPaths service
+    ros::CallbackQueue get_paths_queue_;
+
+    //! spinner serving the GetPaths service callback queue
+    boost::shared_ptr<ros::AsyncSpinner> get_paths_spinner_;
+
+    //! GetPaths service server
+    ros::ServiceServer get_paths_srv_;
+
+    //! GetExecutionStats service server
+    ros::ServiceServer get_execution_stats_srv_;
+
+    //! Publisher of the planner and controller timing statistics
+    ros::Publisher execution_stats_pub_;
+
+    //! Timer to periodically publish the timing statistics
+    ros::Timer execution_stats_timer_;
+
     //! loop variable for the controller action
     bool active_moving_;
 
@@ -294,14 +522,29 @@ typedef boost::shared_ptr<dynamic_reconfigure::Server<mbf_abstract_nav::MoveBase
     //! minimal move distance to not detect an oscillation
     double oscillation_distance_;
 
+    //! decides which feedback updates the ExePath action publishes
+    FeedbackThrottle exe_path_feedback_throttle_;
+
+    //! decides which feedback updates the MoveBase action publishes
+    FeedbackThrottle move_base_feedback_throttle_;
+
+    //! decides which goal drives each execution, so a new goal preempts the one using the same executions
+    ExecutionArbiter execution_arbiter_;
+
     //! true, if recovery behavior for the MoveBase action is enabled.
     bool recovery_enabled_;
 
+    //! true, if the MoveBase action keeps replanning while moving, i.e. the planner frequency is greater than 0.
+    bool replanning_enabled_;
+
     //! true, if clearing rotate is allowed.
     bool clearing_rotation_allowed_;
 
-    //! Publisher to publish the current computed path
-    ros::Publisher path_pub_;
+    //! Publishes the current computed path, simplified, and its compact version
+    boost::shared_ptr<PathPublisher> path_publisher_ptr_;
+
+    //! Post-processing stages applied to the plans before handing them to the controller
+    boost::shared_ptr<PlanProcessingChain> plan_processing_ptr_;
 
     //! Path sequence counter
     int path_seq_count_;
@@ -309,15 +552,6 @@ typedef boost::shared_ptr<dynamic_reconfigure::Server<mbf_abstract_nav::MoveBase
     //! Private node handle
     ros::NodeHandle private_nh_;
 
-    //! Action client used by the move_base action
-    ActionClientExePath action_client_exe_path_;
-
-    //! Action client used by the move_base action
-    ActionClientGetPath action_client_get_path_;
-
-    //! Action client used by the move_base action
-    ActionClientRecovery action_client_recovery_;
-
   };
 
 } /* namespace mbf_abstract_nav */
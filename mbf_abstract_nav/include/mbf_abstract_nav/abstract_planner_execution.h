@@ -41,14 +41,21 @@
 #ifndef MBF_ABSTRACT_NAV__ABSTRACT_PLANNER_EXECUTION_H_
 #define MBF_ABSTRACT_NAV__ABSTRACT_PLANNER_EXECUTION_H_
 
+#include <map>
 #include <pluginlib/class_loader.h>
-#include <boost/chrono/thread_clock.hpp>
+#include <boost/chrono/system_clocks.hpp>
 #include <boost/chrono/duration.hpp>
+#include <boost/atomic.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
 #include <tf/transform_listener.h>
 #include <geometry_msgs/PoseStamped.h>
 #include <mbf_abstract_core/abstract_planner.h>
 
 #include "navigation_utility.h"
+#include "abstract_execution_base.h"
+#include "worker_thread.h"
+#include "execution_stats.h"
 #include "mbf_abstract_nav/MoveBaseFlexConfig.h"
 
 namespace mbf_abstract_nav
@@ -63,23 +70,33 @@ namespace mbf_abstract_nav
 /**
  * @brief The AbstractPlannerExecution class loads and binds the global planner plugin. It contains a thread running
  *        the plugin in a cycle to plan and re-plan. An internal state is saved and will be pulled by the server, which
- *        controls the global planner execution. Due to a state change it wakes up all threads connected to the
- *        condition variable.
+ *        controls the global planner execution. Every state change wakes up the thread waiting in
+ *        waitForStateUpdate(), so the server can react on it immediately. The state is published together with the
+ *        plugin outcome, the last cycle start time and the patience as one immutable snapshot, so readers get a
+ *        consistent view without ever blocking the planning thread. A state change publishes a new snapshot with
+ *        an incremented sequence number; a new cycle start time or patience replaces it keeping the sequence.
  *
  * @ingroup abstract_server planner_execution
  */
-  class AbstractPlannerExecution
+  class AbstractPlannerExecution : public AbstractExecutionBase
   {
   public:
 
     //! shared pointer type to the @ref planner_execution "planner execution".
     typedef boost::shared_ptr<AbstractPlannerExecution > Ptr;
 
+    //! Function providing the current start pose for replanning; returns false if it is not available.
+    typedef boost::function<bool(geometry_msgs::PoseStamped&)> StartPoseFn;
+
+    //! Function receiving every plan found while replanning, together with its cost.
+    typedef boost::function<void(const PlanConstPtr&, double)> NewPlanFn;
+
     /**
      * @brief Constructor
-     * @param condition Thread sleep condition variable, to wake up connected threads
+     * @param tf_listener_ptr Shared pointer to a common tf listener; optional, for the planners that need it
      */
-    AbstractPlannerExecution(boost::condition_variable &condition);
+    AbstractPlannerExecution(
+        const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr = boost::shared_ptr<tf::TransformListener>());
 
     /**
      * @brief Destructor
@@ -87,11 +104,27 @@ namespace mbf_abstract_nav
     virtual ~AbstractPlannerExecution();
 
     /**
-     * @brief Returns a new plan, if one is available.
-     * @param plan A reference to a plan, which then will be filled.
+     * @brief Stops planning, cancelling the planners, and joins the worker threads. The derived classes must call it
+     *        in their destructors, as the worker threads run their overridden methods, which must not run once their
+     *        members are destroyed.
+     */
+    void terminate();
+
+    /**
+     * @brief Returns a new plan, if one is available. The plan is shared, not copied.
+     * @param plan A reference to a plan pointer, which then will point to the plan.
      * @param cost A reference to the costs, which then will be filled.
      */
-    void getNewPlan(std::vector<geometry_msgs::PoseStamped> &plan, double &cost);
+    void getNewPlan(PlanConstPtr &plan, double &cost);
+
+    /**
+     * @brief Returns the best intermediate plan reported by an anytime planner during the current planning, if it
+     *        hasn't been returned yet. The plan is shared, not copied.
+     * @param plan A reference to a plan pointer, which then will point to the plan.
+     * @param cost A reference to the costs, which then will be filled.
+     * @return true, if a new intermediate plan is available, false otherwise.
+     */
+    bool getNewIntermediatePlan(PlanConstPtr &plan, double &cost);
 
     /**
      * @brief Returns the last time a valid plan was available.
@@ -127,12 +160,44 @@ namespace mbf_abstract_nav
       STOPPED       ///< The planner has been stopped.
     };
 
+    //! A consistent view of the planner execution, published as a whole on every state change
+    struct Snapshot
+    {
+      PlanningState state;              //!< the current internal state
+      unsigned int seq;                 //!< sequence number, incremented on each published snapshot
+      uint32_t plugin_code;             //!< the current plugin code
+      std::string plugin_msg;           //!< the current plugin message
+      ros::Time last_cycle_start_time;  //!< the time the last planning cycle started
+      ros::Duration patience;           //!< the planning patience; zero disables it
+
+      /**
+       * @brief Checks whether the patience was exceeded since the last cycle start.
+       * @return true, if the patience duration was exceeded.
+       */
+      bool isPatienceExceeded() const;
+    };
+
+    typedef boost::shared_ptr<const Snapshot> SnapshotConstPtr;
+
+    /**
+     * @brief Returns the latest snapshot of the planner execution with a single wait-free read.
+     * @return Shared pointer to the latest snapshot.
+     */
+    SnapshotConstPtr getSnapshot();
+
     /**
      * @brief Returns the current internal state
      * @return the current internal state
      */
     PlanningState getState();
 
+
+    /**
+     * @brief Gets the timing statistics of the planner cycles.
+     * @return Reference to the statistics, which can be read and reset from any thread.
+     */
+    ExecutionStats &getStats();
+
     /**
      * @brief Cancel the planner execution. This calls the cancel method of the planner plugin. This could be useful if the
      * computation takes to much time.
@@ -172,6 +237,56 @@ namespace mbf_abstract_nav
     bool startPlanning(const geometry_msgs::PoseStamped &start, const geometry_msgs::PoseStamped &goal,
                        double tolerance);
 
+    /**
+     * @brief Starts the planner execution thread in continuous replanning mode. The thread keeps planning at the
+     *        planning frequency from the start pose provided by get_start, and hands every plan found to new_plan_cb,
+     *        until stopReplanning() is called or the planning fails. The first cycle starts after one period, as the
+     *        caller is expected to hold an up to date plan already.
+     * @param goal goal pose for the planning
+     * @param tolerance tolerance to the goal pose for the planning
+     * @param get_start function providing the current start pose on each cycle, usually the robot pose
+     * @param new_plan_cb function called from the planning thread with every plan found
+     * @return true, if the planner thread has been started, false if the thread is already running.
+     */
+    bool startReplanning(const geometry_msgs::PoseStamped &goal, double tolerance,
+                         const StartPoseFn &get_start, const NewPlanFn &new_plan_cb);
+
+    /**
+     * @brief Stops the continuous replanning started with startReplanning(). It doesn't wait for the planning thread,
+     *        as the planner may not be cancelable; the plans and states it still produces are discarded.
+     */
+    void stopReplanning();
+
+    /**
+     * @brief Loads and initializes a new instance of a planner plugin, apart from the ones used by this execution,
+     *        to plan concurrently with them through planWithInstance(); the PlannerPool and the racers use it. The
+     *        execution doesn't need to be initialized.
+     * @param name_or_type Name or type of a configured planner plugin, or the type of another one; if empty, the
+     *        default planner plugin is loaded.
+     * @param name Reference to the name of the planner plugin, which will be filled.
+     * @return The new planner instance, or an empty pointer if it could not be loaded.
+     */
+    mbf_abstract_core::AbstractPlanner::Ptr loadPlannerInstance(const std::string &name_or_type, std::string &name);
+
+    /**
+     * @brief Calls a planner instance loaded with loadPlannerInstance() once, synchronously in the calling thread,
+     *        without retries nor patience control. It neither touches the execution state nor the stored plan, and
+     *        several instances can plan concurrently, each of them on its own thread.
+     * @param planner_ptr The planner instance to call.
+     * @param planner_name The name of the planner plugin, as returned by loadPlannerInstance().
+     * @param start start pose for the planning
+     * @param goal goal pose for the planning
+     * @param tolerance tolerance to the goal pose for the planning
+     * @param plan Reference to the plan, which will be filled
+     * @param cost Reference to the plan cost, which will be filled
+     * @param message Reference to the outcome message, which will be filled
+     * @return The outcome code of the planner plugin.
+     */
+    uint32_t planWithInstance(const mbf_abstract_core::AbstractPlanner::Ptr &planner_ptr,
+                              const std::string &planner_name, const geometry_msgs::PoseStamped &start,
+                              const geometry_msgs::PoseStamped &goal, double tolerance,
+                              std::vector<geometry_msgs::PoseStamped> &plan, double &cost, std::string &message);
+
     /**
      * @brief Copies the plugin info to the references.
      * @param plugin_code Reference to a variable, to which the code will be copied.
@@ -185,40 +300,91 @@ namespace mbf_abstract_nav
     void stopPlanning();
 
     /**
-     * @brief Loads the plugin given by the parameter "local_planner"
+     * @brief Loads all the planner plugins given by the parameter "global_planners", or the single one given by
+     *        "global_planner", and selects the default one.
+     * @return false, if the parameters are invalid or the default plugin could not be loaded.
      */
-    void initialize();
+    bool initialize();
+
+    /**
+     * @brief Selects one of the loaded planner plugins for the next planning; it's used until another one is selected.
+     *        The name of the planner race, if configured, selects the race instead. See racePlans().
+     * @param name Name or type of the planner plugin; if empty, the default plugin is selected.
+     * @return false, if no plugin with that name or type has been loaded.
+     */
+    bool selectPlugin(const std::string &name);
+
+    /**
+     * @brief Returns the names of all loaded planner plugins.
+     * @return Plugin names, sorted alphabetically.
+     */
+    std::vector<std::string> listPlugins();
 
     /**
      * @brief Is called by the server thread to reconfigure the controller execution, if a user uses dynamic reconfigure
-     *        to reconfigure the current state.
+     *        to reconfigure the current state. A new planner plugin is loaded in the background and swapped in
+     *        between two planning cycles; if it cannot be loaded, the current one is kept.
      * @param config MoveBaseFlexConfig object
      */
     void reconfigure(mbf_abstract_nav::MoveBaseFlexConfig &config);
 
   protected:
 
-    //! the local planer to calculate the velocity command
+    //! the local planer to calculate the velocity command; swapped atomically, as cancel() reads it without locking
     boost::shared_ptr<mbf_abstract_core::AbstractPlanner> planner_;
 
-    //! the name of the loaded planner plugin
+    //! the name of the planner plugin in use; changes together with planner_, under the configuration mutex
     std::string plugin_name_;
 
+    //! all loaded planner plugins, by name
+    std::map<std::string, mbf_abstract_core::AbstractPlanner::Ptr> planners_;
+
+    //! the types of the loaded planner plugins, by name
+    std::map<std::string, std::string> planner_types_;
+
+    //! name of the plugin used when a goal doesn't select one; it's the one chosen with dynamic reconfigure
+    std::string default_plugin_name_;
+
+    //! shared pointer to a common TransformListener; null if not given on construction
+    const boost::shared_ptr<tf::TransformListener> tf_listener_ptr_;
+
     //! true, if the planner execution has been canceled.
-    bool cancel_;
+    boost::atomic<bool> cancel_;
 
     /**
      * @brief The main run method, a thread will execute this method. It contains the main planner execution loop.
+     * @param generation The generation of the run, as set by startPlanning() or startReplanning(); the run stops
+     *        and its states are discarded once it's outdated.
      */
-    virtual void run();
+    virtual void run(unsigned int generation);
 
     /**
      * @brief Loads all parameters from the parameter server.
+     * @return false, if the planner plugins are not properly given.
+     */
+    bool loadParams();
+
+    /**
+     * @brief Runs all the planners of the race concurrently on the racer threads, and returns the first plan found,
+     *        or the cheapest one found within the race deadline; the other planners are canceled and abandoned, so
+     *        the next plan doesn't wait for them. Racers still running a previous race are left out of this one.
+     *        Each racer is a planner instance, planning through planWithInstance(). Derived classes can override it
+     *        to do additional stuff before the whole race.
+     * @param start The start pose for planning
+     * @param goal The goal pose for planning
+     * @param tolerance The goal tolerance
+     * @param plan The winning plan
+     * @param cost The cost of the winning plan
+     * @param message The message of the winning planner or, if all failed, of the last one failing
+     * @return An outcome number, see also the action definition in the GetPath.action file; INTERNAL_ERROR if all
+     *         the racers are still running a previous race
      */
-    void loadParams();
+    virtual uint32_t racePlans(const geometry_msgs::PoseStamped &start, const geometry_msgs::PoseStamped &goal,
+                               double tolerance, std::vector<geometry_msgs::PoseStamped> &plan, double &cost,
+                               std::string &message);
 
    /**
-    * @brief Saves the current plugin code and plugin message. This method is for a safe thread communication.
+    * @brief Saves the current plugin code and plugin message, to be published with the next state change.
     * @param plugin_code plugin code received from the plugin
     * @param plugin_msg plugin message received from the plugin
     */
@@ -227,11 +393,55 @@ namespace mbf_abstract_nav
 
   private:
 
+    //! state of a race between several planners, shared with the racer threads
+    struct Race
+    {
+      boost::mutex mutex;
+      boost::condition_variable cond;
+      std::vector<std::string> names;
+      std::vector<mbf_abstract_core::AbstractPlanner::Ptr> planners;
+      std::vector<bool> finished;
+      size_t num_finished;
+      int winner;  // index of the planner providing the current result, or -1 if none succeeded yet
+      uint32_t outcome;
+      std::string message;
+      Plan plan;
+      double cost;
+    };
+
     /**
-     * @brief Saves the last cycle state. This method is for a safe thread communication.
+     * @brief Stores the last cycle start time in the snapshot, so it's up to date even when the state doesn't change
+     *        between cycles.
      */
     void setLastCycleStartTime();
 
+    /**
+     * @brief Stores the planning patience in the snapshot.
+     * @param patience The new patience; zero disables it.
+     */
+    void setPatience(const ros::Duration &patience);
+
+    /**
+     * @brief Runs one of the planners of a race and records its result; run by the racer threads.
+     * @param race The race the planner takes part in.
+     * @param index Index of the planner within the race.
+     * @param racer Index of the racer, as in racers_.
+     * @param start The start pose for planning
+     * @param goal The goal pose for planning
+     * @param tolerance The goal tolerance
+     */
+    void runRacer(const boost::shared_ptr<Race> &race, size_t index, size_t racer,
+                  const geometry_msgs::PoseStamped &start, const geometry_msgs::PoseStamped &goal, double tolerance);
+
+    /**
+     * @brief Receives the intermediate plans of a racer, passing them to handleIntermediatePlan() only while the
+     *        racer runs the current race; abandoned racers still running a previous one are ignored.
+     * @param racer Index of the racer, as in racers_.
+     * @param plan The intermediate plan.
+     * @param cost Its cost.
+     */
+    void handleRacerIntermediatePlan(size_t racer, const Plan &plan, double cost);
+
     /**
      * @brief Loads the plugin associated with the given planner_type parameter.
      * @param planner_type The type of the planner plugin to load.
@@ -241,13 +451,50 @@ namespace mbf_abstract_nav
 
     /**
      * @brief Pure virtual method, the derived class has to implement. Depending on the plugin base class,
-     *        some plugins need to be initialized!
+     *        some plugins need to be initialized! It runs on the plugin loader thread, while the execution can be
+     *        running the previous plugin.
+     * @param name The name of the planner plugin.
+     * @param planner_ptr The planner plugin to initialize.
+     * @return false, if the plugin could not be initialized.
+     */
+    virtual bool initPlugin(const std::string &name, const mbf_abstract_core::AbstractPlanner::Ptr &planner_ptr) = 0;
+
+    /**
+     * @brief Initializes a planner instance loaded with loadPlannerInstance(). It can run on any thread, while the
+     *        execution and other instances are planning. By default it calls initPlugin().
+     * @param name The name of the planner plugin.
+     * @param planner_ptr The planner instance to initialize.
+     * @return false, if the instance could not be initialized.
+     */
+    virtual bool initPlannerInstance(const std::string &name,
+                                     const mbf_abstract_core::AbstractPlanner::Ptr &planner_ptr);
+
+    /**
+     * @brief Loads and initializes a planner plugin, without touching the one in use.
+     * @param name The name given to the planner plugin.
+     * @param type The type of the planner plugin to load.
+     * @return The initialized plugin, or an empty pointer if it could not be loaded.
+     */
+    mbf_abstract_core::AbstractPlanner::Ptr loadPlugin(const std::string &name, const std::string &type);
+
+    /**
+     * @brief Looks up a loaded planner plugin by name or by type.
+     * @param name_or_type Name or type of the planner plugin.
+     * @return The plugin name, or an empty string if none matches.
      */
-    virtual void initPlugin() = 0;
+    std::string findPlugin(const std::string &name_or_type);
+
+    /**
+     * @brief Switches to the last requested planner plugin, loading it first if needed, and makes it the default;
+     *        run by the plugin loader thread.
+     */
+    void loadRequestedPlugin();
 
     /**
      * @brief calls the planner plugin to make a plan from the start pose to the goal pose with the given tolerance,
      *        if a goal tolerance is enabled in the planner plugin.
+     * @param planner_ptr The planner plugin to call
+     * @param planner_name The name of the planner plugin
      * @param start The start pose for planning
      * @param goal The goal pose for planning
      * @param tolerance The goal tolerance
@@ -258,6 +505,30 @@ namespace mbf_abstract_nav
      */
     virtual uint32_t makePlan(
         const mbf_abstract_core::AbstractPlanner::Ptr& planner_ptr,
+        const std::string &planner_name,
+        const geometry_msgs::PoseStamped start,
+        const geometry_msgs::PoseStamped goal,
+        double tolerance,
+        std::vector<geometry_msgs::PoseStamped> &plan,
+        double &cost,
+        std::string &message);
+
+    /**
+     * @brief Makes a plan with a planner instance loaded with loadPlannerInstance(); called by planWithInstance(),
+     *        concurrently from the threads of all the instances. By default it calls makePlan().
+     * @param planner_ptr The planner instance to call
+     * @param planner_name The name of the planner plugin
+     * @param start The start pose for planning
+     * @param goal The goal pose for planning
+     * @param tolerance The goal tolerance
+     * @param plan The computed plan by the plugin
+     * @param cost The computed costs for the corresponding plan
+     * @param message An optional message which should correspond with the returned outcome
+     * @return An outcome number, see also the action definition in the GetPath.action file
+     */
+    virtual uint32_t makeInstancePlan(
+        const mbf_abstract_core::AbstractPlanner::Ptr& planner_ptr,
+        const std::string &planner_name,
         const geometry_msgs::PoseStamped start,
         const geometry_msgs::PoseStamped goal,
         double tolerance,
@@ -265,6 +536,13 @@ namespace mbf_abstract_nav
         double &cost,
         std::string &message);
 
+    /**
+     * @brief Ends the given race: clears the current race and cancels the planners still running, which keep
+     *        their racer threads busy until they return; nobody waits for them.
+     * @param race The race to end.
+     */
+    void endRace(const boost::shared_ptr<Race> &race);
+
 
     /**
      * @brief Sets the internal state, thread communication safe
@@ -273,50 +551,117 @@ namespace mbf_abstract_nav
     void setState(PlanningState state);
 
     /**
-     * @brief Saves the plan, after a plan has been found. Thread communication safe.
-     * @param plan The computed plan to be transferred.
+     * @brief Sets the internal state from the given run, unless the run is outdated.
+     * @param generation The generation of the run.
+     * @param state the current state
+     * @return true, if the state has been set.
+     */
+    bool setRunState(unsigned int generation, PlanningState state);
+
+    /**
+     * @brief Ends the given run with a final state, unless the run is outdated.
+     * @param generation The generation of the run.
+     * @param state the final state
+     */
+    void finishRun(unsigned int generation, PlanningState state);
+
+    /**
+     * @brief Starts a new run generation, so the states of the runs still finishing are discarded, and sets the state.
+     *        Must be called with the snapshot mutex held.
+     * @param state the new state
+     * @return the new generation.
+     */
+    unsigned int startGeneration(PlanningState state);
+
+    /**
+     * @brief Checks whether the given run is still the current one.
+     * @param generation The generation of the run.
+     * @return true, if the run has not been outdated by a new start or by stopReplanning().
+     */
+    bool isCurrentRun(unsigned int generation);
+
+    /**
+     * @brief Saves the plan, after a plan has been found, unless the run has been outdated. Thread communication safe.
+     * @param generation The generation of the run that found the plan.
+     * @param plan The computed plan to be transferred; it must not be modified afterwards.
      * @param cost The computed costs to be transfered.
+     * @return false, if the run has been outdated by a new start or by stopReplanning() and the plan was dropped.
      */
-    void setNewPlan(const std::vector<geometry_msgs::PoseStamped> &plan, double cost);
+    bool setNewPlan(unsigned int generation, const PlanConstPtr &plan, double cost);
 
-    //! mutex to handle safe thread communication for the current state
-    boost::mutex state_mtx_;
+    /**
+     * @brief Saves the plugin code and message of a run, to be published with the next state change, unless the
+     *        run has been outdated.
+     * @param generation The generation of the run.
+     * @param plugin_code plugin code received from the plugin
+     * @param plugin_msg plugin message received from the plugin
+     * @return false, if the run has been outdated by a new start or by stopReplanning().
+     */
+    bool setRunPluginInfo(unsigned int generation, const uint32_t &plugin_code, const std::string &plugin_msg);
+
+    /**
+     * @brief Receives the intermediate plans of anytime planners, keeping the best one, and wakes up the threads
+     *        waiting for a state update.
+     * @param plan The intermediate plan.
+     * @param cost Its cost.
+     */
+    void handleIntermediatePlan(const Plan &plan, double cost);
+
+    /**
+     * @brief Discards the intermediate plan, before starting a new planning.
+     */
+    void resetIntermediatePlan();
+
+    /**
+     * @brief Publishes the staged values as a new snapshot, if the state differs from the latest one, and wakes up
+     *        the threads waiting for a state update. The snapshot mutex must be held.
+     */
+    void publishSnapshot();
+
+    /**
+     * @brief Replaces the latest snapshot with the staged values, keeping its sequence number and without waking up
+     *        anybody. The snapshot mutex must be held.
+     */
+    void storeSnapshot();
+
+    //! mutex serializing the snapshot writers; readers never take it
+    boost::mutex snapshot_mtx_;
+
+    //! values for the next snapshot, staged by the writers
+    Snapshot staged_;
+
+    //! the latest snapshot; only accessed with the shared_ptr atomic functions
+    SnapshotConstPtr snapshot_;
 
     //! mutex to handle safe thread communication for the plan and plan-costs
     boost::mutex plan_mtx_;
 
-    //! mutex to handle safe thread communication for the plugin code and the plugin message.
-    boost::mutex pcode_mtx_;
-
     //! mutex to handle safe thread communication for the goal and start pose.
     boost::mutex goal_start_mtx_;
 
-    //! mutex to handle safe thread communication for the last cycle start time.
-    boost::mutex lct_mtx_;
-
     //! true, if a new goal pose has been set, until it is used.
     bool has_new_goal_;
 
     //! true, if a new start pose has been set, until it is used.
     bool has_new_start_;
 
-    //! the last cycle start time, updated each cycle.
-    ros::Time last_cycle_start_time_;
-
     //! the last time a valid plan has been computed.
     ros::Time last_valid_plan_time_;
 
     //! current global plan
-    std::vector<geometry_msgs::PoseStamped> plan_;
+    PlanConstPtr plan_;
 
     //! current global plan cost
     double cost_;
 
-    //! the current plugin code
-    uint32_t plugin_code_;
+    //! best intermediate plan reported by an anytime planner during the current planning
+    PlanConstPtr intermediate_plan_;
+
+    //! cost of the best intermediate plan
+    double intermediate_cost_;
 
-    //! the current plugin message
-    std::string plugin_msg_;
+    //! true, if the best intermediate plan has not been returned yet
+    bool has_new_intermediate_plan_;
 
     //! the current start pose used for planning
     geometry_msgs::PoseStamped start_;
@@ -336,14 +681,24 @@ namespace mbf_abstract_nav
     //! planning max retries
     int max_retries_;
 
-    //! main cycle variable of the execution loop
-    bool planning_;
+    //! false, if the parameters read on construction are invalid; initialize() fails then
+    bool params_valid_;
+
+    //! true, while the current run is planning; set by the caller thread and cleared by the planning thread
+    boost::atomic<bool> planning_;
+
+    //! true, if the execution loop keeps replanning after finding a plan. See startReplanning()
+    boost::atomic<bool> replanning_;
+
+    //! generation of the current run; written with the snapshot mutex held
+    boost::atomic<unsigned int> generation_;
 
-    //! condition variable to wake up server thread
-    boost::condition_variable &condition_;
+    //! provides the start pose on each replanning cycle
+    StartPoseFn get_start_;
+
+    //! receives every plan found while replanning
+    NewPlanFn new_plan_cb_;
 
-    //! thread for planning
-    boost::thread thread_;
 
     //! timing of the planning thread
     boost::chrono::microseconds calling_duration_;
@@ -354,14 +709,54 @@ namespace mbf_abstract_nav
     //! the global frame in which the planner needs to plan
     std::string global_frame_;
 
-    //! shared pointer to a common TransformListener
-    const boost::shared_ptr<tf::TransformListener> tf_listener_ptr_;
-
-    //! current internal state
-    PlanningState state_;
-
     //! dynamic reconfigure mutex for a thread safe communication
     boost::recursive_mutex configuration_mutex_;
+
+    //! timing statistics of the planner cycles
+    ExecutionStats stats_;
+
+    //! mutex serializing the plugin loads
+    boost::mutex plugin_load_mtx_;
+
+    //! mutex protecting the requested plugin name
+    boost::mutex plugin_request_mtx_;
+
+    //! name or type of the last requested default planner plugin
+    std::string requested_plugin_name_;
+
+    //! name selecting the planner race on a goal; empty if no race is configured
+    std::string race_name_;
+
+    //! names of the planners taking part in the race
+    std::vector<std::string> race_planners_;
+
+    //! instances of the race planners, loaded with loadPlannerInstance() so the racers never share a plugin, nor a
+    //! costmap mirror, with the planning cycles or with the other planner instances
+    std::vector<mbf_abstract_core::AbstractPlanner::Ptr> racer_planners_;
+
+    //! if true, the race waits up to the deadline for cheaper plans than the first one found
+    bool race_best_;
+
+    //! how long to wait for cheaper plans after the first one; zero to wait for all the planners
+    boost::chrono::microseconds race_deadline_;
+
+    //! true, if the race has been selected for the current goal
+    bool racing_;
+
+    //! the current race; swapped atomically, as cancel() reads it without locking
+    boost::shared_ptr<Race> race_;
+
+    //! one long-lived thread per planner in the race
+    std::vector<boost::shared_ptr<WorkerThread> > racers_;
+
+    //! the race each racer is running, if any; swapped atomically, as the intermediate plans are checked against it
+    std::vector<boost::shared_ptr<Race> > racer_races_;
+
+    //! thread loading new planner plugins in the background
+    WorkerThread plugin_loader_;
+
+    //! long-lived worker thread running the planning cycles; declared last, so it's destroyed first
+    WorkerThread worker_;
   };
 
 } /* namespace mbf_abstract_nav */
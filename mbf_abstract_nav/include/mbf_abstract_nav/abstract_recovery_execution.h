@@ -43,10 +43,13 @@
 
 #include <pluginlib/class_loader.h>
 #include <boost/chrono/thread_clock.hpp>
+#include <boost/thread/condition_variable.hpp>
 #include <tf/transform_listener.h>
 #include <mbf_abstract_core/abstract_recovery.h>
 
 #include "navigation_utility.h"
+#include "abstract_execution_base.h"
+#include "worker_thread.h"
 #include "mbf_abstract_nav/MoveBaseFlexConfig.h"
 
 namespace mbf_abstract_nav
@@ -60,12 +63,12 @@ namespace mbf_abstract_nav
 /**
  * @brief The AbstractiRecoveryExecution class loads and binds the recovery behavior plugin. It contains a thread
  *        running the plugin, executing the recovery behavior. An internal state is saved and will be pulled by the
- *        server, which controls the recovery behavior execution. Due to a state change it wakes up all threads
- *        connected to the condition variable.
+ *        server, which controls the recovery behavior execution. Every state change wakes up the thread waiting in
+ *        waitForStateUpdate(), so the server can react on it immediately.
  *
  * @ingroup abstract_server recovery_execution
  */
-  class AbstractRecoveryExecution
+  class AbstractRecoveryExecution : public AbstractExecutionBase
   {
   public:
 
@@ -73,22 +76,28 @@ namespace mbf_abstract_nav
 
     /**
      * @brief Constructor
-     * @param condition Thread sleep condition variable, to wake up connected threads
      * @param tf_listener_ptr Shared pointer to a common tf listener
      */
-    AbstractRecoveryExecution(boost::condition_variable &condition,
-                              const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr);
+    AbstractRecoveryExecution(const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr);
 
     /**
      * @brief Destructor
      */
     virtual ~AbstractRecoveryExecution();
 
+    /**
+     * @brief Cancels the recovery behavior and joins the worker thread. The derived classes must call it in their
+     *        destructors, as the worker thread runs their overridden methods, which must not run once their members
+     *        are destroyed.
+     */
+    void terminate();
+
     /**
      * @brief starts the recovery behavior thread, which calls the recovery behavior plugin.
      * @param name The name of the recovery behavior loaded.
+     * @return true, if the recovery behavior has been started, false if another one is already waiting to be run.
      */
-    void startRecovery(const std::string name);
+    bool startRecovery(const std::string name);
 
     /**
      * @brief Tries to stop the recovery behavior thread by an interrupt
@@ -117,8 +126,9 @@ namespace mbf_abstract_nav
 
     /**
      * @brief Reads the parameter server and tries to load and initialize the recovery behaviors
+     * @return Always true; the recovery behaviors are optional, so failing to load them is not fatal.
      */
-    void initialize();
+    bool initialize();
 
     /**
      * @brief Reconfigures the current configuration and reloads all parameters. This method is called from a dynamic
@@ -134,7 +144,8 @@ namespace mbf_abstract_nav
     bool cancel();
 
     /**
-     * @brief Returns true is the given name has been loaded as recovery behavior.
+     * @brief Returns true is the given name has been loaded, or registered to be loaded on first use, as recovery
+     *        behavior.
      * @param name The name of the recovery behavior.
      * @return true, if the recovery behavior exists, false otherwise.
      */
@@ -157,7 +168,7 @@ namespace mbf_abstract_nav
   protected:
 
     /**
-     * @brief Main execution method which will be executed by the recovery execution thread_.
+     * @brief Main execution method which will be executed by the recovery execution worker thread.
      */
     virtual void run();
 
@@ -184,8 +195,10 @@ namespace mbf_abstract_nav
     /**
      * @brief Pure virtual method, the derived class has to implement. Depending on the plugin base class,
      *        some plugins need to be initialized!
+     * @param name The name under which the recovery behavior has been loaded.
+     * @param behavior The recovery behavior plugin to initialize.
      */
-    virtual void initPlugins() = 0;
+    virtual void initPlugin(const std::string &name, const mbf_abstract_core::AbstractRecovery::Ptr &behavior) = 0;
 
     /**
      * @brief Loads a Recovery plugin associated with given recovery type parameter
@@ -200,17 +213,23 @@ namespace mbf_abstract_nav
      */
     bool loadPlugins();
 
+    /**
+     * @brief Loads and initializes a recovery behavior registered but not loaded yet, as done on first use if
+     *        lazy_recovery_loading is true.
+     * @param name The name of the recovery behavior.
+     * @return true, if the recovery behavior has been loaded and initialized.
+     */
+    bool loadBehavior(const std::string &name);
+
+    //! whether recovery behaviors are loaded on first use instead of on initialization
+    bool lazy_loading_;
+
     //! mutex to handle safe thread communication for the current state
     boost::mutex state_mtx_;
 
     //! the last requested recovery behavior to start
     std::string requested_behavior_name_;
 
-    //! condition variable to wake up control thread
-    boost::condition_variable &condition_;
-
-    //! thread for running recovery behaviors
-    boost::thread thread_;
 
     //! current internal state
     RecoveryState state_;
@@ -220,6 +239,9 @@ namespace mbf_abstract_nav
 
     //! dynamic reconfigure mutex for a thread safe communication
     boost::recursive_mutex configuration_mutex_;
+
+    //! long-lived worker thread running the recovery behaviors; declared last, so it's destroyed first
+    WorkerThread worker_;
   };
 
 } /* namespace mbf_abstract_nav */
@@ -0,0 +1,128 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  execution_arbiter.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_ABSTRACT_NAV__EXECUTION_ARBITER_H_
+#define MBF_ABSTRACT_NAV__EXECUTION_ARBITER_H_
+
+#include <list>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace mbf_abstract_nav
+{
+
+/**
+ * @brief The ExecutionArbiter class decides which goal drives each of the planner, controller and recovery
+ *        executions. A goal claims the executions it needs; the goals already holding any of them are asked to
+ *        preempt, and the claim blocks until they have released them. So the latest goal always wins, as it did when
+ *        the MoveBase action drove the executions through the GetPath, ExePath and Recovery action servers.
+ *
+ * @ingroup abstract_server
+ */
+class ExecutionArbiter
+{
+public:
+
+  //! Executions a goal can claim; combine them with bitwise or
+  enum Execution
+  {
+    PLANNER = 1,
+    CONTROLLER = 2,
+    RECOVERY = 4
+  };
+
+  /**
+   * @brief Constructor
+   */
+  ExecutionArbiter();
+
+  /**
+   * @brief Claims the given executions for a new goal. Any goal holding or waiting for one of them is asked to
+   *        preempt, and the call blocks until the holders have released them.
+   * @param executions The executions to claim, as a combination of Execution values.
+   * @return A ticket identifying the claim, or zero if a newer goal has claimed the executions in the meantime.
+   */
+  unsigned int acquire(unsigned int executions);
+
+  /**
+   * @brief Releases the executions claimed with the given ticket.
+   * @param ticket The ticket returned by acquire(); zero is ignored.
+   */
+  void release(unsigned int ticket);
+
+  /**
+   * @brief Checks whether a newer goal has claimed any of the executions claimed with the given ticket.
+   * @param ticket The ticket returned by acquire().
+   * @return true, if the goal holding the ticket has to preempt.
+   */
+  bool isPreempted(unsigned int ticket);
+
+private:
+
+  //! Executions claimed by a goal
+  struct Claim
+  {
+    unsigned int ticket;      //!< the ticket identifying the claim
+    unsigned int executions;  //!< the claimed executions
+    bool granted;             //!< true, once the goal holds the executions
+    bool preempted;           //!< true, if a newer goal claimed any of the executions
+  };
+
+  /**
+   * @brief Finds the claim with the given ticket.
+   */
+  std::list<Claim>::iterator find(unsigned int ticket);
+
+  //! mutex protecting the claims
+  boost::mutex mutex_;
+
+  //! condition variable to wake up the waiting claims on every release
+  boost::condition_variable cond_;
+
+  //! granted and waiting claims, the oldest first
+  std::list<Claim> claims_;
+
+  //! last ticket handed out
+  unsigned int last_ticket_;
+};
+
+} /* namespace mbf_abstract_nav */
+
+#endif /* MBF_ABSTRACT_NAV__EXECUTION_ARBITER_H_ */
@@ -0,0 +1,158 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  execution_stats.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_ABSTRACT_NAV__EXECUTION_STATS_H_
+#define MBF_ABSTRACT_NAV__EXECUTION_STATS_H_
+
+#include <string>
+#include <boost/atomic.hpp>
+#include <boost/chrono.hpp>
+#include <boost/thread/mutex.hpp>
+#include <mbf_msgs/ExecutionStats.h>
+
+#include "latency_histogram.h"
+
+namespace mbf_abstract_nav
+{
+
+/**
+ * @brief The ExecutionStats class records the timing of the planner or the controller cycles: the time spent on
+ *        each cycle, the period between cycles, its jitter and the number of missed deadlines. Cycles are timed with
+ *        a steady clock, so time blocked on mutexes or preempted by the OS is also accounted for.
+ *        Only the execution thread records cycles; the statistics can be read and reset from any thread.
+ *
+ * @ingroup abstract_server
+ */
+class ExecutionStats
+{
+public:
+
+  /**
+   * @brief Constructor
+   * @param name Name of the execution, e.g. planner or controller.
+   */
+  ExecutionStats(const std::string &name);
+
+  /**
+   * @brief Sets the plugin in use; the statistics are reset, as they are kept per plugin.
+   * @param plugin_name Name of the plugin.
+   */
+  void setPlugin(const std::string &plugin_name);
+
+  /**
+   * @brief Sets the desired cycle period; cycles taking longer are counted as missed deadlines.
+   * @param period The desired period, or zero if the cycles are not periodic.
+   */
+  void setTargetPeriod(const boost::chrono::microseconds &period);
+
+  /**
+   * @brief Marks the start of a new run, so the time since the last cycle of the previous run is not taken as a period.
+   */
+  void startRun();
+
+  /**
+   * @brief Marks the start of a cycle.
+   */
+  void startCycle();
+
+  /**
+   * @brief Marks the end of a cycle, i.e. the work is done and the execution is about to sleep until the next one.
+   */
+  void endCycle();
+
+  /**
+   * @brief Empties all the statistics.
+   */
+  void reset();
+
+  /**
+   * @brief Fills a message with the current statistics.
+   * @param msg The message to fill.
+   */
+  void toMsg(mbf_msgs::ExecutionStats &msg);
+
+  /**
+   * @brief Fills a latency summary message from a histogram.
+   * @param histogram The histogram to summarize.
+   * @param msg The message to fill.
+   */
+  static void toMsg(const LatencyHistogram &histogram, mbf_msgs::LatencyStats &msg);
+
+private:
+
+  typedef boost::chrono::steady_clock::time_point TimePoint;
+
+  //! name of the execution
+  const std::string name_;
+
+  //! mutex protecting the plugin name
+  boost::mutex plugin_mtx_;
+
+  //! name of the plugin in use
+  std::string plugin_name_;
+
+  //! desired cycle period, in microseconds
+  boost::atomic<int64_t> target_period_;
+
+  //! number of completed cycles
+  boost::atomic<uint64_t> cycles_;
+
+  //! number of cycles taking longer than the target period
+  boost::atomic<uint64_t> missed_deadlines_;
+
+  //! time spent on each cycle
+  LatencyHistogram compute_time_;
+
+  //! time between the starts of consecutive cycles
+  LatencyHistogram period_;
+
+  //! deviation of the period from the target period
+  LatencyHistogram jitter_;
+
+  //! start of the current cycle; only used by the execution thread
+  TimePoint cycle_start_;
+
+  //! true, if there is a previous cycle in the current run; only used by the execution thread
+  bool has_last_cycle_;
+};
+
+} /* namespace mbf_abstract_nav */
+
+#endif /* MBF_ABSTRACT_NAV__EXECUTION_STATS_H_ */
@@ -0,0 +1,120 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  feedback_throttle.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_ABSTRACT_NAV__FEEDBACK_THROTTLE_H_
+#define MBF_ABSTRACT_NAV__FEEDBACK_THROTTLE_H_
+
+#include <ros/ros.h>
+#include <geometry_msgs/PoseStamped.h>
+#include <geometry_msgs/TwistStamped.h>
+
+namespace mbf_abstract_nav
+{
+
+/**
+ * @brief The FeedbackThrottle class decides when an action publishes its feedback. Feedback is published at most at
+ *        the given rate, and only if the robot pose or velocity changed meaningfully since the last one published,
+ *        or if the keep-alive period has elapsed; the updates in between are coalesced into the next published one.
+ *        It's used by a single action thread, so it's not thread safe.
+ *
+ * @ingroup abstract_server
+ */
+class FeedbackThrottle
+{
+public:
+
+  /**
+   * @brief Constructor; with all values at zero, every feedback is published.
+   * @param rate Maximum feedback rate; zero for no limit.
+   * @param min_distance Minimum robot displacement, in meters, to publish a new feedback; zero to ignore it.
+   * @param min_angle Minimum robot rotation, in radians, to publish a new feedback; zero to ignore it.
+   * @param min_velocity Minimum change of any velocity component to publish a new feedback; zero to ignore it.
+   * @param keepalive_period Feedback is published after this period, even if nothing changed; zero to disable.
+   */
+  FeedbackThrottle(double rate = 0.0, double min_distance = 0.0, double min_angle = 0.0, double min_velocity = 0.0,
+                   double keepalive_period = 0.0);
+
+  /**
+   * @brief Forgets the last published feedback, so the next one is always published. Call it on each new goal.
+   */
+  void reset();
+
+  /**
+   * @brief Checks whether to publish a feedback with the given robot state now; if so, the state is recorded as
+   *        the last published one.
+   * @param pose The current robot pose.
+   * @param velocity The current robot velocity.
+   * @return true, if the feedback has to be published.
+   */
+  bool check(const geometry_msgs::PoseStamped &pose, const geometry_msgs::TwistStamped &velocity);
+
+private:
+
+  //! minimum period between two feedbacks
+  ros::Duration period_;
+
+  //! minimum robot displacement to publish a new feedback
+  double min_distance_;
+
+  //! minimum robot rotation to publish a new feedback
+  double min_angle_;
+
+  //! minimum velocity change to publish a new feedback
+  double min_velocity_;
+
+  //! maximum period without feedback, even if nothing changed; zero to disable
+  ros::Duration keepalive_period_;
+
+  //! true, if no feedback has been published since the last reset
+  bool first_;
+
+  //! time of the last published feedback
+  ros::Time last_time_;
+
+  //! robot pose in the last published feedback
+  geometry_msgs::PoseStamped last_pose_;
+
+  //! robot velocity in the last published feedback
+  geometry_msgs::TwistStamped last_velocity_;
+};
+
+} /* namespace mbf_abstract_nav */
+
+#endif /* MBF_ABSTRACT_NAV__FEEDBACK_THROTTLE_H_ */
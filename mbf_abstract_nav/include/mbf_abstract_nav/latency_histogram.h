@@ -0,0 +1,135 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  latency_histogram.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_ABSTRACT_NAV__LATENCY_HISTOGRAM_H_
+#define MBF_ABSTRACT_NAV__LATENCY_HISTOGRAM_H_
+
+#include <stdint.h>
+#include <boost/atomic.hpp>
+
+namespace mbf_abstract_nav
+{
+
+/**
+ * @brief The LatencyHistogram class counts durations, in microseconds, on log-linear buckets: each power of two is
+ *        split into 16 buckets, so any percentile is accurate to about 6%, from microseconds to days, with a fixed
+ *        amount of memory. Recording is lock-free and meant for a single writer; any number of threads can read or
+ *        reset the histogram at the same time, at the cost of slightly inconsistent reads.
+ *
+ * @ingroup abstract_server
+ */
+class LatencyHistogram
+{
+public:
+
+  /**
+   * @brief Constructor; creates an empty histogram.
+   */
+  LatencyHistogram();
+
+  /**
+   * @brief Records a duration.
+   * @param value Duration in microseconds.
+   */
+  void record(uint64_t value);
+
+  /**
+   * @brief Empties the histogram.
+   */
+  void reset();
+
+  /**
+   * @brief Number of recorded durations.
+   */
+  uint64_t count() const;
+
+  /**
+   * @brief Shortest recorded duration, or 0 if none.
+   */
+  uint64_t min() const;
+
+  /**
+   * @brief Longest recorded duration.
+   */
+  uint64_t max() const;
+
+  /**
+   * @brief Average of all recorded durations, or 0 if none.
+   */
+  double mean() const;
+
+  /**
+   * @brief Duration below which the given fraction of the recorded durations fall.
+   * @param fraction Fraction between 0 and 1, e.g. 0.99 for the 99th percentile.
+   * @return Duration in microseconds, or 0 if none has been recorded.
+   */
+  uint64_t percentile(double fraction) const;
+
+private:
+
+  //! bits of each value used to split a power of two in buckets
+  static const unsigned int SUB_BUCKET_BITS = 4;
+
+  //! values are clamped to 2^MAX_VALUE_BITS - 1 microseconds, i.e. about 12 days
+  static const unsigned int MAX_VALUE_BITS = 40;
+
+  //! number of buckets needed to cover all values
+  static const unsigned int BUCKETS = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS;
+
+  /**
+   * @brief Index of the bucket a value falls in.
+   */
+  static unsigned int bucketIndex(uint64_t value);
+
+  /**
+   * @brief Middle value of a bucket.
+   */
+  static uint64_t bucketValue(unsigned int index);
+
+  boost::atomic<uint64_t> buckets_[BUCKETS];
+  boost::atomic<uint64_t> count_;
+  boost::atomic<uint64_t> sum_;
+  boost::atomic<uint64_t> min_;
+  boost::atomic<uint64_t> max_;
+};
+
+} /* namespace mbf_abstract_nav */
+
+#endif /* MBF_ABSTRACT_NAV__LATENCY_HISTOGRAM_H_ */
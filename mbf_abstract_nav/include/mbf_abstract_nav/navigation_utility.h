@@ -41,11 +41,20 @@
 #ifndef MOVE_BASE_FLEX__NAVIGATION_STATE_H_
 #define MOVE_BASE_FLEX__NAVIGATION_STATE_H_
 
+#include <vector>
+#include <boost/shared_ptr.hpp>
 #include <tf/transform_listener.h>
+#include <geometry_msgs/PoseStamped.h>
 
 namespace mbf_abstract_nav
 {
 
+//! A plan, i.e. a sequence of stamped poses.
+typedef std::vector<geometry_msgs::PoseStamped> Plan;
+
+//! An immutable, shared plan; it's handed from the planner over the server to the controller without copying it.
+typedef boost::shared_ptr<const Plan> PlanConstPtr;
+
 /**
  * @brief Transforms a pose from one frame into another.
  * @param tf_listener TransformListener.
@@ -65,6 +74,23 @@ bool transformPose(const tf::TransformListener &tf_listener,
                    const std::string &fixed_frame,
                    geometry_msgs::PoseStamped &out);
 
+/**
+ * @brief Transforms a whole plan into the target frame. The transform is looked up only once for each run of
+ *        consecutive poses sharing the same frame and time stamp and then applied to all of them; poses already
+ *        in the target frame are copied without any lookup.
+ * @param tf_listener TransformListener.
+ * @param target_frame Target frame for the plan.
+ * @param timeout Timeout for looking up each of the transformations.
+ * @param in Plan to transform.
+ * @param out Transformed plan; the poses keep their time stamps.
+ * @return true, if all the poses could be transformed.
+ */
+bool transformPlan(const tf::TransformListener &tf_listener,
+                   const std::string &target_frame,
+                   const ros::Duration &timeout,
+                   const Plan &in,
+                   Plan &out);
+
 /**
  * @brief Computes the robot pose.
  * @param tf_listener TransformListener.
@@ -85,15 +111,15 @@ bool getRobotPose(const tf::TransformListener &tf_listener,
  * @param pose2 pose 2
  * @return Euclidean distance between pose 1 and pose 2.
  */
-double distance(const geometry_msgs::PoseStamped pose1, const geometry_msgs::PoseStamped pose2);
+double distance(const geometry_msgs::PoseStamped &pose1, const geometry_msgs::PoseStamped &pose2);
 
 /**
- * @brief computes the smallest angle between two poses.
+ * @brief computes the smallest angle between two poses, directly from the quaternion messages.
  * @param pose1 pose 1
  * @param pose2 pose 2
  * @return smallest angle between pose 1 and pose 2.
  */
-double angle(const geometry_msgs::PoseStamped pose1, const geometry_msgs::PoseStamped pose2);
+double angle(const geometry_msgs::PoseStamped &pose1, const geometry_msgs::PoseStamped &pose2);
 
 } /* namespace mbf_abstract_nav */
 
@@ -0,0 +1,120 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  path_publisher.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_ABSTRACT_NAV__PATH_PUBLISHER_H_
+#define MBF_ABSTRACT_NAV__PATH_PUBLISHER_H_
+
+#include <string>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include <ros/ros.h>
+
+#include "navigation_utility.h"
+
+namespace mbf_abstract_nav
+{
+
+/**
+ * @brief The PathPublisher class publishes the plans for visualization and monitoring. Plans are simplified with the
+ *        Douglas-Peucker algorithm and capped to a maximum number of poses before publishing them, and they are only
+ *        published if someone is listening and the plan has changed since the last one. Besides the nav_msgs/Path
+ *        topic, a compact version with only an (x, y, yaw) triplet per pose is published on the "_compact" topic.
+ *
+ * @ingroup abstract_server
+ */
+class PathPublisher
+{
+public:
+
+  /**
+   * @brief Constructor; advertises the path topics.
+   * @param nh Node handle on which to advertise the topics.
+   * @param topic Name of the path topic; the compact path is advertised on the same name plus "_compact".
+   * @param tolerance Maximum deviation, in meters, of the simplified path from the plan; zero to keep all poses.
+   * @param max_poses Maximum number of poses to publish; zero for no limit.
+   */
+  PathPublisher(ros::NodeHandle &nh, const std::string &topic, double tolerance, int max_poses);
+
+  /**
+   * @brief Publishes the given plan, if there are subscribers and it differs from the last one published.
+   *        Thread safe.
+   * @param plan The plan to publish.
+   */
+  void publish(const Plan &plan);
+
+  /**
+   * @brief Selects the poses to publish: Douglas-Peucker simplification within the tolerance, then an even
+   *        subsampling down to the maximum number of poses. The first and the last pose are always kept.
+   * @param plan The plan to simplify; it must not be empty.
+   * @param tolerance Maximum deviation, in meters, of the simplified path from the plan; zero to keep all poses.
+   * @param max_poses Maximum number of poses to keep; zero for no limit.
+   * @param indices The indices of the poses to publish, in order.
+   */
+  static void simplify(const Plan &plan, double tolerance, size_t max_poses, std::vector<size_t> &indices);
+
+private:
+
+  /**
+   * @brief Checks whether the plan differs from the last one published, ignoring the time stamps.
+   */
+  bool hasChanged(const Plan &plan) const;
+
+  //! maximum deviation of the simplified path from the plan
+  double tolerance_;
+
+  //! maximum number of poses to publish; zero for no limit
+  size_t max_poses_;
+
+  //! mutex serializing the publishing threads
+  boost::mutex mutex_;
+
+  //! last plan published
+  Plan last_plan_;
+
+  //! publisher for the simplified path
+  ros::Publisher path_pub_;
+
+  //! publisher for the compact path
+  ros::Publisher compact_path_pub_;
+};
+
+} /* namespace mbf_abstract_nav */
+
+#endif /* MBF_ABSTRACT_NAV__PATH_PUBLISHER_H_ */
@@ -0,0 +1,103 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  plan_processing_chain.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_ABSTRACT_NAV__PLAN_PROCESSING_CHAIN_H_
+#define MBF_ABSTRACT_NAV__PLAN_PROCESSING_CHAIN_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include <mbf_abstract_core/abstract_plan_processor.h>
+
+#include "navigation_utility.h"
+
+namespace mbf_abstract_nav
+{
+
+/**
+ * @brief The PlanProcessingChain class runs the plans through a sequence of post-processing stages, e.g. smoothing,
+ *        resampling and orientation fill-in, before they are handed to the controller. The stages are plugins
+ *        implementing mbf_abstract_core::AbstractPlanProcessor, configured like the recovery behaviors: the
+ *        "plan_processors" parameter is a list of structs with the name and the type of each stage, applied in
+ *        that order. Each stage reads its parameters from its own namespace, i.e. its name.
+ *
+ * @ingroup abstract_server
+ */
+class PlanProcessingChain
+{
+public:
+
+  /**
+   * @brief Constructor; loads the stages from the "plan_processors" parameter. Stages that cannot be loaded or
+   *        initialized are skipped.
+   */
+  PlanProcessingChain();
+
+  /**
+   * @brief Checks whether there are stages to run.
+   * @return True if no stage is loaded, so plans are passed through unchanged.
+   */
+  bool empty() const;
+
+  /**
+   * @brief Runs the plan through all the stages. Thread safe; concurrent calls are serialized.
+   * @param plan The plan to process.
+   * @param processed The processed plan; the given one, if there are no stages.
+   * @param message The failure details, if any stage fails.
+   * @return True on success, false if a stage failed or left an empty plan.
+   */
+  bool process(const PlanConstPtr &plan, PlanConstPtr &processed, std::string &message);
+
+private:
+
+  //! a named stage
+  typedef std::pair<std::string, mbf_abstract_core::AbstractPlanProcessor::Ptr> Stage;
+
+  //! the stages, in the order they are applied
+  std::vector<Stage> stages_;
+
+  //! mutex serializing the plans through the stages, as these are not required to be thread safe
+  boost::mutex process_mtx_;
+};
+
+} /* namespace mbf_abstract_nav */
+
+#endif /* MBF_ABSTRACT_NAV__PLAN_PROCESSING_CHAIN_H_ */
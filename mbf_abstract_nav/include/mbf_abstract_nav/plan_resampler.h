@@ -0,0 +1,82 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  plan_resampler.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_ABSTRACT_NAV__PLAN_RESAMPLER_H_
+#define MBF_ABSTRACT_NAV__PLAN_RESAMPLER_H_
+
+#include <mbf_abstract_core/abstract_plan_processor.h>
+
+namespace mbf_abstract_nav
+{
+
+/**
+ * @brief Plan processing stage resampling the plan to poses evenly spaced along it, densifying sparse plans and
+ *        thinning out dense ones. Positions are interpolated linearly; each new pose takes the orientation and the
+ *        header of the pose starting its segment, so this stage is usually followed by a PlanOrientationFiller.
+ *        The first and the last pose are kept.
+ *
+ * Parameters, in the stage namespace:
+ * - spacing: distance between consecutive poses, in meters; zero or less to disable the stage; default 0.05
+ *
+ * @ingroup abstract_server
+ */
+class PlanResampler : public mbf_abstract_core::AbstractPlanProcessor
+{
+public:
+
+  PlanResampler();
+
+  virtual ~PlanResampler();
+
+  virtual bool initialize(const std::string &name);
+
+  virtual bool process(const std::vector<geometry_msgs::PoseStamped> &plan,
+                       std::vector<geometry_msgs::PoseStamped> &processed,
+                       std::string &message);
+
+private:
+
+  //! distance between consecutive poses
+  double spacing_;
+};
+
+} /* namespace mbf_abstract_nav */
+
+#endif /* MBF_ABSTRACT_NAV__PLAN_RESAMPLER_H_ */
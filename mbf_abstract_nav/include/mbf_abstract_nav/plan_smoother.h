@@ -0,0 +1,90 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  plan_smoother.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_ABSTRACT_NAV__PLAN_SMOOTHER_H_
+#define MBF_ABSTRACT_NAV__PLAN_SMOOTHER_H_
+
+#include <mbf_abstract_core/abstract_plan_processor.h>
+
+namespace mbf_abstract_nav
+{
+
+/**
+ * @brief Plan processing stage smoothing the plan positions. Each iteration moves every inner pose towards the
+ *        middle of its neighbours, weighted by weight_smooth, and back towards its original position, weighted by
+ *        weight_data; the first and the last pose are kept. Orientations are left untouched, so this stage is
+ *        usually followed by a PlanOrientationFiller.
+ *
+ * Parameters, in the stage namespace:
+ * - iterations: number of smoothing iterations; default 10
+ * - weight_smooth: weight pulling each pose towards its neighbours, within [0, 0.5]; default 0.3
+ * - weight_data: weight pulling each pose back to its original position, within [0, 1]; default 0.1
+ *
+ * @ingroup abstract_server
+ */
+class PlanSmoother : public mbf_abstract_core::AbstractPlanProcessor
+{
+public:
+
+  PlanSmoother();
+
+  virtual ~PlanSmoother();
+
+  virtual bool initialize(const std::string &name);
+
+  virtual bool process(const std::vector<geometry_msgs::PoseStamped> &plan,
+                       std::vector<geometry_msgs::PoseStamped> &processed,
+                       std::string &message);
+
+private:
+
+  //! number of smoothing iterations
+  int iterations_;
+
+  //! weight pulling each pose towards its neighbours
+  double weight_smooth_;
+
+  //! weight pulling each pose back to its original position
+  double weight_data_;
+};
+
+} /* namespace mbf_abstract_nav */
+
+#endif /* MBF_ABSTRACT_NAV__PLAN_SMOOTHER_H_ */
@@ -0,0 +1,204 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  planner_pool.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_ABSTRACT_NAV__PLANNER_POOL_H_
+#define MBF_ABSTRACT_NAV__PLANNER_POOL_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <geometry_msgs/PoseStamped.h>
+
+#include "abstract_planner_execution.h"
+#include "worker_thread.h"
+#include "navigation_utility.h"
+#include "mbf_abstract_nav/MoveBaseFlexConfig.h"
+
+namespace mbf_abstract_nav
+{
+
+/**
+ * @brief The PlannerPool class holds several slots, each of them with its own worker thread and its own instance of
+ *        the requested global planner plugin. It plans batches of independent start / goal queries in parallel,
+ *        distributing them over all the slots. The instances are loaded through a single planner execution, which
+ *        provides the plugin loading and the planning hooks of the concrete server but doesn't load any plugin itself;
+ *        every slot loads the default planner on initialization and any other one on its first request.
+ *        The pool planners are independent from the planner execution used by the GetPath and MoveBase actions.
+ *
+ * @ingroup abstract_server planner_execution
+ */
+class PlannerPool
+{
+public:
+
+  typedef boost::shared_ptr<PlannerPool> Ptr;
+
+  //! Function creating a new, not yet initialized, planner execution; the pool uses it to load its planners
+  typedef boost::function<AbstractPlannerExecution::Ptr()> PlannerFactory;
+
+  //! A single planning query
+  struct Query
+  {
+    geometry_msgs::PoseStamped start;
+    geometry_msgs::PoseStamped goal;
+    double tolerance;
+  };
+
+  //! The answer of the planner to a single planning query
+  struct Answer
+  {
+    PlanConstPtr plan;
+    double cost;
+    uint32_t outcome;
+    std::string message;
+  };
+
+  /**
+   * @brief Constructor
+   * @param factory Function used to create the planner execution loading the pool planners
+   * @param size Number of slots in the pool
+   */
+  PlannerPool(const PlannerFactory &factory, unsigned int size);
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~PlannerPool();
+
+  /**
+   * @brief Creates the planner execution and loads an instance of the default planner plugin on every slot.
+   * @return true, if all the planners have been loaded, false otherwise.
+   */
+  bool initialize();
+
+  /**
+   * @brief Takes the default planner plugin from the configuration; the planners already loaded are kept.
+   * @param config MoveBaseFlexConfig object
+   */
+  void reconfigure(mbf_abstract_nav::MoveBaseFlexConfig &config);
+
+  /**
+   * @brief Plans all the queries in parallel, and blocks until all of them are answered. Every slot takes the
+   *        next pending query as soon as it finishes the previous one. Concurrent batches are run one after another.
+   * @param planner Name or type of the planner plugin to use; if empty, the default one. Planner races are not
+   *        supported, as every query is planned by a single slot.
+   * @param queries The planning queries.
+   * @param answers The answers, one for each query and in the same order.
+   */
+  void makePlans(const std::string &planner, const std::vector<Query> &queries, std::vector<Answer> &answers);
+
+  /**
+   * @brief Returns the number of slots in the pool.
+   * @return the pool size.
+   */
+  unsigned int size() const;
+
+private:
+
+  //! A planner instance loaded on a slot
+  struct Instance
+  {
+    std::string name;
+    mbf_abstract_core::AbstractPlanner::Ptr planner;
+  };
+
+  //! The planner instances of a slot, by requested name or type
+  typedef std::map<std::string, Instance> Slot;
+
+  /**
+   * @brief Returns the instance of the given planner on the given slot, loading it on first use.
+   * @param slot Index of the slot.
+   * @param planner Name or type of the planner plugin, as requested.
+   * @return The instance; its planner is empty if it could not be loaded.
+   */
+  Instance getInstance(size_t slot, const std::string &planner);
+
+  /**
+   * @brief Worker task: takes pending queries from the current batch and plans them, until none is left.
+   * @param slot Index of the slot to use.
+   */
+  void planQueries(size_t slot);
+
+  //! function creating the planner execution
+  PlannerFactory factory_;
+
+  //! number of slots in the pool
+  unsigned int size_;
+
+  //! the planner execution loading the planner instances and providing the planning hooks
+  AbstractPlannerExecution::Ptr execution_;
+
+  //! the planner instances of each slot; each slot is only used by its own worker
+  std::vector<Slot> slots_;
+
+  //! one worker thread per slot
+  std::vector<boost::shared_ptr<WorkerThread> > workers_;
+
+  //! mutex protecting the default planner
+  boost::mutex config_mtx_;
+
+  //! name or type of the default planner plugin, as given on reconfigure; empty until then
+  std::string default_planner_;
+
+  //! mutex to run one batch after another
+  boost::mutex batch_mtx_;
+
+  //! mutex protecting the index of the next pending query
+  boost::mutex query_mtx_;
+
+  //! name or type of the planner plugin requested for the current batch
+  std::string planner_;
+
+  //! the queries of the current batch
+  const std::vector<Query> *queries_;
+
+  //! the answers of the current batch
+  std::vector<Answer> *answers_;
+
+  //! index of the next pending query of the current batch
+  size_t next_query_;
+};
+
+} /* namespace mbf_abstract_nav */
+
+#endif /* MBF_ABSTRACT_NAV__PLANNER_POOL_H_ */
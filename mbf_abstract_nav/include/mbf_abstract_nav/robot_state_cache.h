@@ -0,0 +1,158 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  robot_state_cache.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_ABSTRACT_NAV__ROBOT_STATE_CACHE_H_
+#define MBF_ABSTRACT_NAV__ROBOT_STATE_CACHE_H_
+
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <ros/ros.h>
+#include <tf/transform_listener.h>
+#include <nav_msgs/Odometry.h>
+#include <geometry_msgs/PoseStamped.h>
+#include <geometry_msgs/TwistStamped.h>
+
+namespace mbf_abstract_nav
+{
+
+/**
+ * @brief The RobotStateCache class keeps the latest robot pose and velocity. The velocity is taken from odometry,
+ *        and the pose is looked up on TF on every odometry message and at a fixed rate, using the latest available
+ *        transform, so no one waits for TF. Each update publishes a new immutable state, so readers get a consistent
+ *        pose and velocity without ever blocking on the writers. It's shared by the server and the controller.
+ *
+ * @ingroup abstract_server
+ */
+class RobotStateCache
+{
+public:
+  typedef boost::shared_ptr<RobotStateCache> Ptr;
+
+  //! A snapshot of the robot state; stamps are zero until the first pose or velocity is received
+  struct State
+  {
+    geometry_msgs::PoseStamped pose;
+    geometry_msgs::TwistStamped velocity;
+  };
+
+  typedef boost::shared_ptr<const State> StateConstPtr;
+
+  /**
+   * @brief Constructor; subscribes to the odometry topic.
+   * @param tf_listener_ptr Shared pointer to a common TransformListener.
+   * @param robot_frame The robot frame.
+   * @param global_frame The frame in which to express the robot pose.
+   * @param odom_topic The odometry topic, providing the robot velocity.
+   * @param pose_frequency Rate at which to update the robot pose from TF, besides on every odometry message;
+   *        zero to update it only on odometry messages.
+   */
+  RobotStateCache(const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr,
+                  const std::string &robot_frame, const std::string &global_frame, const std::string &odom_topic,
+                  double pose_frequency);
+
+  /**
+   * @brief Gets the latest robot state. It never blocks.
+   * @return Shared pointer to the latest state.
+   */
+  StateConstPtr get() const;
+
+  /**
+   * @brief Gets the latest robot pose and checks that it's recent enough. If it's not, the pose is updated from TF
+   *        once more before giving up, still without waiting for TF.
+   * @param pose The latest robot pose, even if it's too old.
+   * @param max_age Maximum age of the pose to be considered valid.
+   * @return true, if the pose is not older than max_age, false if it's stale or it has never been received.
+   */
+  bool getPose(geometry_msgs::PoseStamped &pose, const ros::Duration &max_age);
+
+  /**
+   * @brief Updates the robot pose with the latest transform available on TF. It never waits for TF.
+   * @return true, if the pose has been updated, false if the transform is not available.
+   */
+  bool updatePose();
+
+private:
+
+  /**
+   * @brief Odometry callback; updates the robot velocity and the pose.
+   */
+  void odomCallback(const nav_msgs::Odometry::ConstPtr &odom);
+
+  /**
+   * @brief Timer-triggered update of the robot pose.
+   */
+  void poseTimerCallback(const ros::TimerEvent &event);
+
+  /**
+   * @brief Checks whether the pose has ever been received and is not older than max_age.
+   */
+  static bool isFresh(const geometry_msgs::PoseStamped &pose, const ros::Duration &max_age);
+
+  /**
+   * @brief Publishes a new state with the given pose and/or velocity, keeping the current value of the other.
+   */
+  void update(const geometry_msgs::PoseStamped *pose, const geometry_msgs::TwistStamped *velocity);
+
+  //! shared pointer to the common TransformListener
+  const boost::shared_ptr<tf::TransformListener> tf_listener_ptr_;
+
+  //! the robot frame
+  const std::string robot_frame_;
+
+  //! the frame in which the robot pose is expressed
+  const std::string global_frame_;
+
+  //! mutex serializing the writers; readers never take it
+  boost::mutex update_mtx_;
+
+  //! the latest state; only accessed with the shared_ptr atomic functions
+  StateConstPtr state_;
+
+  //! odometry subscriber
+  ros::Subscriber odom_sub_;
+
+  //! timer to update the robot pose at a fixed rate
+  ros::Timer pose_timer_;
+};
+
+} /* namespace mbf_abstract_nav */
+
+#endif /* MBF_ABSTRACT_NAV__ROBOT_STATE_CACHE_H_ */
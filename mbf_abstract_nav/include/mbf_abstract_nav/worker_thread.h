@@ -0,0 +1,161 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  worker_thread.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_ABSTRACT_NAV__WORKER_THREAD_H_
+#define MBF_ABSTRACT_NAV__WORKER_THREAD_H_
+
+#include <string>
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace mbf_abstract_nav
+{
+
+/**
+ * @brief The WorkerThread class owns a long-lived thread, which is parked between the tasks posted to it. The
+ *        executions use it to run their cycles, so no thread is created and torn down for every goal and the thread
+ *        keeps its stack and its CPU affinity.
+ *        Posted tasks should handle boost::thread_interrupted and their own exceptions; the worker only logs them and
+ *        parks again.
+ *
+ * @ingroup abstract_server
+ */
+class WorkerThread
+{
+public:
+
+  //! A task to be run by the worker
+  typedef boost::function<void()> Task;
+
+  /**
+   * @brief Constructor; starts the worker thread.
+   * @param name Name of the worker, used for logging
+   */
+  WorkerThread(const std::string &name);
+
+  /**
+   * @brief Destructor; stops the worker thread, if not done yet. See stop().
+   */
+  virtual ~WorkerThread();
+
+  /**
+   * @brief Stops the worker: discards the posted task, interrupts the current one, if any, and joins the worker
+   *        thread. No tasks are accepted afterwards. Owners whose tasks use their members must call it before these
+   *        are destroyed.
+   */
+  void stop();
+
+  /**
+   * @brief Posts a task to the worker. If the worker is busy, the task starts right after the current one finishes.
+   * @param task The task to run.
+   * @return true, if the task has been accepted, false if another task is already waiting to be run.
+   */
+  bool post(const Task &task);
+
+  /**
+   * @brief Interrupts the current task by a thread interrupt. Only useful if the task contains interruption points.
+   *        If the posted task has not started yet, the interrupt is kept and raised as soon as it starts. An interrupt
+   *        requested while the worker is idle is discarded.
+   */
+  void interrupt();
+
+  /**
+   * @brief Blocks until the worker has finished all posted tasks. The worker thread itself keeps running.
+   */
+  void waitUntilIdle();
+
+  /**
+   * @brief Checks whether the worker is running or about to run a task.
+   * @return true, if the worker is busy.
+   */
+  bool isBusy();
+
+  /**
+   * @brief Pins the worker thread to the given CPU core. Only supported on Linux.
+   * @param cpu Index of the CPU core, or a negative value to do nothing.
+   * @return true, if the affinity has been set or nothing had to be done.
+   */
+  bool setAffinity(int cpu);
+
+  /**
+   * @brief Runs the worker thread with the SCHED_FIFO real-time policy and the given priority, so it preempts any
+   *        normal thread. Only supported on Linux, and usually requires the CAP_SYS_NICE capability or an rtprio limit.
+   * @param priority Real-time priority, from 1 to 99, or zero or a negative value to do nothing.
+   * @return true, if the priority has been set or nothing had to be done.
+   */
+  bool setRealtimePriority(int priority);
+
+private:
+
+  /**
+   * @brief Main loop of the worker thread: waits for a task, runs it, and parks again.
+   */
+  void loop();
+
+  //! name of the worker, used for logging
+  std::string name_;
+
+  //! mutex protecting the task and the worker state
+  boost::mutex mutex_;
+
+  //! condition variable to wake up the worker on new tasks, and the waiters on finished ones
+  boost::condition_variable cond_;
+
+  //! next task to run; empty if there is none
+  Task task_;
+
+  //! true, while a task is running
+  bool running_;
+
+  //! true, if an interrupt has been requested for the posted task before it started
+  bool interrupt_pending_;
+
+  //! true, if the worker thread has to exit
+  bool shutdown_;
+
+  //! the worker thread; declared last, so it's started after all the other members are initialized
+  boost::thread thread_;
+};
+
+} /* namespace mbf_abstract_nav */
+
+#endif /* MBF_ABSTRACT_NAV__WORKER_THREAD_H_ */
@@ -38,6 +38,8 @@
  *
  */
 
+#include <XmlRpcException.h>
+
 #include "mbf_abstract_nav/abstract_controller_execution.h"
 
 namespace mbf_abstract_nav
@@ -45,18 +47,141 @@ namespace mbf_abstract_nav
 
 
   AbstractControllerExecution::AbstractControllerExecution(
-      boost::condition_variable &condition, const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr) :
-      condition_(condition), tf_listener_ptr(tf_listener_ptr), state_(STOPPED), moving_(false), plugin_code_(255)
+      const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr) :
+      tf_listener_ptr(tf_listener_ptr), new_plan_(false), moving_(false),
+      stats_("controller"), plugin_loader_("controller_loader"), worker_("controller")
   {
     ros::NodeHandle nh;
+
+    staged_.state = STOPPED;
+    staged_.seq = 0;
+    staged_.plugin_code = 255;
+    snapshot_ = boost::make_shared<const Snapshot>(staged_);
+
+    params_valid_ = loadParams();
+
+    // init cmd_vel publisher for the robot velocity t
+    vel_pub_ = nh.advertise<geometry_msgs::Twist>("cmd_vel", 1);
+  }
+
+
+  AbstractControllerExecution::~AbstractControllerExecution()
+  {
+    terminate();
+  }
+
+
+  void AbstractControllerExecution::terminate()
+  {
+    moving_ = false;
+    worker_.stop();
+    plugin_loader_.stop();
+  }
+
+
+  bool AbstractControllerExecution::initialize()
+  {
+    if (!params_valid_)
+    {
+      return false;
+    }
+
+    std::map<std::string, std::string>::iterator iter = controller_types_.begin();
+    while (iter != controller_types_.end())
+    {
+      mbf_abstract_core::AbstractController::Ptr controller_ptr = loadPlugin(iter->first, iter->second);
+      if (controller_ptr)
+      {
+        controllers_[iter->first] = controller_ptr;
+        ++iter;
+      }
+      else
+      {
+        ROS_ERROR_STREAM("Could not load the controller plugin \"" << iter->first << "\" of type \""
+                         << iter->second << "\"");
+        controller_types_.erase(iter++);
+      }
+    }
+
+    if (controllers_.find(default_plugin_name_) == controllers_.end())
+    {
+      // on startup there is no previous plugin to fall back to
+      ROS_ERROR_STREAM("The default controller plugin \"" << default_plugin_name_ << "\" could not be loaded!");
+      return false;
+    }
+
+    boost::atomic_store(&controller_, controllers_[default_plugin_name_]);
+    plugin_name_ = default_plugin_name_;
+    stats_.setPlugin(plugin_name_);
+    setState(INITIALIZED);
+    return true;
+  }
+
+
+  bool AbstractControllerExecution::loadParams()
+  {
     ros::NodeHandle private_nh("~");
 
     double patience, frequency;
+    int cpu, priority;
 
-    if(!private_nh.getParam("local_planner", plugin_name_))
+    // named controller plugins, all loaded on initialization so each goal can select one; the first is the default
+    XmlRpc::XmlRpcValue controllers_param;
+    if (private_nh.getParam("local_planners", controllers_param))
     {
-      ROS_ERROR_STREAM("Parameter \"local_planner\" not set!");
-      exit(0);
+      try
+      {
+        for (int i = 0; i < controllers_param.size(); ++i)
+        {
+          std::string name = controllers_param[i]["name"];
+          std::string type = controllers_param[i]["type"];
+          if (!controller_types_.insert(std::make_pair(name, type)).second)
+          {
+            ROS_ERROR_STREAM("The controller plugin name \"" << name << "\" is used twice! Names must be unique!");
+            return false;
+          }
+          if (i == 0)
+            default_plugin_name_ = name;
+        }
+      }
+      catch (XmlRpc::XmlRpcException &e)
+      {
+        ROS_ERROR_STREAM("Invalid parameter structure. The local_planners parameter has to be a list of structs "
+                         << "with fields \"name\" and \"type\" of the controller plugin! " << e.getMessage());
+        return false;
+      }
+    }
+    std::string controller_type;
+    if (private_nh.getParam("local_planner", controller_type))
+    {
+      requested_plugin_name_ = controller_type;
+      if (controller_types_.empty())
+      {
+        // single plugin, named after its class as the class loader does
+        default_plugin_name_ = controller_type.substr(controller_type.find_last_of("/:") + 1);
+        controller_types_[default_plugin_name_] = controller_type;
+      }
+      else
+      {
+        // also select the default plugin by name or type, as done on reconfigure
+        default_plugin_name_ = findPlugin(controller_type);
+        if (default_plugin_name_.empty())
+        {
+          ROS_ERROR_STREAM("The local_planner \"" << controller_type << "\" is not in the local_planners list!");
+          return false;
+        }
+      }
+    }
+    else if (!controller_types_.empty())
+    {
+      // let dynamic reconfigure start with the default plugin
+      requested_plugin_name_ = default_plugin_name_;
+      private_nh.setParam("local_planner", default_plugin_name_);
+    }
+    else
+    {
+      ROS_ERROR_STREAM("Neither parameter \"local_planners\" nor \"local_planner\" is set!");
+      return false;
     }
     private_nh.param("robot_frame", robot_frame_, std::string("base_link"));
     private_nh.param("map_frame", global_frame_, std::string("map"));
@@ -65,57 +190,169 @@ namespace mbf_abstract_nav
     private_nh.param("controller_frequency", frequency, 10.0);
     private_nh.param("dist_tolerance", dist_tolerance_, 0.1);
     private_nh.param("angle_tolerance", angle_tolerance_, M_PI / 18.0);
+    private_nh.param("controller_cpu_affinity", cpu, -1);
+    private_nh.param("controller_realtime_priority", priority, 0);
+    worker_.setAffinity(cpu);
+    worker_.setRealtimePriority(priority);
 
     // Timeout granted to the local planner. We keep calling it up to this time or up to max_retries times
     // If it doesn't return within time, the navigator will cancel it and abort the corresponding action
     patience_ = ros::Duration(patience);
+    setPatience(patience_);
 
     if (frequency <= 0.0)
     {
       ROS_ERROR("Movement frequency must be greater than 0.0!");
-      exit(0);
+      return false;
     }
     // set the calling duration by the moving frequency
     calling_duration_ = boost::chrono::microseconds((int)(1e6 / frequency));
+    stats_.setTargetPeriod(calling_duration_);
+    return true;
+  }
 
-    // init cmd_vel publisher for the robot velocity t
-    vel_pub_ = nh.advertise<geometry_msgs::Twist>("cmd_vel", 1);
+  mbf_abstract_core::AbstractController::Ptr AbstractControllerExecution::loadPlugin(const std::string &name,
+                                                                                     const std::string &type)
+  {
+    boost::lock_guard<boost::mutex> guard(plugin_load_mtx_);
+    mbf_abstract_core::AbstractController::Ptr controller_ptr = loadControllerPlugin(type);
+    if (!controller_ptr || !initPlugin(name, controller_ptr))
+    {
+      return mbf_abstract_core::AbstractController::Ptr();
+    }
+    return controller_ptr;
   }
 
+  std::string AbstractControllerExecution::findPlugin(const std::string &name_or_type)
+  {
+    if (controller_types_.find(name_or_type) != controller_types_.end())
+    {
+      return name_or_type;
+    }
+    std::map<std::string, std::string>::iterator iter = controller_types_.begin();
+    for (; iter != controller_types_.end(); ++iter)
+    {
+      if (iter->second == name_or_type)
+        return iter->first;
+    }
+    return std::string();
+  }
 
-  AbstractControllerExecution::~AbstractControllerExecution()
+  void AbstractControllerExecution::swapPlugin(const std::string &name)
   {
+    boost::atomic_store(&controller_, controllers_[name]);
+    plugin_name_ = name;
+    stats_.setPlugin(plugin_name_);
+    {
+      // ensure we reset the current plan (if any) to the new controller
+      boost::lock_guard<boost::mutex> plan_guard(plan_mtx_);
+      new_plan_ = true;
+    }
   }
 
+  bool AbstractControllerExecution::selectPlugin(const std::string &name)
+  {
+    boost::recursive_mutex::scoped_lock sl(configuration_mutex_);
+    std::string selected = findPlugin(name.empty() ? default_plugin_name_ : name);
+    if (selected.empty())
+    {
+      return false;
+    }
+    if (selected != plugin_name_)
+    {
+      swapPlugin(selected);
+      ROS_INFO_STREAM("Moving with the controller plugin \"" << plugin_name_ << "\"");
+    }
+    return true;
+  }
 
-  void AbstractControllerExecution::initialize()
+  std::vector<std::string> AbstractControllerExecution::listPlugins()
   {
-    controller_ = loadControllerPlugin(plugin_name_);
-    if (!controller_)
+    boost::recursive_mutex::scoped_lock sl(configuration_mutex_);
+    std::vector<std::string> names;
+    std::map<std::string, std::string>::iterator iter = controller_types_.begin();
+    for (; iter != controller_types_.end(); ++iter)
     {
-      exit(1);  // TODO: do not exit directly, so we can just show a WARN on reconfigure
+      names.push_back(iter->first);
     }
+    return names;
+  }
 
-    initPlugin();
-    setState(INITIALIZED);
+  void AbstractControllerExecution::loadRequestedPlugin()
+  {
+    std::string requested;
+    {
+      boost::lock_guard<boost::mutex> guard(plugin_request_mtx_);
+      requested = requested_plugin_name_;
+    }
+
+    while (true)
+    {
+      // a preloaded plugin, given by name or by type, is used right away; otherwise we load the given type
+      std::string name;
+      {
+        boost::recursive_mutex::scoped_lock sl(configuration_mutex_);
+        name = findPlugin(requested);
+      }
+      mbf_abstract_core::AbstractController::Ptr controller_ptr;
+      if (name.empty())
+      {
+        name = requested.substr(requested.find_last_of("/:") + 1);
+        controller_ptr = loadPlugin(name, requested);
+      }
+
+      // swap between two controller cycles, which run holding the configuration mutex
+      boost::recursive_mutex::scoped_lock sl(configuration_mutex_);
+      boost::lock_guard<boost::mutex> guard(plugin_request_mtx_);
+      if (requested_plugin_name_ != requested)
+      {
+        // another plugin has been requested meanwhile; use that one instead
+        requested = requested_plugin_name_;
+        continue;
+      }
+      if (controller_ptr)
+      {
+        controllers_[name] = controller_ptr;
+        controller_types_[name] = requested;
+      }
+      else if (controllers_.find(name) == controllers_.end())
+      {
+        ROS_ERROR_STREAM("Could not load the controller plugin \"" << requested << "\"; keep using \""
+                         << default_plugin_name_ << "\" by default");
+        return;
+      }
+
+      default_plugin_name_ = name;
+      if (name != plugin_name_)
+      {
+        swapPlugin(name);
+      }
+      ROS_INFO_STREAM("Switched to the controller plugin \"" << plugin_name_ << "\"");
+      return;
+    }
   }
 
   void AbstractControllerExecution::reconfigure(mbf_abstract_nav::MoveBaseFlexConfig &config)
   {
-    boost::recursive_mutex::scoped_lock sl(configuration_mutex_);
-
-    if (config.local_planner != plugin_name_)
     {
-      plugin_name_ = config.local_planner;
-      initialize();
-      new_plan_ = true;  // ensure we reset the current plan (if any) to the new controller
+      // switch to a preloaded plugin or load a new one in the background; the current one keeps controlling meanwhile
+      boost::lock_guard<boost::mutex> guard(plugin_request_mtx_);
+      if (config.local_planner != requested_plugin_name_)
+      {
+        requested_plugin_name_ = config.local_planner;
+        plugin_loader_.post(boost::bind(&AbstractControllerExecution::loadRequestedPlugin, this));
+      }
     }
 
+    boost::recursive_mutex::scoped_lock sl(configuration_mutex_);
+
     patience_ = ros::Duration(config.controller_patience);
+    setPatience(patience_);
 
     if (config.controller_frequency > 0.0)
     {
       calling_duration_ = boost::chrono::microseconds((int)(1e6 / config.controller_frequency));
+      stats_.setTargetPeriod(calling_duration_);
     }
     else
       ROS_ERROR("Movement frequency must be greater than 0.0!");
@@ -126,61 +363,123 @@ namespace mbf_abstract_nav
 
   bool AbstractControllerExecution::startMoving()
   {
-    setState(STARTED);
     if (moving_)
     {
+      setState(STARTED);
       return false; // thread is already running.
     }
-    plugin_code_ = 255;
-    plugin_msg_ = "";
+    setPluginInfo(255, "");
+    setState(STARTED);
     moving_ = true;
-    thread_ = boost::thread(&AbstractControllerExecution::run, this);
+    if (!worker_.post(boost::bind(&AbstractControllerExecution::run, this)))
+    {
+      moving_ = false;
+      return false; // the previous run is still finishing and another one is already waiting
+    }
     return true;
   }
 
 
   void AbstractControllerExecution::stopMoving()
   {
-    thread_.interrupt();
+    worker_.interrupt();
   }
 
 
   void AbstractControllerExecution::setState(ControllerState state)
   {
-    boost::lock_guard<boost::mutex> guard(state_mtx_);
-    state_ = state;
+    boost::lock_guard<boost::mutex> guard(snapshot_mtx_);
+    // only the writers, serialized by the snapshot mutex, replace the snapshot, so a plain read is enough here
+    if (state == snapshot_->state)
+    {
+      return;
+    }
+    staged_.state = state;
+    ++staged_.seq;
+    publishSnapshot();
+    notifyStateUpdate();
+  }
+
+
+  void AbstractControllerExecution::setLastPluginCallTime(const ros::Time &time)
+  {
+    boost::lock_guard<boost::mutex> guard(snapshot_mtx_);
+    staged_.last_call_time = time;
+    publishSnapshot();
+  }
+
+
+  void AbstractControllerExecution::setStartTime(const ros::Time &time)
+  {
+    boost::lock_guard<boost::mutex> guard(snapshot_mtx_);
+    staged_.start_time = time;
+  }
+
+
+  void AbstractControllerExecution::setPatience(const ros::Duration &patience)
+  {
+    boost::lock_guard<boost::mutex> guard(snapshot_mtx_);
+    staged_.patience = patience;
+    publishSnapshot();
+  }
+
+
+  void AbstractControllerExecution::publishSnapshot()
+  {
+    boost::atomic_store(&snapshot_, boost::make_shared<const Snapshot>(staged_));
+  }
+
+
+  bool AbstractControllerExecution::Snapshot::isPatienceExceeded() const
+  {
+    return patience > ros::Duration(0) && ros::Time::now() - last_call_time > patience;
+  }
+
+
+  typename AbstractControllerExecution::SnapshotConstPtr AbstractControllerExecution::getSnapshot()
+  {
+    return boost::atomic_load(&snapshot_);
   }
 
 
   typename AbstractControllerExecution::ControllerState
   AbstractControllerExecution::getState()
   {
-    boost::lock_guard<boost::mutex> guard(state_mtx_);
-    return state_;
+    return getSnapshot()->state;
+  }
+
+
+  ExecutionStats &AbstractControllerExecution::getStats()
+  {
+    return stats_;
   }
 
+  void AbstractControllerExecution::setRobotStateCache(const RobotStateCache::Ptr &robot_state_ptr)
+  {
+    robot_state_ptr_ = robot_state_ptr;
+  }
 
   void AbstractControllerExecution::setPluginInfo(const uint32_t &plugin_code, const std::string &plugin_msg)
   {
-    boost::lock_guard<boost::mutex> guard(pcode_mtx_);
-    plugin_code_ =  plugin_code;
-    plugin_msg_ = plugin_msg;
+    boost::lock_guard<boost::mutex> guard(snapshot_mtx_);
+    staged_.plugin_code = plugin_code;
+    staged_.plugin_msg = plugin_msg;
   }
 
 
   void AbstractControllerExecution::getPluginInfo(uint32_t &plugin_code, std::string &plugin_msg)
   {
-    boost::lock_guard<boost::mutex> guard(pcode_mtx_);
-    plugin_code = plugin_code_;
-    plugin_msg = plugin_msg_;
+    SnapshotConstPtr snapshot = boost::atomic_load(&snapshot_);
+    plugin_code = snapshot->plugin_code;
+    plugin_msg = snapshot->plugin_msg;
   }
 
 
-  void AbstractControllerExecution::setNewPlan(const std::vector<geometry_msgs::PoseStamped> &plan)
+  void AbstractControllerExecution::setNewPlan(const PlanConstPtr &plan)
   {
     if (moving_)
     {
-      ROS_WARN("Setting new plan while moving!");
+      ROS_DEBUG("Setting new plan while moving");
     }
     boost::lock_guard<boost::mutex> guard(plan_mtx_);
     new_plan_ = true;
@@ -196,63 +495,62 @@ namespace mbf_abstract_nav
   }
 
 
-  void AbstractControllerExecution::getNewPlan(std::vector<geometry_msgs::PoseStamped> &plan)
+  PlanConstPtr AbstractControllerExecution::getNewPlan()
   {
     boost::lock_guard<boost::mutex> guard(plan_mtx_);
     new_plan_ = false;
-    plan = plan_;
+    return plan_;
   }
 
 
-  uint32_t AbstractControllerExecution::computeVelocityCmd(geometry_msgs::TwistStamped &vel_cmd,
-                                                                           std::string& message)
+  uint32_t AbstractControllerExecution::computeVelocityCmd(const geometry_msgs::PoseStamped &robot_pose,
+                                                           const geometry_msgs::TwistStamped &robot_velocity,
+                                                           geometry_msgs::TwistStamped &vel_cmd,
+                                                           std::string &message)
   {
-    // TODO calculate robot pose and velocity
-    geometry_msgs::PoseStamped robot_pose;
-    geometry_msgs::TwistStamped robot_velocity;
     return controller_->computeVelocityCommands(robot_pose, robot_velocity, vel_cmd, message);
   }
 
 
   void AbstractControllerExecution::setVelocityCmd(const geometry_msgs::TwistStamped &vel_cmd)
   {
-    boost::lock_guard<boost::mutex> guard(vel_cmd_mtx_);
-    vel_cmd_stamped_ = vel_cmd;
+    {
+      boost::lock_guard<boost::mutex> guard(snapshot_mtx_);
+      staged_.vel_cmd = vel_cmd;
+      publishSnapshot();
+    }
+    notifyStateUpdate();
   }
 
 
   void AbstractControllerExecution::getLastValidCmdVel(geometry_msgs::TwistStamped &vel_cmd)
   {
-    boost::lock_guard<boost::mutex> guard(vel_cmd_mtx_);
-    vel_cmd = vel_cmd_stamped_;
+    vel_cmd = getSnapshot()->vel_cmd;
   }
 
 
   ros::Time AbstractControllerExecution::getLastPluginCallTime()
   {
-    boost::lock_guard<boost::mutex> guard(lct_mtx_);
-    return last_call_time_;
+    return getSnapshot()->last_call_time;
   }
 
 
   ros::Time AbstractControllerExecution::getLastValidCmdVelTime()
   {
-    boost::lock_guard<boost::mutex> guard(vel_cmd_mtx_);
-    return vel_cmd_stamped_.header.stamp;
+    return getSnapshot()->vel_cmd.header.stamp;
   }
 
 
   bool AbstractControllerExecution::isPatienceExceeded()
   {
-    boost::lock_guard<boost::mutex> guard(lct_mtx_);
-    return (patience_ > ros::Duration(0)) && (ros::Time::now() - last_call_time_ > patience_);
+    return getSnapshot()->isPatienceExceeded();
   }
 
 
   bool AbstractControllerExecution::isMoving()
   {
-    return moving_ && start_time_ < getLastValidCmdVelTime()
-        && !isPatienceExceeded();
+    SnapshotConstPtr snapshot = getSnapshot();
+    return moving_ && snapshot->start_time < snapshot->vel_cmd.header.stamp && !snapshot->isPatienceExceeded();
   }
 
 
@@ -260,47 +558,52 @@ namespace mbf_abstract_nav
   {
 
     start_time_ = ros::Time::now();
+    setStartTime(start_time_);
 
     // init plan
-    std::vector<geometry_msgs::PoseStamped> plan;
+    PlanConstPtr plan;
     if (!hasNewPlan())
     {
-      setState(NO_PLAN);
       moving_ = false;
+      setState(NO_PLAN);
       ROS_ERROR("robot navigation moving has no plan!");
     }
 
     int retries = 0;
     int seq = 0;
 
+    stats_.startRun();
+
+    // cycles are scheduled on absolute deadlines, so time blocked on mutexes or preempted by the OS
+    // doesn't make the period drift
+    boost::chrono::steady_clock::time_point next_cycle = boost::chrono::steady_clock::now();
+
     try
     {
       while (moving_ && ros::ok())
       {
-        boost::recursive_mutex::scoped_lock sl(configuration_mutex_);
+        stats_.startCycle();
 
-        boost::chrono::thread_clock::time_point loop_start_time = boost::chrono::thread_clock::now();
+        boost::recursive_mutex::scoped_lock sl(configuration_mutex_);
 
         // update plan dynamically
         if (hasNewPlan())
         {
-          getNewPlan(plan);
+          plan = getNewPlan();
 
           // check if plan is empty
-          if (plan.empty())
+          if (!plan || plan->empty())
           {
-            setState(EMPTY_PLAN);
-            condition_.notify_all();
             moving_ = false;
+            setState(EMPTY_PLAN);
             return;
           }
 
           // check if plan could be set
-          if(!controller_->setPlan(plan))
+          if(!controller_->setPlan(*plan))
           {
-            setState(INVALID_PLAN);
-            condition_.notify_all();
             moving_ = false;
+            setState(INVALID_PLAN);
             return;
           }
 
@@ -309,25 +612,27 @@ namespace mbf_abstract_nav
         // ask planner if the goal is reached
         if (controller_->isGoalReached(dist_tolerance_, angle_tolerance_))
         {
-          setState(ARRIVED_GOAL);
-          // goal reached, tell it the controller
-          condition_.notify_all();
+          // goal reached, tell it the server
           moving_ = false;
+          setState(ARRIVED_GOAL);
           // if not, keep moving
         }
         else
         {
-          setState(PLANNING);
-
-          // save time and call the plugin
-          lct_mtx_.lock();
-          last_call_time_ = ros::Time::now();
-          lct_mtx_.unlock();
+          // save time and call the plugin; while getting velocity commands, the state stays GOT_LOCAL_CMD instead
+          // of changing on every cycle, so the server checks the patience on both states
+          setLastPluginCallTime(ros::Time::now());
+          if (getState() != GOT_LOCAL_CMD)
+          {
+            setState(PLANNING);
+          }
 
-          // call plugin to compute the next velocity command
+          // call plugin to compute the next velocity command, from a consistent snapshot of the robot state
           std::string message;
           geometry_msgs::TwistStamped cmd_vel_stamped;
-          uint32_t outcome = computeVelocityCmd(cmd_vel_stamped, message);
+          RobotStateCache::StateConstPtr robot_state =
+              robot_state_ptr_ ? robot_state_ptr_->get() : boost::make_shared<const RobotStateCache::State>();
+          uint32_t outcome = computeVelocityCmd(robot_state->pose, robot_state->velocity, cmd_vel_stamped, message);
           setPluginInfo(outcome, message);
 
           if (outcome < 10)
@@ -335,50 +640,52 @@ namespace mbf_abstract_nav
             // set stamped values: frame id, time stamp and sequence number
             cmd_vel_stamped.header.seq = seq++;
             setVelocityCmd(cmd_vel_stamped);
-            setState(GOT_LOCAL_CMD);
             vel_pub_.publish(cmd_vel_stamped.twist);
-            condition_.notify_all();
+            setState(GOT_LOCAL_CMD);
             retries = 0;
           }
           else
           {
             if (++retries > max_retries_)
             {
-              setState(MAX_RETRIES);
               moving_ = false;
-              condition_.notify_all();
+              setState(MAX_RETRIES);
             }
             else if (ros::Time::now() - getLastValidCmdVelTime() > patience_
                 && ros::Time::now() - start_time_ > patience_)  // why not isPatienceExceeded() ?
             {
-              setState(PAT_EXCEEDED);
               moving_ = false;
-              condition_.notify_all();
+              setState(PAT_EXCEEDED);
             }
             else
             {
               setState(NO_LOCAL_CMD); // useful for server feedback
-              condition_.notify_all();
             }
             // could not compute a valid velocity command -> stop moving the robot
             publishZeroVelocity(); // command the robot to stop
           }
         }
 
-        boost::chrono::thread_clock::time_point end_time = boost::chrono::thread_clock::now();
-        boost::chrono::microseconds execution_duration =
-            boost::chrono::duration_cast<boost::chrono::microseconds>(end_time - loop_start_time);
-        boost::chrono::microseconds sleep_time = calling_duration_ - execution_duration;
+        stats_.endCycle();
+
+        next_cycle += calling_duration_;
+
+        // let reconfiguration and plugin swaps happen while sleeping
+        sl.unlock();
+
         if (moving_ && ros::ok())
         {
-          if (sleep_time > boost::chrono::microseconds(0))
+          boost::chrono::steady_clock::time_point now = boost::chrono::steady_clock::now();
+          if (next_cycle > now)
           {
             // interruption point
-            boost::this_thread::sleep_for(sleep_time);
+            boost::this_thread::sleep_until(next_cycle);
           }
           else
           {
             ROS_WARN_THROTTLE(1.0, "Calculation needs to much time to stay in the moving frequency!");
+            // don't catch up the missed cycles with a burst of commands; restart the schedule from now
+            next_cycle = now;
           }
         }
       }
@@ -388,9 +695,8 @@ namespace mbf_abstract_nav
       // Controller thread interrupted; probably robot is oscillating or we have exceeded planner patience
       ROS_WARN_STREAM("Controller thread interrupted!");
       publishZeroVelocity();
-      setState(STOPPED);
-      condition_.notify_all();
       moving_ = false;
+      setState(STOPPED);
     }
   }
 
@@ -0,0 +1,82 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  abstract_execution_base.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include "mbf_abstract_nav/abstract_execution_base.h"
+
+namespace mbf_abstract_nav
+{
+
+AbstractExecutionBase::AbstractExecutionBase() :
+    update_seq_(0)
+{
+}
+
+AbstractExecutionBase::~AbstractExecutionBase()
+{
+}
+
+void AbstractExecutionBase::notifyStateUpdate()
+{
+  boost::lock_guard<boost::mutex> guard(update_mtx_);
+  ++update_seq_;
+  update_cond_.notify_all();
+}
+
+unsigned int AbstractExecutionBase::getUpdateSeq()
+{
+  boost::lock_guard<boost::mutex> guard(update_mtx_);
+  return update_seq_;
+}
+
+bool AbstractExecutionBase::waitForStateUpdate(unsigned int seq, const boost::chrono::microseconds &duration)
+{
+  boost::unique_lock<boost::mutex> lock(update_mtx_);
+  const boost::chrono::steady_clock::time_point deadline = boost::chrono::steady_clock::now() + duration;
+  while (update_seq_ == seq)
+  {
+    if (update_cond_.wait_until(lock, deadline) == boost::cv_status::timeout)
+    {
+      return update_seq_ != seq;
+    }
+  }
+  return true;
+}
+
+} /* namespace mbf_abstract_nav */
@@ -38,6 +38,11 @@
  *
  */
 
+#ifdef __linux__
+#include <cerrno>
+#include <sys/mman.h>
+#endif
+
 #include <visualization_msgs/Marker.h>
 #include <nav_msgs/Path.h>
 #include "mbf_abstract_nav/abstract_navigation_server.h"
@@ -50,34 +55,105 @@ namespace mbf_abstract_nav
       typename AbstractPlannerExecution::Ptr planning_ptr,
       typename AbstractControllerExecution::Ptr moving_ptr,
       typename AbstractRecoveryExecution::Ptr recovery_ptr) :
+      setup_reconfigure_(false),
       tf_listener_ptr_(tf_listener_ptr),
       planning_ptr_(planning_ptr),
       moving_ptr_(moving_ptr),
       recovery_ptr_(recovery_ptr),
-      private_nh_("~"),
+      startup_begin_(boost::chrono::steady_clock::now()),
+      startup_failures_(0),
+      active_moving_(false),
+      active_planning_(false),
+      active_recovery_(false),
+      recovery_enabled_(false),
+      replanning_enabled_(false),
       path_seq_count_(0),
-      action_client_exe_path_(private_nh_, name_action_exe_path),
-      action_client_get_path_(private_nh_, name_action_get_path),
-      action_client_recovery_(private_nh_, name_action_recovery)
+      private_nh_("~")
   {
     ros::NodeHandle nh;
 
+    // independent startup steps (costmaps construction, plugins loading) can run in parallel
+    private_nh_.param("parallel_startup", parallel_startup_, false);
+    startup_report_pub_ = private_nh_.advertise<mbf_msgs::StartupReport>("startup_report", 1, true);
+
     // non-dynamically reconfigurable parameters
     private_nh_.param("robot_frame", robot_frame_, std::string("base_link"));
     private_nh_.param("global_frame", global_frame_, std::string("map"));
     private_nh_.param("tolerance", tolerance_, 0.0);
     private_nh_.param("tf_timeout", tf_timeout_, 3.0);
 
-    // informative topics: current goal and global path
-    path_pub_ = nh.advertise<nav_msgs::Path>("global_path", 1);
+    // robot pose and velocity tracking, so neither the action threads nor the controller wait for TF
+    std::string odom_topic;
+    double robot_pose_frequency, robot_pose_max_age;
+    private_nh_.param("odom_topic", odom_topic, std::string("odom"));
+    private_nh_.param("robot_pose_frequency", robot_pose_frequency, 20.0);
+    private_nh_.param("robot_pose_max_age", robot_pose_max_age, 1.0);
+    robot_pose_max_age_ = ros::Duration(robot_pose_max_age);
+    robot_state_ptr_ = boost::make_shared<RobotStateCache>(tf_listener_ptr_, robot_frame_, global_frame_,
+                                                           odom_topic, robot_pose_frequency);
+    moving_ptr_->setRobotStateCache(robot_state_ptr_);
+
+    // optionally lock all the process memory, so real-time threads never stall on a page fault
+    bool lock_memory;
+    private_nh_.param("lock_memory", lock_memory, false);
+    if (lock_memory)
+    {
+#ifdef __linux__
+      if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+        ROS_WARN_STREAM("Could not lock the process memory; error: " << errno);
+      else
+        ROS_INFO_STREAM("Locked the process memory");
+#else
+      ROS_WARN_STREAM("Locking the process memory is not supported on this platform");
+#endif
+    }
+
+    // informative topics: current goal and global path; the latter simplified and capped to keep long plans cheap
+    double global_path_tolerance;
+    int global_path_max_poses;
+    private_nh_.param("global_path_tolerance", global_path_tolerance, 0.0);
+    private_nh_.param("global_path_max_poses", global_path_max_poses, 0);
+    path_publisher_ptr_ = boost::make_shared<PathPublisher>(boost::ref(nh), "global_path", global_path_tolerance,
+                                                            global_path_max_poses);
+
+    // post-processing stages run on every plan before handing it to the controller
+    plan_processing_ptr_ = boost::make_shared<PlanProcessingChain>();
     current_goal_pub_ = nh.advertise<geometry_msgs::PoseStamped>("current_goal", 1);
 
+    // timing statistics of the planner and controller cycles, published periodically and on request
+    double execution_stats_period;
+    private_nh_.param("execution_stats_period", execution_stats_period, 1.0);
+    execution_stats_pub_ = private_nh_.advertise<mbf_msgs::ExecutionStats>("execution_stats", 2);
+    get_execution_stats_srv_ = private_nh_.advertiseService("get_execution_stats",
+                                                            &AbstractNavigationServer::callServiceGetExecutionStats,
+                                                            this);
+    if (execution_stats_period > 0.0)
+    {
+      execution_stats_timer_ = private_nh_.createTimer(ros::Duration(execution_stats_period),
+                                                       &AbstractNavigationServer::publishExecutionStats, this);
+    }
+
     // oscillation timeout and distance
     double oscillation_timeout;
     private_nh_.param("oscillation_timeout", oscillation_timeout, 0.0);
     oscillation_timeout_ = ros::Duration(oscillation_timeout);
     private_nh_.param("oscillation_distance", oscillation_distance_, 0.02);
 
+    // feedback rate per action; a feedback is only sent if the robot moved, turned or changed its velocity enough
+    double exe_path_feedback_rate, move_base_feedback_rate;
+    double feedback_min_distance, feedback_min_angle, feedback_min_velocity, feedback_keepalive_period;
+    private_nh_.param("exe_path_feedback_rate", exe_path_feedback_rate, 0.0);
+    private_nh_.param("move_base_feedback_rate", move_base_feedback_rate, 0.0);
+    private_nh_.param("feedback_min_distance", feedback_min_distance, 0.0);
+    private_nh_.param("feedback_min_angle", feedback_min_angle, 0.0);
+    private_nh_.param("feedback_min_velocity", feedback_min_velocity, 0.0);
+    private_nh_.param("feedback_keepalive_period", feedback_keepalive_period, 1.0);
+    exe_path_feedback_throttle_ = FeedbackThrottle(exe_path_feedback_rate, feedback_min_distance, feedback_min_angle,
+                                                   feedback_min_velocity, feedback_keepalive_period);
+    move_base_feedback_throttle_ = FeedbackThrottle(move_base_feedback_rate, feedback_min_distance,
+                                                    feedback_min_angle, feedback_min_velocity,
+                                                    feedback_keepalive_period);
+
     action_server_get_path_ptr_ = ActionServerGetPathPtr(
         new ActionServerGetPath(
             private_nh_,
@@ -111,15 +187,95 @@ namespace mbf_abstract_nav
     // providing just the abstract server parameters
   }
 
-  void AbstractNavigationServer::initializeServerComponents()
+  bool AbstractNavigationServer::initializeServerComponents()
+  {
+    std::vector<StartupStep> steps;
+    steps.push_back(StartupStep("planner", boost::bind(&AbstractPlannerExecution::initialize, planning_ptr_)));
+    steps.push_back(StartupStep("controller", boost::bind(&AbstractControllerExecution::initialize, moving_ptr_)));
+    steps.push_back(StartupStep("recovery", boost::bind(&AbstractRecoveryExecution::initialize, recovery_ptr_)));
+    steps.push_back(StartupStep("planner_pool", boost::bind(&AbstractNavigationServer::initializePlannerPool, this)));
+    return runStartupSteps(steps);
+  }
+
+  bool AbstractNavigationServer::runStartupSteps(const std::vector<StartupStep> &steps)
+  {
+    if (!parallel_startup_)
+    {
+      for (size_t i = 0; i < steps.size(); ++i)
+        timeStartupStep(steps[i].first, steps[i].second);
+    }
+    else
+    {
+      boost::thread_group threads;
+      for (size_t i = 0; i < steps.size(); ++i)
+      {
+        threads.create_thread(boost::bind(&AbstractNavigationServer::timeStartupStep, this,
+                                          steps[i].first, steps[i].second));
+      }
+      threads.join_all();
+    }
+
+    boost::lock_guard<boost::mutex> guard(startup_report_mtx_);
+    return startup_failures_ == 0;
+  }
+
+  void AbstractNavigationServer::timeStartupStep(const std::string &name, const boost::function<bool()> &step)
   {
-    planning_ptr_->initialize();
-    moving_ptr_->initialize();
-    recovery_ptr_->initialize();
+    const boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+    const bool success = step();
+    const double duration =
+        boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+
+    boost::lock_guard<boost::mutex> guard(startup_report_mtx_);
+    startup_report_.steps.push_back(name);
+    startup_report_.durations.push_back(duration);
+    ROS_DEBUG_STREAM("Startup step \"" << name << "\" took " << duration << " s");
+    if (!success)
+    {
+      ROS_ERROR_STREAM("Startup step \"" << name << "\" failed!");
+      ++startup_failures_;
+    }
+  }
+
+  bool AbstractNavigationServer::initializePlannerPool()
+  {
+    // optional pool of planners to plan many independent queries in parallel through the get_paths service
+    int planner_pool_size;
+    private_nh_.param("planner_pool_size", planner_pool_size, 0);
+    if (planner_pool_size > 0)
+    {
+      planner_pool_ptr_ = boost::make_shared<PlannerPool>(
+          boost::bind(&AbstractNavigationServer::newPlannerExecution, this), planner_pool_size);
+      if (!planner_pool_ptr_->initialize())
+      {
+        ROS_ERROR_STREAM("Could not initialize the planner pool; the get_paths service is not available");
+        planner_pool_ptr_.reset();
+        return true;
+      }
+
+      ros::AdvertiseServiceOptions options;
+      options.init<mbf_msgs::GetPaths>(
+          "get_paths", boost::bind(&AbstractNavigationServer::callServiceGetPaths, this, _1, _2));
+      options.callback_queue = &get_paths_queue_;
+      get_paths_srv_ = private_nh_.advertiseService(options);
+      get_paths_spinner_ = boost::make_shared<ros::AsyncSpinner>(1, &get_paths_queue_);
+      get_paths_spinner_->start();
+    }
+    return true;
+  }
+
+  AbstractPlannerExecution::Ptr AbstractNavigationServer::newPlannerExecution()
+  {
+    ROS_WARN_STREAM("This navigation server does not support the planner pool");
+    return AbstractPlannerExecution::Ptr();
   }
 
   AbstractNavigationServer::~AbstractNavigationServer()
   {
+    if (get_paths_spinner_)
+    {
+      get_paths_spinner_->stop();
+    }
     moving_ptr_->stopMoving();
     planning_ptr_->stopPlanning();
     recovery_ptr_->stopRecovery();
@@ -131,6 +287,13 @@ namespace mbf_abstract_nav
     action_server_exe_path_ptr_->start();
     action_server_recovery_ptr_->start();
     action_server_move_base_ptr_->start();
+
+    // this is the last startup step, so the report is complete
+    boost::lock_guard<boost::mutex> guard(startup_report_mtx_);
+    startup_report_.total =
+        boost::chrono::duration<double>(boost::chrono::steady_clock::now() - startup_begin_).count();
+    startup_report_pub_.publish(startup_report_);
+    ROS_INFO_STREAM("Navigation server started in " << startup_report_.total << " s");
   }
 
   void AbstractNavigationServer::startDynamicReconfigureServer()
@@ -160,87 +323,115 @@ namespace mbf_abstract_nav
     }
 
     planning_ptr_->reconfigure(config);
+    if (planner_pool_ptr_)
+    {
+      planner_pool_ptr_->reconfigure(config);
+    }
     moving_ptr_->reconfigure(config);
     recovery_ptr_->reconfigure(config);
     oscillation_timeout_ = ros::Duration(config.oscillation_timeout);
     oscillation_distance_ = config.oscillation_distance;
     recovery_enabled_ = config.recovery_enabled;
+    replanning_enabled_ = config.planner_frequency > 0.0;
 
     last_config_ = config;
   }
 
-  void AbstractNavigationServer::publishPath(
-      std::vector<geometry_msgs::PoseStamped> &plan)
+  void AbstractNavigationServer::publishPath(const Plan &plan)
+  {
+    path_publisher_ptr_->publish(plan);
+  }
+
+  void AbstractNavigationServer::handleReplannedPlan(const PlanConstPtr &plan, double cost)
   {
-    if (plan.empty())
+    publishPath(*plan);
+
+    PlanConstPtr global_plan;
+    if (!transformPlanToGlobalFrame(plan, global_plan) || global_plan->empty())
     {
+      ROS_WARN_STREAM_NAMED(name_action_move_base, "Dropping a replanned path, as it is empty or could not be "
+          "transformed to the global frame; keep following the current one");
       return;
     }
-    nav_msgs::Path path;
-    path.poses = plan;
-    path.header.frame_id = plan.front().header.frame_id;
-    path.header.stamp = plan.front().header.stamp;
-    path_pub_.publish(path);
+    PlanConstPtr processed_plan;
+    std::string message;
+    if (!plan_processing_ptr_->process(global_plan, processed_plan, message))
+    {
+      ROS_WARN_STREAM_NAMED(name_action_move_base, "Dropping a replanned path; " << message
+          << "; keep following the current one");
+      return;
+    }
+    ROS_DEBUG_STREAM_NAMED(name_action_move_base, "Replanned a path with " << processed_plan->size()
+        << " poses and the costs: " << cost);
+    moving_ptr_->setNewPlan(processed_plan);
   }
 
-  bool AbstractNavigationServer::transformPlanToGlobalFrame(
-      std::vector<geometry_msgs::PoseStamped> &plan, std::vector<geometry_msgs::PoseStamped> &global_plan)
+  bool AbstractNavigationServer::transformPlanToGlobalFrame(const PlanConstPtr &plan, PlanConstPtr &global_plan)
   {
-    global_plan.clear();
-    std::vector<geometry_msgs::PoseStamped>::iterator iter;
-    bool tf_success = false;
-    for (iter = plan.begin(); iter != plan.end(); ++iter)
+    Plan::const_iterator iter;
+    for (iter = plan->begin(); iter != plan->end(); ++iter)
     {
-      geometry_msgs::PoseStamped global_pose;
-      tf_success = mbf_abstract_nav::transformPose(*tf_listener_ptr_, global_frame_, iter->header.stamp,
-                                                 ros::Duration(tf_timeout_), *iter, global_frame_, global_pose);
-      if (!tf_success)
-      {
-        ROS_ERROR_STREAM("Can not transform pose from the \"" << iter->header.frame_id << "\" frame into the \""
-              << global_frame_ << "\" frame !");
-        return false;
-      }
-      global_plan.push_back(global_pose);
+      if (iter->header.frame_id != global_frame_)
+        break;
+    }
+    if (iter == plan->end())
+    {
+      // the plan is already in the global frame; share it as it is
+      global_plan = plan;
+      return true;
+    }
+
+    boost::shared_ptr<Plan> transformed_plan(new Plan());
+    if (!mbf_abstract_nav::transformPlan(*tf_listener_ptr_, global_frame_, ros::Duration(tf_timeout_),
+                                         *plan, *transformed_plan))
+    {
+      ROS_ERROR_STREAM("Can not transform the plan from the \"" << iter->header.frame_id << "\" frame into the \""
+            << global_frame_ << "\" frame !");
+      return false;
     }
+    global_plan = transformed_plan;
     return true;
   }
 
   bool AbstractNavigationServer::getRobotPose(
       geometry_msgs::PoseStamped &robot_pose)
   {
-    bool tf_success = mbf_abstract_nav::getRobotPose(*tf_listener_ptr_, robot_frame_, global_frame_,
-                                                     ros::Duration(tf_timeout_), robot_pose);
-
-    if (!tf_success)
+    if (!robot_state_ptr_->getPose(robot_pose, robot_pose_max_age_))
     {
       ROS_ERROR_STREAM("Can not get the robot pose in the global frame. - robot frame: \""
-                       << robot_frame_ << "\"   global frame: \"" << global_frame_ << std::endl);
+                       << robot_frame_ << "\"   global frame: \"" << global_frame_ << "\"   last pose stamp: "
+                       << robot_pose.header.stamp);
       return false;
     }
     return true;
   }
 
-  void AbstractNavigationServer::callActionGetPath(
-      const mbf_msgs::GetPathGoalConstPtr &goal)
+  bool AbstractNavigationServer::isGoalPreempted(const PreemptRequestedFn &action_preempt_requested,
+                                                 unsigned int ticket)
   {
-    ROS_DEBUG_STREAM_NAMED(name_action_get_path, "Start action "  << name_action_get_path);
+    return action_preempt_requested() || execution_arbiter_.isPreempted(ticket);
+  }
 
-    mbf_msgs::GetPathResult result;
+  AbstractNavigationServer::ActionOutcome AbstractNavigationServer::runGetPath(
+      const mbf_msgs::GetPathGoal &goal, mbf_msgs::GetPathResult &result, PlanConstPtr &global_plan,
+      const PreemptRequestedFn &preempt_requested, const GetPathFeedbackFn &publish_feedback)
+  {
+    ActionOutcome outcome = ABORTED;
     geometry_msgs::PoseStamped start_pose, goal_pose;
 
     result.path.header.seq = path_seq_count_++;
     result.path.header.frame_id = global_frame_;
-    goal_pose = goal->target_pose;
+    goal_pose = goal.target_pose;
     current_goal_pub_.publish(goal_pose);
 
-    double tolerance = goal->tolerance;
-    bool use_start_pose = goal->use_start_pose;
+    double tolerance = goal.tolerance;
+    bool use_start_pose = goal.use_start_pose;
 
     active_planning_ = true;
 
     if(use_start_pose)
     {
-      start_pose = goal->start_pose;
+      start_pose = goal.start_pose;
       geometry_msgs::Point p = start_pose.pose.position;
       ROS_INFO_STREAM_NAMED(name_action_get_path, "Use the given start pose ("
           << p.x << ", " << p.y << ", " << p.z << ").");
@@ -252,9 +443,9 @@ namespace mbf_abstract_nav
       {
         result.outcome = mbf_msgs::GetPathResult::TF_ERROR;
         result.message = "Could not get the current robot pose!";
-        action_server_get_path_ptr_->setAborted(result, result.message);
         ROS_ERROR_STREAM_NAMED(name_action_get_path, result.message << " Canceling the action call.");
-        return;
+        active_planning_ = false;
+        return ABORTED;
       }
       else
       {
@@ -269,22 +460,25 @@ namespace mbf_abstract_nav
     {
       result.outcome = mbf_msgs::GetPathResult::INTERNAL_ERROR;
       result.message = "Another thread is still planning!";
-      action_server_get_path_ptr_->setAborted(result, result.message);
       ROS_ERROR_STREAM_NAMED(name_action_get_path, result.message << " Canceling the action call.");
-      return;
+      active_planning_ = false;
+      return ABORTED;
     }
 
     AbstractPlannerExecution::PlanningState state_planning_input;
 
-    std::vector<geometry_msgs::PoseStamped> plan, global_plan;
+    PlanConstPtr plan;
     double costs;
 
     int feedback_cnt = 0;
 
     while (active_planning_ && ros::ok())
     {
-      // get the current state of the planning thread
-      state_planning_input = planning_ptr_->getState();
+      // get the current state of the planning thread, together with the matching plugin outcome; the update
+      // sequence number is read first, so no update between reading the state and waiting for the next is missed
+      const unsigned int planning_seq = planning_ptr_->getUpdateSeq();
+      AbstractPlannerExecution::SnapshotConstPtr planning_snapshot = planning_ptr_->getSnapshot();
+      state_planning_input = planning_snapshot->state;
 
       switch (state_planning_input)
       {
@@ -301,7 +495,7 @@ namespace mbf_abstract_nav
           ROS_WARN_STREAM_NAMED(name_action_get_path, "Planning has been stopped rigorously!");
           result.outcome = mbf_msgs::GetPathResult::STOPPED;
           result.message = "Global planner has been stopped!";
-          action_server_get_path_ptr_->setAborted(result, result.message);
+          outcome = ABORTED;
           active_planning_ = false;
           break;
 
@@ -311,13 +505,28 @@ namespace mbf_abstract_nav
           result.path.header.stamp = ros::Time::now();
           result.outcome = mbf_msgs::GetPathResult::CANCELED;
           result.message = "Global planner has been preempted!";
-          action_server_get_path_ptr_->setPreempted(result, result.message);
+          outcome = PREEMPTED;
           active_planning_ = false;
           break;
 
           // in progress
         case AbstractPlannerExecution::PLANNING:
-          if (planning_ptr_->isPatienceExceeded())
+          // anytime planners report better and better plans while planning; stream them as feedback
+          if (publish_feedback && planning_ptr_->getNewIntermediatePlan(plan, costs))
+          {
+            PlanConstPtr global_intermediate_plan;
+            if (transformPlanToGlobalFrame(plan, global_intermediate_plan))
+            {
+              mbf_msgs::GetPathFeedback feedback;
+              feedback.path.header.stamp = ros::Time::now();
+              feedback.path.header.frame_id = global_frame_;
+              feedback.path.poses = *global_intermediate_plan;
+              feedback.cost = costs;
+              publish_feedback(feedback);
+            }
+          }
+
+          if (planning_snapshot->isPatienceExceeded())
           {
             ROS_INFO_STREAM_NAMED(name_action_get_path, "Global planner patience has been exceeded! "
                 << "Cancel planning...");
@@ -339,7 +548,7 @@ namespace mbf_abstract_nav
           result.path.header.stamp = ros::Time::now();
           ROS_DEBUG_STREAM_NAMED(name_action_get_path, "robot navigation state: found plan");
           planning_ptr_->getNewPlan(plan, costs);
-          publishPath(plan);
+          publishPath(*plan);
 
           if (costs > 0)
           {
@@ -352,25 +561,25 @@ namespace mbf_abstract_nav
             result.message = "Cloud not transform the plan to the global frame!";
 
             ROS_ERROR_STREAM_NAMED(name_action_get_path, result.message << " Canceling the action call.");
-            action_server_get_path_ptr_->setAborted(result, result.message);
+            outcome = ABORTED;
             active_planning_ = false;
             break;
           }
 
-          if (global_plan.empty())
+          if (global_plan->empty())
           {
             result.outcome = mbf_msgs::GetPathResult::EMPTY_PATH;
             result.message = "Global planner returned an empty path!";
 
             ROS_ERROR_STREAM_NAMED(name_action_get_path, result.message);
-            action_server_get_path_ptr_->setAborted(result, result.message);
+            outcome = ABORTED;
             active_planning_ = false;
             break;
           }
 
-          result.path.poses = global_plan;
-          planning_ptr_->getPluginInfo(result.outcome, result.message);
-          action_server_get_path_ptr_->setSucceeded(result, result.message);
+          result.outcome = planning_snapshot->plugin_code;
+          result.message = planning_snapshot->plugin_msg;
+          outcome = SUCCEEDED;
 
           active_planning_ = false;
           break;
@@ -378,15 +587,17 @@ namespace mbf_abstract_nav
           // no plan found
         case AbstractPlannerExecution::NO_PLAN_FOUND:
           ROS_DEBUG_STREAM_NAMED(name_action_get_path, "robot navigation state: no plan found");
-          planning_ptr_->getPluginInfo(result.outcome, result.message);
-          action_server_get_path_ptr_->setAborted(result, result.message);
+          result.outcome = planning_snapshot->plugin_code;
+          result.message = planning_snapshot->plugin_msg;
+          outcome = ABORTED;
           active_planning_ = false;
           break;
 
         case AbstractPlannerExecution::MAX_RETRIES:
           ROS_DEBUG_STREAM_NAMED(name_action_get_path, "Global planner reached the maximum number of retries");
-          planning_ptr_->getPluginInfo(result.outcome, result.message);
-          action_server_get_path_ptr_->setAborted(result, result.message);
+          result.outcome = planning_snapshot->plugin_code;
+          result.message = planning_snapshot->plugin_msg;
+          outcome = ABORTED;
           active_planning_ = false;
           break;
 
@@ -394,18 +605,21 @@ namespace mbf_abstract_nav
           ROS_DEBUG_STREAM_NAMED(name_action_get_path, "Global planner exceeded the patience time");
           result.outcome = mbf_msgs::GetPathResult::PAT_EXCEEDED;
           result.message = "Global planner exceeded the patience time";
-          action_server_get_path_ptr_->setAborted(result, result.message);
+          outcome = ABORTED;
           active_planning_ = false;
           break;
 
         default:
           ROS_FATAL_STREAM_NAMED(name_action_get_path, "Unknown state in move base flex controller with the number:"
               << state_planning_input);
+          result.outcome = mbf_msgs::GetPathResult::INTERNAL_ERROR;
+          result.message = "Unknown planner execution state!";
+          outcome = ABORTED;
           active_planning_ = false;
       }
 
       // if preempt requested while we are planning
-      if (action_server_get_path_ptr_->isPreemptRequested()
+      if (preempt_requested()
           && state_planning_input == AbstractPlannerExecution::PLANNING)
       {
         if (!planning_ptr_->cancel())
@@ -417,12 +631,9 @@ namespace mbf_abstract_nav
 
       if (active_planning_)
       {
-        // try to sleep a bit
-        // normally this thread should be woken up from the planner execution thread
-        // in order to transfer the results to the controller.
-        boost::mutex mutex;
-        boost::unique_lock<boost::mutex> lock(mutex);
-        condition_.wait_for(lock, boost::chrono::milliseconds(500));
+        // wait for the next state update of the planner execution; the timeout is
+        // just a fallback to check for preemption requests while the planner is busy
+        planning_ptr_->waitForStateUpdate(planning_seq, boost::chrono::milliseconds(500));
       }
     }  // while (active_planning_ && ros::ok())
 
@@ -434,39 +645,56 @@ namespace mbf_abstract_nav
     {
       ROS_ERROR_STREAM_NAMED(name_action_get_path, "\"GetPath\" action has been stopped!");
     }
+    return outcome;
   }
 
-  void AbstractNavigationServer::callActionExePath(
-      const mbf_msgs::ExePathGoalConstPtr &goal)
+  AbstractNavigationServer::ActionOutcome AbstractNavigationServer::runExePath(
+      const PlanConstPtr &plan, mbf_msgs::ExePathResult &result,
+      const PreemptRequestedFn &preempt_requested, const ExePathFeedbackFn &publish_feedback,
+      FeedbackThrottle *feedback_throttle)
   {
-    ROS_DEBUG_STREAM_NAMED(name_action_exe_path, "Start action "  << name_action_exe_path);
-
-    mbf_msgs::ExePathResult result;
+    ActionOutcome outcome = ABORTED;
     mbf_msgs::ExePathFeedback feedback;
 
     typename AbstractControllerExecution::ControllerState state_moving_input;
 
     ros::Time last_oscillation_reset = ros::Time::now();
 
-    std::vector<geometry_msgs::PoseStamped> plan = goal->path.poses;
-    geometry_msgs::PoseStamped goal_pose = plan.back();
+    geometry_msgs::PoseStamped goal_pose;
+    if (!plan->empty())
+    {
+      goal_pose = plan->back();
+    }
     ROS_DEBUG_STREAM_NAMED(name_action_exe_path, "Called action \""
         << name_action_exe_path << "\" with plan:" << std::endl
-        << "frame: \"" << goal->path.header.frame_id << "\" " << std::endl
-        << "stamp: " << goal->path.header.stamp << std::endl
-        << "num poses: " << goal->path.poses.size() << std::endl
+        << "frame: \"" << goal_pose.header.frame_id << "\" " << std::endl
+        << "stamp: " << goal_pose.header.stamp << std::endl
+        << "num poses: " << plan->size() << std::endl
         << "goal: (" << goal_pose.pose.position.x << ", "
                      << goal_pose.pose.position.y << ", "
                      << goal_pose.pose.position.z << ")");
 
-    moving_ptr_->setNewPlan(plan);
+    if (feedback_throttle)
+    {
+      feedback_throttle->reset();
+    }
+
+    // clean up the plan before handing it to the controller
+    PlanConstPtr processed_plan;
+    if (!plan_processing_ptr_->process(plan, processed_plan, result.message))
+    {
+      result.outcome = mbf_msgs::ExePathResult::INVALID_PATH;
+      ROS_ERROR_STREAM_NAMED(name_action_exe_path, result.message << "! Canceling the action call.");
+      return ABORTED;
+    }
+
+    moving_ptr_->setNewPlan(processed_plan);
     if (!moving_ptr_->startMoving())
     {
       result.outcome = mbf_msgs::ExePathResult::INTERNAL_ERROR;
       result.message = "Could not start moving, because another moving thread is already / still running!";
-      action_server_exe_path_ptr_->setAborted(result, result.message);
       ROS_ERROR_STREAM_NAMED(name_action_exe_path, result.message << " Canceling the action call.");
-      return;
+      return ABORTED;
     }
 
     active_moving_ = true;
@@ -482,14 +710,13 @@ namespace mbf_abstract_nav
         active_moving_ = false;
         result.outcome = mbf_msgs::ExePathResult::TF_ERROR;
         result.message = "Could not get the robot pose!";
-        action_server_exe_path_ptr_->setAborted(result, result.message);
+        outcome = ABORTED;
         ROS_ERROR_STREAM_NAMED(name_action_exe_path, result.message << " Canceling the action call.");
         break;
       }
       else
       {
         result.final_pose = robot_pose;
-        feedback.current_pose = robot_pose;
       }
 
       if (first_cycle)
@@ -499,12 +726,17 @@ namespace mbf_abstract_nav
       }
 
       // check preempt requested
-      if (action_server_exe_path_ptr_->isPreemptRequested())
+      if (preempt_requested())
       {
         moving_ptr_->stopMoving();
       }
 
-      state_moving_input = moving_ptr_->getState();
+      // one consistent view of the controller state, plugin outcome, velocity command and patience, read after the
+      // update sequence number as for the planner
+      const unsigned int moving_seq = moving_ptr_->getUpdateSeq();
+      AbstractControllerExecution::SnapshotConstPtr moving_snapshot = moving_ptr_->getSnapshot();
+      state_moving_input = moving_snapshot->state;
+      const geometry_msgs::TwistStamped &vel_cmd = moving_snapshot->vel_cmd;
 
       switch (state_moving_input)
       {
@@ -512,7 +744,7 @@ namespace mbf_abstract_nav
           ROS_WARN_STREAM_NAMED(name_action_exe_path, "The moving has been stopped!");
           result.outcome = mbf_msgs::ExePathResult::CANCELED;
           result.message = "Local planner preempted";
-          action_server_exe_path_ptr_->setPreempted(result, result.message);
+          outcome = PREEMPTED;
           ROS_DEBUG_STREAM("Action \"ExePath\" preempted");
           active_moving_ = false;
           break;
@@ -523,7 +755,7 @@ namespace mbf_abstract_nav
 
           // in progress
         case AbstractControllerExecution::PLANNING:
-          if (moving_ptr_->isPatienceExceeded())
+          if (moving_snapshot->isPatienceExceeded())
           {
             ROS_DEBUG_STREAM_NAMED(name_action_exe_path, "Local planner patience has been exceeded! Stopping controller...");
             // TODO planner is stuck, but we don't have currently any way to cancel it!
@@ -535,8 +767,9 @@ namespace mbf_abstract_nav
         case AbstractControllerExecution::MAX_RETRIES:
           ROS_WARN_STREAM_NAMED(name_action_exe_path, "The local planner has been aborted after it exceeded the maximum number of retries!");
           active_moving_ = false;
-          moving_ptr_->getPluginInfo(result.outcome, result.message);
-          action_server_exe_path_ptr_->setAborted(result, result.message);
+          result.outcome = moving_snapshot->plugin_code;
+          result.message = moving_snapshot->plugin_msg;
+          outcome = ABORTED;
           break;
 
         case AbstractControllerExecution::PAT_EXCEEDED:
@@ -549,7 +782,7 @@ namespace mbf_abstract_nav
           active_moving_ = false;
           result.outcome = mbf_msgs::ExePathResult::PAT_EXCEEDED;
           result.message = "Local planner exceeded allocated time";
-          action_server_exe_path_ptr_->setAborted(result, result.message);
+          outcome = ABORTED;
           break;
 
         case AbstractControllerExecution::NO_PLAN:
@@ -557,7 +790,7 @@ namespace mbf_abstract_nav
           active_moving_ = false;
           result.outcome = mbf_msgs::ExePathResult::INVALID_PATH;
           result.message = "Local planner started without a path to follow";
-          action_server_exe_path_ptr_->setAborted(result, result.message);
+          outcome = ABORTED;
           break;
 
         case AbstractControllerExecution::EMPTY_PLAN:
@@ -565,7 +798,7 @@ namespace mbf_abstract_nav
           active_moving_ = false;
           result.outcome = mbf_msgs::ExePathResult::INVALID_PATH;
           result.message = "Local planner started with an empty plan";
-          action_server_exe_path_ptr_->setAborted(result, result.message);
+          outcome = ABORTED;
           break;
 
         case AbstractControllerExecution::INVALID_PLAN:
@@ -573,29 +806,30 @@ namespace mbf_abstract_nav
           active_moving_ = false;
           result.outcome = mbf_msgs::ExePathResult::INVALID_PATH;
           result.message = "Local planner started with an invalid plan";
-          action_server_exe_path_ptr_->setAborted(result, result.message);
+          outcome = ABORTED;
           break;
 
         case AbstractControllerExecution::NO_LOCAL_CMD:
           ROS_WARN_STREAM_THROTTLE_NAMED(3, name_action_exe_path, "Have not received a velocity command from the "
               << "local planner!");
-          moving_ptr_->getLastValidCmdVel(feedback.current_twist);
-          feedback.dist_to_goal = static_cast<float>(mbf_abstract_nav::distance(robot_pose, goal_pose));
-          feedback.angle_to_goal = static_cast<float>(mbf_abstract_nav::angle(robot_pose, goal_pose));
-          action_server_exe_path_ptr_->publishFeedback(feedback);
+          publishExePathFeedback(robot_pose, goal_pose, vel_cmd, feedback, publish_feedback, feedback_throttle);
           break;
 
         case AbstractControllerExecution::GOT_LOCAL_CMD:
+          // the state doesn't change while the controller keeps getting commands, so it may be stuck computing one
+          if (moving_snapshot->isPatienceExceeded())
+          {
+            ROS_DEBUG_STREAM_NAMED(name_action_exe_path, "Local planner patience has been exceeded! Stopping controller...");
+            moving_ptr_->stopMoving();
+          }
+
           if (mbf_abstract_nav::distance(robot_pose, oscillation_pose) >= oscillation_distance_)
           {
             last_oscillation_reset = ros::Time::now();
             oscillation_pose = robot_pose;
           }
 
-          moving_ptr_->getLastValidCmdVel(feedback.current_twist);
-          feedback.dist_to_goal = static_cast<float>(mbf_abstract_nav::distance(robot_pose, goal_pose));
-          feedback.angle_to_goal = static_cast<float>(mbf_abstract_nav::angle(robot_pose, goal_pose));
-          action_server_exe_path_ptr_->publishFeedback(feedback);
+          publishExePathFeedback(robot_pose, goal_pose, vel_cmd, feedback, publish_feedback, feedback_throttle);
 
           // check if oscillating
           if (oscillation_timeout_ > ros::Duration(0.0)
@@ -607,7 +841,7 @@ namespace mbf_abstract_nav
             active_moving_ = false;
             result.outcome = mbf_msgs::ExePathResult::OSCILLATION;
             result.message = "Oscillation detected!";
-            action_server_exe_path_ptr_->setAborted(result, result.message);
+            outcome = ABORTED;
           }
           break;
 
@@ -616,18 +850,15 @@ namespace mbf_abstract_nav
           active_moving_ = false;
           result.outcome = mbf_msgs::ExePathResult::SUCCESS;
           result.message = "Local planner succeeded; arrived to goal!";
-          action_server_exe_path_ptr_->setSucceeded(result, result.message);
+          outcome = SUCCEEDED;
           break;
       }
 
       if (active_moving_)
       {
-        // try to sleep a bit
-        // normally this thread should be woken up from the controller execution thread
-        // in order to transfer the results to the controller
-        boost::mutex mutex;
-        boost::unique_lock<boost::mutex> lock(mutex);
-        condition_.wait_for(lock, boost::chrono::milliseconds(500));
+        // wait for the next state update of the controller execution; the timeout is
+        // just a fallback to check for preemption requests while the controller is busy
+        moving_ptr_->waitForStateUpdate(moving_seq, boost::chrono::milliseconds(500));
       }
 
       first_cycle = false;
@@ -641,28 +872,38 @@ namespace mbf_abstract_nav
     {
       ROS_ERROR_STREAM_NAMED(name_action_exe_path, "\"ExePath\" action has been stopped!");
     }
+    return outcome;
   }
 
-  void AbstractNavigationServer::callActionRecovery(
-      const mbf_msgs::RecoveryGoalConstPtr &goal)
+  AbstractNavigationServer::ActionOutcome AbstractNavigationServer::runRecovery(
+      const mbf_msgs::RecoveryGoal &goal, mbf_msgs::RecoveryResult &result,
+      const PreemptRequestedFn &preempt_requested)
   {
-    ROS_DEBUG_STREAM_NAMED(name_action_recovery, "Start action "  << name_action_recovery);
-
-    mbf_msgs::RecoveryResult result;
-    std::string behavior = goal->behavior;
-    recovery_ptr_->startRecovery(behavior);
+    ActionOutcome outcome = ABORTED;
+    std::string behavior = goal.behavior;
+    if (!recovery_ptr_->startRecovery(behavior))
+    {
+      result.outcome = mbf_msgs::RecoveryResult::INTERNAL_ERROR;
+      result.message = "Another recovery behavior is already waiting to be run!";
+      ROS_ERROR_STREAM_NAMED(name_action_recovery, result.message << " Canceling the action call.");
+      return ABORTED;
+    }
     active_recovery_ = true;
 
     typename AbstractRecoveryExecution::RecoveryState state_recovery_input;
 
     while (active_recovery_ && ros::ok())
     {
+      const unsigned int recovery_seq = recovery_ptr_->getUpdateSeq();
       state_recovery_input = recovery_ptr_->getState();
       switch (state_recovery_input)
       {
         case AbstractRecoveryExecution::STOPPED:
           ROS_WARN_STREAM_NAMED(name_action_recovery, "Recovering \"" << behavior << "\" has been stopped!");
           active_recovery_ = false; // stopping the action
+          result.outcome = mbf_msgs::RecoveryResult::CANCELED;
+          result.message = "Recovering \"" + behavior + "\" has been stopped!";
+          outcome = ABORTED;
           break;
 
         case AbstractRecoveryExecution::STARTED:
@@ -671,8 +912,8 @@ namespace mbf_abstract_nav
 
         case AbstractRecoveryExecution::RECOVERING:
           // check preempt requested; we let for the next iteration to set the action as preempted to
-          // give time to the executing thread to finish, set the CANCELED state and notify condition
-          if (action_server_recovery_ptr_->isPreemptRequested() && recovery_ptr_->cancel())
+          // give time to the executing thread to finish and set the CANCELED state
+          if (preempt_requested() && recovery_ptr_->cancel())
           {
             ROS_DEBUG_STREAM_NAMED(name_action_recovery, "Recovering \"" << behavior << "\" canceled!");
           }
@@ -687,7 +928,7 @@ namespace mbf_abstract_nav
           active_recovery_ = false; // stopping the action
           result.outcome = mbf_msgs::RecoveryResult::INVALID_NAME;
           result.message = "No recovery plugin loaded with the given name\"" + behavior + "\"!";
-          action_server_recovery_ptr_->setAborted(result, result.message);
+          outcome = ABORTED;
           ROS_ERROR_STREAM_NAMED(name_action_recovery, result.message);
           break;
 
@@ -696,7 +937,7 @@ namespace mbf_abstract_nav
           active_recovery_ = false; // stopping the action
           result.outcome = mbf_msgs::RecoveryResult::CANCELED;
           result.message = "Recovering \"" + behavior + "\" preempted!";
-          action_server_recovery_ptr_->setPreempted(result, result.message);
+          outcome = PREEMPTED;
           ROS_DEBUG_STREAM_NAMED(name_action_recovery, result.message);
           break;
 
@@ -705,18 +946,15 @@ namespace mbf_abstract_nav
           result.outcome = mbf_msgs::RecoveryResult::SUCCESS;
           result.message = "Recovery \"" + behavior + "\" done!";
           ROS_DEBUG_STREAM_NAMED(name_action_recovery, result.message);
-          action_server_recovery_ptr_->setSucceeded(result, result.message);
+          outcome = SUCCEEDED;
           break;
       }
 
       if (active_recovery_)
       {
-        // try to sleep a bit
-        // normally the thread should be woken up from the recovery unit
-        // in order to transfer the results to the controller
-        boost::mutex mutex;
-        boost::unique_lock<boost::mutex> lock(mutex);
-        condition_.wait_for(lock, boost::chrono::milliseconds(500));
+        // wait for the next state update of the recovery execution; the timeout is
+        // just a fallback to check for preemption requests while the behavior is running
+        recovery_ptr_->waitForStateUpdate(recovery_seq, boost::chrono::milliseconds(500));
       }
     }  // while (active_recovery_ && ros::ok())
 
@@ -728,6 +966,253 @@ namespace mbf_abstract_nav
     {
       ROS_ERROR_STREAM_NAMED(name_action_recovery, "\"Recovery\" action has been stopped!");
     }
+    return outcome;
+  }
+  void AbstractNavigationServer::callActionGetPath(
+      const mbf_msgs::GetPathGoalConstPtr &goal)
+  {
+    ROS_DEBUG_STREAM_NAMED(name_action_get_path, "Start action "  << name_action_get_path);
+
+    mbf_msgs::GetPathResult result;
+    PlanConstPtr plan;
+
+    // preempt any other goal using the planner execution, e.g. a MoveBase one
+    unsigned int ticket = execution_arbiter_.acquire(ExecutionArbiter::PLANNER);
+    if (!ticket)
+    {
+      result.outcome = mbf_msgs::GetPathResult::CANCELED;
+      result.message = "Preempted by a newer goal before starting";
+      action_server_get_path_ptr_->setPreempted(result, result.message);
+      return;
+    }
+
+    // plan with the requested plugin, or with the default one if none is requested
+    if (!planning_ptr_->selectPlugin(goal->global_planner))
+    {
+      execution_arbiter_.release(ticket);
+      result.outcome = mbf_msgs::GetPathResult::INVALID_PLUGIN;
+      result.message = "No planner plugin named \"" + goal->global_planner + "\" loaded!";
+      ROS_ERROR_STREAM_NAMED(name_action_get_path, result.message << " Canceling the action call.");
+      action_server_get_path_ptr_->setAborted(result, result.message);
+      return;
+    }
+
+    PreemptRequestedFn action_preempt_requested =
+        boost::bind(&ActionServerGetPath::isPreemptRequested, action_server_get_path_ptr_);
+    ActionOutcome outcome =
+        runGetPath(*goal, result, plan,
+                   boost::bind(&AbstractNavigationServer::isGoalPreempted, this, action_preempt_requested, ticket),
+                   boost::bind(&AbstractNavigationServer::actionGetPathFeedback, this, _1));
+    execution_arbiter_.release(ticket);
+
+    switch (outcome)
+    {
+      case SUCCEEDED:
+        result.path.poses = *plan;
+        action_server_get_path_ptr_->setSucceeded(result, result.message);
+        break;
+      case PREEMPTED:
+        action_server_get_path_ptr_->setPreempted(result, result.message);
+        break;
+      case ABORTED:
+        action_server_get_path_ptr_->setAborted(result, result.message);
+        break;
+    }
+  }
+
+  void AbstractNavigationServer::callActionExePath(
+      const mbf_msgs::ExePathGoalConstPtr &goal)
+  {
+    ROS_DEBUG_STREAM_NAMED(name_action_exe_path, "Start action "  << name_action_exe_path);
+
+    // share the path poses of the goal, keeping the goal itself alive, instead of copying them
+    PlanConstPtr plan(goal, &goal->path.poses);
+
+    mbf_msgs::ExePathResult result;
+
+    // preempt any other goal using the controller execution, e.g. a MoveBase one
+    unsigned int ticket = execution_arbiter_.acquire(ExecutionArbiter::CONTROLLER);
+    if (!ticket)
+    {
+      result.outcome = mbf_msgs::ExePathResult::CANCELED;
+      result.message = "Preempted by a newer goal before starting";
+      action_server_exe_path_ptr_->setPreempted(result, result.message);
+      return;
+    }
+
+    // move with the requested plugin, or with the default one if none is requested
+    if (!moving_ptr_->selectPlugin(goal->local_planner))
+    {
+      execution_arbiter_.release(ticket);
+      result.outcome = mbf_msgs::ExePathResult::INVALID_PLUGIN;
+      result.message = "No controller plugin named \"" + goal->local_planner + "\" loaded!";
+      ROS_ERROR_STREAM_NAMED(name_action_exe_path, result.message << " Canceling the action call.");
+      action_server_exe_path_ptr_->setAborted(result, result.message);
+      return;
+    }
+
+    PreemptRequestedFn action_preempt_requested =
+        boost::bind(&ActionServerExePath::isPreemptRequested, action_server_exe_path_ptr_);
+    ActionOutcome outcome =
+        runExePath(plan, result,
+                   boost::bind(&AbstractNavigationServer::isGoalPreempted, this, action_preempt_requested, ticket),
+                   boost::bind(&AbstractNavigationServer::actionExePathFeedback, this, _1),
+                   &exe_path_feedback_throttle_);
+    execution_arbiter_.release(ticket);
+
+    switch (outcome)
+    {
+      case SUCCEEDED:
+        action_server_exe_path_ptr_->setSucceeded(result, result.message);
+        break;
+      case PREEMPTED:
+        action_server_exe_path_ptr_->setPreempted(result, result.message);
+        break;
+      case ABORTED:
+        action_server_exe_path_ptr_->setAborted(result, result.message);
+        break;
+    }
+  }
+
+  void AbstractNavigationServer::callActionRecovery(
+      const mbf_msgs::RecoveryGoalConstPtr &goal)
+  {
+    ROS_DEBUG_STREAM_NAMED(name_action_recovery, "Start action "  << name_action_recovery);
+
+    mbf_msgs::RecoveryResult result;
+
+    // preempt any other goal using the recovery execution, e.g. a MoveBase one
+    unsigned int ticket = execution_arbiter_.acquire(ExecutionArbiter::RECOVERY);
+    if (!ticket)
+    {
+      result.outcome = mbf_msgs::RecoveryResult::CANCELED;
+      result.message = "Preempted by a newer goal before starting";
+      action_server_recovery_ptr_->setPreempted(result, result.message);
+      return;
+    }
+
+    PreemptRequestedFn action_preempt_requested =
+        boost::bind(&ActionServerRecovery::isPreemptRequested, action_server_recovery_ptr_);
+    ActionOutcome outcome =
+        runRecovery(*goal, result,
+                    boost::bind(&AbstractNavigationServer::isGoalPreempted, this, action_preempt_requested, ticket));
+    execution_arbiter_.release(ticket);
+
+    switch (outcome)
+    {
+      case SUCCEEDED:
+        action_server_recovery_ptr_->setSucceeded(result, result.message);
+        break;
+      case PREEMPTED:
+        action_server_recovery_ptr_->setPreempted(result, result.message);
+        break;
+      case ABORTED:
+        action_server_recovery_ptr_->setAborted(result, result.message);
+        break;
+    }
+  }
+
+  bool AbstractNavigationServer::callServiceGetPaths(mbf_msgs::GetPaths::Request &request,
+                                                     mbf_msgs::GetPaths::Response &response)
+  {
+    const size_t num_queries = request.target_poses.size();
+    if (request.start_poses.size() > 1 && request.start_poses.size() != num_queries)
+    {
+      ROS_ERROR_STREAM("Invalid get_paths request: " << request.start_poses.size() << " start poses for "
+                       << num_queries << " target poses; provide none, one or one per target pose");
+      return false;
+    }
+
+    geometry_msgs::PoseStamped robot_pose;
+    if (request.start_poses.empty() && !getRobotPose(robot_pose))
+    {
+      ROS_ERROR_STREAM("Could not get the current robot pose to plan the get_paths queries");
+      return false;
+    }
+
+    std::vector<PlannerPool::Query> queries(num_queries);
+    for (size_t i = 0; i < num_queries; ++i)
+    {
+      if (request.start_poses.empty())
+        queries[i].start = robot_pose;
+      else
+        queries[i].start = request.start_poses.size() == 1 ? request.start_poses[0] : request.start_poses[i];
+      queries[i].goal = request.target_poses[i];
+      queries[i].tolerance = request.tolerance;
+    }
+
+    ros::WallTime start_time = ros::WallTime::now();
+    std::vector<PlannerPool::Answer> answers;
+    planner_pool_ptr_->makePlans(request.planner, queries, answers);
+
+    response.outcomes.resize(num_queries);
+    response.messages.resize(num_queries);
+    response.costs.resize(num_queries);
+    response.paths.resize(num_queries);
+    size_t num_found = 0;
+    for (size_t i = 0; i < num_queries; ++i)
+    {
+      PlannerPool::Answer &answer = answers[i];
+      response.outcomes[i] = answer.outcome;
+      response.messages[i] = answer.message;
+      response.costs[i] = answer.cost;
+
+      nav_msgs::Path &path = response.paths[i];
+      path.header.frame_id = global_frame_;
+      path.header.stamp = ros::Time::now();
+      if (answer.outcome >= 10)
+      {
+        continue;  // no path found; keep the planner outcome
+      }
+
+      PlanConstPtr global_plan;
+      if (!transformPlanToGlobalFrame(answer.plan, global_plan))
+      {
+        response.outcomes[i] = mbf_msgs::GetPathResult::TF_ERROR;
+        response.messages[i] = "Could not transform the plan to the global frame!";
+        continue;
+      }
+      if (global_plan->empty())
+      {
+        response.outcomes[i] = mbf_msgs::GetPathResult::EMPTY_PATH;
+        response.messages[i] = "Global planner returned an empty path!";
+        continue;
+      }
+      path.poses = *global_plan;
+      ++num_found;
+    }
+
+    ROS_DEBUG_STREAM("Planned " << num_found << " of " << num_queries << " get_paths queries with "
+                     << planner_pool_ptr_->size() << " planners in "
+                     << (ros::WallTime::now() - start_time).toSec() << " s");
+    return true;
+  }
+
+  bool AbstractNavigationServer::callServiceGetExecutionStats(mbf_msgs::GetExecutionStats::Request &request,
+                                                              mbf_msgs::GetExecutionStats::Response &response)
+  {
+    response.stats.resize(2);
+    planning_ptr_->getStats().toMsg(response.stats[0]);
+    moving_ptr_->getStats().toMsg(response.stats[1]);
+
+    if (request.reset)
+    {
+      planning_ptr_->getStats().reset();
+      moving_ptr_->getStats().reset();
+    }
+    return true;
+  }
+
+  void AbstractNavigationServer::publishExecutionStats(const ros::TimerEvent &event)
+  {
+    if (execution_stats_pub_.getNumSubscribers() == 0)
+      return;
+
+    mbf_msgs::ExecutionStats stats;
+    planning_ptr_->getStats().toMsg(stats);
+    execution_stats_pub_.publish(stats);
+    moving_ptr_->getStats().toMsg(stats);
+    execution_stats_pub_.publish(stats);
   }
 
   void AbstractNavigationServer::callActionMoveBase(
@@ -735,14 +1220,7 @@ namespace mbf_abstract_nav
   {
     ROS_DEBUG_STREAM_NAMED(name_action_move_base, "Start action "  << name_action_move_base);
 
-    const geometry_msgs::PoseStamped target_pose = goal->target_pose;
-    const std::string local_planner = goal->local_planner;
-    const std::string global_planner = goal->global_planner;
-
     mbf_msgs::MoveBaseResult move_base_result;
-    mbf_msgs::GetPathResult get_path_result;
-    mbf_msgs::ExePathResult exe_path_result;
-    mbf_msgs::RecoveryResult recovery_result;
 
     for(std::vector<std::string>::const_iterator iter = goal->recovery_behaviors.begin();
         iter != goal->recovery_behaviors.end(); ++iter)
@@ -758,21 +1236,61 @@ namespace mbf_abstract_nav
         return;
       }
     }
+
+    // take the executions from any GetPath, ExePath or Recovery goal, as the action servers did before
+    unsigned int ticket = execution_arbiter_.acquire(
+        ExecutionArbiter::PLANNER | ExecutionArbiter::CONTROLLER | ExecutionArbiter::RECOVERY);
+    if (!ticket)
+    {
+      move_base_result.outcome = mbf_msgs::MoveBaseResult::CANCELED;
+      move_base_result.message = "Preempted by a newer goal before starting";
+      action_server_move_base_ptr_->setPreempted(move_base_result, move_base_result.message);
+      return;
+    }
+
+    // select the requested plugins once for the whole goal, as no recovery behavior can help if they are missing
+    if (!planning_ptr_->selectPlugin(goal->global_planner) || !moving_ptr_->selectPlugin(goal->local_planner))
+    {
+      execution_arbiter_.release(ticket);
+      std::stringstream ss;
+      ss << "No planner plugin named \"" << goal->global_planner << "\" or no controller plugin named \""
+         << goal->local_planner << "\" loaded!";
+      ROS_ERROR_STREAM_NAMED(name_action_move_base, ss.str());
+      move_base_result.outcome = mbf_msgs::MoveBaseResult::INVALID_PLUGIN;
+      move_base_result.message = ss.str();
+      action_server_move_base_ptr_->setAborted(move_base_result, ss.str());
+      return;
+    }
+
+    PreemptRequestedFn action_preempt_requested =
+        boost::bind(&ActionServerMoveBase::isPreemptRequested, action_server_move_base_ptr_);
+    runMoveBase(*goal, boost::bind(&AbstractNavigationServer::isGoalPreempted, this, action_preempt_requested, ticket));
+    execution_arbiter_.release(ticket);
+  }
+
+  void AbstractNavigationServer::runMoveBase(const mbf_msgs::MoveBaseGoal &goal,
+                                             const PreemptRequestedFn &preempt_requested)
+  {
+    const geometry_msgs::PoseStamped target_pose = goal.target_pose;
+
+    mbf_msgs::MoveBaseResult move_base_result;
+    mbf_msgs::GetPathResult get_path_result;
+    mbf_msgs::ExePathResult exe_path_result;
+    mbf_msgs::RecoveryResult recovery_result;
+
     geometry_msgs::PoseStamped robot_pose;
 
     mbf_msgs::GetPathGoal get_path_goal;
-    mbf_msgs::ExePathGoal exe_path_goal;
     mbf_msgs::RecoveryGoal recovery_goal;
 
     get_path_goal.target_pose = target_pose;
     get_path_goal.use_start_pose = false; // use the robot pose
-
-    ros::Duration connection_timeout(1.0);
+    get_path_goal.global_planner = goal.global_planner;
 
     // start recovering with the first behavior, use the recovery behaviors from the action request, if specified,
     // otherwise all loaded behaviors.
     std::vector<std::string> recovery_behaviors =
-        goal->recovery_behaviors.empty() ? recovery_ptr_->listRecoveryBehaviors() : goal->recovery_behaviors;
+        goal.recovery_behaviors.empty() ? recovery_ptr_->listRecoveryBehaviors() : goal.recovery_behaviors;
     std::vector<std::string>::iterator current_recovery_behavior = recovery_behaviors.begin();
 
     // get the current robot pose
@@ -785,409 +1303,217 @@ namespace mbf_abstract_nav
       return;
     }
 
-    enum MoveBaseActionState
-    {
-      NONE,
-      GET_PATH,
-      EXE_PATH,
-      RECOVERY
-    };
-
-    // wait for server connections
-    if (!action_client_get_path_.waitForServer(connection_timeout) ||
-        !action_client_exe_path_.waitForServer(connection_timeout) ||
-        !action_client_recovery_.waitForServer(connection_timeout))
+    // the planner, controller and recovery executions are driven directly from this thread, so the path
+    // computed by the planner is handed to the controller without going through the action interfaces
+    ExePathFeedbackFn publish_feedback =
+        boost::bind(&AbstractNavigationServer::actionMoveBaseExePathFeedback, this, _1);
+
+    std::string type; // recovery behavior type
+    PlanConstPtr plan; // the last found plan, handed over to the controller execution
+
+    while (ros::ok())
     {
-      ROS_ERROR_STREAM_NAMED(name_action_move_base, "Could not connect to one or more of move_base_flex actions:"
-                       << "\"" << name_action_get_path
-                       << "\", " << "\"" << name_action_exe_path
-                       << "\", " << "\"" << name_action_recovery << "\"!");
-      move_base_result.outcome = mbf_msgs::MoveBaseResult::INTERNAL_ERROR;
-      move_base_result.message = "Could not connect to the move_base_flex actions!";
-      action_server_move_base_ptr_->setAborted(move_base_result, move_base_result.message);
-      return;
-    }
+      ROS_DEBUG_STREAM_NAMED(name_action_move_base, "Action \""
+          << name_action_move_base << "\" requests a path to \"" << name_action_get_path << "\".");
+      ActionOutcome outcome = runGetPath(get_path_goal, get_path_result, plan, preempt_requested);
 
-    // call get_path action server
-    action_client_get_path_.sendGoal(get_path_goal);
+      if (outcome == SUCCEEDED)
+      {
+        ROS_DEBUG_STREAM_NAMED(name_action_move_base, "Action \""
+            << name_action_move_base << "\" received a path from \""
+            << name_action_get_path << "\": " << get_path_result.message);
 
-    // init goal states with dummy values;
-    actionlib::SimpleClientGoalState get_path_state(actionlib::SimpleClientGoalState::PENDING);
-    actionlib::SimpleClientGoalState exe_path_state(actionlib::SimpleClientGoalState::PENDING);
-    actionlib::SimpleClientGoalState recovery_state(actionlib::SimpleClientGoalState::PENDING);
+        ROS_DEBUG_STREAM_NAMED(name_action_move_base, "Action \""
+            << name_action_move_base << "\" sends the path to \""
+            << name_action_exe_path << "\".");
 
-    MoveBaseActionState state = GET_PATH;
-    MoveBaseActionState last_state = NONE;
-    MoveBaseActionState recovery_trigger = NONE;
+        // keep replanning from the current robot pose while moving, streaming the new plans to the controller
+        bool replanning = replanning_enabled_ && planning_ptr_->startReplanning(
+            get_path_goal.target_pose, get_path_goal.tolerance,
+            boost::bind(&AbstractNavigationServer::getRobotPose, this, _1),
+            boost::bind(&AbstractNavigationServer::handleReplannedPlan, this, _1, _2));
 
-    bool run = true;
-    bool preempted = false;
-    ros::Duration wait(0.5);
+        ros::Time exe_path_start = ros::Time::now();
+        outcome = runExePath(plan, exe_path_result, preempt_requested, publish_feedback, &move_base_feedback_throttle_);
 
-    std::string type; // recovery behavior type
-    bool try_recovery = false; // init with false
+        if (replanning)
+        {
+          planning_ptr_->stopReplanning();
+        }
 
-    while (ros::ok() && run)
-    {
-      switch (state)
+        // copy result from exe_path action
+        move_base_result.outcome = exe_path_result.outcome;
+        move_base_result.message = exe_path_result.message;
+        move_base_result.dist_to_goal = exe_path_result.dist_to_goal;
+        move_base_result.angle_to_goal = exe_path_result.angle_to_goal;
+        move_base_result.final_pose = exe_path_result.final_pose;
+
+        if (outcome == SUCCEEDED)
+        {
+          ROS_DEBUG_STREAM_NAMED(name_action_move_base, "Action \"" << name_action_move_base << "\" succeeded.");
+          move_base_result.outcome = mbf_msgs::MoveBaseResult::SUCCESS;
+          move_base_result.message = "MoveBase action succeeded!";
+          action_server_move_base_ptr_->setSucceeded(move_base_result, move_base_result.message);
+          return;
+        }
+
+        if (outcome == PREEMPTED)
+        {
+          ROS_DEBUG_STREAM_NAMED(name_action_move_base, "The action \""
+              << name_action_move_base << "\" was preempted successfully!");
+          action_server_move_base_ptr_->setPreempted(move_base_result, move_base_result.message);
+          return;
+        }
+
+        switch (exe_path_result.outcome)
+        {
+          case mbf_msgs::ExePathResult::INVALID_PATH:
+          case mbf_msgs::ExePathResult::TF_ERROR:
+          case mbf_msgs::ExePathResult::CANCELED:
+          case mbf_msgs::ExePathResult::NOT_INITIALIZED:
+          case mbf_msgs::ExePathResult::INVALID_PLUGIN:
+          case mbf_msgs::ExePathResult::INTERNAL_ERROR:
+            // no recovery behavior can help on these failures
+            action_server_move_base_ptr_->setAborted(move_base_result, move_base_result.message);
+            return;
+
+          default:
+            break;
+        }
+
+        // reset the recovery behaviors, if the robot has moved since the last recovery
+        if (moving_ptr_->getLastValidCmdVelTime() > exe_path_start)
+        {
+          ROS_INFO_STREAM_NAMED(name_action_move_base, "Reset current recovery behavior pointer to the first "
+              << "recovery behavior in the list!");
+          current_recovery_behavior = recovery_behaviors.begin();
+        }
+      }
+      else
       {
-        case GET_PATH:
-          if (!action_client_get_path_.waitForResult(wait))
-          { // no result -> action server is still running
-            if (action_server_move_base_ptr_->isPreemptRequested() && !preempted)
-            {
-              action_client_get_path_.cancelGoal();
-              preempted = true;
-            }
-          }
-          else
-          {
-            get_path_state = action_client_get_path_.getState();
-            switch (get_path_state.state_)
-            {
-              case actionlib::SimpleClientGoalState::PENDING:
-                // TODO -> not implemented // should not be reached!
-                break;
-
-              case actionlib::SimpleClientGoalState::SUCCEEDED:
-
-                get_path_result = *action_client_get_path_.getResult();
-                ROS_DEBUG_STREAM_NAMED(name_action_move_base, "Action \""
-                    << name_action_move_base << "\" received a path from \""
-                    << name_action_get_path << "\": " << get_path_state.getText());
-
-                exe_path_goal.path = get_path_result.path;
-                ROS_DEBUG_STREAM_NAMED(name_action_move_base, "Action \""
-                    << name_action_move_base << "\" sends the path to \""
-                    << name_action_exe_path << "\".");
-
-                action_client_exe_path_.sendGoal(
-                    exe_path_goal,
-                    ActionClientExePath::SimpleDoneCallback(),
-                    ActionClientExePath::SimpleActiveCallback(),
-                    boost::bind(&mbf_abstract_nav::AbstractNavigationServer::actionMoveBaseExePathFeedback,this, _1));
-                state = EXE_PATH;
-                last_state = GET_PATH;
-                break;
-
-              case actionlib::SimpleClientGoalState::ABORTED:
-                get_path_result = *action_client_get_path_.getResult();
-                // copy result from get_path action
-                move_base_result.outcome = get_path_result.outcome;
-                move_base_result.message = get_path_result.message;
-                move_base_result.dist_to_goal = static_cast<float>(mbf_abstract_nav::distance(robot_pose, target_pose));
-                move_base_result.angle_to_goal = static_cast<float>(mbf_abstract_nav::angle(robot_pose, target_pose));
-                move_base_result.final_pose = robot_pose;
-
-                if (!recovery_enabled_)
-                {
-                  ROS_WARN_STREAM_NAMED(name_action_move_base, "Recovery behaviors are disabled!");
-                  ROS_WARN_STREAM_NAMED(name_action_move_base, "Abort the execution of the planner: "
-                      << get_path_result.message);
-                  run = false;
-                  action_server_move_base_ptr_->setAborted(move_base_result, get_path_state.getText());
-                  break;
-                }
-                else if (current_recovery_behavior == recovery_behaviors.end())
-                {
-                  if (recovery_behaviors.empty())
-                  {
-                    ROS_WARN_STREAM_NAMED(name_action_move_base, "No Recovery Behaviors loaded! Abort controlling: "
-                        << exe_path_result.message);
-                  }
-                  else
-                  {
-                    ROS_WARN_STREAM_NAMED(name_action_move_base, "Executed all available recovery behaviors! "
-                        << "Abort planning: " << get_path_result.message);
-                  }
-                  run = false;
-                  action_server_move_base_ptr_->setAborted(move_base_result, get_path_state.getText());
-                  break;
-                }
-                else
-                {
-                  recovery_goal.behavior = *current_recovery_behavior;
-                  recovery_ptr_->getTypeOfBehavior(*current_recovery_behavior, type);
-                  ROS_DEBUG_STREAM_NAMED(name_action_move_base, "Start recovery behavior\""
-                      << *current_recovery_behavior << "\" of the type \"" << type << "\".");
-                  action_client_recovery_.sendGoal(recovery_goal);
-                  state = RECOVERY;
-                  last_state = GET_PATH;
-                }
-                break;
-
-              case actionlib::SimpleClientGoalState::PREEMPTED:
-                // the get_path action has been preempted.
-                get_path_result = *action_client_get_path_.getResult();
-
-                // copy result from get_path action
-                move_base_result.outcome = get_path_result.outcome;
-                move_base_result.message = get_path_result.message;
-                move_base_result.dist_to_goal = static_cast<float>(mbf_abstract_nav::distance(robot_pose, target_pose));
-                move_base_result.angle_to_goal = static_cast<float>(mbf_abstract_nav::angle(robot_pose, target_pose));
-                move_base_result.final_pose = robot_pose;
-                run = false;
-                action_server_move_base_ptr_->setPreempted(move_base_result, get_path_state.getText());
-                break;
-
-              case actionlib::SimpleClientGoalState::RECALLED:
-              case actionlib::SimpleClientGoalState::REJECTED:
-                ROS_FATAL_STREAM_NAMED(name_action_move_base, "The states RECALLED and REJECTED are not implemented "
-                    << "in the SimpleActionServer!");
-                run = false;
-                action_server_move_base_ptr_->setAborted();
-                break;
-              case actionlib::SimpleClientGoalState::LOST:
-                // TODO
-                break;
-
-              default:
-                ROS_FATAL_STREAM_NAMED(name_action_move_base, "Reached unreachable case! Unknown SimpleActionServer state!");
-                run = false;
-                action_server_move_base_ptr_->setAborted();
-                break;
-            }
-          }
+        // copy result from get_path action
+        move_base_result.outcome = get_path_result.outcome;
+        move_base_result.message = get_path_result.message;
+        move_base_result.dist_to_goal = static_cast<float>(mbf_abstract_nav::distance(robot_pose, target_pose));
+        move_base_result.angle_to_goal = static_cast<float>(mbf_abstract_nav::angle(robot_pose, target_pose));
+        move_base_result.final_pose = robot_pose;
+
+        if (outcome == PREEMPTED)
+        {
+          action_server_move_base_ptr_->setPreempted(move_base_result, move_base_result.message);
+          return;
+        }
+      }
 
-          break;
+      // the planner or the controller failed; try to recover
+      if (!recovery_enabled_)
+      {
+        ROS_WARN_STREAM_NAMED(name_action_move_base, "Recovery behaviors are disabled!");
+        ROS_WARN_STREAM_NAMED(name_action_move_base, "Abort the execution: " << move_base_result.message);
+        action_server_move_base_ptr_->setAborted(move_base_result, move_base_result.message);
+        return;
+      }
 
-        case EXE_PATH:
+      if (current_recovery_behavior == recovery_behaviors.end())
+      {
+        if (recovery_behaviors.empty())
+        {
+          ROS_WARN_STREAM_NAMED(name_action_move_base, "No Recovery Behaviors loaded! Abort the execution: "
+              << move_base_result.message);
+        }
+        else
+        {
+          ROS_WARN_STREAM_NAMED(name_action_move_base, "Executed all available recovery behaviors! "
+              << "Abort the execution: " << move_base_result.message);
+        }
+        action_server_move_base_ptr_->setAborted(move_base_result, move_base_result.message);
+        return;
+      }
 
-          if (!action_client_exe_path_.waitForResult(wait))
-          {  // no result -> action server is still running
-          // reset the recovery behaviors, if the robot moves
-            if (moving_ptr_->isMoving())
-            {
-              ROS_INFO_STREAM_NAMED(name_action_move_base, "Reset current recovery behavior pointer to the first recovery behavior in the list!");
-              current_recovery_behavior = recovery_behaviors.begin();
-            }
+      // run the recovery behaviors in order until one of them succeeds
+      outcome = ABORTED;
+      while (outcome == ABORTED && current_recovery_behavior != recovery_behaviors.end())
+      {
+        recovery_goal.behavior = *current_recovery_behavior;
+        recovery_ptr_->getTypeOfBehavior(*current_recovery_behavior, type);
+        ROS_DEBUG_STREAM_NAMED(name_action_move_base, "Start recovery behavior\""
+            << *current_recovery_behavior << "\" of the type \"" << type << "\".");
 
-            if (action_server_move_base_ptr_->isPreemptRequested() && !preempted)
-            {
-              action_client_exe_path_.cancelGoal();
-              preempted = true;
-            }
-          }
-          else
-          {
-            exe_path_state = action_client_exe_path_.getState();
-            switch (exe_path_state.state_)
-            {
-              case actionlib::SimpleClientGoalState::PENDING:
-                //TODO
-                break;
-              case actionlib::SimpleClientGoalState::SUCCEEDED:
-                exe_path_result = *action_client_exe_path_.getResult();
-                ROS_DEBUG_STREAM_NAMED(name_action_move_base, "Action \""
-                    << name_action_move_base << "\" received a result from \""
-                    << name_action_exe_path << "\": " << exe_path_state.getText());
-                exe_path_goal.path = get_path_result.path;
-                ROS_DEBUG_STREAM_NAMED(name_action_move_base, "Action \"" << name_action_move_base << "\" succeeded.");
-
-                move_base_result.angle_to_goal = exe_path_result.angle_to_goal;
-                move_base_result.dist_to_goal = exe_path_result.dist_to_goal;
-                move_base_result.final_pose = exe_path_result.final_pose;
-                move_base_result.outcome = mbf_msgs::MoveBaseResult::SUCCESS;
-                move_base_result.message = "MoveBase action succeeded!";
-                action_server_move_base_ptr_->setSucceeded(move_base_result, move_base_result.message);
-                run = false;
-                break;
-              case actionlib::SimpleClientGoalState::ABORTED:
-                exe_path_result = *action_client_exe_path_.getResult();
-
-                switch (exe_path_result.outcome)
-                {
-                  case mbf_msgs::ExePathResult::INVALID_PATH:
-                  case mbf_msgs::ExePathResult::TF_ERROR:
-                  case mbf_msgs::ExePathResult::CANCELED:
-                  case mbf_msgs::ExePathResult::NOT_INITIALIZED:
-                  case mbf_msgs::ExePathResult::INVALID_PLUGIN:
-                  case mbf_msgs::ExePathResult::INTERNAL_ERROR:
-
-                    // copy result from get_path action
-                    move_base_result.outcome = exe_path_result.outcome;
-                    move_base_result.message = exe_path_result.message;
-                    move_base_result.dist_to_goal = exe_path_result.dist_to_goal;
-                    move_base_result.angle_to_goal = exe_path_result.angle_to_goal;
-                    move_base_result.final_pose = exe_path_result.final_pose;
-                    run = false;
-                    try_recovery = false;
-
-                    action_server_move_base_ptr_->setAborted(move_base_result, exe_path_state.getText());
-                    break;
-
-                  default:
-                    // copy result from get_path action
-                    move_base_result.outcome = exe_path_result.outcome;
-                    move_base_result.message = exe_path_result.message;
-                    move_base_result.dist_to_goal = exe_path_result.dist_to_goal;
-                    move_base_result.angle_to_goal = exe_path_result.angle_to_goal;
-                    move_base_result.final_pose = exe_path_result.final_pose;
-
-                    try_recovery = true;
-                    break;
-                }
-
-                if (try_recovery)
-                {
-                  if (!recovery_enabled_)
-                  {
-                    ROS_WARN_STREAM_NAMED(name_action_move_base, "Recovery behaviors are disabled!");
-                    ROS_WARN_STREAM_NAMED(name_action_move_base, "Abort the execution of the controller: "
-                        << exe_path_result.message);
-                    run = false;
-                    action_server_move_base_ptr_->setAborted(move_base_result, exe_path_state.getText());
-                    break;
-                  }
-                  else if (current_recovery_behavior == recovery_behaviors.end())
-                  {
-                    if (recovery_behaviors.empty())
-                    {
-                      ROS_WARN_STREAM_NAMED(name_action_move_base, "No Recovery Behaviors loaded! Abort controlling: "
-                          << exe_path_result.message);
-                    }
-                    else
-                    {
-                      ROS_WARN_STREAM_NAMED(name_action_move_base, "Executed all available recovery behaviors! Abort controlling: "
-                          << exe_path_result.message);
-                    }
-                    run = false;
-                    action_server_move_base_ptr_->setAborted(move_base_result, exe_path_state.getText());
-                    break;
-                  }
-                  else
-                  {
-                    recovery_goal.behavior = *current_recovery_behavior;
-                    recovery_ptr_->getTypeOfBehavior(*current_recovery_behavior, type);
-                    ROS_DEBUG_STREAM_NAMED(name_action_move_base, "Start recovery behavior\""
-                        << *current_recovery_behavior << "\" of the type \"" << type << "\".");
-                    action_client_recovery_.sendGoal(recovery_goal);
-                    state = RECOVERY;
-                    last_state = EXE_PATH;
-                  }
-                }
-                break;
-              case actionlib::SimpleClientGoalState::PREEMPTED:
-                // action was preempted successfully!
-                ROS_DEBUG_STREAM_NAMED(name_action_move_base, "The action \""
-                    << name_action_move_base << "\" was preempted successfully!");
-                action_server_move_base_ptr_->setPreempted();
-                run = false;
-                break;
-              case actionlib::SimpleClientGoalState::RECALLED:
-              case actionlib::SimpleClientGoalState::REJECTED:
-                ROS_FATAL_STREAM_NAMED(name_action_move_base,
-                    "The states RECALLED and REJECTED are not implemented in the SimpleActionServer!");
-                run = false;
-                action_server_move_base_ptr_->setAborted();
-                break;
-              case actionlib::SimpleClientGoalState::LOST:
-                // TODO
-                break;
-              default:
-                ROS_FATAL_STREAM_NAMED(name_action_move_base, "Reached unreachable case! Unknown SimpleActionServer state!");
-                run = false;
-                action_server_move_base_ptr_->setAborted();
-                break;
-            }
-          }
-          break;
+        outcome = runRecovery(recovery_goal, recovery_result, preempt_requested);
+        current_recovery_behavior++; // use next behavior, the next time
 
-        case RECOVERY:
-          recovery_trigger = last_state;
-          if (!action_client_recovery_.waitForResult(wait))
-          {
-            if (action_server_move_base_ptr_->isPreemptRequested() && !preempted)
-            {
-              preempted = true;
-              action_client_recovery_.cancelGoal();
-            }
-          }
-          else
-          {
-            recovery_state = action_client_recovery_.getState();
-            switch (recovery_state.state_)
-            {
-              case actionlib::SimpleClientGoalState::PENDING:
-                //TODO
-                break;
-              case actionlib::SimpleClientGoalState::ABORTED:
-                ROS_DEBUG_STREAM_NAMED(name_action_move_base, "Recovery behavior aborted!");
-                recovery_result = *action_client_recovery_.getResult();
-                recovery_ptr_->getTypeOfBehavior(*current_recovery_behavior, type);
-                ROS_DEBUG_STREAM_NAMED(name_action_move_base, "The recovery behavior \""
-                                    << *current_recovery_behavior << "\"" << "of the type \"" << type << "\" failed. ");
-                ROS_DEBUG_STREAM("Recovery behavior message: " << recovery_result.message
-                                    << ", outcome: " << recovery_result.outcome);
-
-                current_recovery_behavior++; // use next behavior;
-                if(current_recovery_behavior == recovery_behaviors.end()){
-                  ROS_DEBUG_STREAM_NAMED(name_action_move_base, "All recovery behaviours failed. Abort recovering and abort the move_base action");
-                  action_server_move_base_ptr_->setAborted(move_base_result, "All recovery behaviors failed.");
-                  run = false;
-                }else{
-                  recovery_goal.behavior = *current_recovery_behavior;
-                  recovery_ptr_->getTypeOfBehavior(*current_recovery_behavior, type);
-
-                  ROS_INFO_STREAM_NAMED(name_action_move_base, "Run the next recovery behavior\""
-                      << *current_recovery_behavior << "\" of the type \"" << type << "\".");
-                  action_client_recovery_.sendGoal(recovery_goal);
-                }
-                break;
-              case actionlib::SimpleClientGoalState::SUCCEEDED:
-                recovery_result = *action_client_recovery_.getResult();
-                //go to planning state
-                ROS_DEBUG_STREAM_NAMED(name_action_move_base, "Execution of the recovery behavior \""
-                    << *current_recovery_behavior << "\" succeeded!");
-                ROS_DEBUG_STREAM_NAMED(name_action_move_base, "Try planning again and increment the current recovery "
-                    << "behavior in the list.");
-                // TODO GET_PATH if triggered by GET_PATH and execute EXE_PATH if triggered by EXE_PATH
-                state = GET_PATH;
-                last_state = RECOVERY;
-                current_recovery_behavior++; // use next behavior, the next time;
-                action_client_get_path_.sendGoal(get_path_goal);
-                break;
-              case actionlib::SimpleClientGoalState::PREEMPTED:
-                run = false;
-                action_server_move_base_ptr_->setPreempted();
-                break;
-              case actionlib::SimpleClientGoalState::RECALLED:
-              case actionlib::SimpleClientGoalState::REJECTED:
-                ROS_FATAL_STREAM_NAMED(name_action_move_base, "The states RECALLED and REJECTED are not implemented "
-                    << "in the SimpleActionServer!");
-                run = false;
-                action_server_move_base_ptr_->setAborted();
-                break;
-              case actionlib::SimpleClientGoalState::LOST:
-              default:
-                ROS_FATAL_STREAM_NAMED(name_action_move_base, "Reached unreachable case! Unknown SimpleActionServer "
-                    << "state!");
-                run = false;
-                action_server_move_base_ptr_->setAborted();
-                break;
-            }
-          }
+        if (outcome == ABORTED)
+        {
+          ROS_DEBUG_STREAM_NAMED(name_action_move_base, "The recovery behavior \"" << recovery_goal.behavior
+              << "\" of the type \"" << type << "\" failed. ");
+          ROS_DEBUG_STREAM("Recovery behavior message: " << recovery_result.message
+              << ", outcome: " << recovery_result.outcome);
+        }
+      }
 
-          break;
+      if (outcome == PREEMPTED)
+      {
+        move_base_result.outcome = mbf_msgs::MoveBaseResult::CANCELED;
+        move_base_result.message = recovery_result.message;
+        action_server_move_base_ptr_->setPreempted(move_base_result, move_base_result.message);
+        return;
+      }
 
-        default:
-          move_base_result.outcome = mbf_msgs::MoveBaseResult::INTERNAL_ERROR;
-          move_base_result.message = "Reached a undefined case! Please report the bug!";
-          action_server_move_base_ptr_->setAborted(move_base_result, move_base_result.message);
-          ROS_FATAL_STREAM_NAMED(name_action_move_base, move_base_result.message);
-          break;
+      if (outcome == ABORTED)
+      {
+        ROS_DEBUG_STREAM_NAMED(name_action_move_base, "All recovery behaviours failed. Abort recovering and abort "
+            << "the move_base action");
+        action_server_move_base_ptr_->setAborted(move_base_result, "All recovery behaviors failed.");
+        return;
       }
+
+      // recovery succeeded; go to planning state
+      ROS_DEBUG_STREAM_NAMED(name_action_move_base, "Execution of the recovery behavior \""
+          << recovery_goal.behavior << "\" succeeded!");
+      ROS_DEBUG_STREAM_NAMED(name_action_move_base, "Try planning again and increment the current recovery "
+          << "behavior in the list.");
+    }
+  }
+
+  void AbstractNavigationServer::publishExePathFeedback(const geometry_msgs::PoseStamped &robot_pose,
+                                                        const geometry_msgs::PoseStamped &goal_pose,
+                                                        const geometry_msgs::TwistStamped &cmd_vel,
+                                                        mbf_msgs::ExePathFeedback &feedback,
+                                                        const ExePathFeedbackFn &publish_feedback,
+                                                        FeedbackThrottle *feedback_throttle)
+  {
+    // skip the updates not worth sending, before filling in the feedback
+    if (!publish_feedback || (feedback_throttle && !feedback_throttle->check(robot_pose, cmd_vel)))
+    {
+      return;
     }
+    feedback.current_pose = robot_pose;
+    feedback.current_twist = cmd_vel;
+    feedback.dist_to_goal = static_cast<float>(mbf_abstract_nav::distance(robot_pose, goal_pose));
+    feedback.angle_to_goal = static_cast<float>(mbf_abstract_nav::angle(robot_pose, goal_pose));
+    publish_feedback(feedback);
+  }
+
+  void AbstractNavigationServer::actionGetPathFeedback(
+      const mbf_msgs::GetPathFeedback &feedback)
+  {
+    action_server_get_path_ptr_->publishFeedback(feedback);
+  }
+
+  void AbstractNavigationServer::actionExePathFeedback(
+      const mbf_msgs::ExePathFeedback &feedback)
+  {
+    action_server_exe_path_ptr_->publishFeedback(feedback);
   }
 
   void AbstractNavigationServer::actionMoveBaseExePathFeedback(
-      const mbf_msgs::ExePathFeedbackConstPtr &feedback)
+      const mbf_msgs::ExePathFeedback &feedback)
   {
     mbf_msgs::MoveBaseFeedback feedback_out;
-    feedback_out.angle_to_goal = feedback->angle_to_goal;
-    feedback_out.dist_to_goal = feedback->dist_to_goal;
-    feedback_out.current_pose = feedback->current_pose;
-    feedback_out.current_twist = feedback->current_twist;
+    feedback_out.angle_to_goal = feedback.angle_to_goal;
+    feedback_out.dist_to_goal = feedback.dist_to_goal;
+    feedback_out.current_pose = feedback.current_pose;
+    feedback_out.current_twist = feedback.current_twist;
     action_server_move_base_ptr_->publishFeedback(feedback_out);
   }
 
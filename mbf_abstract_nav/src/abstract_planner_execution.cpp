@@ -38,50 +38,265 @@
  *
  */
 
+#include <algorithm>
+#include <XmlRpcException.h>
+#include <mbf_msgs/GetPathResult.h>
+
 #include "mbf_abstract_nav/abstract_planner_execution.h"
 
 namespace mbf_abstract_nav
 {
 
+//! shortest period between replanning cycles, so a run never busy-spins
+static const boost::chrono::microseconds MIN_REPLANNING_PERIOD(10000);
+
 
-  AbstractPlannerExecution::AbstractPlannerExecution(boost::condition_variable &condition) :
-      condition_(condition), state_(STOPPED), planning_(false),
-      has_new_start_(false), has_new_goal_(false), plugin_code_(255)
+  AbstractPlannerExecution::AbstractPlannerExecution(const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr) :
+      tf_listener_ptr_(tf_listener_ptr), cancel_(false),
+      has_new_goal_(false), has_new_start_(false), has_new_intermediate_plan_(false),
+      planning_(false), replanning_(false), generation_(0), stats_("planner"),
+      race_best_(false), racing_(false), plugin_loader_("planner_loader"), worker_("planner")
   {
-    loadParams();
+    staged_.state = STOPPED;
+    staged_.seq = 0;
+    staged_.plugin_code = 255;
+    snapshot_ = boost::make_shared<const Snapshot>(staged_);
+    params_valid_ = loadParams();
   }
 
 
   AbstractPlannerExecution::~AbstractPlannerExecution()
   {
+    terminate();
   }
 
 
-  void AbstractPlannerExecution::initialize()
+  void AbstractPlannerExecution::terminate()
   {
-    planner_ = loadPlannerPlugin(plugin_name_);
-    if (!planner_)
+    // outdate the running cycle, so it publishes nothing while finishing
+    {
+      boost::lock_guard<boost::mutex> guard(snapshot_mtx_);
+      startGeneration(STOPPED);
+    }
+    replanning_ = false;
+    planning_ = false;
+    cancel();
+    worker_.stop();
+    for (size_t i = 0; i < racers_.size(); ++i)
     {
-      exit(1);  // TODO: do not exit directly, so we can just show a WARN on reconfigure
+      racers_[i]->stop();
+    }
+    plugin_loader_.stop();
+  }
+
+
+  bool AbstractPlannerExecution::initialize()
+  {
+    if (!params_valid_)
+    {
+      return false;
     }
 
-    initPlugin();
+    std::map<std::string, std::string>::iterator iter = planner_types_.begin();
+    while (iter != planner_types_.end())
+    {
+      mbf_abstract_core::AbstractPlanner::Ptr planner_ptr = loadPlugin(iter->first, iter->second);
+      if (planner_ptr)
+      {
+        planners_[iter->first] = planner_ptr;
+        ++iter;
+      }
+      else
+      {
+        ROS_ERROR_STREAM("Could not load the planner plugin \"" << iter->first << "\" of type \""
+                         << iter->second << "\"");
+        planner_types_.erase(iter++);
+      }
+    }
+
+    if (planners_.find(default_plugin_name_) == planners_.end())
+    {
+      // on startup there is no previous plugin to fall back to
+      ROS_ERROR_STREAM("The default planner plugin \"" << default_plugin_name_ << "\" could not be loaded!");
+      return false;
+    }
+
+    boost::atomic_store(&planner_, planners_[default_plugin_name_]);
+    plugin_name_ = default_plugin_name_;
+    stats_.setPlugin(plugin_name_);
+
+    if (!race_name_.empty())
+    {
+      std::vector<std::string>::iterator race_iter = race_planners_.begin();
+      while (race_iter != race_planners_.end())
+      {
+        mbf_abstract_core::AbstractPlanner::Ptr racer_ptr;
+        if (planners_.find(*race_iter) != planners_.end())
+        {
+          std::string racer_name;
+          racer_ptr = loadPlannerInstance(*race_iter, racer_name);
+        }
+        if (!racer_ptr)
+        {
+          ROS_ERROR_STREAM("The planner \"" << *race_iter << "\" of the planner race is not loaded; ignoring it");
+          race_iter = race_planners_.erase(race_iter);
+        }
+        else
+        {
+          racer_ptr->setIntermediatePlanFn(boost::bind(&AbstractPlannerExecution::handleRacerIntermediatePlan, this,
+                                                       racer_planners_.size(), _1, _2));
+          racer_planners_.push_back(racer_ptr);
+          racers_.push_back(boost::make_shared<WorkerThread>("planner_racer_" + *race_iter));
+          racer_races_.push_back(boost::shared_ptr<Race>());
+          ++race_iter;
+        }
+      }
+      ROS_INFO_STREAM("Planner race \"" << race_name_ << "\" with " << race_planners_.size() << " planners");
+    }
     setState(INITIALIZED);
+    return true;
   }
 
 
-  void AbstractPlannerExecution::reconfigure(mbf_abstract_nav::MoveBaseFlexConfig &config)
+  mbf_abstract_core::AbstractPlanner::Ptr AbstractPlannerExecution::loadPlugin(const std::string &name,
+                                                                               const std::string &type)
+  {
+    boost::lock_guard<boost::mutex> guard(plugin_load_mtx_);
+    mbf_abstract_core::AbstractPlanner::Ptr planner_ptr = loadPlannerPlugin(type);
+    if (!planner_ptr || !initPlugin(name, planner_ptr))
+    {
+      return mbf_abstract_core::AbstractPlanner::Ptr();
+    }
+    planner_ptr->setIntermediatePlanFn(boost::bind(&AbstractPlannerExecution::handleIntermediatePlan, this, _1, _2));
+    return planner_ptr;
+  }
+
+
+  std::string AbstractPlannerExecution::findPlugin(const std::string &name_or_type)
+  {
+    if (planner_types_.find(name_or_type) != planner_types_.end())
+    {
+      return name_or_type;
+    }
+    std::map<std::string, std::string>::iterator iter = planner_types_.begin();
+    for (; iter != planner_types_.end(); ++iter)
+    {
+      if (iter->second == name_or_type)
+        return iter->first;
+    }
+    return std::string();
+  }
+
+
+  bool AbstractPlannerExecution::selectPlugin(const std::string &name)
   {
     boost::recursive_mutex::scoped_lock sl(configuration_mutex_);
+    racing_ = !race_name_.empty() && name == race_name_ && !race_planners_.empty();
+    if (racing_)
+    {
+      return true;
+    }
 
-    if (config.global_planner != plugin_name_)
+    std::string selected = findPlugin(name.empty() ? default_plugin_name_ : name);
+    if (selected.empty())
     {
-      plugin_name_ = config.global_planner;
-      initialize();
+      return false;
+    }
+    if (selected != plugin_name_)
+    {
+      boost::atomic_store(&planner_, planners_[selected]);
+      plugin_name_ = selected;
+      stats_.setPlugin(plugin_name_);
+      ROS_INFO_STREAM("Planning with the planner plugin \"" << plugin_name_ << "\"");
+    }
+    return true;
+  }
+
+
+  std::vector<std::string> AbstractPlannerExecution::listPlugins()
+  {
+    boost::recursive_mutex::scoped_lock sl(configuration_mutex_);
+    std::vector<std::string> names;
+    std::map<std::string, std::string>::iterator iter = planner_types_.begin();
+    for (; iter != planner_types_.end(); ++iter)
+    {
+      names.push_back(iter->first);
+    }
+    return names;
+  }
+
+
+  void AbstractPlannerExecution::loadRequestedPlugin()
+  {
+    std::string requested;
+    {
+      boost::lock_guard<boost::mutex> guard(plugin_request_mtx_);
+      requested = requested_plugin_name_;
+    }
+
+    while (true)
+    {
+      // a preloaded plugin, given by name or by type, is used right away; otherwise we load the given type
+      std::string name;
+      {
+        boost::recursive_mutex::scoped_lock sl(configuration_mutex_);
+        name = findPlugin(requested);
+      }
+      mbf_abstract_core::AbstractPlanner::Ptr planner_ptr;
+      if (name.empty())
+      {
+        name = requested.substr(requested.find_last_of("/:") + 1);
+        planner_ptr = loadPlugin(name, requested);
+      }
+
+      // the running cycle keeps the plugin it has copied; the next one plans with the new plugin
+      boost::recursive_mutex::scoped_lock sl(configuration_mutex_);
+      boost::lock_guard<boost::mutex> guard(plugin_request_mtx_);
+      if (requested_plugin_name_ != requested)
+      {
+        // another plugin has been requested meanwhile; use that one instead
+        requested = requested_plugin_name_;
+        continue;
+      }
+      if (planner_ptr)
+      {
+        planners_[name] = planner_ptr;
+        planner_types_[name] = requested;
+      }
+      else if (planners_.find(name) == planners_.end())
+      {
+        ROS_ERROR_STREAM("Could not load the planner plugin \"" << requested << "\"; keep using \""
+                         << default_plugin_name_ << "\" by default");
+        return;
+      }
+
+      default_plugin_name_ = name;
+      boost::atomic_store(&planner_, planners_[name]);
+      plugin_name_ = name;
+      stats_.setPlugin(plugin_name_);
+      ROS_INFO_STREAM("Switched to the planner plugin \"" << plugin_name_ << "\"");
+      return;
+    }
+  }
+
+
+  void AbstractPlannerExecution::reconfigure(mbf_abstract_nav::MoveBaseFlexConfig &config)
+  {
+    {
+      // switch to a preloaded plugin or load a new one in the background; the current one keeps planning meanwhile
+      boost::lock_guard<boost::mutex> guard(plugin_request_mtx_);
+      if (config.global_planner != requested_plugin_name_)
+      {
+        requested_plugin_name_ = config.global_planner;
+        plugin_loader_.post(boost::bind(&AbstractPlannerExecution::loadRequestedPlugin, this));
+      }
     }
 
+    boost::recursive_mutex::scoped_lock sl(configuration_mutex_);
+
     max_retries_ = config.planner_max_retries;
     patience_ = ros::Duration(config.planner_patience);
+    setPatience(patience_);
 
     // replanning chrono setup
     if (config.planner_frequency > 0.0)
@@ -90,68 +305,281 @@ namespace mbf_abstract_nav
     }
     else
     {
-      calling_duration_.zero();
+      // an ongoing replanning run keeps its last period until it is stopped; see run()
+      ROS_WARN_STREAM_COND(replanning_ && planning_, "Planner frequency set to 0 while replanning; "
+                           "keep replanning at the previous rate until the current goal is finished");
+      calling_duration_ = boost::chrono::microseconds(0);
     }
+    stats_.setTargetPeriod(calling_duration_);
   }
 
 
-  void AbstractPlannerExecution::loadParams()
+  bool AbstractPlannerExecution::loadParams()
   {
     double patience, frequency;
+    int cpu;
 
     ros::NodeHandle private_nh_("~");
 
-    if(!private_nh_.getParam("global_planner", plugin_name_))
+    // named planner plugins, all loaded on initialization so each goal can select one; the first is the default
+    XmlRpc::XmlRpcValue planners_param;
+    if (private_nh_.getParam("global_planners", planners_param))
     {
-      ROS_ERROR_STREAM("Parameter \"global_planner\" is not set!");
-      exit(0);
+      try
+      {
+        for (int i = 0; i < planners_param.size(); ++i)
+        {
+          std::string name = planners_param[i]["name"];
+          std::string type = planners_param[i]["type"];
+          if (!planner_types_.insert(std::make_pair(name, type)).second)
+          {
+            ROS_ERROR_STREAM("The planner plugin name \"" << name << "\" is used twice! Names must be unique!");
+            return false;
+          }
+          if (i == 0)
+            default_plugin_name_ = name;
+        }
+      }
+      catch (XmlRpc::XmlRpcException &e)
+      {
+        ROS_ERROR_STREAM("Invalid parameter structure. The global_planners parameter has to be a list of structs "
+                         << "with fields \"name\" and \"type\" of the planner plugin! " << e.getMessage());
+        return false;
+      }
+    }
+    std::string planner_type;
+    if (private_nh_.getParam("global_planner", planner_type))
+    {
+      requested_plugin_name_ = planner_type;
+      if (planner_types_.empty())
+      {
+        // single plugin, named after its class as the class loader does
+        default_plugin_name_ = planner_type.substr(planner_type.find_last_of("/:") + 1);
+        planner_types_[default_plugin_name_] = planner_type;
+      }
+      else
+      {
+        // also select the default plugin by name or type, as done on reconfigure
+        default_plugin_name_ = findPlugin(planner_type);
+        if (default_plugin_name_.empty())
+        {
+          ROS_ERROR_STREAM("The global_planner \"" << planner_type << "\" is not in the global_planners list!");
+          return false;
+        }
+      }
+    }
+    else if (!planner_types_.empty())
+    {
+      // let dynamic reconfigure start with the default plugin
+      requested_plugin_name_ = default_plugin_name_;
+      private_nh_.setParam("global_planner", default_plugin_name_);
+    }
+    else
+    {
+      ROS_ERROR_STREAM("Neither parameter \"global_planners\" nor \"global_planner\" is set!");
+      return false;
     }
     private_nh_.param("robot_frame", robot_frame_, std::string("base_footprint"));
     private_nh_.param("map_frame", global_frame_, std::string("map"));
     private_nh_.param("planner_max_retries", max_retries_, 10);
     private_nh_.param("planner_patience", patience, 5.0);
     private_nh_.param("planner_frequency", frequency, 0.0);
+    private_nh_.param("planner_cpu_affinity", cpu, -1);
+
+    // planners to run concurrently, when a goal selects the race by its name
+    std::string race_mode;
+    double race_deadline;
+    private_nh_.param("planner_race_name", race_name_, std::string(""));
+    private_nh_.param("planner_race_planners", race_planners_, std::vector<std::string>());
+    private_nh_.param("planner_race_mode", race_mode, std::string("first"));
+    private_nh_.param("planner_race_deadline", race_deadline, 0.0);
+    if (race_mode != "first" && race_mode != "best")
+    {
+      ROS_WARN_STREAM("Unknown planner race mode \"" << race_mode << "\"; use \"first\" or \"best\". Using \"first\"");
+    }
+    race_best_ = race_mode == "best";
+    race_deadline_ = boost::chrono::microseconds((int64_t)(std::max(race_deadline, 0.0) * 1e6));
+    worker_.setAffinity(cpu);
 
     // Timeout granted to the global planner. We keep calling it up to this time or up to max_retries times
     // If it doesn't return within time, the navigator will cancel it and abort the corresponding action
     patience_ = ros::Duration(patience);
+    setPatience(patience_);
 
     // replanning chrono setup
     if (frequency > 0.0)
     {
       calling_duration_ = boost::chrono::microseconds((int)(1e6 / frequency));
     }
+    else
+    {
+      calling_duration_ = boost::chrono::microseconds(0);
+    }
+    stats_.setTargetPeriod(calling_duration_);
+    return true;
   }
 
 
 
   void AbstractPlannerExecution::setPluginInfo(const uint32_t &plugin_code, const std::string &plugin_msg)
 {
-  boost::lock_guard<boost::mutex> guard(pcode_mtx_);
-  plugin_code_ =  plugin_code;
-  plugin_msg_ = plugin_msg;
+  boost::lock_guard<boost::mutex> guard(snapshot_mtx_);
+  staged_.plugin_code = plugin_code;
+  staged_.plugin_msg = plugin_msg;
 }
 
 
+  bool AbstractPlannerExecution::setRunPluginInfo(unsigned int generation, const uint32_t &plugin_code,
+                                                  const std::string &plugin_msg)
+  {
+    boost::lock_guard<boost::mutex> guard(snapshot_mtx_);
+    if (generation != generation_)
+    {
+      return false;  // outdated run; the outcome belongs to a plan nobody waits for anymore
+    }
+    staged_.plugin_code = plugin_code;
+    staged_.plugin_msg = plugin_msg;
+    return true;
+  }
+
+
   void AbstractPlannerExecution::getPluginInfo(uint32_t &plugin_code, std::string &plugin_msg)
 {
-  boost::lock_guard<boost::mutex> guard(pcode_mtx_);
-  plugin_code = plugin_code_;
-  plugin_msg = plugin_msg_;
+  SnapshotConstPtr snapshot = boost::atomic_load(&snapshot_);
+  plugin_code = snapshot->plugin_code;
+  plugin_msg = snapshot->plugin_msg;
 }
 
 
   void AbstractPlannerExecution::setState(PlanningState state)
   {
-    boost::lock_guard<boost::mutex> guard(state_mtx_);
-    state_ = state;
+    boost::lock_guard<boost::mutex> guard(snapshot_mtx_);
+    staged_.state = state;
+    publishSnapshot();
+  }
+
+
+  bool AbstractPlannerExecution::setRunState(unsigned int generation, PlanningState state)
+  {
+    boost::lock_guard<boost::mutex> guard(snapshot_mtx_);
+    if (generation != generation_)
+    {
+      return false;  // outdated run, still finishing after stopReplanning() or a new start
+    }
+    staged_.state = state;
+    publishSnapshot();
+    return true;
+  }
+
+
+  void AbstractPlannerExecution::finishRun(unsigned int generation, PlanningState state)
+  {
+    boost::lock_guard<boost::mutex> guard(snapshot_mtx_);
+    if (generation != generation_)
+    {
+      return;  // outdated run; planning_ already belongs to the current one
+    }
+    // cleared before publishing the final state, so the caller can start a new run as soon as it sees it
+    planning_ = false;
+    // the finished run is outdated from now on; otherwise a new run setting planning_ before starting its own
+    // generation would keep it looping, and its end would clear planning_ for the new run
+    ++generation_;
+    staged_.state = state;
+    publishSnapshot();
+  }
+
+
+  unsigned int AbstractPlannerExecution::startGeneration(PlanningState state)
+  {
+    staged_.state = state;
+    publishSnapshot();
+    return ++generation_;
+  }
+
+
+  bool AbstractPlannerExecution::isCurrentRun(unsigned int generation)
+  {
+    return generation == generation_;
+  }
+
+
+  void AbstractPlannerExecution::publishSnapshot()
+  {
+    // only the writers, serialized by the snapshot mutex, replace the snapshot, so a plain read is enough here
+    if (staged_.state == snapshot_->state)
+    {
+      return;  // e.g. another planning cycle; the plugin outcome is published with the next state change
+    }
+    ++staged_.seq;
+    storeSnapshot();
+    notifyStateUpdate();
+  }
+
+
+  void AbstractPlannerExecution::storeSnapshot()
+  {
+    boost::atomic_store(&snapshot_, boost::make_shared<const Snapshot>(staged_));
+  }
+
+
+  bool AbstractPlannerExecution::Snapshot::isPatienceExceeded() const
+  {
+    return patience > ros::Duration(0) && ros::Time::now() - last_cycle_start_time > patience;
+  }
+
+
+  typename AbstractPlannerExecution::SnapshotConstPtr AbstractPlannerExecution::getSnapshot()
+  {
+    return boost::atomic_load(&snapshot_);
   }
 
 
   typename AbstractPlannerExecution::PlanningState AbstractPlannerExecution::getState()
   {
-    boost::lock_guard<boost::mutex> guard(state_mtx_);
-    return state_;
+    return getSnapshot()->state;
+  }
+
+
+  ExecutionStats &AbstractPlannerExecution::getStats()
+  {
+    return stats_;
+  }
+
+  bool AbstractPlannerExecution::getNewIntermediatePlan(PlanConstPtr &plan, double &cost)
+  {
+    boost::lock_guard<boost::mutex> guard(plan_mtx_);
+    if (!has_new_intermediate_plan_)
+      return false;
+
+    has_new_intermediate_plan_ = false;
+    plan = intermediate_plan_;
+    cost = intermediate_cost_;
+    return true;
+  }
+
+
+  void AbstractPlannerExecution::handleIntermediatePlan(const Plan &plan, double cost)
+  {
+    {
+      boost::lock_guard<boost::mutex> guard(plan_mtx_);
+      if (plan.empty() || (intermediate_plan_ && cost >= intermediate_cost_))
+        return;
+
+      intermediate_plan_ = boost::make_shared<const Plan>(plan);
+      intermediate_cost_ = cost;
+      has_new_intermediate_plan_ = true;
+    }
+
+    // the state doesn't change, but waiters must wake up to pick the new plan
+    notifyStateUpdate();
+  }
+
+
+  void AbstractPlannerExecution::resetIntermediatePlan()
+  {
+    boost::lock_guard<boost::mutex> guard(plan_mtx_);
+    intermediate_plan_.reset();
+    has_new_intermediate_plan_ = false;
   }
 
 
@@ -164,40 +592,54 @@ namespace mbf_abstract_nav
 
   ros::Time AbstractPlannerExecution::getLastCycleStartTime()
   {
-    boost::lock_guard<boost::mutex> guard(lct_mtx_);
-    return last_cycle_start_time_;
+    return getSnapshot()->last_cycle_start_time;
   }
 
 
   void AbstractPlannerExecution::setLastCycleStartTime()
   {
-    boost::lock_guard<boost::mutex> guard(lct_mtx_);
-    last_cycle_start_time_ = ros::Time::now();
+    boost::lock_guard<boost::mutex> guard(snapshot_mtx_);
+    staged_.last_cycle_start_time = ros::Time::now();
+    storeSnapshot();
+  }
+
+
+  void AbstractPlannerExecution::setPatience(const ros::Duration &patience)
+  {
+    boost::lock_guard<boost::mutex> guard(snapshot_mtx_);
+    staged_.patience = patience;
+    storeSnapshot();
   }
 
 
   bool AbstractPlannerExecution::isPatienceExceeded()
   {
-    boost::lock_guard<boost::mutex> guard(lct_mtx_);
-    return (patience_ > ros::Duration(0)) && (ros::Time::now() - last_cycle_start_time_ > patience_);
+    return getSnapshot()->isPatienceExceeded();
   }
 
 
-  void AbstractPlannerExecution::getNewPlan(std::vector<geometry_msgs::PoseStamped> &plan, double &cost)
+  void AbstractPlannerExecution::getNewPlan(PlanConstPtr &plan, double &cost)
   {
     boost::lock_guard<boost::mutex> guard(plan_mtx_);
-    // copy plan and costs to output
+    // share plan and copy costs to output
     plan = plan_;
     cost = cost_;
   }
 
 
-  void AbstractPlannerExecution::setNewPlan(const std::vector<geometry_msgs::PoseStamped> &plan, double cost)
+  bool AbstractPlannerExecution::setNewPlan(unsigned int generation, const PlanConstPtr &plan, double cost)
   {
+    // the snapshot mutex serializes the generation check with startGeneration(); always taken before the plan mutex
+    boost::lock_guard<boost::mutex> snapshot_guard(snapshot_mtx_);
+    if (generation != generation_)
+    {
+      return false;  // outdated run; don't overwrite the plan of the current one
+    }
     boost::lock_guard<boost::mutex> guard(plan_mtx_);
     plan_ = plan;
     cost_ = cost;
     last_valid_plan_time_ = ros::Time::now();
+    return true;
   }
 
 
@@ -235,15 +677,20 @@ namespace mbf_abstract_nav
                                                const geometry_msgs::PoseStamped &goal,
                                                double tolerance)
   {
-    if (planning_)
+    bool idle = false;
+    if (!planning_.compare_exchange_strong(idle, true))
     {
       return false;
     }
-    planning_ = true;
+    replanning_ = false;
     cancel_ = false;
-    start_ = start;
-    goal_ = goal;
-    tolerance_ = tolerance;
+    {
+      // a run outdated by stopReplanning() may still be finishing; it holds its own copies of these
+      boost::lock_guard<boost::mutex> guard(goal_start_mtx_);
+      start_ = start;
+      goal_ = goal;
+      tolerance_ = tolerance;
+    }
 
     geometry_msgs::Point s = start.pose.position;
     geometry_msgs::Point g = goal.pose.position;
@@ -251,17 +698,82 @@ namespace mbf_abstract_nav
     ROS_INFO_STREAM("Start planning from the start pose: (" << s.x << ", " << s.y << ", " << s.z << ")"
                                    << " to the goal pose: ("<< g.x << ", " << g.y << ", " << g.z << ")");
 
-    setState(STARTED);
-    thread_ = boost::thread(&AbstractPlannerExecution::run, this);
+    unsigned int generation;
+    {
+      boost::lock_guard<boost::mutex> guard(snapshot_mtx_);
+      generation = startGeneration(STARTED);
+    }
+    if (!worker_.post(boost::bind(&AbstractPlannerExecution::run, this, generation)))
+    {
+      planning_ = false;
+      return false; // the previous run is still finishing and another one is already waiting
+    }
+    return true;
+  }
+
+
+  bool AbstractPlannerExecution::startReplanning(const geometry_msgs::PoseStamped &goal, double tolerance,
+                                                 const StartPoseFn &get_start, const NewPlanFn &new_plan_cb)
+  {
+    bool idle = false;
+    if (!planning_.compare_exchange_strong(idle, true))
+    {
+      return false;
+    }
+    replanning_ = true;
+    cancel_ = false;
+    {
+      // a run outdated by stopReplanning() may still be finishing; it holds its own copies of these
+      boost::lock_guard<boost::mutex> guard(goal_start_mtx_);
+      goal_ = goal;
+      tolerance_ = tolerance;
+      get_start_ = get_start;
+      new_plan_cb_ = new_plan_cb;
+    }
+
+    geometry_msgs::Point g = goal.pose.position;
+    ROS_INFO_STREAM("Start replanning continuously to the goal pose: (" << g.x << ", " << g.y << ", " << g.z << ")");
+
+    unsigned int generation;
+    {
+      boost::lock_guard<boost::mutex> guard(snapshot_mtx_);
+      generation = startGeneration(STARTED);
+    }
+    if (!worker_.post(boost::bind(&AbstractPlannerExecution::run, this, generation)))
+    {
+      planning_ = false;
+      return false; // the previous run is still finishing and another one is already waiting
+    }
     return true;
   }
 
 
+  void AbstractPlannerExecution::stopReplanning()
+  {
+    if (!replanning_)
+    {
+      return;
+    }
+
+    // outdate the running cycle, so nothing it still produces reaches the caller, and let it finish on its own
+    {
+      boost::lock_guard<boost::mutex> guard(snapshot_mtx_);
+      startGeneration(STOPPED);
+    }
+    cancel();
+    // wake up the thread if it's sleeping between cycles or the planner provides interruption points
+    worker_.interrupt();
+    replanning_ = false;
+    planning_ = false;
+    ROS_INFO_STREAM("Continuous replanning stopped");
+  }
+
+
   void AbstractPlannerExecution::stopPlanning()
   {
     // only useful if there are any interruption points in the global planner
     ROS_WARN_STREAM("Try to stop the planning rigorously by interrupting the thread!");
-    thread_.interrupt();
+    worker_.interrupt();
   }
 
 
@@ -269,11 +781,80 @@ namespace mbf_abstract_nav
   {
     cancel_ = true;  // force cancel immediately, as the call to cancel in the planner can take a while
 
+    boost::shared_ptr<Race> race = boost::atomic_load(&race_);
+    if (race)
+    {
+      bool canceled = true;
+      boost::lock_guard<boost::mutex> guard(race->mutex);
+      for (size_t i = 0; i < race->planners.size(); ++i)
+      {
+        if (!race->finished[i])
+          canceled = race->planners[i]->cancel() && canceled;
+      }
+      race->cond.notify_all();  // stop waiting for the racers
+      return canceled;
+    }
+
     // returns false if cancel is not implemented or rejected by the planner (will run until completion)
-    return planner_->cancel();
+    mbf_abstract_core::AbstractPlanner::Ptr planner_ptr = boost::atomic_load(&planner_);
+    return planner_ptr && planner_ptr->cancel();
+  }
+
+  mbf_abstract_core::AbstractPlanner::Ptr AbstractPlannerExecution::loadPlannerInstance(
+      const std::string &name_or_type, std::string &name)
+  {
+    std::string type;
+    {
+      // as on reconfigure, a plugin type not given on the parameters is loaded named after itself
+      boost::recursive_mutex::scoped_lock sl(configuration_mutex_);
+      name = findPlugin(name_or_type.empty() ? default_plugin_name_ : name_or_type);
+      if (name.empty())
+        name = name_or_type;
+      type = planner_types_.find(name) != planner_types_.end() ? planner_types_[name] : name;
+    }
+
+    boost::lock_guard<boost::mutex> guard(plugin_load_mtx_);
+    mbf_abstract_core::AbstractPlanner::Ptr planner_ptr = loadPlannerPlugin(type);
+    if (!planner_ptr || !initPlannerInstance(name, planner_ptr))
+    {
+      ROS_ERROR_STREAM("Could not load an instance of the planner plugin \"" << name << "\"");
+      return mbf_abstract_core::AbstractPlanner::Ptr();
+    }
+    return planner_ptr;
+  }
+
+  bool AbstractPlannerExecution::initPlannerInstance(const std::string &name,
+                                                     const mbf_abstract_core::AbstractPlanner::Ptr &planner_ptr)
+  {
+    return initPlugin(name, planner_ptr);
+  }
+
+  uint32_t AbstractPlannerExecution::planWithInstance(const mbf_abstract_core::AbstractPlanner::Ptr &planner_ptr,
+                                                      const std::string &planner_name,
+                                                      const geometry_msgs::PoseStamped &start,
+                                                      const geometry_msgs::PoseStamped &goal,
+                                                      double tolerance,
+                                                      std::vector<geometry_msgs::PoseStamped> &plan,
+                                                      double &cost,
+                                                      std::string &message)
+  {
+    return makeInstancePlan(planner_ptr, planner_name, start, goal, tolerance, plan, cost, message);
+  }
+
+  uint32_t AbstractPlannerExecution::makeInstancePlan(const mbf_abstract_core::AbstractPlanner::Ptr& planner_ptr,
+                                                      const std::string &planner_name,
+                                                      const geometry_msgs::PoseStamped start,
+                                                      const geometry_msgs::PoseStamped goal,
+                                                      double tolerance,
+                                                      std::vector<geometry_msgs::PoseStamped> &plan,
+                                                      double &cost,
+                                                      std::string &message)
+  {
+    return makePlan(planner_ptr, planner_name, start, goal, tolerance, plan, cost, message);
   }
 
   uint32_t AbstractPlannerExecution::makePlan(const mbf_abstract_core::AbstractPlanner::Ptr& planner_ptr,
+                                          const std::string &planner_name,
                                           const geometry_msgs::PoseStamped start,
                                           const geometry_msgs::PoseStamped goal,
                                           double tolerance,
@@ -284,30 +865,237 @@ namespace mbf_abstract_nav
     return planner_ptr->makePlan(start, goal, tolerance, plan, cost, message);
   }
 
-  void AbstractPlannerExecution::run()
+  uint32_t AbstractPlannerExecution::racePlans(const geometry_msgs::PoseStamped &start,
+                                               const geometry_msgs::PoseStamped &goal,
+                                               double tolerance,
+                                               std::vector<geometry_msgs::PoseStamped> &plan,
+                                               double &cost,
+                                               std::string &message)
+  {
+    boost::shared_ptr<Race> race = boost::make_shared<Race>();
+    race->num_finished = 0;
+    race->winner = -1;
+    race->outcome = mbf_msgs::GetPathResult::NO_PATH_FOUND;
+    race->cost = 0.0;
+
+    boost::unique_lock<boost::mutex> lock(race->mutex);
+    boost::atomic_store(&race_, race);
+    for (size_t i = 0; i < racers_.size(); ++i)
+    {
+      // losers of a previous race keep running until their planner returns; they sit this race out
+      if (racers_[i]->isBusy())
+      {
+        ROS_DEBUG_STREAM("The planner \"" << race_planners_[i] << "\" is still running a previous race; skipping it");
+        continue;
+      }
+      race->names.push_back(race_planners_[i]);
+      race->planners.push_back(racer_planners_[i]);
+      race->finished.push_back(false);
+      if (!racers_[i]->post(boost::bind(&AbstractPlannerExecution::runRacer, this, race, race->planners.size() - 1, i,
+                                        start, goal, tolerance)))
+      {
+        race->names.pop_back();
+        race->planners.pop_back();
+        race->finished.pop_back();
+      }
+    }
+    if (race->planners.empty())
+    {
+      boost::atomic_store(&race_, boost::shared_ptr<Race>());
+      message = "All the planners of the race are still running a previous one";
+      ROS_WARN_STREAM(message);
+      return mbf_msgs::GetPathResult::INTERNAL_ERROR;
+    }
+
+    boost::chrono::steady_clock::time_point deadline;
+    try
+    {
+      while (race->num_finished < race->planners.size() && !cancel_)
+      {
+        if (race->winner < 0)
+        {
+          race->cond.wait(lock);  // interruption point
+        }
+        else if (!race_best_)
+        {
+          break;
+        }
+        else if (race_deadline_ == boost::chrono::microseconds(0))
+        {
+          race->cond.wait(lock);
+        }
+        else
+        {
+          // the deadline starts with the first plan found
+          if (deadline == boost::chrono::steady_clock::time_point())
+            deadline = boost::chrono::steady_clock::now() + race_deadline_;
+          if (race->cond.wait_until(lock, deadline) == boost::cv_status::timeout)
+            break;
+        }
+      }
+    }
+    catch (const boost::thread_interrupted &ex)
+    {
+      endRace(race);
+      throw;
+    }
+    endRace(race);
+
+    if (race->winner >= 0)
+    {
+      plan = race->plan;
+      cost = race->cost;
+      ROS_DEBUG_STREAM("The planner \"" << race->names[race->winner] << "\" won the race with cost " << cost
+                       << "; " << race->num_finished << " of " << race->planners.size() << " planners finished");
+    }
+    message = race->message;
+    return race->outcome;
+  }
+
+
+  void AbstractPlannerExecution::endRace(const boost::shared_ptr<Race> &race)
+  {
+    boost::atomic_store(&race_, boost::shared_ptr<Race>());
+    for (size_t i = 0; i < race->planners.size(); ++i)
+    {
+      if (!race->finished[i])
+        race->planners[i]->cancel();
+    }
+  }
+
+
+  void AbstractPlannerExecution::runRacer(const boost::shared_ptr<Race> &race, size_t index, size_t racer,
+                                          const geometry_msgs::PoseStamped &start,
+                                          const geometry_msgs::PoseStamped &goal, double tolerance)
+  {
+    boost::atomic_store(&racer_races_[racer], race);
+    Plan plan;
+    double cost = 0.0;
+    std::string message = "The race ended before the planner started";
+    uint32_t outcome = mbf_msgs::GetPathResult::CANCELED;
+    // the race can end before this racer starts, missing the cancel call; planning then would only keep it busy
+    if (boost::atomic_load(&race_) == race)
+    {
+      try
+      {
+        // the racer planners never change after initialization, unlike the race vectors, filled as racers start
+        outcome = planWithInstance(racer_planners_[racer], race_planners_[racer], start, goal, tolerance, plan,
+                                   cost, message);
+      }
+      catch (const boost::thread_interrupted &ex)
+      {
+        outcome = mbf_msgs::GetPathResult::STOPPED;
+        message = "The planner thread has been interrupted";
+      }
+      catch (const std::exception &ex)
+      {
+        outcome = mbf_msgs::GetPathResult::INTERNAL_ERROR;
+        message = std::string("The planner failed: ") + ex.what();
+      }
+    }
+    boost::atomic_store(&racer_races_[racer], boost::shared_ptr<Race>());
+
+    boost::lock_guard<boost::mutex> guard(race->mutex);
+    race->finished[index] = true;
+    ++race->num_finished;
+    bool success = outcome < 10;  // success outcomes, see GetPath.action
+    if (success && (race->winner < 0 || cost < race->cost))
+    {
+      race->winner = index;
+      race->plan.swap(plan);
+      race->cost = cost;
+      race->outcome = outcome;
+      race->message = message;
+    }
+    else if (!success && race->winner < 0)
+    {
+      race->outcome = outcome;
+      race->message = race->names[index] + ": " + message;
+    }
+    race->cond.notify_all();
+  }
+
+
+  void AbstractPlannerExecution::handleRacerIntermediatePlan(size_t racer, const Plan &plan, double cost)
+  {
+    boost::shared_ptr<Race> race = boost::atomic_load(&race_);
+    if (race && race == boost::atomic_load(&racer_races_[racer]))
+      handleIntermediatePlan(plan, cost);
+  }
+
+
+  void AbstractPlannerExecution::run(unsigned int generation)
   {
     int retries = 0;
+    const bool replanning = replanning_;
+
+    goal_start_mtx_.lock();
     geometry_msgs::PoseStamped current_start = start_;
     geometry_msgs::PoseStamped current_goal = goal_;
     double current_tolerance = tolerance_;
+    const StartPoseFn get_start = get_start_;
+    const NewPlanFn new_plan_cb = new_plan_cb_;
+    goal_start_mtx_.unlock();
 
     bool success = false;
     bool make_plan = false;
     bool exceeded = false;
 
-    last_valid_plan_time_ = ros::Time::now();
+    {
+      boost::lock_guard<boost::mutex> guard(plan_mtx_);
+      last_valid_plan_time_ = ros::Time::now();
+    }
+
+    // period kept while replanning, if the planner frequency is reconfigured to 0 before the run is stopped
+    boost::chrono::microseconds replanning_period;
+    {
+      boost::recursive_mutex::scoped_lock sl(configuration_mutex_);
+      replanning_period = std::max(calling_duration_, MIN_REPLANNING_PERIOD);
+    }
+
+    stats_.startRun();
 
     try
     {
-      while (planning_ && ros::ok())
+      if (replanning)
       {
-        boost::recursive_mutex::scoped_lock sl(configuration_mutex_);
+        // the caller already holds a plan from the current pose; wait one period before replanning
+        boost::this_thread::sleep_for(replanning_period);
+      }
 
-        boost::chrono::thread_clock::time_point start_time = boost::chrono::thread_clock::now();
+      while (isCurrentRun(generation) && planning_ && ros::ok())
+      {
+        stats_.startCycle();
+
+        // copy the configuration, so reconfiguring or swapping plugins doesn't wait for the planner to return
+        mbf_abstract_core::AbstractPlanner::Ptr planner_ptr;
+        std::string planner_name;
+        bool racing;
+        int max_retries;
+        ros::Duration patience;
+        boost::chrono::microseconds calling_duration;
+        {
+          boost::recursive_mutex::scoped_lock sl(configuration_mutex_);
+          planner_ptr = planner_;
+          planner_name = plugin_name_;
+          racing = racing_;
+          max_retries = max_retries_;
+          patience = patience_;
+          calling_duration = calling_duration_;
+        }
+        if (replanning)
+        {
+          // never busy-spin a replanning run; a zero period only makes sense for a single planning run
+          if (calling_duration > boost::chrono::microseconds(0))
+            replanning_period = std::max(calling_duration, MIN_REPLANNING_PERIOD);
+          calling_duration = replanning_period;
+        }
+
+        boost::chrono::steady_clock::time_point start_time = boost::chrono::steady_clock::now();
 
         setLastCycleStartTime();
-        // call the planner
-        std::vector<geometry_msgs::PoseStamped> plan;
+        // call the planner; the plan is filled in place and then shared as it is
+        boost::shared_ptr<Plan> plan(new Plan());
         double cost;
 
         // lock goal start mutex
@@ -337,42 +1125,81 @@ namespace mbf_abstract_nav
 
         // unlock goal
         goal_start_mtx_.unlock();
-        setState(PLANNING);
+
+        if (replanning)
+        {
+          // always plan from the latest start pose, i.e. the current robot pose
+          make_plan = get_start(current_start);
+          if (!make_plan)
+          {
+            ROS_WARN_THROTTLE(1.0, "Could not get the start pose for replanning; skipping this cycle");
+          }
+        }
+        setRunState(generation, PLANNING);
         if (make_plan)
         {
-          ROS_INFO_STREAM("Start planning");
+          ROS_INFO_STREAM_COND(!replanning, "Start planning");
 
           std::string message;
 
-          uint32_t outcome = makePlan(planner_, current_start, current_goal, current_tolerance, plan, cost, message);
+          resetIntermediatePlan();
+          uint32_t outcome =
+              racing ? racePlans(current_start, current_goal, current_tolerance, *plan, cost, message)
+                     : makePlan(planner_ptr, planner_name, current_start, current_goal, current_tolerance, *plan,
+                                cost, message);
 
           success = outcome < 10;
-          setPluginInfo(outcome, message);
+          if (!success && isPatienceExceeded())
+          {
+            // an anytime planner cut short by the patience still provides the best plan it found so far
+            boost::lock_guard<boost::mutex> guard(plan_mtx_);
+            if (intermediate_plan_)
+            {
+              *plan = *intermediate_plan_;
+              cost = intermediate_cost_;
+              outcome = 0;
+              message = "Planning patience exceeded; using the best intermediate plan";
+              success = true;
+              ROS_INFO_STREAM(message << " (cost = " << cost << ")");
+            }
+          }
+          if (!setRunPluginInfo(generation, outcome, message))
+          {
+            ROS_DEBUG_STREAM("Discarding the outcome of an outdated planning run");
+            stats_.endCycle();
+            break;
+          }
 
           if (cancel_ && !isPatienceExceeded())
           {
-            setState(CANCELED);
             ROS_INFO_STREAM("The global planner has been canceled!"); // but not due to patience exceeded
-            planning_ = false;
-            condition_.notify_all();
+            finishRun(generation, CANCELED);
+          }
+          else if (success && replanning)
+          {
+            ROS_DEBUG_STREAM("Successfully found a new plan while replanning.");
+            retries = 0;
+
+            if (setNewPlan(generation, plan, cost) && setRunState(generation, FOUND_PLAN))
+            {
+              new_plan_cb(plan, cost);
+            }
           }
           else if (success)
           {
             ROS_INFO_STREAM("Successfully found a plan.");
             exceeded = false;
-            planning_ = false;
 
-            setNewPlan(plan, cost);
-            setState(FOUND_PLAN);
-            condition_.notify_all(); // notify observer
+            if (setNewPlan(generation, plan, cost))
+            {
+              finishRun(generation, FOUND_PLAN);
+            }
           }
-          else if (max_retries_ > 0 && ++retries > max_retries_)
+          else if (max_retries > 0 && ++retries > max_retries)
           {
             ROS_INFO_STREAM("Planning reached max retries!");
-            setState(MAX_RETRIES);
             exceeded = true;
-            planning_ = false;
-            condition_.notify_all(); // notify observer
+            finishRun(generation, MAX_RETRIES);
           }
           else if (isPatienceExceeded())
           {
@@ -381,18 +1208,14 @@ namespace mbf_abstract_nav
             // fact and cleanup the mess either after a succesfull canceling or after planner finally gived up
             ROS_INFO_STREAM("Planning patience has been exceeded" << (cancel_ ? "; planner canceled!"
                                                                               : " but we failed to cancel it!"));
-            setState(PAT_EXCEEDED);
             exceeded = true;
-            planning_ = false;
-            condition_.notify_all(); // notify observer
+            finishRun(generation, PAT_EXCEEDED);
           }
-          else if (max_retries_ == 0 && patience_ == ros::Duration(0))
+          else if (max_retries == 0 && patience == ros::Duration(0))
           {
             ROS_INFO_STREAM("Planning could not find a plan!");
             exceeded = true;
-            setState(NO_PLAN_FOUND);
-            condition_.notify_all(); // notify observer
-            planning_ = false;
+            finishRun(generation, NO_PLAN_FOUND);
           }
           else
           {
@@ -403,22 +1226,20 @@ namespace mbf_abstract_nav
         else if (cancel_)
         {
           ROS_INFO_STREAM("The global planner has been canceled!");
-          setState(CANCELED);
-          planning_ = false;
-          condition_.notify_all();
+          finishRun(generation, CANCELED);
         }
 
-        //compute sleep time
-        boost::chrono::thread_clock::time_point end_time = boost::chrono::thread_clock::now();
-        boost::chrono::microseconds execution_duration =
-            boost::chrono::duration_cast<boost::chrono::microseconds>(end_time - start_time);
-        boost::chrono::microseconds sleep_time = calling_duration_ - execution_duration;
-        if (planning_ && ros::ok())
+        stats_.endCycle();
+
+        // sleep until the next cycle deadline, if any; the steady clock also accounts for the time blocked or preempted
+        boost::chrono::steady_clock::time_point next_cycle = start_time + calling_duration;
+
+        if (isCurrentRun(generation) && planning_ && ros::ok())
         { // do not sleep if finished
-          if (sleep_time > boost::chrono::microseconds(0))
+          if (next_cycle > boost::chrono::steady_clock::now())
           {
             // interruption point
-            boost::this_thread::sleep_for(sleep_time);
+            boost::this_thread::sleep_until(next_cycle);
           }
           else
           {
@@ -426,15 +1247,13 @@ namespace mbf_abstract_nav
             ROS_WARN_THROTTLE(100, "Planning needs to much time to stay in the planning frequency!");
           }
         }
-      } // while (planning_ && ros::ok())
+      } // while (isCurrentRun(generation) && planning_ && ros::ok())
     }
     catch (const boost::thread_interrupted &ex)
     {
       // Planner thread interrupted; probably we have exceeded planner patience
       ROS_WARN_STREAM("Planner thread interrupted!");
-      setState(STOPPED);
-      condition_.notify_all(); // notify observer
-      planning_ = false;
+      finishRun(generation, STOPPED);
     }
   }
 
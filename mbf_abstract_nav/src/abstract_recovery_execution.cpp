@@ -47,19 +47,34 @@ namespace mbf_abstract_nav
 
 
   AbstractRecoveryExecution::AbstractRecoveryExecution(
-      boost::condition_variable &condition,
       const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr) :
-      condition_(condition), tf_listener_ptr_(tf_listener_ptr), state_(STOPPED), canceled_(false)
+      tf_listener_ptr_(tf_listener_ptr), state_(STOPPED), canceled_(false),
+      worker_("recovery")
   {
+    ros::NodeHandle private_nh("~");
+    int cpu;
+    private_nh.param("recovery_cpu_affinity", cpu, -1);
+    worker_.setAffinity(cpu);
+
+    // loading recovery behaviors on first use shortens the startup, at the cost of a delay on first execution
+    private_nh.param("lazy_recovery_loading", lazy_loading_, false);
   }
 
 
   AbstractRecoveryExecution::~AbstractRecoveryExecution()
   {
+    terminate();
   }
 
 
-  void AbstractRecoveryExecution::initialize()
+  void AbstractRecoveryExecution::terminate()
+  {
+    cancel();
+    worker_.stop();
+  }
+
+
+  bool AbstractRecoveryExecution::initialize()
   {
     if (!loadPlugins())
     {
@@ -74,8 +89,13 @@ namespace mbf_abstract_nav
       }
     }
 
-    initPlugins();
+    std::map<std::string, mbf_abstract_core::AbstractRecovery::Ptr>::iterator iter = recovery_behaviors_.begin();
+    for (; iter != recovery_behaviors_.end(); ++iter)
+    {
+      initPlugin(iter->first, iter->second);
+    }
     setState(INITIALIZED);
+    return true;
   }
 
 
@@ -107,11 +127,18 @@ namespace mbf_abstract_nav
         std::string name = elem["name"];
         std::string type = elem["type"];
 
-        if (recovery_behaviors_.find(name) != recovery_behaviors_.end())
+        if (recovery_behaviors_type_.find(name) != recovery_behaviors_type_.end())
         {
           ROS_ERROR_STREAM("The recovery behavior \"" << name << "\" has already been loaded! Names must be unique!");
           return false;
         }
+        if (lazy_loading_)
+        {
+          recovery_behaviors_type_.insert(std::pair<std::string, std::string>(name, type));
+          ROS_INFO_STREAM("The recovery behavior \"" << type << "\" has been registered under the name \""
+                          << name << "\"; it will be loaded on first use.");
+          continue;
+        }
         mbf_abstract_core::AbstractRecovery::Ptr recovery_ptr = loadRecoveryPlugin(type);
         if(recovery_ptr)
         {
@@ -140,10 +167,36 @@ namespace mbf_abstract_nav
   }
 
 
+  bool AbstractRecoveryExecution::loadBehavior(const std::string &name)
+  {
+    std::map<std::string, std::string>::iterator type_iter = recovery_behaviors_type_.find(name);
+    if (type_iter == recovery_behaviors_type_.end())
+    {
+      return false;
+    }
+
+    const ros::WallTime start = ros::WallTime::now();
+    mbf_abstract_core::AbstractRecovery::Ptr recovery_ptr = loadRecoveryPlugin(type_iter->second);
+    if (!recovery_ptr)
+    {
+      ROS_ERROR_STREAM("Could not load the plugin with the name \"" << name << "\" and the type \""
+                       << type_iter->second << "\"!");
+      return false;
+    }
+    initPlugin(name, recovery_ptr);
+    recovery_behaviors_.insert(std::pair<std::string, mbf_abstract_core::AbstractRecovery::Ptr>(name, recovery_ptr));
+
+    ROS_INFO_STREAM("The recovery behavior \"" << name << "\" has been loaded on first use in "
+                    << (ros::WallTime::now() - start).toSec() << " s");
+    return true;
+  }
+
+
   void AbstractRecoveryExecution::setState(RecoveryState state)
   {
     boost::lock_guard<boost::mutex> guard(state_mtx_);
     state_ = state;
+    notifyStateUpdate();
   }
 
 
@@ -154,17 +207,17 @@ namespace mbf_abstract_nav
   }
 
 
-  void AbstractRecoveryExecution::startRecovery(const std::string name)
+  bool AbstractRecoveryExecution::startRecovery(const std::string name)
   {
     requested_behavior_name_ = name;
     setState(STARTED);
-    thread_ = boost::thread(&AbstractRecoveryExecution::run, this);
+    return worker_.post(boost::bind(&AbstractRecoveryExecution::run, this));
   }
 
 
   void AbstractRecoveryExecution::stopRecovery()
   {
-    thread_.interrupt();
+    worker_.interrupt();
     setState(STOPPED);
   }
 
@@ -183,7 +236,7 @@ namespace mbf_abstract_nav
 
   bool AbstractRecoveryExecution::hasRecoveryBehavior(const std::string &name)
   {
-    return recovery_behaviors_.find(name) != recovery_behaviors_.end();
+    return recovery_behaviors_type_.find(name) != recovery_behaviors_type_.end();
   }
 
 
@@ -218,13 +271,16 @@ namespace mbf_abstract_nav
 
     typename std::map<std::string, boost::shared_ptr<mbf_abstract_core::AbstractRecovery> >::iterator find_iter;
     find_iter = recovery_behaviors_.find(requested_behavior_name_);
+    if (find_iter == recovery_behaviors_.end() && lazy_loading_ && loadBehavior(requested_behavior_name_))
+    {
+      find_iter = recovery_behaviors_.find(requested_behavior_name_);
+    }
 
     if (find_iter == recovery_behaviors_.end())
     {
       // no such recovery behavior
       ROS_ERROR_STREAM("No recovery behavior for the given name: \"" << requested_behavior_name_ << "\"!");
       setState(WRONG_NAME);
-      condition_.notify_one();
       return;
     }
 
@@ -248,7 +304,6 @@ namespace mbf_abstract_nav
     {
       setState(STOPPED);
     }
-    condition_.notify_one();
     current_behavior_.reset();
   }
 } /* namespace mbf_abstract_nav */
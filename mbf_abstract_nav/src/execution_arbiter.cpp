@@ -0,0 +1,130 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  execution_arbiter.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include "mbf_abstract_nav/execution_arbiter.h"
+
+namespace mbf_abstract_nav
+{
+
+ExecutionArbiter::ExecutionArbiter() :
+    last_ticket_(0)
+{
+}
+
+std::list<ExecutionArbiter::Claim>::iterator ExecutionArbiter::find(unsigned int ticket)
+{
+  std::list<Claim>::iterator it = claims_.begin();
+  while (it != claims_.end() && it->ticket != ticket)
+  {
+    ++it;
+  }
+  return it;
+}
+
+unsigned int ExecutionArbiter::acquire(unsigned int executions)
+{
+  boost::unique_lock<boost::mutex> lock(mutex_);
+
+  // ask every overlapping claim, granted or still waiting, to give way
+  for (std::list<Claim>::iterator it = claims_.begin(); it != claims_.end(); ++it)
+  {
+    if (it->executions & executions)
+    {
+      it->preempted = true;
+    }
+  }
+
+  Claim claim;
+  claim.ticket = ++last_ticket_ ? last_ticket_ : ++last_ticket_;  // zero means no ticket
+  claim.executions = executions;
+  claim.granted = false;
+  claim.preempted = false;
+  claims_.push_back(claim);
+  cond_.notify_all();
+
+  while (true)
+  {
+    std::list<Claim>::iterator self = find(claim.ticket);
+    if (self->preempted)
+    {
+      // an even newer goal came while we were waiting
+      claims_.erase(self);
+      cond_.notify_all();
+      return 0;
+    }
+
+    bool busy = false;
+    for (std::list<Claim>::iterator it = claims_.begin(); it != claims_.end() && !busy; ++it)
+    {
+      busy = it->granted && (it->executions & executions);
+    }
+    if (!busy)
+    {
+      self->granted = true;
+      return claim.ticket;
+    }
+    cond_.wait(lock);
+  }
+}
+
+void ExecutionArbiter::release(unsigned int ticket)
+{
+  if (!ticket)
+  {
+    return;
+  }
+
+  boost::lock_guard<boost::mutex> guard(mutex_);
+  std::list<Claim>::iterator it = find(ticket);
+  if (it != claims_.end())
+  {
+    claims_.erase(it);
+    cond_.notify_all();
+  }
+}
+
+bool ExecutionArbiter::isPreempted(unsigned int ticket)
+{
+  boost::lock_guard<boost::mutex> guard(mutex_);
+  std::list<Claim>::iterator it = find(ticket);
+  return it == claims_.end() || it->preempted;
+}
+
+} /* namespace mbf_abstract_nav */
@@ -0,0 +1,136 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  execution_stats.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include "mbf_abstract_nav/execution_stats.h"
+
+namespace mbf_abstract_nav
+{
+
+ExecutionStats::ExecutionStats(const std::string &name) : name_(name), has_last_cycle_(false)
+{
+  target_period_.store(0);
+  cycles_.store(0);
+  missed_deadlines_.store(0);
+}
+
+void ExecutionStats::setPlugin(const std::string &plugin_name)
+{
+  boost::lock_guard<boost::mutex> guard(plugin_mtx_);
+  if (plugin_name != plugin_name_)
+  {
+    plugin_name_ = plugin_name;
+    reset();
+  }
+}
+
+void ExecutionStats::setTargetPeriod(const boost::chrono::microseconds &period)
+{
+  target_period_.store(period.count(), boost::memory_order_relaxed);
+}
+
+void ExecutionStats::startRun()
+{
+  has_last_cycle_ = false;
+}
+
+void ExecutionStats::startCycle()
+{
+  TimePoint now = boost::chrono::steady_clock::now();
+  if (has_last_cycle_)
+  {
+    int64_t period = boost::chrono::duration_cast<boost::chrono::microseconds>(now - cycle_start_).count();
+    period_.record(period);
+
+    int64_t target_period = target_period_.load(boost::memory_order_relaxed);
+    if (target_period > 0)
+      jitter_.record(period > target_period ? period - target_period : target_period - period);
+  }
+  cycle_start_ = now;
+  has_last_cycle_ = true;
+}
+
+void ExecutionStats::endCycle()
+{
+  int64_t compute_time = boost::chrono::duration_cast<boost::chrono::microseconds>(
+      boost::chrono::steady_clock::now() - cycle_start_).count();
+  compute_time_.record(compute_time);
+
+  int64_t target_period = target_period_.load(boost::memory_order_relaxed);
+  if (target_period > 0 && compute_time > target_period)
+    missed_deadlines_.fetch_add(1, boost::memory_order_relaxed);
+  cycles_.fetch_add(1, boost::memory_order_relaxed);
+}
+
+void ExecutionStats::reset()
+{
+  cycles_.store(0, boost::memory_order_relaxed);
+  missed_deadlines_.store(0, boost::memory_order_relaxed);
+  compute_time_.reset();
+  period_.reset();
+  jitter_.reset();
+}
+
+void ExecutionStats::toMsg(mbf_msgs::ExecutionStats &msg)
+{
+  msg.name = name_;
+  {
+    boost::lock_guard<boost::mutex> guard(plugin_mtx_);
+    msg.plugin = plugin_name_;
+  }
+  msg.target_period = target_period_.load(boost::memory_order_relaxed) * 1e-6;
+  msg.cycles = cycles_.load(boost::memory_order_relaxed);
+  msg.missed_deadlines = missed_deadlines_.load(boost::memory_order_relaxed);
+  toMsg(compute_time_, msg.compute_time);
+  toMsg(period_, msg.period);
+  toMsg(jitter_, msg.jitter);
+}
+
+void ExecutionStats::toMsg(const LatencyHistogram &histogram, mbf_msgs::LatencyStats &msg)
+{
+  msg.count = histogram.count();
+  msg.min = histogram.min() * 1e-6;
+  msg.mean = histogram.mean() * 1e-6;
+  msg.max = histogram.max() * 1e-6;
+  msg.p50 = histogram.percentile(0.5) * 1e-6;
+  msg.p90 = histogram.percentile(0.9) * 1e-6;
+  msg.p99 = histogram.percentile(0.99) * 1e-6;
+}
+
+} /* namespace mbf_abstract_nav */
@@ -0,0 +1,96 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  feedback_throttle.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <cmath>
+
+#include "mbf_abstract_nav/feedback_throttle.h"
+#include "mbf_abstract_nav/navigation_utility.h"
+
+namespace mbf_abstract_nav
+{
+
+FeedbackThrottle::FeedbackThrottle(double rate, double min_distance, double min_angle, double min_velocity,
+                                   double keepalive_period) :
+    period_(rate > 0.0 ? 1.0 / rate : 0.0), min_distance_(min_distance), min_angle_(min_angle),
+    min_velocity_(min_velocity), keepalive_period_(keepalive_period), first_(true)
+{
+}
+
+void FeedbackThrottle::reset()
+{
+  first_ = true;
+}
+
+bool FeedbackThrottle::check(const geometry_msgs::PoseStamped &pose, const geometry_msgs::TwistStamped &velocity)
+{
+  const ros::Time now = ros::Time::now();
+  if (!first_)
+  {
+    const ros::Duration elapsed = now - last_time_;
+    if (elapsed < period_)
+    {
+      return false;
+    }
+
+    // cheapest checks first; the rotation is only computed if nothing else changed enough. A zero threshold ignores
+    // its quantity, and with all of them at zero there is nothing to wait for
+    const geometry_msgs::Twist &v1 = velocity.twist;
+    const geometry_msgs::Twist &v2 = last_velocity_.twist;
+    bool changed = (min_distance_ <= 0.0 && min_angle_ <= 0.0 && min_velocity_ <= 0.0)
+        || (keepalive_period_ > ros::Duration(0.0) && elapsed >= keepalive_period_)
+        || (min_velocity_ > 0.0 && (fabs(v1.linear.x - v2.linear.x) >= min_velocity_
+                                    || fabs(v1.linear.y - v2.linear.y) >= min_velocity_
+                                    || fabs(v1.angular.z - v2.angular.z) >= min_velocity_))
+        || (min_distance_ > 0.0 && distance(pose, last_pose_) >= min_distance_)
+        || (min_angle_ > 0.0 && angle(pose, last_pose_) >= min_angle_);
+    if (!changed)
+    {
+      return false;
+    }
+  }
+
+  first_ = false;
+  last_time_ = now;
+  last_pose_ = pose;
+  last_velocity_ = velocity;
+  return true;
+}
+
+} /* namespace mbf_abstract_nav */
@@ -0,0 +1,145 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  latency_histogram.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "mbf_abstract_nav/latency_histogram.h"
+
+namespace mbf_abstract_nav
+{
+
+LatencyHistogram::LatencyHistogram()
+{
+  reset();
+}
+
+void LatencyHistogram::record(uint64_t value)
+{
+  value = std::min(value, (static_cast<uint64_t>(1) << MAX_VALUE_BITS) - 1);
+
+  buckets_[bucketIndex(value)].fetch_add(1, boost::memory_order_relaxed);
+  sum_.fetch_add(value, boost::memory_order_relaxed);
+
+  // there is a single writer, so min and max need no compare-and-swap loop
+  if (value < min_.load(boost::memory_order_relaxed))
+    min_.store(value, boost::memory_order_relaxed);
+  if (value > max_.load(boost::memory_order_relaxed))
+    max_.store(value, boost::memory_order_relaxed);
+
+  // count is updated the last, so readers never see more samples than the buckets contain
+  count_.fetch_add(1, boost::memory_order_release);
+}
+
+void LatencyHistogram::reset()
+{
+  count_.store(0, boost::memory_order_relaxed);
+  for (unsigned int i = 0; i < BUCKETS; ++i)
+    buckets_[i].store(0, boost::memory_order_relaxed);
+  sum_.store(0, boost::memory_order_relaxed);
+  min_.store(std::numeric_limits<uint64_t>::max(), boost::memory_order_relaxed);
+  max_.store(0, boost::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const
+{
+  return count_.load(boost::memory_order_acquire);
+}
+
+uint64_t LatencyHistogram::min() const
+{
+  return count() ? min_.load(boost::memory_order_relaxed) : 0;
+}
+
+uint64_t LatencyHistogram::max() const
+{
+  return max_.load(boost::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const
+{
+  uint64_t n = count();
+  return n ? static_cast<double>(sum_.load(boost::memory_order_relaxed)) / n : 0.0;
+}
+
+uint64_t LatencyHistogram::percentile(double fraction) const
+{
+  uint64_t n = count();
+  if (!n)
+    return 0;
+
+  uint64_t target = std::max(static_cast<uint64_t>(1), static_cast<uint64_t>(fraction * n + 0.5));
+  uint64_t accumulated = 0;
+  for (unsigned int i = 0; i < BUCKETS; ++i)
+  {
+    accumulated += buckets_[i].load(boost::memory_order_relaxed);
+    if (accumulated >= target)
+      return std::min(bucketValue(i), max());
+  }
+  return max();
+}
+
+unsigned int LatencyHistogram::bucketIndex(uint64_t value)
+{
+  const uint64_t sub_buckets = static_cast<uint64_t>(1) << SUB_BUCKET_BITS;
+  if (value < sub_buckets)
+    return value;
+
+  // position of the most significant bit; the next SUB_BUCKET_BITS bits select the bucket within its power of two
+  unsigned int msb = SUB_BUCKET_BITS;
+  while (value >> (msb + 1))
+    ++msb;
+
+  unsigned int shift = msb - SUB_BUCKET_BITS;
+  return ((msb - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS) + ((value >> shift) & (sub_buckets - 1));
+}
+
+uint64_t LatencyHistogram::bucketValue(unsigned int index)
+{
+  const uint64_t sub_buckets = static_cast<uint64_t>(1) << SUB_BUCKET_BITS;
+  if (index < sub_buckets)
+    return index;
+
+  unsigned int shift = (index >> SUB_BUCKET_BITS) - 1;
+  uint64_t lower = (sub_buckets + (index & (sub_buckets - 1))) << shift;
+  return lower + ((static_cast<uint64_t>(1) << shift) >> 1);
+}
+
+} /* namespace mbf_abstract_nav */
@@ -20,7 +20,8 @@ def add_mbf_abstract_nav_params(gen):
     # gen.add("recovery_behaviors", str_t, 0, "A list of recovery behavior plugins to use with move_base_flex.", "[{name: conservative_reset, type: clear_costmap_recovery/ClearCostmapRecovery}, {name: rotate_recovery, type: rotate_recovery/RotateRecovery}, {name: aggressive_reset, type: clear_costmap_recovery/ClearCostmapRecovery}]")
     
     gen.add("planner_frequency", double_t, 0,
-            "The rate in Hz at which to run the planning loop.", 0, 0, 100)
+            "The rate in Hz at which to run the planning loop. If greater than 0, the MoveBase action keeps replanning "
+            "from the current robot pose while the robot follows the path.", 0, 0, 100)
     gen.add("planner_patience", double_t, 0,
             "How long the planner will wait in seconds in an attempt to find a valid plan before giving up.", 5.0, 0, 100)
     gen.add("planner_max_retries", int_t, 0,
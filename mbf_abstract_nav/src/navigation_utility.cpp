@@ -38,6 +38,9 @@
  *
  */
 
+#include <algorithm>
+#include <cmath>
+
 #include "mbf_abstract_nav/navigation_utility.h"
 
 namespace mbf_abstract_nav
@@ -101,24 +104,86 @@ bool transformPose(const tf::TransformListener &tf_listener,
   return true;
 }
 
-double distance(const geometry_msgs::PoseStamped pose1, const geometry_msgs::PoseStamped pose2)
+bool transformPlan(const tf::TransformListener &tf_listener,
+                   const std::string &target_frame,
+                   const ros::Duration &timeout,
+                   const Plan &in,
+                   Plan &out)
 {
-  const geometry_msgs::Point p1 = pose1.pose.position;
-  const geometry_msgs::Point p2 = pose2.pose.position;
+  out.resize(in.size());
+
+  tf::StampedTransform transform;
+  bool has_transform = false;
+  for (size_t i = 0; i < in.size(); ++i)
+  {
+    const std_msgs::Header &header = in[i].header;
+    if (header.frame_id == target_frame)
+    {
+      out[i] = in[i];
+      continue;
+    }
+
+    // look up a new transform only if frame or stamp differ from the previous pose's ones
+    if (!has_transform || header.frame_id != transform.child_frame_id_ || header.stamp != transform.stamp_)
+    {
+      std::string error_msg;
+      if (!tf_listener.waitForTransform(target_frame, header.frame_id, header.stamp, timeout,
+                                        ros::Duration(0.01), &error_msg))
+      {
+        ROS_WARN("Failed to look up transform from %s into the %s frame: %s", header.frame_id.c_str(),
+                 target_frame.c_str(), error_msg.c_str());
+        return false;
+      }
+
+      try
+      {
+        tf_listener.lookupTransform(target_frame, header.frame_id, header.stamp, transform);
+      }
+      catch (tf::TransformException &ex)
+      {
+        ROS_WARN("Failed to transform pose from %s into the %s frame: %s", header.frame_id.c_str(),
+                 target_frame.c_str(), ex.what());
+        return false;
+      }
+      // keep the requested stamp and frame as cache key; lookupTransform can return the latest available stamp
+      transform.child_frame_id_ = header.frame_id;
+      transform.stamp_ = header.stamp;
+      has_transform = true;
+    }
+
+    tf::Pose pose;
+    tf::poseMsgToTF(in[i].pose, pose);
+    tf::poseTFToMsg(transform * pose, out[i].pose);
+    out[i].header.seq = header.seq;
+    out[i].header.stamp = header.stamp;
+    out[i].header.frame_id = target_frame;
+  }
+  return true;
+}
+
+double distance(const geometry_msgs::PoseStamped &pose1, const geometry_msgs::PoseStamped &pose2)
+{
+  const geometry_msgs::Point &p1 = pose1.pose.position;
+  const geometry_msgs::Point &p2 = pose2.pose.position;
   const double dx = p1.x - p2.x;
   const double dy = p1.y - p2.y;
   const double dz = p1.z - p2.z;
   return sqrt(dx * dx + dy * dy + dz * dz);
 }
 
-double angle(const geometry_msgs::PoseStamped pose1, const geometry_msgs::PoseStamped pose2)
+double angle(const geometry_msgs::PoseStamped &pose1, const geometry_msgs::PoseStamped &pose2)
 {
-  const geometry_msgs::Quaternion q1 = pose1.pose.orientation;
-  const geometry_msgs::Quaternion q2 = pose2.pose.orientation;
-  tf::Quaternion rot1, rot2;
-  tf::quaternionMsgToTF(q1, rot1);
-  tf::quaternionMsgToTF(q2, rot2);
-  return rot1.angleShortestPath(rot2);
+  // same as tf::Quaternion::angleShortestPath, without converting the messages
+  const geometry_msgs::Quaternion &q1 = pose1.pose.orientation;
+  const geometry_msgs::Quaternion &q2 = pose2.pose.orientation;
+  const double norms = sqrt((q1.x * q1.x + q1.y * q1.y + q1.z * q1.z + q1.w * q1.w)
+                          * (q2.x * q2.x + q2.y * q2.y + q2.z * q2.z + q2.w * q2.w));
+  if (norms == 0.0)
+  {
+    return 0.0;
+  }
+  const double dot = fabs(q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w) / norms;
+  return 2.0 * acos(std::min(dot, 1.0));
 }
 
 } /* namespace mbf_abstract_nav */
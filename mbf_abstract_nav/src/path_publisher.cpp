@@ -0,0 +1,198 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  path_publisher.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <cmath>
+#include <utility>
+#include <nav_msgs/Path.h>
+#include <tf/transform_datatypes.h>
+#include <mbf_msgs/CompactPath.h>
+
+#include "mbf_abstract_nav/path_publisher.h"
+
+namespace mbf_abstract_nav
+{
+
+PathPublisher::PathPublisher(ros::NodeHandle &nh, const std::string &topic, double tolerance, int max_poses)
+  : tolerance_(tolerance), max_poses_(max_poses > 0 ? max_poses : 0)
+{
+  path_pub_ = nh.advertise<nav_msgs::Path>(topic, 1);
+  compact_path_pub_ = nh.advertise<mbf_msgs::CompactPath>(topic + "_compact", 1);
+}
+
+void PathPublisher::publish(const Plan &plan)
+{
+  if (plan.empty() || (path_pub_.getNumSubscribers() == 0 && compact_path_pub_.getNumSubscribers() == 0))
+  {
+    return;
+  }
+
+  boost::lock_guard<boost::mutex> guard(mutex_);
+  if (!hasChanged(plan))
+  {
+    return;
+  }
+  last_plan_ = plan;
+
+  std::vector<size_t> indices;
+  simplify(plan, tolerance_, max_poses_, indices);
+
+  if (path_pub_.getNumSubscribers() > 0)
+  {
+    nav_msgs::Path path;
+    path.header.frame_id = plan.front().header.frame_id;
+    path.header.stamp = plan.front().header.stamp;
+    path.poses.reserve(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+      path.poses.push_back(plan[indices[i]]);
+    }
+    path_pub_.publish(path);
+  }
+
+  if (compact_path_pub_.getNumSubscribers() > 0)
+  {
+    mbf_msgs::CompactPath path;
+    path.header.frame_id = plan.front().header.frame_id;
+    path.header.stamp = plan.front().header.stamp;
+    path.poses.reserve(3 * indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+      const geometry_msgs::Pose &pose = plan[indices[i]].pose;
+      path.poses.push_back(static_cast<float>(pose.position.x));
+      path.poses.push_back(static_cast<float>(pose.position.y));
+      path.poses.push_back(static_cast<float>(tf::getYaw(pose.orientation)));
+    }
+    compact_path_pub_.publish(path);
+  }
+}
+
+bool PathPublisher::hasChanged(const Plan &plan) const
+{
+  if (plan.size() != last_plan_.size() || plan.front().header.frame_id != last_plan_.front().header.frame_id)
+  {
+    return true;
+  }
+  for (size_t i = 0; i < plan.size(); ++i)
+  {
+    const geometry_msgs::Pose &p1 = plan[i].pose;
+    const geometry_msgs::Pose &p2 = last_plan_[i].pose;
+    if (p1.position.x != p2.position.x || p1.position.y != p2.position.y || p1.position.z != p2.position.z
+        || p1.orientation.x != p2.orientation.x || p1.orientation.y != p2.orientation.y
+        || p1.orientation.z != p2.orientation.z || p1.orientation.w != p2.orientation.w)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void PathPublisher::simplify(const Plan &plan, double tolerance, size_t max_poses, std::vector<size_t> &indices)
+{
+  const size_t n = plan.size();
+  std::vector<bool> keep(n, tolerance <= 0.0);
+  keep.front() = true;
+  keep.back() = true;
+
+  if (tolerance > 0.0)
+  {
+    // Douglas-Peucker on the x-y plane, iterative to not depend on the stack size for long plans
+    std::vector<std::pair<size_t, size_t> > segments;
+    segments.push_back(std::make_pair(static_cast<size_t>(0), n - 1));
+    while (!segments.empty())
+    {
+      const size_t first = segments.back().first;
+      const size_t last = segments.back().second;
+      segments.pop_back();
+
+      const geometry_msgs::Point &a = plan[first].pose.position;
+      const geometry_msgs::Point &b = plan[last].pose.position;
+      const double dx = b.x - a.x;
+      const double dy = b.y - a.y;
+      const double length2 = dx * dx + dy * dy;
+
+      double max_dist = 0.0;
+      size_t max_index = first;
+      for (size_t i = first + 1; i < last; ++i)
+      {
+        // distance to the segment from a to b
+        const geometry_msgs::Point &p = plan[i].pose.position;
+        double t = length2 > 0.0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / length2 : 0.0;
+        t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+        const double ex = p.x - (a.x + t * dx);
+        const double ey = p.y - (a.y + t * dy);
+        const double dist = std::sqrt(ex * ex + ey * ey);
+        if (dist > max_dist)
+        {
+          max_dist = dist;
+          max_index = i;
+        }
+      }
+
+      if (max_dist > tolerance)
+      {
+        keep[max_index] = true;
+        segments.push_back(std::make_pair(first, max_index));
+        segments.push_back(std::make_pair(max_index, last));
+      }
+    }
+  }
+
+  indices.clear();
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (keep[i])
+      indices.push_back(i);
+  }
+
+  if (max_poses > 1 && indices.size() > max_poses)
+  {
+    // evenly subsample the kept poses, always keeping the last one
+    std::vector<size_t> capped;
+    capped.reserve(max_poses);
+    for (size_t i = 0; i < max_poses - 1; ++i)
+    {
+      capped.push_back(indices[i * (indices.size() - 1) / (max_poses - 1)]);
+    }
+    capped.push_back(indices.back());
+    indices.swap(capped);
+  }
+}
+
+} /* namespace mbf_abstract_nav */
@@ -0,0 +1,110 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  plan_orientation_filler.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <cmath>
+#include <ros/ros.h>
+#include <tf/transform_datatypes.h>
+#include <pluginlib/class_list_macros.h>
+
+#include "mbf_abstract_nav/plan_orientation_filler.h"
+
+namespace mbf_abstract_nav
+{
+
+PlanOrientationFiller::PlanOrientationFiller() : keep_goal_orientation_(true)
+{
+}
+
+PlanOrientationFiller::~PlanOrientationFiller()
+{
+}
+
+bool PlanOrientationFiller::initialize(const std::string &name)
+{
+  ros::NodeHandle private_nh("~/" + name);
+  private_nh.param("keep_goal_orientation", keep_goal_orientation_, true);
+  return true;
+}
+
+bool PlanOrientationFiller::process(const std::vector<geometry_msgs::PoseStamped> &plan,
+                                    std::vector<geometry_msgs::PoseStamped> &processed,
+                                    std::string &message)
+{
+  processed = plan;
+  const size_t n = plan.size();
+  if (n < 2)
+  {
+    return true;
+  }
+
+  // segment directions over contiguous coordinate arrays
+  std::vector<double> dx(n - 1), dy(n - 1), yaw(n - 1);
+  for (size_t i = 0; i < n - 1; ++i)
+  {
+    dx[i] = plan[i + 1].pose.position.x - plan[i].pose.position.x;
+    dy[i] = plan[i + 1].pose.position.y - plan[i].pose.position.y;
+  }
+  for (size_t i = 0; i < n - 1; ++i)
+  {
+    yaw[i] = std::atan2(dy[i], dx[i]);
+  }
+
+  // poses without a direction of their own keep the orientation of the previous one (the original one, if first)
+  for (size_t i = 0; i < n - 1; ++i)
+  {
+    if (dx[i] * dx[i] + dy[i] * dy[i] > 1e-12)
+    {
+      processed[i].pose.orientation = tf::createQuaternionMsgFromYaw(yaw[i]);
+    }
+    else if (i > 0)
+    {
+      processed[i].pose.orientation = processed[i - 1].pose.orientation;
+    }
+  }
+  if (!keep_goal_orientation_)
+  {
+    processed[n - 1].pose.orientation = processed[n - 2].pose.orientation;
+  }
+  return true;
+}
+
+} /* namespace mbf_abstract_nav */
+
+PLUGINLIB_EXPORT_CLASS(mbf_abstract_nav::PlanOrientationFiller, mbf_abstract_core::AbstractPlanProcessor);
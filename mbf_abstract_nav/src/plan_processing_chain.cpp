@@ -0,0 +1,136 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  plan_processing_chain.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <ros/ros.h>
+#include <pluginlib/class_loader.h>
+
+#include "mbf_abstract_nav/plan_processing_chain.h"
+
+namespace mbf_abstract_nav
+{
+
+PlanProcessingChain::PlanProcessingChain()
+{
+  static pluginlib::ClassLoader<mbf_abstract_core::AbstractPlanProcessor>
+      class_loader("mbf_abstract_core", "mbf_abstract_core::AbstractPlanProcessor");
+
+  ros::NodeHandle private_nh("~");
+  XmlRpc::XmlRpcValue plan_processors_param_list;
+  if (!private_nh.getParam("plan_processors", plan_processors_param_list))
+  {
+    ROS_DEBUG_STREAM("No plan processors configured; plans are handed to the controller as planned.");
+    return;
+  }
+
+  try
+  {
+    for (int i = 0; i < plan_processors_param_list.size(); i++)
+    {
+      XmlRpc::XmlRpcValue elem = plan_processors_param_list[i];
+
+      std::string name = elem["name"];
+      std::string type = elem["type"];
+
+      mbf_abstract_core::AbstractPlanProcessor::Ptr stage_ptr;
+      try
+      {
+        stage_ptr = class_loader.createInstance(type);
+      }
+      catch (pluginlib::PluginlibException &ex)
+      {
+        ROS_ERROR_STREAM("Failed to load the plan processor \"" << name << "\" of type \"" << type
+                         << "\"; skipping it. Exception: " << ex.what());
+        continue;
+      }
+
+      if (!stage_ptr || !stage_ptr->initialize(name))
+      {
+        ROS_ERROR_STREAM("Could not initialize the plan processor \"" << name << "\" of type \"" << type
+                         << "\"; skipping it.");
+        continue;
+      }
+      stages_.push_back(Stage(name, stage_ptr));
+      ROS_INFO_STREAM("The plan processor \"" << type << "\" has been loaded successfully under the name \""
+                      << name << "\".");
+    }
+  }
+  catch (XmlRpc::XmlRpcException &e)
+  {
+    ROS_ERROR_STREAM("Invalid parameter structure. The plan_processors parameter has to be a list of structs "
+                     << "with fields \"name\" and \"type\" of the plan processor!");
+    ROS_ERROR_STREAM(e.getMessage());
+  }
+}
+
+bool PlanProcessingChain::empty() const
+{
+  return stages_.empty();
+}
+
+bool PlanProcessingChain::process(const PlanConstPtr &plan, PlanConstPtr &processed, std::string &message)
+{
+  if (stages_.empty() || plan->empty())
+  {
+    processed = plan;
+    return true;
+  }
+
+  boost::lock_guard<boost::mutex> guard(process_mtx_);
+
+  // ping-pong between two buffers, so each stage reads the output of the previous one without copying it
+  Plan input(*plan);
+  boost::shared_ptr<Plan> output = boost::make_shared<Plan>();
+  for (std::vector<Stage>::iterator stage = stages_.begin(); stage != stages_.end(); ++stage)
+  {
+    std::string stage_message;
+    if (!stage->second->process(input, *output, stage_message) || output->empty())
+    {
+      message = "The plan processor \"" + stage->first + "\" failed"
+          + (stage_message.empty() ? std::string("") : ": " + stage_message);
+      return false;
+    }
+    input.swap(*output);
+  }
+  output->swap(input);
+  processed = output;
+  return true;
+}
+
+} /* namespace mbf_abstract_nav */
@@ -0,0 +1,129 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  plan_resampler.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <cmath>
+#include <ros/ros.h>
+#include <pluginlib/class_list_macros.h>
+
+#include "mbf_abstract_nav/plan_resampler.h"
+
+namespace mbf_abstract_nav
+{
+
+PlanResampler::PlanResampler() : spacing_(0.05)
+{
+}
+
+PlanResampler::~PlanResampler()
+{
+}
+
+bool PlanResampler::initialize(const std::string &name)
+{
+  ros::NodeHandle private_nh("~/" + name);
+  private_nh.param("spacing", spacing_, 0.05);
+  return true;
+}
+
+bool PlanResampler::process(const std::vector<geometry_msgs::PoseStamped> &plan,
+                            std::vector<geometry_msgs::PoseStamped> &processed,
+                            std::string &message)
+{
+  const size_t n = plan.size();
+  if (n < 2 || spacing_ <= 0.0)
+  {
+    processed = plan;
+    return true;
+  }
+
+  // contiguous coordinate arrays and the cumulated length along the plan at each pose
+  std::vector<double> x(n), y(n), z(n), dx(n - 1), dy(n - 1), dz(n - 1), length(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    x[i] = plan[i].pose.position.x;
+    y[i] = plan[i].pose.position.y;
+    z[i] = plan[i].pose.position.z;
+  }
+  for (size_t i = 0; i < n - 1; ++i)
+  {
+    dx[i] = x[i + 1] - x[i];
+    dy[i] = y[i + 1] - y[i];
+    dz[i] = z[i + 1] - z[i];
+  }
+  length[0] = 0.0;
+  for (size_t i = 0; i < n - 1; ++i)
+  {
+    length[i + 1] = length[i] + std::sqrt(dx[i] * dx[i] + dy[i] * dy[i] + dz[i] * dz[i]);
+  }
+
+  // the last pose is added on its own, so skip a sample falling (almost) on top of it
+  const double total_length = length[n - 1];
+  size_t samples = static_cast<size_t>(std::floor(total_length / spacing_)) + 1;
+  if (samples > 1 && total_length - (samples - 1) * spacing_ < 0.5 * spacing_)
+  {
+    --samples;
+  }
+
+  processed.clear();
+  processed.reserve(samples + 1);
+  size_t segment = 0;
+  for (size_t k = 0; k < samples; ++k)
+  {
+    const double s = k * spacing_;
+    while (segment < n - 2 && length[segment + 1] < s)
+    {
+      ++segment;
+    }
+    const double segment_length = length[segment + 1] - length[segment];
+    const double t = segment_length > 0.0 ? (s - length[segment]) / segment_length : 0.0;
+
+    geometry_msgs::PoseStamped pose = plan[segment];
+    pose.pose.position.x = x[segment] + t * dx[segment];
+    pose.pose.position.y = y[segment] + t * dy[segment];
+    pose.pose.position.z = z[segment] + t * dz[segment];
+    processed.push_back(pose);
+  }
+  processed.push_back(plan.back());
+  return true;
+}
+
+} /* namespace mbf_abstract_nav */
+
+PLUGINLIB_EXPORT_CLASS(mbf_abstract_nav::PlanResampler, mbf_abstract_core::AbstractPlanProcessor);
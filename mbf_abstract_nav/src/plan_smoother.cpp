@@ -0,0 +1,119 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  plan_smoother.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <algorithm>
+#include <ros/ros.h>
+#include <pluginlib/class_list_macros.h>
+
+#include "mbf_abstract_nav/plan_smoother.h"
+
+namespace mbf_abstract_nav
+{
+
+PlanSmoother::PlanSmoother() : iterations_(10), weight_smooth_(0.3), weight_data_(0.1)
+{
+}
+
+PlanSmoother::~PlanSmoother()
+{
+}
+
+bool PlanSmoother::initialize(const std::string &name)
+{
+  ros::NodeHandle private_nh("~/" + name);
+  private_nh.param("iterations", iterations_, 10);
+  private_nh.param("weight_smooth", weight_smooth_, 0.3);
+  private_nh.param("weight_data", weight_data_, 0.1);
+
+  // above 0.5 the iterations oscillate instead of converging
+  weight_smooth_ = std::min(std::max(weight_smooth_, 0.0), 0.5);
+  weight_data_ = std::min(std::max(weight_data_, 0.0), 1.0);
+  return true;
+}
+
+bool PlanSmoother::process(const std::vector<geometry_msgs::PoseStamped> &plan,
+                           std::vector<geometry_msgs::PoseStamped> &processed,
+                           std::string &message)
+{
+  processed = plan;
+  const size_t n = plan.size();
+  if (n < 3 || iterations_ <= 0)
+  {
+    return true;
+  }
+
+  // work on contiguous coordinate arrays, so the compiler can vectorize the iterations
+  std::vector<double> x0(n), y0(n), z0(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    x0[i] = plan[i].pose.position.x;
+    y0[i] = plan[i].pose.position.y;
+    z0[i] = plan[i].pose.position.z;
+  }
+  std::vector<double> x(x0), y(y0), z(z0);
+  std::vector<double> next_x(x0), next_y(y0), next_z(z0);
+
+  const double ws = weight_smooth_;
+  const double wd = weight_data_;
+  for (int iteration = 0; iteration < iterations_; ++iteration)
+  {
+    for (size_t i = 1; i < n - 1; ++i)
+    {
+      next_x[i] = x[i] + ws * (x[i - 1] + x[i + 1] - 2.0 * x[i]) + wd * (x0[i] - x[i]);
+      next_y[i] = y[i] + ws * (y[i - 1] + y[i + 1] - 2.0 * y[i]) + wd * (y0[i] - y[i]);
+      next_z[i] = z[i] + ws * (z[i - 1] + z[i + 1] - 2.0 * z[i]) + wd * (z0[i] - z[i]);
+    }
+    x.swap(next_x);
+    y.swap(next_y);
+    z.swap(next_z);
+  }
+
+  for (size_t i = 1; i < n - 1; ++i)
+  {
+    processed[i].pose.position.x = x[i];
+    processed[i].pose.position.y = y[i];
+    processed[i].pose.position.z = z[i];
+  }
+  return true;
+}
+
+} /* namespace mbf_abstract_nav */
+
+PLUGINLIB_EXPORT_CLASS(mbf_abstract_nav::PlanSmoother, mbf_abstract_core::AbstractPlanProcessor);
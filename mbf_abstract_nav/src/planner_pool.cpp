@@ -0,0 +1,205 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  planner_pool.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <algorithm>
+#include <sstream>
+#include <boost/bind.hpp>
+#include <mbf_msgs/GetPathResult.h>
+
+#include "mbf_abstract_nav/planner_pool.h"
+
+namespace mbf_abstract_nav
+{
+
+PlannerPool::PlannerPool(const PlannerFactory &factory, unsigned int size) :
+    factory_(factory), size_(size), queries_(NULL), answers_(NULL), next_query_(0)
+{
+}
+
+PlannerPool::~PlannerPool()
+{
+  // stop the workers before the planners they use, and these before the execution which loaded them
+  workers_.clear();
+  slots_.clear();
+}
+
+bool PlannerPool::initialize()
+{
+  execution_ = factory_();
+  if (!execution_)
+  {
+    ROS_ERROR_STREAM("Could not create the planner execution of the planner pool!");
+    return false;
+  }
+
+  slots_.resize(size_);
+  for (unsigned int i = 0; i < size_; ++i)
+  {
+    if (!getInstance(i, std::string()).planner)
+    {
+      ROS_ERROR_STREAM("Could not load the default planner on the slot number " << i << " of the planner pool!");
+      return false;
+    }
+
+    std::stringstream name;
+    name << "planner pool " << i;
+    workers_.push_back(boost::shared_ptr<WorkerThread>(new WorkerThread(name.str())));
+  }
+  ROS_INFO_STREAM("Planner pool with " << size_ << " planners initialized");
+  return true;
+}
+
+void PlannerPool::reconfigure(mbf_abstract_nav::MoveBaseFlexConfig &config)
+{
+  boost::lock_guard<boost::mutex> guard(config_mtx_);
+  default_planner_ = config.global_planner;
+}
+
+unsigned int PlannerPool::size() const
+{
+  return size_;
+}
+
+void PlannerPool::makePlans(const std::string &planner, const std::vector<Query> &queries,
+                            std::vector<Answer> &answers)
+{
+  boost::lock_guard<boost::mutex> batch_guard(batch_mtx_);
+
+  if (planner.empty())
+  {
+    boost::lock_guard<boost::mutex> guard(config_mtx_);
+    planner_ = default_planner_;
+  }
+  else
+  {
+    planner_ = planner;
+  }
+
+  answers.assign(queries.size(), Answer());
+  queries_ = &queries;
+  answers_ = &answers;
+  next_query_ = 0;
+
+  // no need to wake up more planners than queries
+  size_t num_workers = std::min(workers_.size(), queries.size());
+  for (size_t i = 0; i < num_workers; ++i)
+  {
+    workers_[i]->post(boost::bind(&PlannerPool::planQueries, this, i));
+  }
+  for (size_t i = 0; i < num_workers; ++i)
+  {
+    workers_[i]->waitUntilIdle();
+  }
+
+  queries_ = NULL;
+  answers_ = NULL;
+}
+
+PlannerPool::Instance PlannerPool::getInstance(size_t slot, const std::string &planner)
+{
+  Slot::iterator iter = slots_[slot].find(planner);
+  if (iter != slots_[slot].end())
+  {
+    return iter->second;
+  }
+
+  Instance instance;
+  instance.planner = execution_->loadPlannerInstance(planner, instance.name);
+  if (instance.planner)
+  {
+    slots_[slot][planner] = instance;  // on failure, we try again on the next batch
+  }
+  return instance;
+}
+
+void PlannerPool::planQueries(size_t slot)
+{
+  Instance instance;
+  std::string error;
+  try
+  {
+    instance = getInstance(slot, planner_);
+  }
+  catch (const std::exception &ex)
+  {
+    error = ex.what();
+  }
+
+  while (true)
+  {
+    size_t index;
+    {
+      boost::lock_guard<boost::mutex> guard(query_mtx_);
+      if (next_query_ >= queries_->size())
+      {
+        return;
+      }
+      index = next_query_++;
+    }
+
+    const Query &query = (*queries_)[index];
+    Answer &answer = (*answers_)[index];
+
+    // every answer is written only by the worker which took the query, so no locking is needed here
+    answer.cost = 0.0;
+    if (!instance.planner)
+    {
+      answer.outcome = mbf_msgs::GetPathResult::INVALID_PLUGIN;
+      answer.message = "Could not load the planner \"" + planner_ + "\"" + (error.empty() ? "" : ": " + error);
+      continue;
+    }
+
+    boost::shared_ptr<Plan> plan(new Plan());
+    try
+    {
+      answer.outcome = execution_->planWithInstance(instance.planner, instance.name, query.start, query.goal,
+                                                    query.tolerance, *plan, answer.cost, answer.message);
+    }
+    catch (const std::exception &ex)
+    {
+      ROS_ERROR_STREAM("The planner \"" << instance.name << "\" of the planner pool failed: " << ex.what());
+      answer.outcome = mbf_msgs::GetPathResult::INTERNAL_ERROR;
+      answer.message = ex.what();
+    }
+    answer.plan = plan;
+  }
+}
+
+} /* namespace mbf_abstract_nav */
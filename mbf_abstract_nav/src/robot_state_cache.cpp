@@ -0,0 +1,133 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  robot_state_cache.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include "mbf_abstract_nav/robot_state_cache.h"
+
+namespace mbf_abstract_nav
+{
+
+RobotStateCache::RobotStateCache(const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr,
+                                 const std::string &robot_frame, const std::string &global_frame,
+                                 const std::string &odom_topic, double pose_frequency)
+  : tf_listener_ptr_(tf_listener_ptr), robot_frame_(robot_frame), global_frame_(global_frame),
+    state_(new State())
+{
+  ros::NodeHandle nh;
+  odom_sub_ = nh.subscribe(odom_topic, 1, &RobotStateCache::odomCallback, this);
+  if (pose_frequency > 0.0)
+  {
+    pose_timer_ = nh.createTimer(ros::Duration(1.0 / pose_frequency), &RobotStateCache::poseTimerCallback, this);
+  }
+}
+
+RobotStateCache::StateConstPtr RobotStateCache::get() const
+{
+  return boost::atomic_load(&state_);
+}
+
+bool RobotStateCache::getPose(geometry_msgs::PoseStamped &pose, const ros::Duration &max_age)
+{
+  StateConstPtr state = get();
+  if (!isFresh(state->pose, max_age))
+  {
+    // the pose tracking may not have run yet or TF may have just caught up; try once more, still without waiting
+    updatePose();
+    state = get();
+  }
+  pose = state->pose;
+  return isFresh(pose, max_age);
+}
+
+bool RobotStateCache::isFresh(const geometry_msgs::PoseStamped &pose, const ros::Duration &max_age)
+{
+  return !pose.header.stamp.isZero() && ros::Time::now() - pose.header.stamp <= max_age;
+}
+
+bool RobotStateCache::updatePose()
+{
+  geometry_msgs::PoseStamped robot_pose;
+  robot_pose.header.frame_id = robot_frame_;
+  robot_pose.header.stamp = ros::Time(0.0);  // most recent available
+  robot_pose.pose.orientation.w = 1.0;
+
+  geometry_msgs::PoseStamped global_pose;
+  try
+  {
+    tf_listener_ptr_->transformPose(global_frame_, robot_pose, global_pose);
+  }
+  catch (const tf::TransformException &ex)
+  {
+    ROS_WARN_STREAM_THROTTLE(1.0, "Could not update the robot pose on frame '" << global_frame_ << "': " << ex.what());
+    return false;
+  }
+
+  update(&global_pose, NULL);
+  return true;
+}
+
+void RobotStateCache::odomCallback(const nav_msgs::Odometry::ConstPtr &odom)
+{
+  geometry_msgs::TwistStamped velocity;
+  velocity.header.stamp = odom->header.stamp;
+  velocity.header.frame_id = odom->child_frame_id;
+  velocity.twist = odom->twist.twist;
+  update(NULL, &velocity);
+
+  updatePose();
+}
+
+void RobotStateCache::poseTimerCallback(const ros::TimerEvent &event)
+{
+  updatePose();
+}
+
+void RobotStateCache::update(const geometry_msgs::PoseStamped *pose, const geometry_msgs::TwistStamped *velocity)
+{
+  boost::lock_guard<boost::mutex> guard(update_mtx_);
+
+  boost::shared_ptr<State> state(new State(*state_));
+  if (pose)
+    state->pose = *pose;
+  if (velocity)
+    state->velocity = *velocity;
+  boost::atomic_store(&state_, StateConstPtr(state));
+}
+
+} /* namespace mbf_abstract_nav */
@@ -0,0 +1,228 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  worker_thread.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <ros/ros.h>
+
+#include "mbf_abstract_nav/worker_thread.h"
+
+namespace mbf_abstract_nav
+{
+
+WorkerThread::WorkerThread(const std::string &name) :
+    name_(name), running_(false), interrupt_pending_(false), shutdown_(false),
+    thread_(&WorkerThread::loop, this)
+{
+}
+
+WorkerThread::~WorkerThread()
+{
+  stop();
+}
+
+void WorkerThread::stop()
+{
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    shutdown_ = true;
+    task_.clear();
+  }
+  cond_.notify_all();
+  thread_.interrupt();
+  if (thread_.joinable())
+  {
+    thread_.join();
+  }
+}
+
+bool WorkerThread::post(const Task &task)
+{
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    if (shutdown_ || task_)
+    {
+      return false;
+    }
+    task_ = task;
+  }
+  cond_.notify_all();
+  return true;
+}
+
+void WorkerThread::interrupt()
+{
+  boost::lock_guard<boost::mutex> guard(mutex_);
+  if (running_)
+  {
+    thread_.interrupt();
+  }
+  else if (task_)
+  {
+    // the worker has not picked up the task yet; deliver the interrupt when it starts
+    interrupt_pending_ = true;
+  }
+}
+
+void WorkerThread::waitUntilIdle()
+{
+  boost::unique_lock<boost::mutex> lock(mutex_);
+  while (running_ || task_)
+  {
+    cond_.wait(lock);
+  }
+}
+
+bool WorkerThread::isBusy()
+{
+  boost::lock_guard<boost::mutex> guard(mutex_);
+  return running_ || task_;
+}
+
+bool WorkerThread::setAffinity(int cpu)
+{
+  if (cpu < 0)
+  {
+    return true;
+  }
+#ifdef __linux__
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu, &cpu_set);
+  int error = pthread_setaffinity_np(thread_.native_handle(), sizeof(cpu_set_t), &cpu_set);
+  if (error != 0)
+  {
+    ROS_WARN_STREAM("Could not pin the " << name_ << " worker thread to the CPU " << cpu << "; error: " << error);
+    return false;
+  }
+  ROS_INFO_STREAM("Pinned the " << name_ << " worker thread to the CPU " << cpu);
+  return true;
+#else
+  ROS_WARN_STREAM("Setting the CPU affinity of the " << name_ << " worker thread is not supported on this platform");
+  return false;
+#endif
+}
+
+bool WorkerThread::setRealtimePriority(int priority)
+{
+  if (priority <= 0)
+  {
+    return true;
+  }
+#ifdef __linux__
+  sched_param param;
+  param.sched_priority = priority;
+  int error = pthread_setschedparam(thread_.native_handle(), SCHED_FIFO, &param);
+  if (error != 0)
+  {
+    ROS_WARN_STREAM("Could not set the real-time priority " << priority << " to the " << name_
+                    << " worker thread; error: " << error);
+    return false;
+  }
+  ROS_INFO_STREAM("Running the " << name_ << " worker thread with real-time priority " << priority);
+  return true;
+#else
+  ROS_WARN_STREAM("Real-time priority for the " << name_ << " worker thread is not supported on this platform");
+  return false;
+#endif
+}
+
+void WorkerThread::loop()
+{
+  while (true)
+  {
+    Task task;
+    {
+      // interrupts are meant for the running task; don't let them break the parked worker
+      boost::this_thread::disable_interruption no_interruption;
+      boost::unique_lock<boost::mutex> lock(mutex_);
+      while (!shutdown_ && !task_)
+      {
+        cond_.wait(lock);
+      }
+      if (shutdown_)
+      {
+        return;
+      }
+      task.swap(task_);
+      running_ = true;
+      if (interrupt_pending_)
+      {
+        // raised at the first interruption point of the task, once interruptions are enabled again
+        interrupt_pending_ = false;
+        thread_.interrupt();
+      }
+    }
+
+    try
+    {
+      task();
+    }
+    catch (const boost::thread_interrupted &ex)
+    {
+      ROS_WARN_STREAM("Task of the " << name_ << " worker thread interrupted");
+    }
+    catch (const std::exception &ex)
+    {
+      // the worker must survive a failing task, so the waiters get notified and new tasks can be posted
+      ROS_ERROR_STREAM("Task of the " << name_ << " worker thread failed: " << ex.what());
+    }
+
+    {
+      boost::lock_guard<boost::mutex> guard(mutex_);
+      running_ = false;
+    }
+    cond_.notify_all();
+
+    try
+    {
+      // discard an interrupt requested while the task was finishing; no new ones come once running_ is cleared
+      boost::this_thread::interruption_point();
+    }
+    catch (const boost::thread_interrupted &ex)
+    {
+    }
+  }
+}
+
+} /* namespace mbf_abstract_nav */
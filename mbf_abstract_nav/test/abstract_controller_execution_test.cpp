@@ -0,0 +1,511 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  abstract_controller_execution_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include <boost/make_shared.hpp>
+#include <boost/thread.hpp>
+#include <mbf_abstract_core/abstract_controller.h>
+#include <mbf_msgs/ExePathResult.h>
+
+#include "mbf_abstract_nav/abstract_controller_execution.h"
+#include "mbf_abstract_nav/robot_state_cache.h"
+
+using mbf_abstract_nav::AbstractControllerExecution;
+using mbf_abstract_nav::Plan;
+using mbf_abstract_nav::PlanConstPtr;
+
+typedef boost::chrono::steady_clock::time_point TimePoint;
+
+/**
+ * @brief Behaviour of the fake controllers of one type, shared by all their instances, and record of their calls.
+ *        Every call blocks for the given duration, as if waiting on a mutex, so it consumes no CPU time. Creating a
+ *        controller, i.e. loading it, takes the load duration.
+ */
+class ControllerScript
+{
+public:
+  ControllerScript() : outcome_(mbf_msgs::ExePathResult::SUCCESS), call_duration_(0), slow_call_(-1),
+                       load_duration_(0), instances_(0), plans_(0)
+  {
+  }
+
+  void setOutcome(uint32_t outcome)
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    outcome_ = outcome;
+  }
+
+  //! blocks every call for the given duration, and the given call for the slow duration
+  void setCallDuration(const boost::chrono::milliseconds &duration, int slow_call = -1,
+                       const boost::chrono::milliseconds &slow_duration = boost::chrono::milliseconds(0))
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    call_duration_ = duration;
+    slow_call_ = slow_call;
+    slow_duration_ = slow_duration;
+  }
+
+  void setLoadDuration(const boost::chrono::milliseconds &duration)
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    load_duration_ = duration;
+  }
+
+  //! number of controller instances created so far
+  int instances()
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    return instances_;
+  }
+
+  //! number of plans set so far
+  int plans()
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    return plans_;
+  }
+
+  //! start times of the computeVelocityCommands calls so far
+  std::vector<TimePoint> callTimes()
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    return call_times_;
+  }
+
+  //! robot poses received on the computeVelocityCommands calls so far
+  std::vector<geometry_msgs::PoseStamped> poses()
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    return poses_;
+  }
+
+  //! waits until the given number of computeVelocityCommands calls have started; false if they don't within 2 s
+  bool waitForCalls(size_t calls)
+  {
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    const TimePoint deadline = boost::chrono::steady_clock::now() + boost::chrono::seconds(2);
+    while (call_times_.size() < calls)
+    {
+      if (cond_.wait_until(lock, deadline) == boost::cv_status::timeout)
+        return call_times_.size() >= calls;
+    }
+    return true;
+  }
+
+private:
+  friend class FakeController;
+
+  uint32_t outcome_;
+  boost::chrono::milliseconds call_duration_;
+  int slow_call_;
+  boost::chrono::milliseconds slow_duration_;
+  boost::chrono::milliseconds load_duration_;
+  int instances_;
+  int plans_;
+  std::vector<TimePoint> call_times_;
+  std::vector<geometry_msgs::PoseStamped> poses_;
+  boost::mutex mutex_;
+  boost::condition_variable cond_;
+};
+
+typedef boost::shared_ptr<ControllerScript> ControllerScriptPtr;
+
+/**
+ * @brief Controller plugin following the script of its type. It never reaches the goal, and its velocity commands
+ *        have the controller type as frame, so the tests can tell them apart.
+ */
+class FakeController : public mbf_abstract_core::AbstractController
+{
+public:
+  FakeController(const std::string &type, const ControllerScriptPtr &script) : type_(type), script_(script)
+  {
+    boost::chrono::milliseconds load_duration;
+    {
+      boost::lock_guard<boost::mutex> guard(script_->mutex_);
+      ++script_->instances_;
+      load_duration = script_->load_duration_;
+    }
+    boost::this_thread::sleep_for(load_duration);
+  }
+
+  virtual uint32_t computeVelocityCommands(const geometry_msgs::PoseStamped &pose,
+                                           const geometry_msgs::TwistStamped &velocity,
+                                           geometry_msgs::TwistStamped &cmd_vel, std::string &message)
+  {
+    boost::chrono::milliseconds duration;
+    uint32_t outcome;
+    {
+      boost::lock_guard<boost::mutex> guard(script_->mutex_);
+      duration = static_cast<int>(script_->call_times_.size()) == script_->slow_call_ ?
+                 script_->slow_duration_ : script_->call_duration_;
+      outcome = script_->outcome_;
+      script_->call_times_.push_back(boost::chrono::steady_clock::now());
+      script_->poses_.push_back(pose);
+      script_->cond_.notify_all();
+    }
+    // like most controllers, without interruption points
+    boost::this_thread::disable_interruption no_interruption;
+    boost::this_thread::sleep_for(duration);
+
+    cmd_vel.header.frame_id = type_;
+    cmd_vel.header.stamp = ros::Time::now();
+    cmd_vel.twist.linear.x = 0.1;
+    message = type_;
+    return outcome;
+  }
+
+  virtual bool isGoalReached(double dist_tolerance, double angle_tolerance)
+  {
+    return false;
+  }
+
+  virtual bool setPlan(const std::vector<geometry_msgs::PoseStamped> &plan)
+  {
+    boost::lock_guard<boost::mutex> guard(script_->mutex_);
+    ++script_->plans_;
+    return true;
+  }
+
+  virtual bool cancel()
+  {
+    return false;
+  }
+
+private:
+  const std::string type_;
+  const ControllerScriptPtr script_;
+};
+
+//! the scripts of all the fake controller types, created on first use
+class ControllerScripts
+{
+public:
+  ControllerScriptPtr get(const std::string &type)
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    ControllerScriptPtr &script = scripts_[type];
+    if (!script)
+      script = boost::make_shared<ControllerScript>();
+    return script;
+  }
+
+private:
+  std::map<std::string, ControllerScriptPtr> scripts_;
+  boost::mutex mutex_;
+};
+
+//! controller execution loading fake controllers; the type "missing" cannot be loaded
+class TestControllerExecution : public AbstractControllerExecution
+{
+public:
+  TestControllerExecution(const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr,
+                          ControllerScripts &scripts) :
+      AbstractControllerExecution(tf_listener_ptr), scripts_(scripts)
+  {
+  }
+
+  virtual ~TestControllerExecution()
+  {
+    terminate();
+  }
+
+protected:
+  virtual mbf_abstract_core::AbstractController::Ptr loadControllerPlugin(const std::string &controller_type)
+  {
+    if (controller_type == "missing")
+      return mbf_abstract_core::AbstractController::Ptr();
+    return boost::make_shared<FakeController>(controller_type, scripts_.get(controller_type));
+  }
+
+  virtual bool initPlugin(const std::string &name,
+                          const mbf_abstract_core::AbstractController::Ptr &controller_ptr)
+  {
+    return true;
+  }
+
+private:
+  ControllerScripts &scripts_;
+};
+
+//! milliseconds between two time points
+double millis(const TimePoint &from, const TimePoint &to)
+{
+  return boost::chrono::duration<double, boost::milli>(to - from).count();
+}
+
+class AbstractControllerExecutionTest : public testing::Test
+{
+protected:
+  AbstractControllerExecutionTest() : private_nh_("~"), tf_listener_ptr_(new tf::TransformListener())
+  {
+  }
+
+  virtual void SetUp()
+  {
+    // every test starts from the same parameters: a single controller at 50 Hz, without patience nor retries
+    const char *params[] = {"local_planner", "local_planners", "controller_patience", "controller_max_retries",
+                            "controller_frequency"};
+    for (size_t i = 0; i < sizeof(params) / sizeof(params[0]); ++i)
+    {
+      private_nh_.deleteParam(params[i]);
+    }
+    private_nh_.setParam("local_planner", std::string("fake"));
+    private_nh_.setParam("controller_patience", 0.0);
+    private_nh_.setParam("controller_max_retries", 0);
+    private_nh_.setParam("controller_frequency", 50.0);
+
+    Plan plan(2);
+    plan[0].header.frame_id = "map";
+    plan[0].pose.orientation.w = 1.0;
+    plan[1] = plan[0];
+    plan[1].pose.position.x = 2.0;
+    plan_ = boost::make_shared<const Plan>(plan);
+  }
+
+  virtual void TearDown()
+  {
+    execution_.reset();
+  }
+
+  //! creates and initializes the controller execution with the current parameters
+  bool init()
+  {
+    execution_ = boost::make_shared<TestControllerExecution>(tf_listener_ptr_, boost::ref(scripts_));
+    return execution_->initialize();
+  }
+
+  //! starts moving along the test plan
+  bool start()
+  {
+    execution_->setNewPlan(plan_);
+    return execution_->startMoving();
+  }
+
+  //! reconfigures the controller with the given plugin, at 50 Hz, without patience nor retries
+  void reconfigure(const std::string &controller)
+  {
+    mbf_abstract_nav::MoveBaseFlexConfig config = mbf_abstract_nav::MoveBaseFlexConfig::__getDefault__();
+    config.local_planner = controller;
+    config.controller_frequency = 50.0;
+    config.controller_patience = 0.0;
+    config.controller_max_retries = 0;
+    execution_->reconfigure(config);
+  }
+
+  ros::NodeHandle private_nh_;
+  boost::shared_ptr<tf::TransformListener> tf_listener_ptr_;
+  ControllerScripts scripts_;
+  boost::shared_ptr<TestControllerExecution> execution_;
+  PlanConstPtr plan_;
+};
+
+TEST_F(AbstractControllerExecutionTest, periodKeptWhileTheControllerBlocks)
+{
+  // the controller spends most of each 20 ms cycle blocked; that time counts for the period too
+  ASSERT_TRUE(init());
+  scripts_.get("fake")->setCallDuration(boost::chrono::milliseconds(12));
+  ASSERT_TRUE(start());
+  ASSERT_TRUE(scripts_.get("fake")->waitForCalls(26));
+  execution_->stopMoving();
+
+  // 25 cycles of 20 ms; counting only the time not blocked, they would take 32 ms each
+  std::vector<TimePoint> times = scripts_.get("fake")->callTimes();
+  EXPECT_NEAR(500.0, millis(times[0], times[25]), 60.0);
+}
+
+TEST_F(AbstractControllerExecutionTest, noBurstAfterAnOverrun)
+{
+  // the third call takes more than three cycles; the missed cycles are skipped, not caught up
+  ASSERT_TRUE(init());
+  scripts_.get("fake")->setCallDuration(boost::chrono::milliseconds(1), 2, boost::chrono::milliseconds(70));
+  ASSERT_TRUE(start());
+  ASSERT_TRUE(scripts_.get("fake")->waitForCalls(8));
+  execution_->stopMoving();
+
+  std::vector<TimePoint> times = scripts_.get("fake")->callTimes();
+  // the schedule restarts when the overrun ends; catching up would call the controller right away
+  EXPECT_GE(millis(times[2], times[3]), 70.0);
+  for (size_t i = 4; i < 8; ++i)
+  {
+    EXPECT_GT(millis(times[i - 1], times[i]), 5.0) << "cycle " << i;
+  }
+}
+
+TEST_F(AbstractControllerExecutionTest, robotStateFromTheCache)
+{
+  tf::StampedTransform robot_pose(tf::Transform(tf::Quaternion(0.0, 0.0, 0.0, 1.0), tf::Vector3(1.0, 2.0, 0.0)),
+                                  ros::Time::now(), "map", "base_link");
+  tf_listener_ptr_->setTransform(robot_pose);
+  mbf_abstract_nav::RobotStateCache::Ptr robot_state_ptr =
+      boost::make_shared<mbf_abstract_nav::RobotStateCache>(tf_listener_ptr_, "base_link", "map", "odom", 0.0);
+  ASSERT_TRUE(robot_state_ptr->updatePose());
+
+  // the controller gets the cached pose on every call
+  ASSERT_TRUE(init());
+  execution_->setRobotStateCache(robot_state_ptr);
+  ASSERT_TRUE(start());
+  ASSERT_TRUE(scripts_.get("fake")->waitForCalls(3));
+  execution_->stopMoving();
+
+  std::vector<geometry_msgs::PoseStamped> poses = scripts_.get("fake")->poses();
+  for (size_t i = 0; i < 3; ++i)
+  {
+    EXPECT_EQ("map", poses[i].header.frame_id);
+    EXPECT_DOUBLE_EQ(1.0, poses[i].pose.position.x);
+    EXPECT_DOUBLE_EQ(2.0, poses[i].pose.position.y);
+  }
+}
+
+TEST_F(AbstractControllerExecutionTest, pluginSwappedWhileMoving)
+{
+  ASSERT_TRUE(init());
+  ControllerScriptPtr fake = scripts_.get("fake");
+  ControllerScriptPtr slow = scripts_.get("slow");
+  slow->setLoadDuration(boost::chrono::milliseconds(300));
+  ASSERT_TRUE(start());
+  ASSERT_TRUE(fake->waitForCalls(3));
+
+  const TimePoint start = boost::chrono::steady_clock::now();
+  reconfigure("slow");
+  EXPECT_LT(millis(start, boost::chrono::steady_clock::now()), 100.0);
+
+  // the current controller keeps moving the robot while the new one loads
+  EXPECT_TRUE(fake->waitForCalls(fake->callTimes().size() + 5));
+  EXPECT_TRUE(slow->callTimes().empty());
+
+  // then the new one takes over, with the current plan
+  ASSERT_TRUE(slow->waitForCalls(3));
+  EXPECT_EQ(1, slow->plans());
+  const size_t fake_calls = fake->callTimes().size();
+  ASSERT_TRUE(slow->waitForCalls(8));
+  EXPECT_EQ(fake_calls, fake->callTimes().size());
+  EXPECT_TRUE(execution_->isMoving());
+  execution_->stopMoving();
+}
+
+TEST_F(AbstractControllerExecutionTest, namedControllersSelectable)
+{
+  XmlRpc::XmlRpcValue controllers;
+  controllers.setSize(2);
+  controllers[0]["name"] = "a";
+  controllers[0]["type"] = "fake";
+  controllers[1]["name"] = "b";
+  controllers[1]["type"] = "other";
+  private_nh_.setParam("local_planners", controllers);
+  private_nh_.deleteParam("local_planner");
+  ASSERT_TRUE(init());
+  EXPECT_EQ(1, scripts_.get("fake")->instances());
+  EXPECT_EQ(1, scripts_.get("other")->instances());
+  std::vector<std::string> names = execution_->listPlugins();
+  ASSERT_EQ(2u, names.size());
+  EXPECT_EQ("a", names[0]);
+  EXPECT_EQ("b", names[1]);
+
+  // moving with the selected one, which gets the plan
+  EXPECT_FALSE(execution_->selectPlugin("c"));
+  ASSERT_TRUE(execution_->selectPlugin("b"));
+  ASSERT_TRUE(start());
+  ASSERT_TRUE(scripts_.get("other")->waitForCalls(3));
+  execution_->stopMoving();
+  EXPECT_TRUE(scripts_.get("fake")->callTimes().empty());
+  EXPECT_EQ(1, scripts_.get("other")->plans());
+  EXPECT_EQ(0, scripts_.get("fake")->plans());
+}
+
+TEST_F(AbstractControllerExecutionTest, snapshotCarriesTheLastCommand)
+{
+  ASSERT_TRUE(init());
+  const ros::Time before = ros::Time::now();
+  ASSERT_TRUE(start());
+  ASSERT_TRUE(scripts_.get("fake")->waitForCalls(3));
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(5));  // the third call has returned
+
+  AbstractControllerExecution::SnapshotConstPtr snapshot = execution_->getSnapshot();
+  EXPECT_EQ(AbstractControllerExecution::GOT_LOCAL_CMD, snapshot->state);
+  EXPECT_EQ(mbf_msgs::ExePathResult::SUCCESS, snapshot->plugin_code);
+  EXPECT_EQ("fake", snapshot->plugin_msg);
+  EXPECT_EQ("fake", snapshot->vel_cmd.header.frame_id);
+  EXPECT_DOUBLE_EQ(0.1, snapshot->vel_cmd.twist.linear.x);
+  EXPECT_GE(snapshot->start_time, before);
+  EXPECT_GE(snapshot->last_call_time, snapshot->start_time);
+  EXPECT_GE(snapshot->vel_cmd.header.stamp, snapshot->last_call_time);
+  EXPECT_TRUE(snapshot->patience.isZero());
+
+  // every call publishes a new snapshot, leaving the old one untouched
+  const ros::Time last_call_time = snapshot->last_call_time;
+  ASSERT_TRUE(scripts_.get("fake")->waitForCalls(5));
+  execution_->stopMoving();
+  EXPECT_GT(execution_->getSnapshot()->last_call_time, last_call_time);
+  EXPECT_EQ(last_call_time, snapshot->last_call_time);
+  EXPECT_GE(execution_->getSnapshot()->seq, snapshot->seq);
+}
+
+TEST_F(AbstractControllerExecutionTest, patienceInTheSnapshot)
+{
+  private_nh_.setParam("controller_patience", 0.1);
+  ASSERT_TRUE(init());
+  EXPECT_DOUBLE_EQ(0.1, execution_->getSnapshot()->patience.toSec());
+
+  // the second call blocks longer than the patience
+  scripts_.get("fake")->setCallDuration(boost::chrono::milliseconds(1), 1, boost::chrono::milliseconds(300));
+  ASSERT_TRUE(start());
+  ASSERT_TRUE(scripts_.get("fake")->waitForCalls(2));
+  EXPECT_FALSE(execution_->getSnapshot()->isPatienceExceeded());
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(150));
+  EXPECT_TRUE(execution_->getSnapshot()->isPatienceExceeded());
+
+  // reconfiguring the patience updates the snapshot right away
+  reconfigure("fake");
+  EXPECT_TRUE(execution_->getSnapshot()->patience.isZero());
+  EXPECT_FALSE(execution_->getSnapshot()->isPatienceExceeded());
+  execution_->stopMoving();
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "abstract_controller_execution_test");
+  ros::NodeHandle nh;
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,120 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  abstract_execution_base_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include "mbf_abstract_nav/abstract_execution_base.h"
+
+using mbf_abstract_nav::AbstractExecutionBase;
+
+//! execution exposing the protected state update notification
+class TestExecution : public AbstractExecutionBase
+{
+public:
+  void notify()
+  {
+    notifyStateUpdate();
+  }
+};
+
+//! waits for a state update after the given sequence number, and records whether it came within the timeout
+void waitForUpdate(TestExecution *execution, unsigned int seq, bool *updated)
+{
+  *updated = execution->waitForStateUpdate(seq, boost::chrono::seconds(10));
+}
+
+class AbstractExecutionBaseTest : public testing::Test
+{
+protected:
+  TestExecution execution_;
+};
+
+TEST_F(AbstractExecutionBaseTest, timesOutWithoutUpdate)
+{
+  const unsigned int seq = execution_.getUpdateSeq();
+  const boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  EXPECT_FALSE(execution_.waitForStateUpdate(seq, boost::chrono::milliseconds(50)));
+  EXPECT_GE(boost::chrono::steady_clock::now() - start, boost::chrono::milliseconds(50));
+  EXPECT_EQ(seq, execution_.getUpdateSeq());
+}
+
+TEST_F(AbstractExecutionBaseTest, updateBeforeWaitingNotMissed)
+{
+  // an update between reading the sequence number and going to sleep returns right away
+  const unsigned int seq = execution_.getUpdateSeq();
+  execution_.notify();
+  const boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  EXPECT_TRUE(execution_.waitForStateUpdate(seq, boost::chrono::seconds(10)));
+  EXPECT_LT(boost::chrono::steady_clock::now() - start, boost::chrono::seconds(1));
+
+  // but waiting with the up-to-date sequence number doesn't
+  EXPECT_FALSE(execution_.waitForStateUpdate(execution_.getUpdateSeq(), boost::chrono::milliseconds(10)));
+}
+
+TEST_F(AbstractExecutionBaseTest, updateWakesUpAllWaiters)
+{
+  const unsigned int seq = execution_.getUpdateSeq();
+  bool updated[3] = {false, false, false};
+  boost::thread_group waiters;
+  for (int i = 0; i < 3; ++i)
+  {
+    waiters.create_thread(boost::bind(&waitForUpdate, &execution_, seq, &updated[i]));
+  }
+
+  // let the waiters go to sleep; a single update must wake up all of them well before their timeout
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+  const boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  execution_.notify();
+  waiters.join_all();
+  EXPECT_LT(boost::chrono::steady_clock::now() - start, boost::chrono::seconds(1));
+  for (int i = 0; i < 3; ++i)
+  {
+    EXPECT_TRUE(updated[i]);
+  }
+  EXPECT_EQ(seq + 1, execution_.getUpdateSeq());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,265 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  abstract_navigation_server_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include <boost/make_shared.hpp>
+#include <boost/thread.hpp>
+#include <mbf_msgs/StartupReport.h>
+
+#include "mbf_abstract_nav/abstract_navigation_server.h"
+
+using mbf_abstract_nav::AbstractNavigationServer;
+
+//! planner execution without planners; only the startup steps are tested here
+class TestPlannerExecution : public mbf_abstract_nav::AbstractPlannerExecution
+{
+public:
+  virtual ~TestPlannerExecution()
+  {
+    terminate();
+  }
+
+protected:
+  virtual mbf_abstract_core::AbstractPlanner::Ptr loadPlannerPlugin(const std::string &planner_type)
+  {
+    return mbf_abstract_core::AbstractPlanner::Ptr();
+  }
+
+  virtual bool initPlugin(const std::string &name, const mbf_abstract_core::AbstractPlanner::Ptr &planner_ptr)
+  {
+    return true;
+  }
+};
+
+//! controller execution without controllers
+class TestControllerExecution : public mbf_abstract_nav::AbstractControllerExecution
+{
+public:
+  TestControllerExecution(const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr) :
+      AbstractControllerExecution(tf_listener_ptr)
+  {
+  }
+
+  virtual ~TestControllerExecution()
+  {
+    terminate();
+  }
+
+protected:
+  virtual mbf_abstract_core::AbstractController::Ptr loadControllerPlugin(const std::string &controller_type)
+  {
+    return mbf_abstract_core::AbstractController::Ptr();
+  }
+
+  virtual bool initPlugin(const std::string &name,
+                          const mbf_abstract_core::AbstractController::Ptr &controller_ptr)
+  {
+    return true;
+  }
+};
+
+//! recovery execution without recovery behaviors
+class TestRecoveryExecution : public mbf_abstract_nav::AbstractRecoveryExecution
+{
+public:
+  TestRecoveryExecution(const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr) :
+      AbstractRecoveryExecution(tf_listener_ptr)
+  {
+  }
+
+  virtual ~TestRecoveryExecution()
+  {
+    terminate();
+  }
+
+private:
+  virtual mbf_abstract_core::AbstractRecovery::Ptr loadRecoveryPlugin(const std::string &recovery_type)
+  {
+    return mbf_abstract_core::AbstractRecovery::Ptr();
+  }
+
+  virtual void initPlugin(const std::string &name, const mbf_abstract_core::AbstractRecovery::Ptr &behavior)
+  {
+  }
+};
+
+//! navigation server exposing its startup steps
+class TestNavigationServer : public AbstractNavigationServer
+{
+public:
+  TestNavigationServer(const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr) :
+      AbstractNavigationServer(tf_listener_ptr, boost::make_shared<TestPlannerExecution>(),
+                               boost::make_shared<TestControllerExecution>(tf_listener_ptr),
+                               boost::make_shared<TestRecoveryExecution>(tf_listener_ptr))
+  {
+  }
+
+  using AbstractNavigationServer::StartupStep;
+  using AbstractNavigationServer::runStartupSteps;
+};
+
+//! startup step sleeping for the given time and returning the given result
+bool sleepingStep(int millis, bool result)
+{
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(millis));
+  return result;
+}
+
+class AbstractNavigationServerTest : public testing::Test
+{
+protected:
+  AbstractNavigationServerTest() : private_nh_("~"), tf_listener_ptr_(new tf::TransformListener())
+  {
+  }
+
+  virtual void SetUp()
+  {
+    private_nh_.deleteParam("parallel_startup");
+    report_sub_ = private_nh_.subscribe("startup_report", 1, &AbstractNavigationServerTest::reportCb, this);
+  }
+
+  virtual void TearDown()
+  {
+    server_.reset();
+  }
+
+  //! creates the server with the given startup mode
+  void init(bool parallel_startup)
+  {
+    private_nh_.setParam("parallel_startup", parallel_startup);
+    server_.reset(new TestNavigationServer(tf_listener_ptr_));
+  }
+
+  //! three steps of 200 ms each; the second fails if told so
+  std::vector<TestNavigationServer::StartupStep> steps(bool failing = false)
+  {
+    std::vector<TestNavigationServer::StartupStep> steps;
+    steps.push_back(TestNavigationServer::StartupStep("first", boost::bind(&sleepingStep, 200, true)));
+    steps.push_back(TestNavigationServer::StartupStep("second", boost::bind(&sleepingStep, 200, !failing)));
+    steps.push_back(TestNavigationServer::StartupStep("third", boost::bind(&sleepingStep, 200, true)));
+    return steps;
+  }
+
+  //! starts the action servers and waits for the startup report; false if it isn't received within two seconds
+  bool waitForReport()
+  {
+    server_->startActionServers();
+    for (int i = 0; i < 200 && !report_; ++i)
+    {
+      ros::spinOnce();
+      boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+    }
+    return report_.get() != NULL;
+  }
+
+  void reportCb(const mbf_msgs::StartupReport::ConstPtr &report)
+  {
+    report_ = report;
+  }
+
+  ros::NodeHandle private_nh_;
+  ros::Subscriber report_sub_;
+  boost::shared_ptr<tf::TransformListener> tf_listener_ptr_;
+  boost::shared_ptr<TestNavigationServer> server_;
+  mbf_msgs::StartupReport::ConstPtr report_;
+};
+
+TEST_F(AbstractNavigationServerTest, sequentialByDefault)
+{
+  init(false);
+  const boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  EXPECT_TRUE(server_->runStartupSteps(steps()));
+  EXPECT_GE(boost::chrono::steady_clock::now() - start, boost::chrono::milliseconds(600));
+
+  ASSERT_TRUE(waitForReport());
+  ASSERT_EQ(3u, report_->steps.size());
+  ASSERT_EQ(3u, report_->durations.size());
+  EXPECT_EQ("first", report_->steps[0]);
+  EXPECT_EQ("second", report_->steps[1]);
+  EXPECT_EQ("third", report_->steps[2]);
+  for (size_t i = 0; i < report_->durations.size(); ++i)
+  {
+    EXPECT_NEAR(0.2, report_->durations[i], 0.1);
+  }
+  EXPECT_GE(report_->total, 0.6);
+}
+
+TEST_F(AbstractNavigationServerTest, parallelStartup)
+{
+  init(true);
+  const boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  EXPECT_TRUE(server_->runStartupSteps(steps()));
+  EXPECT_LT(boost::chrono::steady_clock::now() - start, boost::chrono::milliseconds(450));
+
+  // every step is reported, in order of completion
+  ASSERT_TRUE(waitForReport());
+  ASSERT_EQ(3u, report_->steps.size());
+  ASSERT_EQ(3u, report_->durations.size());
+  for (size_t i = 0; i < report_->durations.size(); ++i)
+  {
+    EXPECT_NEAR(0.2, report_->durations[i], 0.1);
+  }
+  EXPECT_LT(report_->total, 0.45);
+}
+
+TEST_F(AbstractNavigationServerTest, failuresReported)
+{
+  init(false);
+  EXPECT_FALSE(server_->runStartupSteps(steps(true)));
+
+  // the following steps still run, and the failure is kept on the next ones
+  ASSERT_TRUE(waitForReport());
+  EXPECT_EQ(3u, report_->steps.size());
+  std::vector<TestNavigationServer::StartupStep> more;
+  more.push_back(TestNavigationServer::StartupStep("fourth", boost::bind(&sleepingStep, 0, true)));
+  EXPECT_FALSE(server_->runStartupSteps(more));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "abstract_navigation_server_test");
+  ros::NodeHandle nh;
+  return RUN_ALL_TESTS();
+}
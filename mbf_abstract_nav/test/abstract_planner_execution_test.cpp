@@ -0,0 +1,1161 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  abstract_planner_execution_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include <boost/algorithm/string.hpp>
+#include <boost/atomic.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread.hpp>
+#include <mbf_abstract_core/abstract_planner.h>
+#include <mbf_msgs/GetPathResult.h>
+
+#include "mbf_abstract_nav/abstract_planner_execution.h"
+#include "mbf_abstract_nav/planner_pool.h"
+
+using mbf_abstract_nav::AbstractPlannerExecution;
+using mbf_abstract_nav::Plan;
+using mbf_abstract_nav::PlanConstPtr;
+using mbf_abstract_nav::PlannerPool;
+
+/**
+ * @brief Behaviour of the fake planners of one type, shared by all their instances. While closed, the planners
+ *        block until it's opened or they are canceled. Creating a planner, i.e. loading it, takes the load duration.
+ */
+class PlannerScript
+{
+public:
+  PlannerScript() : outcome_(mbf_msgs::GetPathResult::SUCCESS), cost_(1.0), open_(true), cancelable_(true),
+                    load_duration_(0), instances_(0), calls_(0), cancels_(0), running_(0)
+  {
+  }
+
+  void setOutcome(uint32_t outcome, double cost)
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    outcome_ = outcome;
+    cost_ = cost;
+  }
+
+  void setIntermediateCosts(const std::vector<double> &costs)
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    intermediate_costs_ = costs;
+  }
+
+  void setCancelable(bool cancelable)
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    cancelable_ = cancelable;
+  }
+
+  void setLoadDuration(const boost::chrono::milliseconds &duration)
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    load_duration_ = duration;
+  }
+
+  void setOpen(bool open)
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    open_ = open;
+    cond_.notify_all();
+  }
+
+  //! number of planner instances created so far
+  int instances()
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    return instances_;
+  }
+
+  //! number of makePlan calls so far
+  int calls()
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    return calls_;
+  }
+
+  //! number of cancel calls so far
+  int cancels()
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    return cancels_;
+  }
+
+  //! number of makePlan calls in progress
+  int running()
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    return running_;
+  }
+
+  //! waits until the given number of makePlan calls have started; false if they don't within two seconds
+  bool waitForCalls(int calls)
+  {
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    const boost::chrono::steady_clock::time_point deadline =
+        boost::chrono::steady_clock::now() + boost::chrono::seconds(2);
+    while (calls_ < calls)
+    {
+      if (cond_.wait_until(lock, deadline) == boost::cv_status::timeout)
+        return calls_ >= calls;
+    }
+    return true;
+  }
+
+private:
+  friend class FakePlanner;
+
+  uint32_t outcome_;
+  double cost_;
+  std::vector<double> intermediate_costs_;
+  bool open_;
+  bool cancelable_;
+  boost::chrono::milliseconds load_duration_;
+  int instances_;
+  int calls_;
+  int cancels_;
+  int running_;
+  boost::mutex mutex_;
+  boost::condition_variable cond_;
+};
+
+typedef boost::shared_ptr<PlannerScript> PlannerScriptPtr;
+
+/**
+ * @brief Planner plugin following the script of its type. The plans go straight from start to goal in three poses,
+ *        with the planner type as frame and the plan cost as z coordinate, so the tests can tell them apart.
+ */
+class FakePlanner : public mbf_abstract_core::AbstractPlanner
+{
+public:
+  FakePlanner(const std::string &type, const PlannerScriptPtr &script) : type_(type), script_(script), canceled_(false)
+  {
+    boost::chrono::milliseconds load_duration;
+    {
+      boost::lock_guard<boost::mutex> guard(script_->mutex_);
+      ++script_->instances_;
+      load_duration = script_->load_duration_;
+    }
+    boost::this_thread::sleep_for(load_duration);
+  }
+
+  virtual uint32_t makePlan(const geometry_msgs::PoseStamped &start, const geometry_msgs::PoseStamped &goal,
+                            double tolerance, std::vector<geometry_msgs::PoseStamped> &plan, double &cost,
+                            std::string &message)
+  {
+    // like most planners, without interruption points
+    boost::this_thread::disable_interruption no_interruption;
+
+    std::vector<double> intermediate_costs;
+    {
+      boost::lock_guard<boost::mutex> guard(script_->mutex_);
+      ++script_->calls_;
+      ++script_->running_;
+      canceled_ = false;
+      intermediate_costs = script_->intermediate_costs_;
+      script_->cond_.notify_all();
+    }
+
+    for (size_t i = 0; i < intermediate_costs.size(); ++i)
+    {
+      publishIntermediatePlan(makePath(start, goal, intermediate_costs[i]), intermediate_costs[i]);
+    }
+
+    boost::unique_lock<boost::mutex> lock(script_->mutex_);
+    while (!script_->open_ && !canceled_)
+    {
+      script_->cond_.wait(lock);
+    }
+    --script_->running_;
+    if (canceled_)
+    {
+      message = type_ + " canceled";
+      return mbf_msgs::GetPathResult::CANCELED;
+    }
+    cost = script_->cost_;
+    plan = makePath(start, goal, cost);
+    message = type_ + " done";
+    return script_->outcome_;
+  }
+
+  virtual bool cancel()
+  {
+    boost::lock_guard<boost::mutex> guard(script_->mutex_);
+    ++script_->cancels_;
+    if (!script_->cancelable_)
+      return false;
+    canceled_ = true;
+    script_->cond_.notify_all();
+    return true;
+  }
+
+  //! creates a plan from this planner with the given cost
+  std::vector<geometry_msgs::PoseStamped> makePath(const geometry_msgs::PoseStamped &start,
+                                                   const geometry_msgs::PoseStamped &goal, double cost)
+  {
+    std::vector<geometry_msgs::PoseStamped> path(3);
+    for (size_t i = 0; i < path.size(); ++i)
+    {
+      path[i].header.frame_id = type_;
+      path[i].pose.position.x = start.pose.position.x + i * (goal.pose.position.x - start.pose.position.x) / 2.0;
+      path[i].pose.position.y = start.pose.position.y + i * (goal.pose.position.y - start.pose.position.y) / 2.0;
+      path[i].pose.position.z = cost;
+      path[i].pose.orientation.w = 1.0;
+    }
+    return path;
+  }
+
+private:
+  const std::string type_;
+  const PlannerScriptPtr script_;
+  bool canceled_;  //!< protected by the script mutex
+};
+
+//! the scripts of all the fake planner types, created on first use
+class PlannerScripts
+{
+public:
+  PlannerScriptPtr get(const std::string &type)
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    PlannerScriptPtr &script = scripts_[type];
+    if (!script)
+      script = boost::make_shared<PlannerScript>();
+    return script;
+  }
+
+private:
+  std::map<std::string, PlannerScriptPtr> scripts_;
+  boost::mutex mutex_;
+};
+
+//! planner execution loading fake planners; the type "missing" cannot be loaded
+class TestPlannerExecution : public AbstractPlannerExecution
+{
+public:
+  TestPlannerExecution(PlannerScripts &scripts) : scripts_(scripts)
+  {
+  }
+
+  virtual ~TestPlannerExecution()
+  {
+    terminate();
+  }
+
+protected:
+  virtual mbf_abstract_core::AbstractPlanner::Ptr loadPlannerPlugin(const std::string &planner_type)
+  {
+    if (planner_type == "missing")
+      return mbf_abstract_core::AbstractPlanner::Ptr();
+    return boost::make_shared<FakePlanner>(planner_type, scripts_.get(planner_type));
+  }
+
+  virtual bool initPlugin(const std::string &name, const mbf_abstract_core::AbstractPlanner::Ptr &planner_ptr)
+  {
+    return true;
+  }
+
+private:
+  PlannerScripts &scripts_;
+};
+
+//! creates a new planner execution for the planner pool
+AbstractPlannerExecution::Ptr createExecution(PlannerScripts *scripts)
+{
+  return boost::make_shared<TestPlannerExecution>(boost::ref(*scripts));
+}
+
+//! collects the plans found while replanning
+class PlanCollector
+{
+public:
+  void add(const PlanConstPtr &plan, double cost)
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    plans_.push_back(plan);
+  }
+
+  size_t size()
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    return plans_.size();
+  }
+
+  //! waits until the given number of plans have been collected; false if they aren't within two seconds
+  bool waitForPlans(size_t count)
+  {
+    for (int i = 0; i < 200 && size() < count; ++i)
+    {
+      boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+    }
+    return size() >= count;
+  }
+
+private:
+  std::vector<PlanConstPtr> plans_;
+  boost::mutex mutex_;
+};
+
+//! provides the given start pose for replanning
+bool getStart(const geometry_msgs::PoseStamped &start, geometry_msgs::PoseStamped &current_start)
+{
+  current_start = start;
+  return true;
+}
+
+class AbstractPlannerExecutionTest : public testing::Test
+{
+protected:
+  AbstractPlannerExecutionTest() : private_nh_("~")
+  {
+  }
+
+  virtual void SetUp()
+  {
+    // every test starts from the same parameters: a single planner, planning once, without patience nor retries
+    const char *params[] = {"global_planner", "global_planners", "planner_patience", "planner_max_retries",
+                            "planner_frequency", "planner_race_name", "planner_race_planners", "planner_race_mode",
+                            "planner_race_deadline"};
+    for (size_t i = 0; i < sizeof(params) / sizeof(params[0]); ++i)
+    {
+      private_nh_.deleteParam(params[i]);
+    }
+    private_nh_.setParam("global_planner", std::string("fake"));
+    private_nh_.setParam("planner_patience", 0.0);
+    private_nh_.setParam("planner_max_retries", 0);
+
+    start_.header.frame_id = "map";
+    start_.pose.orientation.w = 1.0;
+    goal_ = start_;
+    goal_.pose.position.x = 2.0;
+  }
+
+  virtual void TearDown()
+  {
+    execution_.reset();
+  }
+
+  //! creates and initializes the execution with the current parameters
+  bool init()
+  {
+    execution_.reset(new TestPlannerExecution(scripts_));
+    return execution_->initialize();
+  }
+
+  //! waits until the execution reaches the given state; false if it doesn't within two seconds
+  bool waitForState(AbstractPlannerExecution::PlanningState state)
+  {
+    const boost::chrono::steady_clock::time_point deadline =
+        boost::chrono::steady_clock::now() + boost::chrono::seconds(2);
+    while (true)
+    {
+      const unsigned int seq = execution_->getUpdateSeq();
+      if (execution_->getState() == state)
+        return true;
+      const boost::chrono::steady_clock::duration left = deadline - boost::chrono::steady_clock::now();
+      if (left <= boost::chrono::steady_clock::duration::zero() ||
+          !execution_->waitForStateUpdate(seq, boost::chrono::duration_cast<boost::chrono::microseconds>(left)))
+        return execution_->getState() == state;
+    }
+  }
+
+  //! sets the global_planners list, with the given names and types, and no global_planner
+  void setPlanners(const std::string &names, const std::string &types)
+  {
+    std::vector<std::string> name_list, type_list;
+    boost::split(name_list, names, boost::is_any_of(" "));
+    boost::split(type_list, types, boost::is_any_of(" "));
+    XmlRpc::XmlRpcValue planners;
+    planners.setSize(name_list.size());
+    for (size_t i = 0; i < name_list.size(); ++i)
+    {
+      planners[i]["name"] = name_list[i];
+      planners[i]["type"] = type_list[i];
+    }
+    private_nh_.setParam("global_planners", planners);
+    private_nh_.deleteParam("global_planner");
+  }
+
+  //! configures the race "race" between the given planners, named after their types, and selects it
+  bool initRace(const std::string &planners, const std::string &mode = "first", double deadline = 0.0)
+  {
+    setPlanners("fake " + planners, "fake " + planners);
+    std::vector<std::string> racers;
+    boost::split(racers, planners, boost::is_any_of(" "));
+    private_nh_.setParam("planner_race_name", std::string("race"));
+    private_nh_.setParam("planner_race_planners", racers);
+    private_nh_.setParam("planner_race_mode", mode);
+    private_nh_.setParam("planner_race_deadline", deadline);
+    return init() && execution_->selectPlugin("race");
+  }
+
+  //! plans once from start to goal and returns the type of the planner that found the plan
+  std::string plannedWith()
+  {
+    PlanConstPtr plan;
+    double cost;
+    if (!execution_->startPlanning(start_, goal_, 0.0) || !waitForState(AbstractPlannerExecution::FOUND_PLAN))
+      return "";
+    execution_->getNewPlan(plan, cost);
+    return plan ? plan->front().header.frame_id : "";
+  }
+
+  //! plans until the given planner type is used; false if it isn't within two seconds
+  bool waitForPlanner(const std::string &type)
+  {
+    for (int i = 0; i < 200; ++i)
+    {
+      if (plannedWith() == type)
+        return true;
+      boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+    }
+    return false;
+  }
+
+  //! reconfigures the planner with the given plugin, planning once, without patience nor retries
+  void reconfigure(const std::string &planner)
+  {
+    mbf_abstract_nav::MoveBaseFlexConfig config = mbf_abstract_nav::MoveBaseFlexConfig::__getDefault__();
+    config.global_planner = planner;
+    config.planner_frequency = 0.0;
+    config.planner_patience = 0.0;
+    config.planner_max_retries = 0;
+    execution_->reconfigure(config);
+  }
+
+  ros::NodeHandle private_nh_;
+  PlannerScripts scripts_;
+  boost::shared_ptr<TestPlannerExecution> execution_;
+  geometry_msgs::PoseStamped start_;
+  geometry_msgs::PoseStamped goal_;
+};
+
+TEST_F(AbstractPlannerExecutionTest, planIsSharedNotCopied)
+{
+  ASSERT_TRUE(init());
+  ASSERT_TRUE(execution_->startPlanning(start_, goal_, 0.0));
+  ASSERT_TRUE(waitForState(AbstractPlannerExecution::FOUND_PLAN));
+
+  PlanConstPtr plan, same_plan;
+  double cost, same_cost;
+  execution_->getNewPlan(plan, cost);
+  execution_->getNewPlan(same_plan, same_cost);
+  ASSERT_TRUE(plan);
+  EXPECT_EQ(plan.get(), same_plan.get());
+  EXPECT_EQ(3u, plan->size());
+  EXPECT_EQ("fake", plan->front().header.frame_id);
+  EXPECT_DOUBLE_EQ(1.0, cost);
+
+  // a new plan replaces the shared one, but the readers of the old one keep it untouched
+  scripts_.get("fake")->setOutcome(mbf_msgs::GetPathResult::SUCCESS, 2.0);
+  ASSERT_TRUE(execution_->startPlanning(start_, goal_, 0.0));
+  ASSERT_TRUE(waitForState(AbstractPlannerExecution::FOUND_PLAN));
+  PlanConstPtr new_plan;
+  execution_->getNewPlan(new_plan, cost);
+  ASSERT_TRUE(new_plan);
+  EXPECT_NE(plan.get(), new_plan.get());
+  EXPECT_DOUBLE_EQ(2.0, new_plan->front().pose.position.z);
+  EXPECT_DOUBLE_EQ(1.0, plan->front().pose.position.z);
+}
+
+TEST_F(AbstractPlannerExecutionTest, replanningStreamsPlans)
+{
+  private_nh_.setParam("planner_frequency", 50.0);
+  ASSERT_TRUE(init());
+
+  PlanCollector plans;
+  ASSERT_TRUE(execution_->startReplanning(goal_, 0.0, boost::bind(&getStart, start_, _1),
+                                          boost::bind(&PlanCollector::add, &plans, _1, _2)));
+  EXPECT_TRUE(plans.waitForPlans(3));
+  EXPECT_GE(scripts_.get("fake")->calls(), 3);
+
+  execution_->stopReplanning();
+  EXPECT_EQ(AbstractPlannerExecution::STOPPED, execution_->getState());
+  const size_t found = plans.size();
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+  EXPECT_LE(plans.size(), found + 1);  // at most the plan of a cycle that was about to deliver it
+}
+
+TEST_F(AbstractPlannerExecutionTest, stopReplanningDoesntWaitForThePlanner)
+{
+  private_nh_.setParam("planner_frequency", 50.0);
+  ASSERT_TRUE(init());
+  PlanConstPtr first_plan;
+  double cost;
+  ASSERT_TRUE(execution_->startPlanning(start_, goal_, 0.0));
+  ASSERT_TRUE(waitForState(AbstractPlannerExecution::FOUND_PLAN));
+  execution_->getNewPlan(first_plan, cost);
+
+  // the planner can neither be canceled nor interrupted
+  PlannerScriptPtr script = scripts_.get("fake");
+  script->setCancelable(false);
+  script->setOpen(false);
+  script->setOutcome(mbf_msgs::GetPathResult::SUCCESS, 5.0);
+
+  PlanCollector plans;
+  ASSERT_TRUE(execution_->startReplanning(goal_, 0.0, boost::bind(&getStart, start_, _1),
+                                          boost::bind(&PlanCollector::add, &plans, _1, _2)));
+  ASSERT_TRUE(script->waitForCalls(2));
+
+  const boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  execution_->stopReplanning();
+  EXPECT_LT(boost::chrono::steady_clock::now() - start, boost::chrono::milliseconds(100));
+  EXPECT_EQ(1, script->running());
+  EXPECT_EQ(AbstractPlannerExecution::STOPPED, execution_->getState());
+
+  // once the planner returns, the outdated run neither delivers its plan nor changes the state or the outcome
+  script->setOpen(true);
+  for (int i = 0; i < 100 && script->running(); ++i)
+  {
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+  }
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+  EXPECT_EQ(0u, plans.size());
+  EXPECT_EQ(AbstractPlannerExecution::STOPPED, execution_->getState());
+  PlanConstPtr plan;
+  execution_->getNewPlan(plan, cost);
+  EXPECT_EQ(first_plan.get(), plan.get());
+  uint32_t outcome;
+  std::string message;
+  execution_->getPluginInfo(outcome, message);
+  EXPECT_EQ("fake done", message);
+  EXPECT_DOUBLE_EQ(1.0, cost);
+}
+
+TEST_F(AbstractPlannerExecutionTest, newRunWhileTheOutdatedOneFinishes)
+{
+  private_nh_.setParam("planner_frequency", 50.0);
+  ASSERT_TRUE(init());
+  PlannerScriptPtr script = scripts_.get("fake");
+  script->setCancelable(false);
+  script->setOpen(false);
+
+  PlanCollector plans;
+  ASSERT_TRUE(execution_->startReplanning(goal_, 0.0, boost::bind(&getStart, start_, _1),
+                                          boost::bind(&PlanCollector::add, &plans, _1, _2)));
+  ASSERT_TRUE(script->waitForCalls(1));
+  execution_->stopReplanning();
+
+  // the new run waits for the outdated one to return, and then plans as usual
+  ASSERT_TRUE(execution_->startPlanning(start_, goal_, 0.0));
+  EXPECT_EQ(AbstractPlannerExecution::STARTED, execution_->getState());
+  script->setOutcome(mbf_msgs::GetPathResult::SUCCESS, 3.0);
+  script->setOpen(true);
+  ASSERT_TRUE(waitForState(AbstractPlannerExecution::FOUND_PLAN));
+  PlanConstPtr plan;
+  double cost;
+  execution_->getNewPlan(plan, cost);
+  ASSERT_TRUE(plan);
+  EXPECT_DOUBLE_EQ(3.0, cost);
+  EXPECT_EQ(0u, plans.size());
+  EXPECT_EQ(2, script->calls());
+}
+
+TEST_F(AbstractPlannerExecutionTest, newRunRightAfterTheEnd)
+{
+  // a finished run doesn't take over the next one, started as soon as its final state is seen; the window for that
+  // is narrow, so it takes many runs to hit it
+  ASSERT_TRUE(init());
+  for (int i = 0; i < 200; ++i)
+  {
+    ASSERT_TRUE(execution_->startPlanning(start_, goal_, 0.0));
+    ASSERT_TRUE(waitForState(AbstractPlannerExecution::FOUND_PLAN));
+  }
+  EXPECT_EQ(200, scripts_.get("fake")->calls());
+}
+
+//! waits for a new intermediate plan of the given cost; false if there's none within two seconds
+bool waitForIntermediatePlan(AbstractPlannerExecution &execution, double expected_cost, PlanConstPtr &plan)
+{
+  double cost = 0.0;
+  for (int i = 0; i < 200; ++i)
+  {
+    if (execution.getNewIntermediatePlan(plan, cost) && cost == expected_cost)
+      return true;
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+  }
+  return false;
+}
+
+TEST_F(AbstractPlannerExecutionTest, bestIntermediatePlanKept)
+{
+  ASSERT_TRUE(init());
+  PlannerScriptPtr script = scripts_.get("fake");
+  std::vector<double> costs;
+  costs.push_back(5.0);
+  costs.push_back(3.0);
+  costs.push_back(4.0);
+  script->setIntermediateCosts(costs);
+  script->setOpen(false);
+
+  // the worse plan reported last doesn't replace the best one; each one is returned only once
+  ASSERT_TRUE(execution_->startPlanning(start_, goal_, 0.0));
+  PlanConstPtr plan;
+  double cost;
+  ASSERT_TRUE(waitForIntermediatePlan(*execution_, 3.0, plan));
+  ASSERT_TRUE(plan);
+  EXPECT_DOUBLE_EQ(3.0, plan->front().pose.position.z);
+  EXPECT_FALSE(execution_->getNewIntermediatePlan(plan, cost));
+
+  // the final plan is the one returned by the planner
+  script->setOpen(true);
+  ASSERT_TRUE(waitForState(AbstractPlannerExecution::FOUND_PLAN));
+  execution_->getNewPlan(plan, cost);
+  EXPECT_DOUBLE_EQ(1.0, cost);
+}
+
+TEST_F(AbstractPlannerExecutionTest, intermediatePlanUsedWhenPatienceRunsOut)
+{
+  private_nh_.setParam("planner_patience", 0.2);
+  ASSERT_TRUE(init());
+  PlannerScriptPtr script = scripts_.get("fake");
+  std::vector<double> costs;
+  costs.push_back(5.0);
+  costs.push_back(3.0);
+  script->setIntermediateCosts(costs);
+  script->setOpen(false);
+
+  // the server cancels the planner once the patience is exceeded
+  ASSERT_TRUE(execution_->startPlanning(start_, goal_, 0.0));
+  PlanConstPtr plan;
+  ASSERT_TRUE(waitForIntermediatePlan(*execution_, 3.0, plan));
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(300));
+  ASSERT_TRUE(execution_->isPatienceExceeded());
+  ASSERT_TRUE(execution_->cancel());
+
+  ASSERT_TRUE(waitForState(AbstractPlannerExecution::FOUND_PLAN));
+  double cost;
+  execution_->getNewPlan(plan, cost);
+  ASSERT_TRUE(plan);
+  EXPECT_DOUBLE_EQ(3.0, cost);
+  EXPECT_DOUBLE_EQ(3.0, plan->front().pose.position.z);
+  uint32_t outcome;
+  std::string message;
+  execution_->getPluginInfo(outcome, message);
+  EXPECT_EQ(0u, outcome);
+}
+
+TEST_F(AbstractPlannerExecutionTest, patienceExceededWithoutIntermediatePlans)
+{
+  private_nh_.setParam("planner_patience", 0.2);
+  ASSERT_TRUE(init());
+  scripts_.get("fake")->setOpen(false);
+
+  ASSERT_TRUE(execution_->startPlanning(start_, goal_, 0.0));
+  ASSERT_TRUE(scripts_.get("fake")->waitForCalls(1));
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(300));
+  ASSERT_TRUE(execution_->isPatienceExceeded());
+  ASSERT_TRUE(execution_->cancel());
+  EXPECT_TRUE(waitForState(AbstractPlannerExecution::PAT_EXCEEDED));
+}
+
+TEST_F(AbstractPlannerExecutionTest, intermediatePlansDiscardedOnNewPlanning)
+{
+  ASSERT_TRUE(init());
+  PlannerScriptPtr script = scripts_.get("fake");
+  script->setIntermediateCosts(std::vector<double>(1, 5.0));
+  ASSERT_TRUE(execution_->startPlanning(start_, goal_, 0.0));
+  ASSERT_TRUE(waitForState(AbstractPlannerExecution::FOUND_PLAN));
+
+  // a worse plan from a new planning is still reported
+  script->setIntermediateCosts(std::vector<double>(1, 7.0));
+  script->setOpen(false);
+  ASSERT_TRUE(execution_->startPlanning(start_, goal_, 0.0));
+  PlanConstPtr plan;
+  EXPECT_TRUE(waitForIntermediatePlan(*execution_, 7.0, plan));
+  script->setOpen(true);
+  ASSERT_TRUE(waitForState(AbstractPlannerExecution::FOUND_PLAN));
+}
+
+//! plans a batch of queries on the given pool, as the GetPaths service does
+void makePlans(PlannerPool *pool, const std::string &planner, const std::vector<PlannerPool::Query> *queries,
+               std::vector<PlannerPool::Answer> *answers)
+{
+  pool->makePlans(planner, *queries, *answers);
+}
+
+TEST_F(AbstractPlannerExecutionTest, pluginSwappedOnReconfigure)
+{
+  ASSERT_TRUE(init());
+  EXPECT_EQ("fake", plannedWith());
+
+  reconfigure("other");
+  EXPECT_TRUE(waitForPlanner("other"));
+  EXPECT_EQ(1, scripts_.get("other")->instances());
+
+  // the plugins loaded are kept, so switching back doesn't load it again
+  reconfigure("fake");
+  EXPECT_TRUE(waitForPlanner("fake"));
+  EXPECT_EQ(1, scripts_.get("fake")->instances());
+}
+
+TEST_F(AbstractPlannerExecutionTest, reconfigureDoesntWaitForThePluginToLoad)
+{
+  ASSERT_TRUE(init());
+  scripts_.get("slow")->setLoadDuration(boost::chrono::milliseconds(500));
+
+  const boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  reconfigure("slow");
+  EXPECT_LT(boost::chrono::steady_clock::now() - start, boost::chrono::milliseconds(100));
+
+  // the current planner keeps planning while the new one loads
+  EXPECT_EQ("fake", plannedWith());
+  EXPECT_TRUE(waitForPlanner("slow"));
+}
+
+TEST_F(AbstractPlannerExecutionTest, currentPluginKeptIfTheNewOneFailsToLoad)
+{
+  ASSERT_TRUE(init());
+  reconfigure("missing");
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(200));
+  EXPECT_EQ("fake", plannedWith());
+}
+
+TEST_F(AbstractPlannerExecutionTest, latestPluginRequestWins)
+{
+  ASSERT_TRUE(init());
+  scripts_.get("slow")->setLoadDuration(boost::chrono::milliseconds(300));
+  reconfigure("slow");
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(50));  // the slow one is loading now
+  reconfigure("other");
+
+  // the slow planner, loaded once the other is requested, is never swapped in
+  EXPECT_TRUE(waitForPlanner("other"));
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(400));
+  EXPECT_EQ("other", plannedWith());
+}
+
+TEST_F(AbstractPlannerExecutionTest, namedPlannersPreloaded)
+{
+  setPlanners("a b", "fake other");
+  ASSERT_TRUE(init());
+  EXPECT_EQ(1, scripts_.get("fake")->instances());
+  EXPECT_EQ(1, scripts_.get("other")->instances());
+  std::vector<std::string> names = execution_->listPlugins();
+  ASSERT_EQ(2u, names.size());
+  EXPECT_EQ("a", names[0]);
+  EXPECT_EQ("b", names[1]);
+
+  // the first one is the default
+  EXPECT_EQ("fake", plannedWith());
+  std::string default_planner;
+  EXPECT_TRUE(private_nh_.getParam("global_planner", default_planner));
+  EXPECT_EQ("a", default_planner);
+}
+
+TEST_F(AbstractPlannerExecutionTest, plannerSelectedByNameOrType)
+{
+  setPlanners("a b", "fake other");
+  ASSERT_TRUE(init());
+
+  ASSERT_TRUE(execution_->selectPlugin("b"));
+  EXPECT_EQ("other", plannedWith());
+  ASSERT_TRUE(execution_->selectPlugin("fake"));
+  EXPECT_EQ("fake", plannedWith());
+  ASSERT_TRUE(execution_->selectPlugin("other"));
+  EXPECT_EQ("other", plannedWith());
+
+  // no name selects the default, and an unknown one is rejected, keeping the current planner
+  ASSERT_TRUE(execution_->selectPlugin(""));
+  EXPECT_EQ("fake", plannedWith());
+  EXPECT_FALSE(execution_->selectPlugin("c"));
+  EXPECT_EQ("fake", plannedWith());
+
+  // no planner is loaded on selection
+  EXPECT_EQ(1, scripts_.get("fake")->instances());
+  EXPECT_EQ(1, scripts_.get("other")->instances());
+}
+
+TEST_F(AbstractPlannerExecutionTest, defaultPlannerFromTheList)
+{
+  setPlanners("a b", "fake other");
+  private_nh_.setParam("global_planner", std::string("b"));
+  ASSERT_TRUE(init());
+  EXPECT_EQ("other", plannedWith());
+
+  private_nh_.setParam("global_planner", std::string("c"));
+  EXPECT_FALSE(init());
+}
+
+TEST_F(AbstractPlannerExecutionTest, plannerNamesMustBeUnique)
+{
+  setPlanners("a a", "fake other");
+  EXPECT_FALSE(init());
+}
+
+TEST_F(AbstractPlannerExecutionTest, singlePlannerNamedAfterItsClass)
+{
+  private_nh_.setParam("global_planner", std::string("fake_planners/Fake"));
+  ASSERT_TRUE(init());
+  std::vector<std::string> names = execution_->listPlugins();
+  ASSERT_EQ(1u, names.size());
+  EXPECT_EQ("Fake", names[0]);
+  EXPECT_EQ("fake_planners/Fake", plannedWith());
+}
+
+TEST_F(AbstractPlannerExecutionTest, raceWonByTheFirstPlan)
+{
+  PlannerScriptPtr quick = scripts_.get("quick");
+  quick->setOutcome(mbf_msgs::GetPathResult::SUCCESS, 2.0);
+  quick->setOpen(false);
+  scripts_.get("slow")->setOutcome(mbf_msgs::GetPathResult::SUCCESS, 1.0);
+  scripts_.get("slow")->setOpen(false);
+  ASSERT_TRUE(initRace("quick slow"));
+
+  // each racer plans with its own instance; once the quick one finishes, the loser is canceled
+  ASSERT_TRUE(execution_->startPlanning(start_, goal_, 0.0));
+  ASSERT_TRUE(quick->waitForCalls(1));
+  ASSERT_TRUE(scripts_.get("slow")->waitForCalls(1));
+  quick->setOpen(true);
+  ASSERT_TRUE(waitForState(AbstractPlannerExecution::FOUND_PLAN));
+  PlanConstPtr plan;
+  double cost;
+  execution_->getNewPlan(plan, cost);
+  ASSERT_TRUE(plan);
+  EXPECT_EQ("quick", plan->front().header.frame_id);
+  EXPECT_DOUBLE_EQ(2.0, cost);
+  EXPECT_EQ(2, scripts_.get("slow")->instances());
+  EXPECT_EQ(1, scripts_.get("slow")->calls());
+  EXPECT_EQ(1, scripts_.get("slow")->cancels());
+  for (int i = 0; i < 100 && scripts_.get("slow")->running(); ++i)
+  {
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(0, scripts_.get("slow")->running());
+}
+
+TEST_F(AbstractPlannerExecutionTest, raceWonByTheBestPlanWithinTheDeadline)
+{
+  scripts_.get("quick")->setOutcome(mbf_msgs::GetPathResult::SUCCESS, 2.0);
+  scripts_.get("cheap")->setOutcome(mbf_msgs::GetPathResult::SUCCESS, 1.0);
+  scripts_.get("cheap")->setOpen(false);
+  ASSERT_TRUE(initRace("quick cheap", "best", 0.5));
+
+  ASSERT_TRUE(execution_->startPlanning(start_, goal_, 0.0));
+  ASSERT_TRUE(scripts_.get("quick")->waitForCalls(1));
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+  EXPECT_EQ(AbstractPlannerExecution::PLANNING, execution_->getState());
+  scripts_.get("cheap")->setOpen(true);
+  ASSERT_TRUE(waitForState(AbstractPlannerExecution::FOUND_PLAN));
+
+  PlanConstPtr plan;
+  double cost;
+  execution_->getNewPlan(plan, cost);
+  ASSERT_TRUE(plan);
+  EXPECT_EQ("cheap", plan->front().header.frame_id);
+  EXPECT_DOUBLE_EQ(1.0, cost);
+}
+
+TEST_F(AbstractPlannerExecutionTest, raceEndedByTheDeadline)
+{
+  scripts_.get("quick")->setOutcome(mbf_msgs::GetPathResult::SUCCESS, 2.0);
+  scripts_.get("cheap")->setOutcome(mbf_msgs::GetPathResult::SUCCESS, 1.0);
+  scripts_.get("cheap")->setOpen(false);
+  ASSERT_TRUE(initRace("quick cheap", "best", 0.2));
+
+  const boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  EXPECT_EQ("quick", plannedWith());
+  const boost::chrono::steady_clock::duration elapsed = boost::chrono::steady_clock::now() - start;
+  EXPECT_GE(elapsed, boost::chrono::milliseconds(190));
+  EXPECT_LT(elapsed, boost::chrono::milliseconds(400));
+  EXPECT_EQ(1, scripts_.get("cheap")->cancels());
+}
+
+TEST_F(AbstractPlannerExecutionTest, busyRacerAbandonedAndLeftOut)
+{
+  // the slow planner can neither be canceled nor interrupted
+  PlannerScriptPtr slow = scripts_.get("slow");
+  slow->setCancelable(false);
+  slow->setOpen(false);
+  PlannerScriptPtr quick = scripts_.get("quick");
+  quick->setOpen(false);
+  ASSERT_TRUE(initRace("quick slow"));
+
+  // the race doesn't wait for the loser to return
+  ASSERT_TRUE(execution_->startPlanning(start_, goal_, 0.0));
+  ASSERT_TRUE(quick->waitForCalls(1));
+  ASSERT_TRUE(slow->waitForCalls(1));
+  quick->setOpen(true);
+  ASSERT_TRUE(waitForState(AbstractPlannerExecution::FOUND_PLAN));
+  EXPECT_EQ(1, slow->running());
+
+  // it sits out the next races while still running the first one
+  EXPECT_EQ("quick", plannedWith());
+  EXPECT_EQ(2, scripts_.get("quick")->calls());
+  EXPECT_EQ(1, slow->calls());
+
+  // and joins them again once it returns
+  slow->setOpen(true);
+  for (int i = 0; i < 100 && slow->running(); ++i)
+  {
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+  }
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+  quick->setOpen(false);
+  ASSERT_TRUE(execution_->startPlanning(start_, goal_, 0.0));
+  EXPECT_TRUE(slow->waitForCalls(2));
+  quick->setOpen(true);
+  EXPECT_TRUE(waitForState(AbstractPlannerExecution::FOUND_PLAN));
+}
+
+TEST_F(AbstractPlannerExecutionTest, noRaceWhileAllRacersAreBusy)
+{
+  PlannerScriptPtr slow = scripts_.get("slow");
+  slow->setCancelable(false);
+  slow->setOpen(false);
+  ASSERT_TRUE(initRace("slow"));
+
+  ASSERT_TRUE(execution_->startPlanning(start_, goal_, 0.0));
+  ASSERT_TRUE(slow->waitForCalls(1));
+  EXPECT_FALSE(execution_->cancel());
+  ASSERT_TRUE(waitForState(AbstractPlannerExecution::CANCELED));
+
+  ASSERT_TRUE(execution_->startPlanning(start_, goal_, 0.0));
+  ASSERT_TRUE(waitForState(AbstractPlannerExecution::NO_PLAN_FOUND));
+  uint32_t outcome;
+  std::string message;
+  execution_->getPluginInfo(outcome, message);
+  EXPECT_EQ(mbf_msgs::GetPathResult::INTERNAL_ERROR, outcome);
+  EXPECT_EQ(1, slow->calls());
+  slow->setOpen(true);
+}
+
+TEST_F(AbstractPlannerExecutionTest, snapshotsDontChange)
+{
+  ASSERT_TRUE(init());
+  ASSERT_TRUE(execution_->startPlanning(start_, goal_, 0.0));
+  ASSERT_TRUE(waitForState(AbstractPlannerExecution::FOUND_PLAN));
+
+  // reading the same state twice gets the same snapshot, not a copy
+  AbstractPlannerExecution::SnapshotConstPtr found = execution_->getSnapshot();
+  EXPECT_EQ(found.get(), execution_->getSnapshot().get());
+  EXPECT_EQ(AbstractPlannerExecution::FOUND_PLAN, found->state);
+  EXPECT_EQ(mbf_msgs::GetPathResult::SUCCESS, found->plugin_code);
+  EXPECT_EQ("fake done", found->plugin_msg);
+  EXPECT_FALSE(found->last_cycle_start_time.isZero());
+
+  // a new state is published as a new snapshot, with a higher sequence number
+  scripts_.get("fake")->setOutcome(mbf_msgs::GetPathResult::NO_PATH_FOUND, 0.0);
+  ASSERT_TRUE(execution_->startPlanning(start_, goal_, 0.0));
+  ASSERT_TRUE(waitForState(AbstractPlannerExecution::NO_PLAN_FOUND));
+  AbstractPlannerExecution::SnapshotConstPtr not_found = execution_->getSnapshot();
+  EXPECT_GT(not_found->seq, found->seq);
+  EXPECT_EQ(mbf_msgs::GetPathResult::NO_PATH_FOUND, not_found->plugin_code);
+  EXPECT_EQ(AbstractPlannerExecution::FOUND_PLAN, found->state);
+  EXPECT_EQ(mbf_msgs::GetPathResult::SUCCESS, found->plugin_code);
+  EXPECT_EQ("fake done", found->plugin_msg);
+}
+
+//! reads snapshots until stopped, counting those whose final state doesn't match their plugin outcome
+void readSnapshots(AbstractPlannerExecution *execution, const boost::atomic<bool> *stop, int *inconsistent)
+{
+  while (!*stop)
+  {
+    AbstractPlannerExecution::SnapshotConstPtr snapshot = execution->getSnapshot();
+    if ((snapshot->state == AbstractPlannerExecution::FOUND_PLAN &&
+         snapshot->plugin_code != mbf_msgs::GetPathResult::SUCCESS) ||
+        (snapshot->state == AbstractPlannerExecution::NO_PLAN_FOUND &&
+         snapshot->plugin_code != mbf_msgs::GetPathResult::NO_PATH_FOUND))
+      ++*inconsistent;
+  }
+}
+
+TEST_F(AbstractPlannerExecutionTest, snapshotsConsistentWhilePlanning)
+{
+  ASSERT_TRUE(init());
+  boost::atomic<bool> stop(false);
+  int inconsistent = 0;
+  boost::thread reader(&readSnapshots, execution_.get(), &stop, &inconsistent);
+
+  // alternate successful and failed runs, while the snapshots are read concurrently
+  PlannerScriptPtr script = scripts_.get("fake");
+  for (int i = 0; i < 100; ++i)
+  {
+    const bool success = i % 2 == 0;
+    const uint32_t outcome = success ? static_cast<uint32_t>(mbf_msgs::GetPathResult::SUCCESS)
+                                     : static_cast<uint32_t>(mbf_msgs::GetPathResult::NO_PATH_FOUND);
+    script->setOutcome(outcome, 1.0);
+    ASSERT_TRUE(execution_->startPlanning(start_, goal_, 0.0));
+    ASSERT_TRUE(waitForState(success ? AbstractPlannerExecution::FOUND_PLAN : AbstractPlannerExecution::NO_PLAN_FOUND));
+  }
+  stop = true;
+  reader.join();
+  EXPECT_EQ(0, inconsistent);
+}
+
+TEST_F(AbstractPlannerExecutionTest, patienceInTheSnapshot)
+{
+  private_nh_.setParam("planner_patience", 0.2);
+  ASSERT_TRUE(init());
+  EXPECT_DOUBLE_EQ(0.2, execution_->getSnapshot()->patience.toSec());
+
+  PlannerScriptPtr script = scripts_.get("fake");
+  script->setOpen(false);
+  ASSERT_TRUE(execution_->startPlanning(start_, goal_, 0.0));
+  ASSERT_TRUE(script->waitForCalls(1));
+  EXPECT_FALSE(execution_->getSnapshot()->isPatienceExceeded());
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(300));
+  EXPECT_TRUE(execution_->getSnapshot()->isPatienceExceeded());
+
+  // reconfiguring the patience updates the snapshot right away
+  reconfigure("fake");
+  EXPECT_TRUE(execution_->getSnapshot()->patience.isZero());
+  EXPECT_FALSE(execution_->getSnapshot()->isPatienceExceeded());
+  execution_->cancel();
+  ASSERT_TRUE(waitForState(AbstractPlannerExecution::CANCELED));
+}
+
+class PlannerPoolTest : public AbstractPlannerExecutionTest
+{
+protected:
+  //! creates and initializes a planner pool with the given number of slots
+  bool initPool(unsigned int size)
+  {
+    pool_.reset(new PlannerPool(boost::bind(&createExecution, &scripts_), size));
+    return pool_->initialize();
+  }
+
+  //! creates the given number of queries, each with its own goal
+  std::vector<PlannerPool::Query> makeQueries(size_t count)
+  {
+    std::vector<PlannerPool::Query> queries(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+      queries[i].start = start_;
+      queries[i].goal = goal_;
+      queries[i].goal.pose.position.y = i;
+      queries[i].tolerance = 0.0;
+    }
+    return queries;
+  }
+
+  virtual void TearDown()
+  {
+    pool_.reset();
+    AbstractPlannerExecutionTest::TearDown();
+  }
+
+  boost::shared_ptr<PlannerPool> pool_;
+};
+
+TEST_F(PlannerPoolTest, everySlotHasItsOwnInstance)
+{
+  ASSERT_TRUE(initPool(3));
+  EXPECT_EQ(3, scripts_.get("fake")->instances());
+}
+
+TEST_F(PlannerPoolTest, queriesPlannedInParallel)
+{
+  ASSERT_TRUE(initPool(3));
+  PlannerScriptPtr script = scripts_.get("fake");
+  script->setOpen(false);
+
+  std::vector<PlannerPool::Query> queries = makeQueries(3);
+  std::vector<PlannerPool::Answer> answers;
+  boost::thread batch(boost::bind(&makePlans, pool_.get(), std::string(), &queries, &answers));
+
+  // all the queries are being planned at the same time
+  EXPECT_TRUE(script->waitForCalls(3));
+  EXPECT_EQ(3, script->running());
+  script->setOpen(true);
+  ASSERT_TRUE(batch.try_join_for(boost::chrono::seconds(2)));
+
+  ASSERT_EQ(3u, answers.size());
+  for (size_t i = 0; i < answers.size(); ++i)
+  {
+    EXPECT_EQ(mbf_msgs::GetPathResult::SUCCESS, answers[i].outcome);
+    ASSERT_TRUE(answers[i].plan);
+    ASSERT_EQ(3u, answers[i].plan->size());
+    EXPECT_DOUBLE_EQ(i, answers[i].plan->back().pose.position.y);  // the answers keep the order of the queries
+  }
+}
+
+TEST_F(PlannerPoolTest, moreQueriesThanSlots)
+{
+  ASSERT_TRUE(initPool(2));
+  std::vector<PlannerPool::Query> queries = makeQueries(5);
+  std::vector<PlannerPool::Answer> answers;
+  pool_->makePlans("", queries, answers);
+  ASSERT_EQ(5u, answers.size());
+  for (size_t i = 0; i < answers.size(); ++i)
+  {
+    EXPECT_EQ(mbf_msgs::GetPathResult::SUCCESS, answers[i].outcome);
+    ASSERT_TRUE(answers[i].plan);
+    EXPECT_DOUBLE_EQ(i, answers[i].plan->back().pose.position.y);
+  }
+  EXPECT_EQ(5, scripts_.get("fake")->calls());
+}
+
+TEST_F(PlannerPoolTest, requestedPlannerUsed)
+{
+  ASSERT_TRUE(initPool(2));
+  std::vector<PlannerPool::Query> queries = makeQueries(3);
+  std::vector<PlannerPool::Answer> answers;
+  pool_->makePlans("other", queries, answers);
+  ASSERT_EQ(3u, answers.size());
+  for (size_t i = 0; i < answers.size(); ++i)
+  {
+    EXPECT_EQ(mbf_msgs::GetPathResult::SUCCESS, answers[i].outcome);
+    ASSERT_TRUE(answers[i].plan);
+    EXPECT_EQ("other", answers[i].plan->front().header.frame_id);
+  }
+  EXPECT_EQ(0, scripts_.get("fake")->calls());
+
+  // a planner that cannot be loaded answers every query with an error
+  pool_->makePlans("missing", queries, answers);
+  ASSERT_EQ(3u, answers.size());
+  for (size_t i = 0; i < answers.size(); ++i)
+  {
+    EXPECT_EQ(mbf_msgs::GetPathResult::INVALID_PLUGIN, answers[i].outcome);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "abstract_planner_execution_test");
+  ros::NodeHandle nh;
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,251 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  abstract_recovery_execution_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include <boost/make_shared.hpp>
+#include <boost/thread.hpp>
+#include <mbf_abstract_core/abstract_recovery.h>
+
+#include "mbf_abstract_nav/abstract_recovery_execution.h"
+
+using mbf_abstract_nav::AbstractRecoveryExecution;
+
+//! recovery behavior plugin succeeding right away
+class FakeRecovery : public mbf_abstract_core::AbstractRecovery
+{
+public:
+  virtual uint32_t runBehavior(std::string &message)
+  {
+    return 0;
+  }
+
+  virtual bool cancel()
+  {
+    return false;
+  }
+};
+
+//! recovery execution loading fake recovery behaviors and recording the loaded types and the initialized names;
+//! the type "missing" cannot be loaded
+class TestRecoveryExecution : public AbstractRecoveryExecution
+{
+public:
+  TestRecoveryExecution() : AbstractRecoveryExecution(boost::shared_ptr<tf::TransformListener>())
+  {
+  }
+
+  virtual ~TestRecoveryExecution()
+  {
+    terminate();
+  }
+
+  std::vector<std::string> loaded()
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    return loaded_;
+  }
+
+  std::vector<std::string> initialized()
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    return initialized_;
+  }
+
+private:
+  virtual mbf_abstract_core::AbstractRecovery::Ptr loadRecoveryPlugin(const std::string &recovery_type)
+  {
+    if (recovery_type == "missing")
+      return mbf_abstract_core::AbstractRecovery::Ptr();
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    loaded_.push_back(recovery_type);
+    return boost::make_shared<FakeRecovery>();
+  }
+
+  virtual void initPlugin(const std::string &name, const mbf_abstract_core::AbstractRecovery::Ptr &behavior)
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    initialized_.push_back(name);
+  }
+
+  std::vector<std::string> loaded_;
+  std::vector<std::string> initialized_;
+  boost::mutex mutex_;
+};
+
+class AbstractRecoveryExecutionTest : public testing::Test
+{
+protected:
+  AbstractRecoveryExecutionTest() : private_nh_("~")
+  {
+  }
+
+  virtual void SetUp()
+  {
+    private_nh_.deleteParam("lazy_recovery_loading");
+    behaviors_ = XmlRpc::XmlRpcValue();
+    behaviors_.setSize(0);
+  }
+
+  virtual void TearDown()
+  {
+    execution_.reset();
+  }
+
+  void addBehavior(const std::string &name, const std::string &type)
+  {
+    const int i = behaviors_.size();
+    behaviors_.setSize(i + 1);
+    behaviors_[i]["name"] = name;
+    behaviors_[i]["type"] = type;
+  }
+
+  //! creates and initializes the execution with the current parameters
+  void init(bool lazy_loading)
+  {
+    private_nh_.setParam("lazy_recovery_loading", lazy_loading);
+    private_nh_.setParam("recovery_behaviors", behaviors_);
+    execution_.reset(new TestRecoveryExecution());
+    ASSERT_TRUE(execution_->initialize());
+  }
+
+  //! runs the given recovery behavior and returns the state it ends in
+  AbstractRecoveryExecution::RecoveryState run(const std::string &name)
+  {
+    EXPECT_TRUE(execution_->startRecovery(name));
+    const boost::chrono::steady_clock::time_point deadline =
+        boost::chrono::steady_clock::now() + boost::chrono::seconds(2);
+    while (true)
+    {
+      const unsigned int seq = execution_->getUpdateSeq();
+      const AbstractRecoveryExecution::RecoveryState state = execution_->getState();
+      if (state != AbstractRecoveryExecution::STARTED && state != AbstractRecoveryExecution::RECOVERING)
+        return state;
+      const boost::chrono::steady_clock::duration left = deadline - boost::chrono::steady_clock::now();
+      if (left <= boost::chrono::steady_clock::duration::zero() ||
+          !execution_->waitForStateUpdate(seq, boost::chrono::duration_cast<boost::chrono::microseconds>(left)))
+        return execution_->getState();
+    }
+  }
+
+  ros::NodeHandle private_nh_;
+  XmlRpc::XmlRpcValue behaviors_;
+  boost::shared_ptr<TestRecoveryExecution> execution_;
+};
+
+TEST_F(AbstractRecoveryExecutionTest, loadedOnInitialization)
+{
+  addBehavior("clear", "fake_clear");
+  addBehavior("rotate", "fake_rotate");
+  init(false);
+
+  ASSERT_EQ(2u, execution_->loaded().size());
+  EXPECT_EQ(2u, execution_->initialized().size());
+  EXPECT_TRUE(execution_->hasRecoveryBehavior("clear"));
+
+  EXPECT_EQ(AbstractRecoveryExecution::RECOVERY_DONE, run("rotate"));
+  EXPECT_EQ(2u, execution_->loaded().size());
+}
+
+TEST_F(AbstractRecoveryExecutionTest, lazyLoadedOnFirstUse)
+{
+  addBehavior("clear", "fake_clear");
+  addBehavior("rotate", "fake_rotate");
+  init(true);
+
+  // only registered on initialization
+  EXPECT_TRUE(execution_->loaded().empty());
+  EXPECT_TRUE(execution_->initialized().empty());
+  EXPECT_TRUE(execution_->hasRecoveryBehavior("clear"));
+  EXPECT_TRUE(execution_->hasRecoveryBehavior("rotate"));
+  std::string type;
+  ASSERT_TRUE(execution_->getTypeOfBehavior("rotate", type));
+  EXPECT_EQ("fake_rotate", type);
+
+  // loaded and initialized once, on first use
+  EXPECT_EQ(AbstractRecoveryExecution::RECOVERY_DONE, run("rotate"));
+  EXPECT_EQ(AbstractRecoveryExecution::RECOVERY_DONE, run("rotate"));
+  ASSERT_EQ(1u, execution_->loaded().size());
+  EXPECT_EQ("fake_rotate", execution_->loaded()[0]);
+  ASSERT_EQ(1u, execution_->initialized().size());
+  EXPECT_EQ("rotate", execution_->initialized()[0]);
+}
+
+TEST_F(AbstractRecoveryExecutionTest, lazyLoadingFailureReportedOnUse)
+{
+  addBehavior("broken", "missing");
+  init(true);
+
+  EXPECT_TRUE(execution_->hasRecoveryBehavior("broken"));
+  EXPECT_EQ(AbstractRecoveryExecution::WRONG_NAME, run("broken"));
+  EXPECT_TRUE(execution_->initialized().empty());
+}
+
+TEST_F(AbstractRecoveryExecutionTest, unknownBehaviorNotLoaded)
+{
+  addBehavior("clear", "fake_clear");
+  init(true);
+
+  EXPECT_FALSE(execution_->hasRecoveryBehavior("rotate"));
+  EXPECT_EQ(AbstractRecoveryExecution::WRONG_NAME, run("rotate"));
+  EXPECT_TRUE(execution_->loaded().empty());
+}
+
+TEST_F(AbstractRecoveryExecutionTest, namesMustBeUnique)
+{
+  addBehavior("clear", "fake_clear");
+  addBehavior("clear", "fake_rotate");
+  init(true);
+
+  EXPECT_EQ(AbstractRecoveryExecution::RECOVERY_DONE, run("clear"));
+  ASSERT_EQ(1u, execution_->loaded().size());
+  EXPECT_EQ("fake_clear", execution_->loaded()[0]);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "abstract_recovery_execution_test");
+  ros::NodeHandle nh;
+  return RUN_ALL_TESTS();
+}
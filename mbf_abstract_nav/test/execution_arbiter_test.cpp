@@ -0,0 +1,137 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  execution_arbiter_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include "mbf_abstract_nav/execution_arbiter.h"
+
+using mbf_abstract_nav::ExecutionArbiter;
+
+//! claims the given executions, as a goal thread does, and stores the ticket received
+void claim(ExecutionArbiter *arbiter, unsigned int executions, unsigned int *ticket)
+{
+  *ticket = arbiter->acquire(executions);
+}
+
+class ExecutionArbiterTest : public testing::Test
+{
+protected:
+  //! waits until the claim with the given ticket is asked to preempt; false if it doesn't happen within a second
+  bool waitForPreemption(unsigned int ticket)
+  {
+    for (int i = 0; i < 100 && !arbiter_.isPreempted(ticket); ++i)
+    {
+      boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+    }
+    return arbiter_.isPreempted(ticket);
+  }
+
+  ExecutionArbiter arbiter_;
+};
+
+TEST_F(ExecutionArbiterTest, disjointClaimsDontInterfere)
+{
+  // e.g. a recovery action while the robot is planning
+  const unsigned int planner = arbiter_.acquire(ExecutionArbiter::PLANNER);
+  const unsigned int recovery = arbiter_.acquire(ExecutionArbiter::RECOVERY);
+  EXPECT_NE(0u, planner);
+  EXPECT_NE(0u, recovery);
+  EXPECT_NE(planner, recovery);
+  EXPECT_FALSE(arbiter_.isPreempted(planner));
+  EXPECT_FALSE(arbiter_.isPreempted(recovery));
+}
+
+TEST_F(ExecutionArbiterTest, newerGoalPreemptsAndWaitsForTheHolder)
+{
+  // MoveBase holds all the executions; a new ExePath goal claims the controller
+  const unsigned int move_base = arbiter_.acquire(ExecutionArbiter::PLANNER | ExecutionArbiter::CONTROLLER |
+                                                  ExecutionArbiter::RECOVERY);
+  unsigned int exe_path = 0;
+  boost::thread goal(boost::bind(&claim, &arbiter_, ExecutionArbiter::CONTROLLER, &exe_path));
+
+  // the holder is asked to preempt, but keeps the executions until it releases them
+  ASSERT_TRUE(waitForPreemption(move_base));
+  EXPECT_FALSE(goal.try_join_for(boost::chrono::milliseconds(50)));
+
+  arbiter_.release(move_base);
+  ASSERT_TRUE(goal.try_join_for(boost::chrono::seconds(1)));
+  EXPECT_NE(0u, exe_path);
+  EXPECT_FALSE(arbiter_.isPreempted(exe_path));
+}
+
+TEST_F(ExecutionArbiterTest, waitingGoalSupersededByANewerOne)
+{
+  const unsigned int holder = arbiter_.acquire(ExecutionArbiter::CONTROLLER);
+  unsigned int older = 1;
+  boost::thread older_goal(boost::bind(&claim, &arbiter_, ExecutionArbiter::CONTROLLER, &older));
+  ASSERT_TRUE(waitForPreemption(holder));
+
+  // the goal still waiting for the holder gives up as soon as an even newer goal comes
+  unsigned int newer = 0;
+  boost::thread newer_goal(boost::bind(&claim, &arbiter_, ExecutionArbiter::CONTROLLER, &newer));
+  ASSERT_TRUE(older_goal.try_join_for(boost::chrono::seconds(1)));
+  EXPECT_EQ(0u, older);
+
+  // the newest goal gets the controller once the holder releases it
+  EXPECT_FALSE(newer_goal.try_join_for(boost::chrono::milliseconds(50)));
+  arbiter_.release(holder);
+  ASSERT_TRUE(newer_goal.try_join_for(boost::chrono::seconds(1)));
+  EXPECT_NE(0u, newer);
+}
+
+TEST_F(ExecutionArbiterTest, releasedTicketsAreNoLongerValid)
+{
+  const unsigned int ticket = arbiter_.acquire(ExecutionArbiter::PLANNER);
+  arbiter_.release(ticket);
+  EXPECT_TRUE(arbiter_.isPreempted(ticket));
+
+  // releasing twice or releasing no ticket at all is harmless
+  arbiter_.release(ticket);
+  arbiter_.release(0);
+  EXPECT_NE(0u, arbiter_.acquire(ExecutionArbiter::PLANNER));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,210 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  feedback_throttle_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <cmath>
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+
+#include "mbf_abstract_nav/feedback_throttle.h"
+
+using mbf_abstract_nav::FeedbackThrottle;
+
+class FeedbackThrottleTest : public testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    // simulated time, so the test controls the clock
+    ros::Time::setNow(ros::Time(100.0));
+    pose_.pose.orientation.w = 1.0;
+  }
+
+  //! checks the given throttle at the given time, relative to the start of the test, with the current robot state
+  bool checkAt(FeedbackThrottle &throttle, double t)
+  {
+    ros::Time::setNow(ros::Time(100.0 + t));
+    return throttle.check(pose_, velocity_);
+  }
+
+  //! moves the robot by the given distance along x
+  void move(double dx)
+  {
+    pose_.pose.position.x += dx;
+  }
+
+  //! rotates the robot to the given yaw
+  void rotate(double yaw)
+  {
+    pose_.pose.orientation.z = sin(yaw / 2.0);
+    pose_.pose.orientation.w = cos(yaw / 2.0);
+  }
+
+  geometry_msgs::PoseStamped pose_;
+  geometry_msgs::TwistStamped velocity_;
+};
+
+TEST_F(FeedbackThrottleTest, noLimitsPublishesEverything)
+{
+  FeedbackThrottle throttle;
+  EXPECT_TRUE(checkAt(throttle, 0.0));
+  EXPECT_TRUE(checkAt(throttle, 0.0));
+  EXPECT_TRUE(checkAt(throttle, 0.001));
+}
+
+TEST_F(FeedbackThrottleTest, firstFeedbackAfterResetAlwaysPublished)
+{
+  FeedbackThrottle throttle(1.0, 1.0, 1.0, 1.0);
+  EXPECT_TRUE(checkAt(throttle, 0.0));
+  EXPECT_FALSE(checkAt(throttle, 0.1));
+
+  // a new goal gets its feedback right away, even within the rate period and without any change
+  throttle.reset();
+  EXPECT_TRUE(checkAt(throttle, 0.2));
+  EXPECT_FALSE(checkAt(throttle, 0.3));
+}
+
+TEST_F(FeedbackThrottleTest, rateLimited)
+{
+  FeedbackThrottle throttle(10.0);
+  EXPECT_TRUE(checkAt(throttle, 0.0));
+  move(1.0);
+  EXPECT_FALSE(checkAt(throttle, 0.05));
+  EXPECT_FALSE(checkAt(throttle, 0.099));
+  EXPECT_TRUE(checkAt(throttle, 0.1));
+
+  // the period counts from the last published feedback, not from the last check
+  EXPECT_FALSE(checkAt(throttle, 0.15));
+  EXPECT_TRUE(checkAt(throttle, 0.2));
+}
+
+TEST_F(FeedbackThrottleTest, updatesCoalescedIntoTheNextPublished)
+{
+  FeedbackThrottle throttle(10.0, 0.1);
+  EXPECT_TRUE(checkAt(throttle, 0.0));
+
+  // a big move within the rate period is not published, but it's not lost either: the next check after the period
+  // publishes it, although the robot didn't move since the suppressed update
+  move(1.0);
+  EXPECT_FALSE(checkAt(throttle, 0.05));
+  EXPECT_TRUE(checkAt(throttle, 0.1));
+
+  // once published, the same state is not published again
+  EXPECT_FALSE(checkAt(throttle, 0.2));
+  EXPECT_FALSE(checkAt(throttle, 0.3));
+}
+
+TEST_F(FeedbackThrottleTest, smallMovesAccumulate)
+{
+  FeedbackThrottle throttle(0.0, 0.1);
+  EXPECT_TRUE(checkAt(throttle, 0.0));
+
+  // the displacement is measured from the last published pose, so small moves add up until they are published
+  move(0.04);
+  EXPECT_FALSE(checkAt(throttle, 0.1));
+  move(0.04);
+  EXPECT_FALSE(checkAt(throttle, 0.2));
+  move(0.04);
+  EXPECT_TRUE(checkAt(throttle, 0.3));
+  move(0.04);
+  EXPECT_FALSE(checkAt(throttle, 0.4));
+}
+
+TEST_F(FeedbackThrottleTest, rotation)
+{
+  FeedbackThrottle throttle(0.0, 1.0, 0.1);
+  EXPECT_TRUE(checkAt(throttle, 0.0));
+  rotate(0.05);
+  EXPECT_FALSE(checkAt(throttle, 0.1));
+  rotate(0.12);
+  EXPECT_TRUE(checkAt(throttle, 0.2));
+  rotate(0.15);
+  EXPECT_FALSE(checkAt(throttle, 0.3));
+
+  // rotating back is a change too
+  rotate(0.0);
+  EXPECT_TRUE(checkAt(throttle, 0.4));
+}
+
+TEST_F(FeedbackThrottleTest, velocity)
+{
+  FeedbackThrottle throttle(0.0, 1.0, 1.0, 0.1);
+  EXPECT_TRUE(checkAt(throttle, 0.0));
+  velocity_.twist.linear.x = 0.05;
+  EXPECT_FALSE(checkAt(throttle, 0.1));
+  velocity_.twist.linear.x = 0.1;
+  EXPECT_TRUE(checkAt(throttle, 0.2));
+  velocity_.twist.linear.y = -0.1;
+  EXPECT_TRUE(checkAt(throttle, 0.3));
+  velocity_.twist.angular.z = 0.5;
+  EXPECT_TRUE(checkAt(throttle, 0.4));
+  EXPECT_FALSE(checkAt(throttle, 0.5));
+}
+
+TEST_F(FeedbackThrottleTest, zeroThresholdIgnored)
+{
+  // only the displacement matters; velocity and rotation changes alone don't publish
+  FeedbackThrottle throttle(0.0, 0.1);
+  EXPECT_TRUE(checkAt(throttle, 0.0));
+  velocity_.twist.linear.x = 1.0;
+  rotate(1.0);
+  EXPECT_FALSE(checkAt(throttle, 0.1));
+  move(0.1);
+  EXPECT_TRUE(checkAt(throttle, 0.2));
+}
+
+TEST_F(FeedbackThrottleTest, keepalive)
+{
+  FeedbackThrottle throttle(10.0, 1.0, 1.0, 1.0, 2.0);
+  EXPECT_TRUE(checkAt(throttle, 0.0));
+  EXPECT_FALSE(checkAt(throttle, 1.0));
+  EXPECT_FALSE(checkAt(throttle, 1.9));
+  EXPECT_TRUE(checkAt(throttle, 2.0));
+
+  // the keep-alive period also counts from the last published feedback
+  EXPECT_FALSE(checkAt(throttle, 3.0));
+  EXPECT_TRUE(checkAt(throttle, 4.0));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::Time::init();
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,160 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  latency_histogram_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <cmath>
+#include <gtest/gtest.h>
+
+#include "mbf_abstract_nav/latency_histogram.h"
+
+using mbf_abstract_nav::LatencyHistogram;
+
+TEST(LatencyHistogramTest, empty)
+{
+  LatencyHistogram histogram;
+  EXPECT_EQ(0u, histogram.count());
+  EXPECT_EQ(0u, histogram.min());
+  EXPECT_EQ(0u, histogram.max());
+  EXPECT_EQ(0.0, histogram.mean());
+  EXPECT_EQ(0u, histogram.percentile(0.5));
+  EXPECT_EQ(0u, histogram.percentile(1.0));
+}
+
+TEST(LatencyHistogramTest, exactStats)
+{
+  LatencyHistogram histogram;
+  histogram.record(1000);
+  histogram.record(3);
+  histogram.record(250000);
+  histogram.record(77);
+  EXPECT_EQ(4u, histogram.count());
+  EXPECT_EQ(3u, histogram.min());
+  EXPECT_EQ(250000u, histogram.max());
+  EXPECT_DOUBLE_EQ((1000.0 + 3.0 + 250000.0 + 77.0) / 4.0, histogram.mean());
+}
+
+TEST(LatencyHistogramTest, smallValuesHaveTheirOwnBucket)
+{
+  // values below two sub-bucket ranges map one to one to buckets
+  LatencyHistogram histogram;
+  for (uint64_t value = 0; value < 32; ++value)
+    histogram.record(value);
+
+  for (uint64_t value = 0; value < 32; ++value)
+    EXPECT_EQ(value, histogram.percentile((value + 1) / 32.0)) << "value " << value;
+}
+
+TEST(LatencyHistogramTest, bucketsAccurateToAFewPercent)
+{
+  // a value shares its bucket with values up to 1/16 apart, and the bucket is reported by its middle value
+  for (double value = 32.0; value < 1e12; value *= 1.37)
+  {
+    LatencyHistogram histogram;
+    histogram.record(static_cast<uint64_t>(value));
+    histogram.record(static_cast<uint64_t>(value * 100.0));
+    double median = histogram.percentile(0.5);
+    EXPECT_NEAR(static_cast<uint64_t>(value), median, value / 32.0 + 1.0) << "value " << value;
+  }
+}
+
+TEST(LatencyHistogramTest, bucketBoundaries)
+{
+  // 32 to 63 are split in 16 buckets of width 2; 64 to 127 in 16 buckets of width 4
+  LatencyHistogram histogram;
+  histogram.record(64);
+  histogram.record(67);
+  histogram.record(68);
+  histogram.record(1000000);
+  EXPECT_EQ(histogram.percentile(0.25), histogram.percentile(0.5));
+  EXPECT_LT(histogram.percentile(0.5), histogram.percentile(0.75));
+  EXPECT_LE(64u, histogram.percentile(0.5));
+  EXPECT_GE(67u, histogram.percentile(0.5));
+}
+
+TEST(LatencyHistogramTest, percentilesFollowTheDistribution)
+{
+  LatencyHistogram histogram;
+  for (uint64_t value = 1; value <= 10000; ++value)
+    histogram.record(value);
+
+  const double fractions[] = {0.01, 0.1, 0.5, 0.9, 0.99, 0.999};
+  uint64_t previous = 0;
+  for (size_t i = 0; i < sizeof(fractions) / sizeof(fractions[0]); ++i)
+  {
+    uint64_t percentile = histogram.percentile(fractions[i]);
+    double expected = fractions[i] * 10000;
+    EXPECT_NEAR(expected, percentile, expected / 16.0) << "fraction " << fractions[i];
+    EXPECT_LE(previous, percentile);
+    previous = percentile;
+  }
+
+  // never beyond the longest duration
+  EXPECT_NEAR(10000.0, histogram.percentile(1.0), 10000.0 / 32.0);
+  EXPECT_GE(10000u, histogram.percentile(1.0));
+}
+
+TEST(LatencyHistogramTest, hugeValuesClamped)
+{
+  LatencyHistogram histogram;
+  histogram.record(static_cast<uint64_t>(1) << 50);
+  EXPECT_EQ((static_cast<uint64_t>(1) << 40) - 1, histogram.max());
+  EXPECT_NEAR(histogram.max(), histogram.percentile(0.5), histogram.max() / 32.0);
+}
+
+TEST(LatencyHistogramTest, reset)
+{
+  LatencyHistogram histogram;
+  histogram.record(5);
+  histogram.record(500);
+  histogram.reset();
+  EXPECT_EQ(0u, histogram.count());
+  EXPECT_EQ(0u, histogram.max());
+  EXPECT_EQ(0u, histogram.percentile(0.5));
+
+  histogram.record(40);
+  EXPECT_EQ(1u, histogram.count());
+  EXPECT_EQ(40u, histogram.min());
+  EXPECT_EQ(40u, histogram.max());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,151 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  navigation_utility_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <cmath>
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include <tf/transform_datatypes.h>
+#include <tf/transform_listener.h>
+
+#include "mbf_abstract_nav/navigation_utility.h"
+
+using mbf_abstract_nav::Plan;
+
+class TransformPlanTest : public testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    // odom is 1 m ahead and 2 m left of the map origin, turned 90 degrees to the left
+    tf::StampedTransform odom(tf::Transform(tf::createQuaternionFromYaw(M_PI_2), tf::Vector3(1.0, 2.0, 0.0)),
+                              ros::Time::now(), "map", "odom");
+    tf_listener_.setTransform(odom);
+    // and the robot 1 m ahead in odom
+    tf::StampedTransform base(tf::Transform(tf::createQuaternionFromYaw(0.0), tf::Vector3(1.0, 0.0, 0.0)),
+                              ros::Time::now(), "map", "base_link");
+    tf_listener_.setTransform(base);
+  }
+
+  //! appends a pose in the given frame, at the latest available transformation
+  void addPose(Plan &plan, const std::string &frame, double x, double y, double yaw)
+  {
+    geometry_msgs::PoseStamped pose;
+    pose.header.frame_id = frame;
+    pose.header.seq = plan.size();
+    pose.pose.position.x = x;
+    pose.pose.position.y = y;
+    pose.pose.orientation = tf::createQuaternionMsgFromYaw(yaw);
+    plan.push_back(pose);
+  }
+
+  //! checks a pose of the transformed plan
+  void expectPose(const geometry_msgs::PoseStamped &pose, double x, double y, double yaw)
+  {
+    EXPECT_EQ("map", pose.header.frame_id);
+    EXPECT_NEAR(x, pose.pose.position.x, 1e-9);
+    EXPECT_NEAR(y, pose.pose.position.y, 1e-9);
+    EXPECT_NEAR(0.0, remainder(yaw - tf::getYaw(pose.pose.orientation), 2.0 * M_PI), 1e-9);
+  }
+
+  tf::TransformListener tf_listener_;
+};
+
+TEST_F(TransformPlanTest, posesInTheTargetFrameCopied)
+{
+  Plan plan, global_plan;
+  addPose(plan, "map", 1.0, 2.0, 0.5);
+  addPose(plan, "map", 3.0, 4.0, -0.5);
+  ASSERT_TRUE(mbf_abstract_nav::transformPlan(tf_listener_, "map", ros::Duration(0.1), plan, global_plan));
+  ASSERT_EQ(2u, global_plan.size());
+  expectPose(global_plan[0], 1.0, 2.0, 0.5);
+  expectPose(global_plan[1], 3.0, 4.0, -0.5);
+}
+
+TEST_F(TransformPlanTest, wholePlanTransformed)
+{
+  Plan plan, global_plan;
+  addPose(plan, "odom", 0.0, 0.0, 0.0);
+  addPose(plan, "odom", 1.0, 0.0, 0.0);
+  addPose(plan, "odom", 1.0, 1.0, M_PI_2);
+  ASSERT_TRUE(mbf_abstract_nav::transformPlan(tf_listener_, "map", ros::Duration(0.1), plan, global_plan));
+  ASSERT_EQ(3u, global_plan.size());
+  expectPose(global_plan[0], 1.0, 2.0, M_PI_2);
+  expectPose(global_plan[1], 1.0, 3.0, M_PI_2);
+  expectPose(global_plan[2], 0.0, 3.0, M_PI);
+
+  // the poses keep their headers, apart from the frame
+  for (size_t i = 0; i < plan.size(); ++i)
+  {
+    EXPECT_EQ(plan[i].header.seq, global_plan[i].header.seq);
+    EXPECT_EQ(plan[i].header.stamp, global_plan[i].header.stamp);
+  }
+}
+
+TEST_F(TransformPlanTest, mixedFrames)
+{
+  // each pose is transformed from its own frame, although the previous one was in another frame
+  Plan plan, global_plan;
+  addPose(plan, "odom", 1.0, 0.0, 0.0);
+  addPose(plan, "base_link", 1.0, 0.0, 0.0);
+  addPose(plan, "map", 1.0, 0.0, 0.0);
+  addPose(plan, "odom", 2.0, 0.0, 0.0);
+  ASSERT_TRUE(mbf_abstract_nav::transformPlan(tf_listener_, "map", ros::Duration(0.1), plan, global_plan));
+  ASSERT_EQ(4u, global_plan.size());
+  expectPose(global_plan[0], 1.0, 3.0, M_PI_2);
+  expectPose(global_plan[1], 2.0, 0.0, 0.0);
+  expectPose(global_plan[2], 1.0, 0.0, 0.0);
+  expectPose(global_plan[3], 1.0, 4.0, M_PI_2);
+}
+
+TEST_F(TransformPlanTest, unknownFrameFails)
+{
+  Plan plan, global_plan;
+  addPose(plan, "odom", 1.0, 0.0, 0.0);
+  addPose(plan, "nowhere", 1.0, 0.0, 0.0);
+  EXPECT_FALSE(mbf_abstract_nav::transformPlan(tf_listener_, "map", ros::Duration(0.05), plan, global_plan));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "navigation_utility_test");
+  ros::NodeHandle nh;
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,231 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  path_publisher_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <gtest/gtest.h>
+
+#include "mbf_abstract_nav/path_publisher.h"
+
+using mbf_abstract_nav::Plan;
+using mbf_abstract_nav::PathPublisher;
+
+//! appends a pose at the given position to the plan
+void addPose(Plan &plan, double x, double y)
+{
+  geometry_msgs::PoseStamped pose;
+  pose.pose.position.x = x;
+  pose.pose.position.y = y;
+  pose.pose.orientation.w = 1.0;
+  plan.push_back(pose);
+}
+
+//! random walk with smooth heading changes, like a real plan
+Plan randomPlan(size_t size, unsigned int seed)
+{
+  std::srand(seed);
+  Plan plan;
+  double x = 0.0, y = 0.0, heading = 0.0;
+  for (size_t i = 0; i < size; ++i)
+  {
+    addPose(plan, x, y);
+    heading += 0.4 * (std::rand() / (double)RAND_MAX - 0.5);
+    x += 0.05 * cos(heading);
+    y += 0.05 * sin(heading);
+  }
+  return plan;
+}
+
+//! distance on the x-y plane from p to the segment from a to b
+double segmentDistance(const geometry_msgs::Point &p, const geometry_msgs::Point &a, const geometry_msgs::Point &b)
+{
+  const double dx = b.x - a.x;
+  const double dy = b.y - a.y;
+  const double length2 = dx * dx + dy * dy;
+  double t = length2 > 0.0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / length2 : 0.0;
+  t = std::max(0.0, std::min(1.0, t));
+  return hypot(p.x - (a.x + t * dx), p.y - (a.y + t * dy));
+}
+
+//! checks that the indices start and end with the plan endpoints, and are strictly increasing
+void expectEndpointsAndOrder(const Plan &plan, const std::vector<size_t> &indices)
+{
+  ASSERT_FALSE(indices.empty());
+  EXPECT_EQ(0u, indices.front());
+  EXPECT_EQ(plan.size() - 1, indices.back());
+  for (size_t k = 1; k < indices.size(); ++k)
+  {
+    EXPECT_LT(indices[k - 1], indices[k]);
+  }
+}
+
+//! largest distance from a pose of the plan to the segment of the simplified path replacing it
+double maxDeviation(const Plan &plan, const std::vector<size_t> &indices)
+{
+  double max_deviation = 0.0;
+  for (size_t k = 1; k < indices.size(); ++k)
+  {
+    const geometry_msgs::Point &a = plan[indices[k - 1]].pose.position;
+    const geometry_msgs::Point &b = plan[indices[k]].pose.position;
+    for (size_t i = indices[k - 1] + 1; i < indices[k]; ++i)
+    {
+      max_deviation = std::max(max_deviation, segmentDistance(plan[i].pose.position, a, b));
+    }
+  }
+  return max_deviation;
+}
+
+TEST(PathPublisherTest, endpointsKept)
+{
+  const double tolerances[] = {0.0, 0.01, 0.1, 1.0, 100.0};
+  for (unsigned int seed = 1; seed <= 5; ++seed)
+  {
+    Plan plan = randomPlan(500, seed);
+    for (size_t t = 0; t < sizeof(tolerances) / sizeof(tolerances[0]); ++t)
+    {
+      std::vector<size_t> indices;
+      PathPublisher::simplify(plan, tolerances[t], 0, indices);
+      expectEndpointsAndOrder(plan, indices);
+    }
+  }
+}
+
+TEST(PathPublisherTest, toleranceRespected)
+{
+  const double tolerances[] = {0.005, 0.02, 0.1, 0.5};
+  for (unsigned int seed = 1; seed <= 5; ++seed)
+  {
+    Plan plan = randomPlan(1000, seed);
+    size_t last_size = plan.size();
+    for (size_t t = 0; t < sizeof(tolerances) / sizeof(tolerances[0]); ++t)
+    {
+      std::vector<size_t> indices;
+      PathPublisher::simplify(plan, tolerances[t], 0, indices);
+      EXPECT_LE(maxDeviation(plan, indices), tolerances[t] + 1e-9) << "seed " << seed << ", tolerance " << tolerances[t];
+
+      // a larger tolerance never needs more poses, and the plans are curvy enough to need some
+      EXPECT_LE(indices.size(), last_size);
+      EXPECT_GT(indices.size(), 2u);
+      last_size = indices.size();
+    }
+  }
+}
+
+TEST(PathPublisherTest, straightLineReducedToEndpoints)
+{
+  Plan plan;
+  for (int i = 0; i <= 100; ++i)
+    addPose(plan, 0.1 * i, 0.05 * i);
+
+  std::vector<size_t> indices;
+  PathPublisher::simplify(plan, 0.001, 0, indices);
+  ASSERT_EQ(2u, indices.size());
+  EXPECT_EQ(0u, indices[0]);
+  EXPECT_EQ(100u, indices[1]);
+}
+
+TEST(PathPublisherTest, deviationAboveToleranceKept)
+{
+  // a single bump of 0.5 m in the middle of a straight line
+  Plan plan;
+  addPose(plan, 0.0, 0.0);
+  addPose(plan, 1.0, 0.0);
+  addPose(plan, 2.0, 0.5);
+  addPose(plan, 3.0, 0.0);
+  addPose(plan, 4.0, 0.0);
+
+  std::vector<size_t> indices;
+  PathPublisher::simplify(plan, 0.3, 0, indices);
+  ASSERT_EQ(3u, indices.size());
+  EXPECT_EQ(2u, indices[1]);
+
+  PathPublisher::simplify(plan, 0.6, 0, indices);
+  ASSERT_EQ(2u, indices.size());
+  EXPECT_EQ(0u, indices[0]);
+  EXPECT_EQ(4u, indices[1]);
+}
+
+TEST(PathPublisherTest, zeroToleranceKeepsAll)
+{
+  Plan plan = randomPlan(200, 7);
+  std::vector<size_t> indices;
+  PathPublisher::simplify(plan, 0.0, 0, indices);
+  ASSERT_EQ(plan.size(), indices.size());
+  for (size_t i = 0; i < indices.size(); ++i)
+    EXPECT_EQ(i, indices[i]);
+}
+
+TEST(PathPublisherTest, shortPlans)
+{
+  Plan plan;
+  addPose(plan, 1.0, 2.0);
+  std::vector<size_t> indices;
+  PathPublisher::simplify(plan, 0.1, 0, indices);
+  ASSERT_EQ(1u, indices.size());
+  EXPECT_EQ(0u, indices[0]);
+
+  addPose(plan, 3.0, 4.0);
+  PathPublisher::simplify(plan, 0.1, 0, indices);
+  ASSERT_EQ(2u, indices.size());
+  EXPECT_EQ(0u, indices[0]);
+  EXPECT_EQ(1u, indices[1]);
+}
+
+TEST(PathPublisherTest, maxPosesCapped)
+{
+  Plan plan = randomPlan(1000, 3);
+  std::vector<size_t> indices;
+  PathPublisher::simplify(plan, 0.0, 10, indices);
+  ASSERT_EQ(10u, indices.size());
+  expectEndpointsAndOrder(plan, indices);
+
+  // the cap applies after the simplification, so a plan simplified below it is left as it is
+  std::vector<size_t> simplified;
+  PathPublisher::simplify(plan, 0.5, 0, simplified);
+  ASSERT_LT(simplified.size(), 100u);
+  PathPublisher::simplify(plan, 0.5, 100, indices);
+  EXPECT_EQ(simplified, indices);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
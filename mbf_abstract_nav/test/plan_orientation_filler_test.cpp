@@ -0,0 +1,152 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  plan_orientation_filler_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <cmath>
+#include <gtest/gtest.h>
+#include <tf/transform_datatypes.h>
+
+#include "mbf_abstract_nav/plan_orientation_filler.h"
+
+typedef std::vector<geometry_msgs::PoseStamped> Plan;
+
+//! appends a pose at the given position and heading to the plan
+void addPose(Plan &plan, double x, double y, double yaw = 0.0)
+{
+  geometry_msgs::PoseStamped pose;
+  pose.pose.position.x = x;
+  pose.pose.position.y = y;
+  pose.pose.orientation = tf::createQuaternionMsgFromYaw(yaw);
+  plan.push_back(pose);
+}
+
+TEST(PlanOrientationFillerTest, orientedTowardsTheNextPose)
+{
+  Plan plan;
+  addPose(plan, 0.0, 0.0);
+  addPose(plan, 1.0, 0.0);
+  addPose(plan, 1.0, 1.0);
+  addPose(plan, 0.0, 2.0);
+  addPose(plan, -1.0, 1.0, 1.0);
+
+  Plan processed;
+  std::string message;
+  mbf_abstract_nav::PlanOrientationFiller filler;
+  ASSERT_TRUE(filler.process(plan, processed, message));
+  ASSERT_EQ(plan.size(), processed.size());
+  EXPECT_NEAR(0.0, tf::getYaw(processed[0].pose.orientation), 1e-9);
+  EXPECT_NEAR(M_PI_2, tf::getYaw(processed[1].pose.orientation), 1e-9);
+  EXPECT_NEAR(3 * M_PI_4, tf::getYaw(processed[2].pose.orientation), 1e-9);
+  EXPECT_NEAR(-3 * M_PI_4, tf::getYaw(processed[3].pose.orientation), 1e-9);
+
+  // the goal orientation is kept by default
+  EXPECT_NEAR(1.0, tf::getYaw(processed[4].pose.orientation), 1e-9);
+}
+
+TEST(PlanOrientationFillerTest, positionsUnchanged)
+{
+  Plan plan;
+  for (int i = 0; i < 10; ++i)
+    addPose(plan, 0.1 * i, 0.01 * i * i);
+
+  Plan processed;
+  std::string message;
+  mbf_abstract_nav::PlanOrientationFiller filler;
+  ASSERT_TRUE(filler.process(plan, processed, message));
+  ASSERT_EQ(plan.size(), processed.size());
+  for (size_t i = 0; i < plan.size(); ++i)
+  {
+    EXPECT_EQ(plan[i].pose.position.x, processed[i].pose.position.x);
+    EXPECT_EQ(plan[i].pose.position.y, processed[i].pose.position.y);
+  }
+}
+
+TEST(PlanOrientationFillerTest, repeatedPosesTakeThePreviousOrientation)
+{
+  Plan plan;
+  addPose(plan, 0.0, 0.0);
+  addPose(plan, 1.0, 0.0, 2.0);
+  addPose(plan, 1.0, 0.0, 2.0);
+  addPose(plan, 1.0, 1.0);
+
+  Plan processed;
+  std::string message;
+  mbf_abstract_nav::PlanOrientationFiller filler;
+  ASSERT_TRUE(filler.process(plan, processed, message));
+  ASSERT_EQ(plan.size(), processed.size());
+  EXPECT_NEAR(0.0, tf::getYaw(processed[1].pose.orientation), 1e-9);
+  EXPECT_NEAR(M_PI_2, tf::getYaw(processed[2].pose.orientation), 1e-9);
+}
+
+TEST(PlanOrientationFillerTest, repeatedStartKeepsItsOrientation)
+{
+  Plan plan;
+  addPose(plan, 0.0, 0.0, 2.0);
+  addPose(plan, 0.0, 0.0, 2.0);
+  addPose(plan, 0.0, 1.0);
+
+  Plan processed;
+  std::string message;
+  mbf_abstract_nav::PlanOrientationFiller filler;
+  ASSERT_TRUE(filler.process(plan, processed, message));
+  ASSERT_EQ(plan.size(), processed.size());
+  EXPECT_NEAR(2.0, tf::getYaw(processed[0].pose.orientation), 1e-9);
+  EXPECT_NEAR(M_PI_2, tf::getYaw(processed[1].pose.orientation), 1e-9);
+}
+
+TEST(PlanOrientationFillerTest, shortPlansUnchanged)
+{
+  Plan plan;
+  Plan processed;
+  std::string message;
+  mbf_abstract_nav::PlanOrientationFiller filler;
+  ASSERT_TRUE(filler.process(plan, processed, message));
+  EXPECT_TRUE(processed.empty());
+
+  addPose(plan, 1.0, 2.0, 0.5);
+  ASSERT_TRUE(filler.process(plan, processed, message));
+  ASSERT_EQ(1u, processed.size());
+  EXPECT_NEAR(0.5, tf::getYaw(processed[0].pose.orientation), 1e-9);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,189 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  plan_resampler_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <cmath>
+#include <gtest/gtest.h>
+
+#include "mbf_abstract_nav/plan_resampler.h"
+
+typedef std::vector<geometry_msgs::PoseStamped> Plan;
+
+//! appends a pose at the given position to the plan
+void addPose(Plan &plan, double x, double y)
+{
+  geometry_msgs::PoseStamped pose;
+  pose.header.seq = plan.size();
+  pose.pose.position.x = x;
+  pose.pose.position.y = y;
+  pose.pose.orientation.w = 1.0;
+  plan.push_back(pose);
+}
+
+//! distance on the x-y plane between two poses
+double distance(const geometry_msgs::PoseStamped &a, const geometry_msgs::PoseStamped &b)
+{
+  return hypot(b.pose.position.x - a.pose.position.x, b.pose.position.y - a.pose.position.y);
+}
+
+TEST(PlanResamplerTest, sparsePlanDensified)
+{
+  // a single 1 m segment, resampled with the default 0.05 m spacing
+  Plan plan;
+  addPose(plan, 0.0, 0.0);
+  addPose(plan, 1.0, 0.0);
+
+  Plan processed;
+  std::string message;
+  mbf_abstract_nav::PlanResampler resampler;
+  ASSERT_TRUE(resampler.process(plan, processed, message));
+  ASSERT_EQ(21u, processed.size());
+  for (size_t i = 0; i < processed.size(); ++i)
+  {
+    EXPECT_NEAR(0.05 * i, processed[i].pose.position.x, 1e-9);
+    EXPECT_EQ(0.0, processed[i].pose.position.y);
+  }
+}
+
+TEST(PlanResamplerTest, densePlanThinned)
+{
+  Plan plan;
+  for (int i = 0; i <= 1000; ++i)
+    addPose(plan, 0.001 * i, 0.0);
+
+  Plan processed;
+  std::string message;
+  mbf_abstract_nav::PlanResampler resampler;
+  ASSERT_TRUE(resampler.process(plan, processed, message));
+  ASSERT_EQ(21u, processed.size());
+  for (size_t i = 1; i < processed.size(); ++i)
+  {
+    EXPECT_NEAR(0.05, distance(processed[i - 1], processed[i]), 1e-6);
+  }
+}
+
+TEST(PlanResamplerTest, posesAlongThePlan)
+{
+  // an L-shaped plan; every resampled pose must lie on one of its two legs, 0.05 m apart along the plan
+  Plan plan;
+  addPose(plan, 0.0, 0.0);
+  addPose(plan, 0.33, 0.0);
+  addPose(plan, 1.0, 0.0);
+  addPose(plan, 1.0, 1.0);
+
+  Plan processed;
+  std::string message;
+  mbf_abstract_nav::PlanResampler resampler;
+  ASSERT_TRUE(resampler.process(plan, processed, message));
+  ASSERT_EQ(41u, processed.size());
+  for (size_t i = 0; i < processed.size(); ++i)
+  {
+    const double x = processed[i].pose.position.x;
+    const double y = processed[i].pose.position.y;
+    const double length = y < 1e-9 ? x : 1.0 + y;
+    EXPECT_TRUE(std::fabs(y) < 1e-9 || std::fabs(x - 1.0) < 1e-9) << "pose " << i << " off the plan";
+    EXPECT_NEAR(0.05 * i, length, 1e-9) << "pose " << i;
+  }
+}
+
+TEST(PlanResamplerTest, endpointsKept)
+{
+  Plan plan;
+  addPose(plan, 0.2, -0.1);
+  addPose(plan, 0.5, 0.7);
+  addPose(plan, 1.3, 0.9);
+  plan.back().pose.orientation.z = 1.0;
+  plan.back().pose.orientation.w = 0.0;
+
+  Plan processed;
+  std::string message;
+  mbf_abstract_nav::PlanResampler resampler;
+  ASSERT_TRUE(resampler.process(plan, processed, message));
+  ASSERT_GT(processed.size(), 2u);
+  EXPECT_EQ(plan.front().pose.position.x, processed.front().pose.position.x);
+  EXPECT_EQ(plan.front().pose.position.y, processed.front().pose.position.y);
+  EXPECT_EQ(plan.back().header.seq, processed.back().header.seq);
+  EXPECT_EQ(plan.back().pose.position.x, processed.back().pose.position.x);
+  EXPECT_EQ(plan.back().pose.position.y, processed.back().pose.position.y);
+  EXPECT_EQ(plan.back().pose.orientation.z, processed.back().pose.orientation.z);
+}
+
+TEST(PlanResamplerTest, noSampleCrowdingTheLastPose)
+{
+  // 1.01 m long, so a sample at 1 m would fall 1 cm short of the last pose; it must be dropped
+  Plan plan;
+  addPose(plan, 0.0, 0.0);
+  addPose(plan, 1.01, 0.0);
+
+  Plan processed;
+  std::string message;
+  mbf_abstract_nav::PlanResampler resampler;
+  ASSERT_TRUE(resampler.process(plan, processed, message));
+  ASSERT_EQ(21u, processed.size());
+  EXPECT_NEAR(0.95, processed[19].pose.position.x, 1e-9);
+  EXPECT_EQ(1.01, processed[20].pose.position.x);
+}
+
+TEST(PlanResamplerTest, degeneratePlans)
+{
+  Plan plan;
+  Plan processed;
+  std::string message;
+  mbf_abstract_nav::PlanResampler resampler;
+  ASSERT_TRUE(resampler.process(plan, processed, message));
+  EXPECT_TRUE(processed.empty());
+
+  addPose(plan, 1.0, 2.0);
+  ASSERT_TRUE(resampler.process(plan, processed, message));
+  ASSERT_EQ(1u, processed.size());
+
+  // all the poses at the same position
+  addPose(plan, 1.0, 2.0);
+  addPose(plan, 1.0, 2.0);
+  ASSERT_TRUE(resampler.process(plan, processed, message));
+  ASSERT_EQ(2u, processed.size());
+  EXPECT_EQ(0u, processed.front().header.seq);
+  EXPECT_EQ(2u, processed.back().header.seq);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
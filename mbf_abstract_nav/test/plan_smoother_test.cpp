@@ -0,0 +1,156 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  plan_smoother_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <cmath>
+#include <gtest/gtest.h>
+
+#include "mbf_abstract_nav/plan_smoother.h"
+
+typedef std::vector<geometry_msgs::PoseStamped> Plan;
+
+//! appends a pose at the given position to the plan
+void addPose(Plan &plan, double x, double y)
+{
+  geometry_msgs::PoseStamped pose;
+  pose.header.frame_id = "map";
+  pose.header.seq = plan.size();
+  pose.pose.position.x = x;
+  pose.pose.position.y = y;
+  pose.pose.orientation.z = 0.6;
+  pose.pose.orientation.w = 0.8;
+  plan.push_back(pose);
+}
+
+//! zigzag along the x axis, with poses alternating between y = amplitude and y = -amplitude
+Plan zigzagPlan(size_t size, double amplitude)
+{
+  Plan plan;
+  for (size_t i = 0; i < size; ++i)
+    addPose(plan, 0.1 * i, i % 2 ? -amplitude : amplitude);
+  return plan;
+}
+
+TEST(PlanSmootherTest, endpointsKept)
+{
+  Plan plan = zigzagPlan(21, 0.1);
+  Plan processed;
+  std::string message;
+  mbf_abstract_nav::PlanSmoother smoother;
+  ASSERT_TRUE(smoother.process(plan, processed, message));
+  ASSERT_EQ(plan.size(), processed.size());
+  EXPECT_EQ(plan.front().pose.position.x, processed.front().pose.position.x);
+  EXPECT_EQ(plan.front().pose.position.y, processed.front().pose.position.y);
+  EXPECT_EQ(plan.back().pose.position.x, processed.back().pose.position.x);
+  EXPECT_EQ(plan.back().pose.position.y, processed.back().pose.position.y);
+}
+
+TEST(PlanSmootherTest, zigzagFlattened)
+{
+  Plan plan = zigzagPlan(21, 0.1);
+  Plan processed;
+  std::string message;
+  mbf_abstract_nav::PlanSmoother smoother;
+  ASSERT_TRUE(smoother.process(plan, processed, message));
+  ASSERT_EQ(plan.size(), processed.size());
+
+  // the inner poses get pulled towards the x axis, but the data weight keeps them from collapsing onto it
+  for (size_t i = 1; i < processed.size() - 1; ++i)
+  {
+    EXPECT_LT(std::fabs(processed[i].pose.position.y), 0.05) << "pose " << i;
+    EXPECT_NE(0.0, processed[i].pose.position.y) << "pose " << i;
+  }
+}
+
+TEST(PlanSmootherTest, evenlySpacedLineUnchanged)
+{
+  Plan plan;
+  for (int i = 0; i <= 20; ++i)
+    addPose(plan, 0.1 * i, 0.05 * i);
+
+  Plan processed;
+  std::string message;
+  mbf_abstract_nav::PlanSmoother smoother;
+  ASSERT_TRUE(smoother.process(plan, processed, message));
+  ASSERT_EQ(plan.size(), processed.size());
+  for (size_t i = 0; i < plan.size(); ++i)
+  {
+    EXPECT_NEAR(plan[i].pose.position.x, processed[i].pose.position.x, 1e-9);
+    EXPECT_NEAR(plan[i].pose.position.y, processed[i].pose.position.y, 1e-9);
+  }
+}
+
+TEST(PlanSmootherTest, orientationsAndHeadersKept)
+{
+  Plan plan = zigzagPlan(10, 0.2);
+  Plan processed;
+  std::string message;
+  mbf_abstract_nav::PlanSmoother smoother;
+  ASSERT_TRUE(smoother.process(plan, processed, message));
+  ASSERT_EQ(plan.size(), processed.size());
+  for (size_t i = 0; i < plan.size(); ++i)
+  {
+    EXPECT_EQ(plan[i].header.seq, processed[i].header.seq);
+    EXPECT_EQ(plan[i].header.frame_id, processed[i].header.frame_id);
+    EXPECT_EQ(plan[i].pose.orientation.z, processed[i].pose.orientation.z);
+    EXPECT_EQ(plan[i].pose.orientation.w, processed[i].pose.orientation.w);
+  }
+}
+
+TEST(PlanSmootherTest, shortPlansUnchanged)
+{
+  Plan plan;
+  Plan processed;
+  std::string message;
+  mbf_abstract_nav::PlanSmoother smoother;
+  ASSERT_TRUE(smoother.process(plan, processed, message));
+  EXPECT_TRUE(processed.empty());
+
+  addPose(plan, 1.0, 2.0);
+  addPose(plan, 3.0, 5.0);
+  ASSERT_TRUE(smoother.process(plan, processed, message));
+  ASSERT_EQ(2u, processed.size());
+  EXPECT_EQ(5.0, processed[1].pose.position.y);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,212 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  robot_state_cache_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include <boost/make_shared.hpp>
+#include <nav_msgs/Odometry.h>
+#include <tf/transform_listener.h>
+
+#include "mbf_abstract_nav/robot_state_cache.h"
+
+using mbf_abstract_nav::RobotStateCache;
+
+class RobotStateCacheTest : public testing::Test
+{
+protected:
+  RobotStateCacheTest() : tf_listener_ptr_(new tf::TransformListener())
+  {
+  }
+
+  //! sets the robot pose on the map, stamped now
+  void setRobotPose(double x, double y)
+  {
+    tf::StampedTransform robot_pose(tf::Transform(tf::Quaternion(0.0, 0.0, 0.0, 1.0), tf::Vector3(x, y, 0.0)),
+                                    ros::Time::now(), "map", "base_link");
+    tf_listener_ptr_->setTransform(robot_pose);
+  }
+
+  //! spins until the cache gets a velocity; false if it doesn't within two seconds
+  bool waitForVelocity(const RobotStateCache &cache)
+  {
+    ros::Time timeout = ros::Time::now() + ros::Duration(2.0);
+    while (cache.get()->velocity.header.stamp.isZero() && ros::Time::now() < timeout)
+    {
+      ros::spinOnce();
+      ros::Duration(0.01).sleep();
+    }
+    return !cache.get()->velocity.header.stamp.isZero();
+  }
+
+  boost::shared_ptr<tf::TransformListener> tf_listener_ptr_;
+  ros::NodeHandle nh_;
+};
+
+TEST_F(RobotStateCacheTest, emptyUntilUpdated)
+{
+  setRobotPose(1.0, 2.0);
+  RobotStateCache cache(tf_listener_ptr_, "base_link", "map", "odom", 0.0);
+  EXPECT_TRUE(cache.get()->pose.header.stamp.isZero());
+  EXPECT_TRUE(cache.get()->velocity.header.stamp.isZero());
+}
+
+TEST_F(RobotStateCacheTest, poseFromTf)
+{
+  setRobotPose(1.0, 2.0);
+  RobotStateCache cache(tf_listener_ptr_, "base_link", "map", "odom", 0.0);
+  ASSERT_TRUE(cache.updatePose());
+  RobotStateCache::StateConstPtr state = cache.get();
+  EXPECT_EQ("map", state->pose.header.frame_id);
+  EXPECT_FALSE(state->pose.header.stamp.isZero());
+  EXPECT_DOUBLE_EQ(1.0, state->pose.pose.position.x);
+  EXPECT_DOUBLE_EQ(2.0, state->pose.pose.position.y);
+}
+
+TEST_F(RobotStateCacheTest, snapshotsDontChange)
+{
+  setRobotPose(1.0, 2.0);
+  RobotStateCache cache(tf_listener_ptr_, "base_link", "map", "odom", 0.0);
+  ASSERT_TRUE(cache.updatePose());
+  RobotStateCache::StateConstPtr old_state = cache.get();
+
+  setRobotPose(3.0, 4.0);
+  ASSERT_TRUE(cache.updatePose());
+  EXPECT_DOUBLE_EQ(1.0, old_state->pose.pose.position.x);
+  EXPECT_DOUBLE_EQ(3.0, cache.get()->pose.pose.position.x);
+}
+
+TEST_F(RobotStateCacheTest, noPoseWithoutTransform)
+{
+  setRobotPose(1.0, 2.0);
+  RobotStateCache cache(tf_listener_ptr_, "base_link", "nowhere", "odom", 0.0);
+  EXPECT_FALSE(cache.updatePose());
+  EXPECT_TRUE(cache.get()->pose.header.stamp.isZero());
+}
+
+TEST_F(RobotStateCacheTest, getPoseUpdatesAStalePose)
+{
+  RobotStateCache cache(tf_listener_ptr_, "base_link", "map", "odom", 0.0);
+  geometry_msgs::PoseStamped pose;
+  setRobotPose(1.0, 2.0);
+  ASSERT_TRUE(cache.getPose(pose, ros::Duration(1.0)));
+  EXPECT_DOUBLE_EQ(1.0, pose.pose.position.x);
+
+  // a pose older than the given age is refreshed; if it can't be, the stale one is returned, but as a failure
+  ros::Duration(0.1).sleep();
+  setRobotPose(3.0, 4.0);
+  ASSERT_TRUE(cache.getPose(pose, ros::Duration(0.05)));
+  EXPECT_DOUBLE_EQ(3.0, pose.pose.position.x);
+
+  tf::StampedTransform old_pose(tf::Transform(tf::Quaternion(0.0, 0.0, 0.0, 1.0), tf::Vector3(5.0, 6.0, 0.0)),
+                                ros::Time::now() - ros::Duration(1.0), "map", "base_link");
+  tf_listener_ptr_->setTransform(old_pose);
+  ros::Duration(0.1).sleep();
+  EXPECT_FALSE(cache.getPose(pose, ros::Duration(0.05)));
+}
+
+TEST_F(RobotStateCacheTest, odometryUpdatesVelocityAndPose)
+{
+  setRobotPose(1.0, 2.0);
+  RobotStateCache cache(tf_listener_ptr_, "base_link", "map", "odom", 0.0);
+  ros::Publisher odom_pub = nh_.advertise<nav_msgs::Odometry>("odom", 1);
+
+  nav_msgs::Odometry odom;
+  odom.header.stamp = ros::Time::now();
+  odom.header.frame_id = "odom";
+  odom.child_frame_id = "base_link";
+  odom.twist.twist.linear.x = 0.3;
+  odom.twist.twist.angular.z = 0.2;
+  ros::Time timeout = ros::Time::now() + ros::Duration(2.0);
+  while (odom_pub.getNumSubscribers() == 0 && ros::Time::now() < timeout)
+  {
+    ros::Duration(0.01).sleep();
+  }
+  odom_pub.publish(odom);
+  ASSERT_TRUE(waitForVelocity(cache));
+
+  RobotStateCache::StateConstPtr state = cache.get();
+  EXPECT_EQ("base_link", state->velocity.header.frame_id);
+  EXPECT_EQ(odom.header.stamp, state->velocity.header.stamp);
+  EXPECT_DOUBLE_EQ(0.3, state->velocity.twist.linear.x);
+  EXPECT_DOUBLE_EQ(0.2, state->velocity.twist.angular.z);
+  EXPECT_DOUBLE_EQ(1.0, state->pose.pose.position.x);
+}
+
+TEST_F(RobotStateCacheTest, poseTrackedWithoutOdometry)
+{
+  setRobotPose(1.0, 2.0);
+  RobotStateCache cache(tf_listener_ptr_, "base_link", "map", "odom", 50.0);
+
+  // the pose follows TF at the given rate
+  ros::Time timeout = ros::Time::now() + ros::Duration(2.0);
+  while (cache.get()->pose.pose.position.x != 1.0 && ros::Time::now() < timeout)
+  {
+    ros::spinOnce();
+    ros::Duration(0.005).sleep();
+  }
+  EXPECT_DOUBLE_EQ(1.0, cache.get()->pose.pose.position.x);
+
+  setRobotPose(3.0, 4.0);
+  timeout = ros::Time::now() + ros::Duration(2.0);
+  while (cache.get()->pose.pose.position.x != 3.0 && ros::Time::now() < timeout)
+  {
+    ros::spinOnce();
+    ros::Duration(0.005).sleep();
+  }
+  EXPECT_DOUBLE_EQ(3.0, cache.get()->pose.pose.position.x);
+  EXPECT_TRUE(cache.get()->velocity.header.stamp.isZero());
+}
+
+TEST_F(RobotStateCacheTest, getPoseNeverWaitsForTf)
+{
+  RobotStateCache cache(tf_listener_ptr_, "base_link", "nowhere", "odom", 0.0);
+  geometry_msgs::PoseStamped pose;
+  const ros::WallTime start = ros::WallTime::now();
+  EXPECT_FALSE(cache.getPose(pose, ros::Duration(1.0)));
+  EXPECT_LT((ros::WallTime::now() - start).toSec(), 0.1);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "robot_state_cache_test");
+  ros::NodeHandle nh;
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,281 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  worker_thread_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <stdexcept>
+#include <vector>
+#include <gtest/gtest.h>
+#ifdef __linux__
+#include <pthread.h>
+#endif
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include "mbf_abstract_nav/worker_thread.h"
+
+using mbf_abstract_nav::WorkerThread;
+
+//! records the tasks run by a worker
+class TaskLog
+{
+public:
+  TaskLog() : gate_open_(true), started_(0)
+  {
+  }
+
+  //! task recording its id and thread
+  void run(int id)
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    ids_.push_back(id);
+    threads_.push_back(boost::this_thread::get_id());
+  }
+
+  //! task waiting, without interruption points, until the gate is opened
+  void waitForGate(int id)
+  {
+    boost::this_thread::disable_interruption no_interruption;
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    ++started_;
+    cond_.notify_all();
+    while (!gate_open_)
+    {
+      cond_.wait(lock);
+    }
+    ids_.push_back(id);
+  }
+
+  //! task sleeping for a long while; the sleep is an interruption point
+  void sleep(int id)
+  {
+    {
+      boost::lock_guard<boost::mutex> guard(mutex_);
+      ++started_;
+      cond_.notify_all();
+    }
+    try
+    {
+      boost::this_thread::sleep_for(boost::chrono::seconds(10));
+      run(id);
+    }
+    catch (const boost::thread_interrupted &ex)
+    {
+      run(-id);
+    }
+  }
+
+  //! task throwing an exception
+  void fail(int id)
+  {
+    run(id);
+    throw std::runtime_error("task failure");
+  }
+
+  void setGateOpen(bool open)
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    gate_open_ = open;
+    cond_.notify_all();
+  }
+
+  //! waits until the given number of waiting or sleeping tasks have started; false if they don't within a second
+  bool waitForStarted(int started)
+  {
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    const boost::chrono::steady_clock::time_point deadline =
+        boost::chrono::steady_clock::now() + boost::chrono::seconds(1);
+    while (started_ < started)
+    {
+      if (cond_.wait_until(lock, deadline) == boost::cv_status::timeout)
+        return started_ >= started;
+    }
+    return true;
+  }
+
+  std::vector<int> ids()
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    return ids_;
+  }
+
+  std::vector<boost::thread::id> threads()
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    return threads_;
+  }
+
+private:
+  std::vector<int> ids_;
+  std::vector<boost::thread::id> threads_;
+  bool gate_open_;
+  int started_;
+  boost::mutex mutex_;
+  boost::condition_variable cond_;
+};
+
+class WorkerThreadTest : public testing::Test
+{
+protected:
+  WorkerThreadTest() : worker_("test")
+  {
+  }
+
+  TaskLog log_;
+  WorkerThread worker_;
+};
+
+TEST_F(WorkerThreadTest, tasksRunOnTheSameThread)
+{
+  ASSERT_TRUE(worker_.post(boost::bind(&TaskLog::run, &log_, 1)));
+  worker_.waitUntilIdle();
+  ASSERT_TRUE(worker_.post(boost::bind(&TaskLog::run, &log_, 2)));
+  worker_.waitUntilIdle();
+  EXPECT_FALSE(worker_.isBusy());
+
+  std::vector<boost::thread::id> threads = log_.threads();
+  ASSERT_EQ(2u, threads.size());
+  EXPECT_EQ(threads[0], threads[1]);
+  EXPECT_NE(boost::this_thread::get_id(), threads[0]);
+}
+
+TEST_F(WorkerThreadTest, onlyOneTaskWaits)
+{
+  log_.setGateOpen(false);
+  ASSERT_TRUE(worker_.post(boost::bind(&TaskLog::waitForGate, &log_, 1)));
+  ASSERT_TRUE(log_.waitForStarted(1));
+
+  // the second task waits for the first one, but there's no room for a third one
+  EXPECT_TRUE(worker_.post(boost::bind(&TaskLog::run, &log_, 2)));
+  EXPECT_FALSE(worker_.post(boost::bind(&TaskLog::run, &log_, 3)));
+  EXPECT_TRUE(worker_.isBusy());
+
+  log_.setGateOpen(true);
+  worker_.waitUntilIdle();
+  std::vector<int> ids = log_.ids();
+  ASSERT_EQ(2u, ids.size());
+  EXPECT_EQ(1, ids[0]);
+  EXPECT_EQ(2, ids[1]);
+}
+
+TEST_F(WorkerThreadTest, interruptStopsTheRunningTaskOnly)
+{
+  ASSERT_TRUE(worker_.post(boost::bind(&TaskLog::sleep, &log_, 1)));
+  ASSERT_TRUE(log_.waitForStarted(1));
+  const boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  worker_.interrupt();
+  worker_.waitUntilIdle();
+  EXPECT_LT(boost::chrono::steady_clock::now() - start, boost::chrono::seconds(1));
+
+  // the worker survives the interrupt, and the next task is not interrupted
+  ASSERT_TRUE(worker_.post(boost::bind(&TaskLog::run, &log_, 2)));
+  worker_.waitUntilIdle();
+  std::vector<int> ids = log_.ids();
+  ASSERT_EQ(2u, ids.size());
+  EXPECT_EQ(-1, ids[0]);
+  EXPECT_EQ(2, ids[1]);
+}
+
+TEST_F(WorkerThreadTest, interruptWhileIdleDiscarded)
+{
+  worker_.interrupt();
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+  ASSERT_TRUE(worker_.post(boost::bind(&TaskLog::sleep, &log_, 1)));
+  ASSERT_TRUE(log_.waitForStarted(1));
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+  EXPECT_TRUE(log_.ids().empty());  // still sleeping, not interrupted
+  worker_.interrupt();
+  worker_.waitUntilIdle();
+  ASSERT_EQ(1u, log_.ids().size());
+  EXPECT_EQ(-1, log_.ids()[0]);
+}
+
+TEST_F(WorkerThreadTest, failingTaskDoesntStopTheWorker)
+{
+  ASSERT_TRUE(worker_.post(boost::bind(&TaskLog::fail, &log_, 1)));
+  worker_.waitUntilIdle();
+  ASSERT_TRUE(worker_.post(boost::bind(&TaskLog::run, &log_, 2)));
+  worker_.waitUntilIdle();
+  EXPECT_EQ(2u, log_.ids().size());
+}
+
+TEST_F(WorkerThreadTest, stopDiscardsThePostedTask)
+{
+  ASSERT_TRUE(worker_.post(boost::bind(&TaskLog::sleep, &log_, 1)));
+  ASSERT_TRUE(log_.waitForStarted(1));
+  ASSERT_TRUE(worker_.post(boost::bind(&TaskLog::run, &log_, 2)));
+
+  const boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  worker_.stop();
+  EXPECT_LT(boost::chrono::steady_clock::now() - start, boost::chrono::seconds(1));
+  std::vector<int> ids = log_.ids();
+  ASSERT_EQ(1u, ids.size());
+  EXPECT_EQ(-1, ids[0]);
+
+  EXPECT_FALSE(worker_.post(boost::bind(&TaskLog::run, &log_, 3)));
+}
+
+#ifdef __linux__
+//! task recording the scheduling policy of its thread
+void getPolicy(int *policy)
+{
+  sched_param param;
+  pthread_getschedparam(pthread_self(), policy, &param);
+}
+
+TEST_F(WorkerThreadTest, realtimePriorityIsOptIn)
+{
+  int policy = -1;
+  EXPECT_TRUE(worker_.setRealtimePriority(0));
+  ASSERT_TRUE(worker_.post(boost::bind(&getPolicy, &policy)));
+  worker_.waitUntilIdle();
+  EXPECT_EQ(SCHED_OTHER, policy);
+
+  // without the privileges for it, the worker keeps running with the normal policy
+  bool realtime = worker_.setRealtimePriority(1);
+  ASSERT_TRUE(worker_.post(boost::bind(&getPolicy, &policy)));
+  worker_.waitUntilIdle();
+  EXPECT_EQ(realtime ? SCHED_FIFO : SCHED_OTHER, policy);
+}
+#endif
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,159 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  costmap_activation.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_COSTMAP_NAV__COSTMAP_ACTIVATION_H_
+#define MBF_COSTMAP_NAV__COSTMAP_ACTIVATION_H_
+
+#include <string>
+
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <costmap_2d/costmap_2d_ros.h>
+#include <mbf_abstract_nav/latency_histogram.h>
+#include <ros/ros.h>
+
+namespace mbf_costmap_nav
+{
+/**
+ * @brief The CostmapActivation class switches a costmap between active and inactive on a background thread, so
+ *        callers don't block on the costmap start. An inactive costmap is either stopped, unsubscribing its layers
+ *        from the sensors, or, if a standby frequency is given, kept in warm standby: the layers keep receiving
+ *        observations, but the map is only updated at the standby frequency. Waking up from standby takes a single
+ *        map update instead of the sensors warm-up.
+ *        The duration of each activation is recorded and published on the name/activation_latency topic.
+ *
+ * @ingroup move_base_server
+ */
+class CostmapActivation
+{
+public:
+  typedef boost::shared_ptr<CostmapActivation> Ptr;
+  typedef boost::shared_ptr<costmap_2d::Costmap2DROS> CostmapPtr;
+
+  /**
+   * @brief Constructor; the costmap is assumed to be running.
+   * @param costmap_ptr Shared pointer to the costmap.
+   * @param name Name of the costmap, used for logging and as the namespace of the latency topic.
+   * @param standby_frequency Frequency at which the map is updated while inactive; 0 to stop the costmap instead.
+   */
+  CostmapActivation(const CostmapPtr &costmap_ptr, const std::string &name, double standby_frequency);
+
+  /**
+   * @brief Destructor; waits for the current transition to finish.
+   */
+  ~CostmapActivation();
+
+  /**
+   * @brief Requests the costmap activation; returns immediately.
+   */
+  void activate();
+
+  /**
+   * @brief Requests the costmap deactivation; returns immediately.
+   */
+  void deactivate();
+
+  /**
+   * @brief Whether the costmap is active or being activated.
+   */
+  bool isActive();
+
+  /**
+   * @brief Waits until the costmap is active and current, i.e. all its layers have received recent observations.
+   * @param timeout Maximum time to wait.
+   * @return true, if the costmap is active and current.
+   */
+  bool waitUntilActive(const ros::Duration &timeout);
+
+  /**
+   * @brief Returns the durations of the activations done so far.
+   */
+  const mbf_abstract_nav::LatencyHistogram &getActivationLatency() const;
+
+private:
+
+  /**
+   * @brief Thread performing the requested transitions and the standby map updates.
+   */
+  void run();
+
+  //! the costmap
+  CostmapPtr costmap_ptr_;
+
+  //! name of the costmap
+  const std::string name_;
+
+  //! map updates period while in standby; zero if the costmap is stopped instead
+  const boost::chrono::duration<double> standby_period_;
+
+  //! mutex protecting the requested and current states
+  boost::mutex mutex_;
+
+  //! condition variable signaling state changes
+  boost::condition_variable condition_;
+
+  //! requested state
+  bool requested_active_;
+
+  //! current state
+  bool active_;
+
+  //! time of the last activation request
+  boost::chrono::steady_clock::time_point activation_requested_;
+
+  //! true to terminate the thread
+  bool shutdown_;
+
+  //! durations of the activations
+  mbf_abstract_nav::LatencyHistogram activation_latency_;
+
+  //! publisher of the activation latency statistics
+  ros::Publisher activation_latency_pub_;
+
+  //! transitions thread; started last, once all members are initialized
+  boost::thread thread_;
+};
+
+} /* namespace mbf_costmap_nav */
+
+#endif /* MBF_COSTMAP_NAV__COSTMAP_ACTIVATION_H_ */
@@ -45,6 +45,8 @@
 #include <mbf_costmap_core/costmap_controller.h>
 #include <mbf_abstract_nav/abstract_controller_execution.h>
 
+#include "mbf_costmap_nav/costmap_mirror.h"
+
 namespace mbf_costmap_nav
 {
 /**
@@ -62,12 +64,10 @@ public:
 
   /**
    * @brief Constructor
-   * @param condition Thread sleep condition variable, to wake up connected threads
    * @param tf_listener_ptr Shared pointer to a common tf listener
    * @param costmap_ptr Shared pointer to the costmap.
    */
-  CostmapControllerExecution(boost::condition_variable &condition,
-                              const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr,
+  CostmapControllerExecution(const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr,
                               CostmapPtr &costmap_ptr);
 
   /**
@@ -80,7 +80,10 @@ protected:
   /**
    * @brief Request plugin for a new velocity command. We override this method so we can lock the local costmap
    *        before calling the planner.
+   * @param robot_pose current robot pose
+   * @param robot_velocity current robot velocity
    * @param vel_cmd_stamped current velocity command
+   * @param message the plugin message, if any
    */
   virtual uint32_t computeVelocityCmd(
       const geometry_msgs::PoseStamped& robot_pose,
@@ -100,9 +103,12 @@ private:
 
   /**
    * @brief Initializes the local planner plugin with its name, a pointer to the TransformListener
-   *        and pointer to the costmap
+   *        and pointer to the costmap, or to the mirror of the costmap if controller_costmap_mirror is set
+   * @param name The name of the controller plugin.
+   * @param abstract_controller_ptr The controller plugin to initialize.
+   * @return false, if the tf listener or the costmap have not been initialized.
    */
-  virtual void initPlugin();
+  virtual bool initPlugin(const std::string &name, const mbf_abstract_core::AbstractController::Ptr &abstract_controller_ptr);
 
   //! costmap for 2d navigation planning
   CostmapPtr &costmap_ptr_;
@@ -110,8 +116,11 @@ private:
   //! Whether to lock costmap before calling the controller (see issue #4 for details)
   bool lock_costmap_;
 
-  //! name of the controller plugin assigned by the class loader
-  std::string controller_name_;
+  //! Whether to give the plugins a mirror of the costmap, updated before each call, instead of the costmap itself
+  bool use_costmap_mirror_;
+
+  //! Mirror of the local costmap, created on the first plugin initialization; null if disabled
+  CostmapMirror::Ptr costmap_mirror_ptr_;
 };
 
 } /* namespace mbf_costmap_nav */
@@ -0,0 +1,131 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  costmap_mirror.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_COSTMAP_NAV__COSTMAP_MIRROR_H_
+#define MBF_COSTMAP_NAV__COSTMAP_MIRROR_H_
+
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include <costmap_2d/costmap_2d_ros.h>
+#include <geometry_msgs/Point.h>
+#include <tf/transform_listener.h>
+
+#include "mbf_costmap_nav/costmap_update_tracker.h"
+
+namespace mbf_costmap_nav
+{
+/**
+ * @brief The CostmapMirror class provides a Costmap2DROS whose content is a snapshot of a live costmap, to be handed
+ *        to the planner and controller plugins instead of the live one. The plugins API requires a Costmap2DROS, so
+ *        the mirror is one with the same parameters as the live costmap but no layers and no update or publish
+ *        cycles; it never changes by itself. On update(), only the window of the live costmap rewritten since the
+ *        previous update, as recorded by its CostmapUpdateTracker, is copied into the mirror, holding the live
+ *        costmap mutex just while copying. The whole map is copied on the first update, if the live costmap has no
+ *        tracker, if too many updates were missed or if the map geometry changed, e.g. on rolling window costmaps.
+ *        So the plugins read a consistent map without stalling the layer updates for the whole plugin call.
+ *        The owner must call update() before every plugin call, and never while a plugin reads the mirror.
+ *
+ * @ingroup move_base_server
+ */
+class CostmapMirror
+{
+public:
+  typedef boost::shared_ptr<CostmapMirror> Ptr;
+  typedef boost::shared_ptr<costmap_2d::Costmap2DROS> CostmapPtr;
+
+  /**
+   * @brief Constructor; creates the mirror costmap, with the parameters of the live costmap, and fills it.
+   * @param costmap_ptr Shared pointer to the live costmap.
+   * @param name Name of the mirror costmap; it must be unique within the node.
+   * @param tf_listener TransformListener used by the mirror costmap to look up the robot pose.
+   */
+  CostmapMirror(const CostmapPtr &costmap_ptr, const std::string &name, tf::TransformListener &tf_listener);
+
+  /**
+   * @brief Returns the mirror costmap, to initialize the plugins with.
+   * @return Pointer to the mirror costmap, valid as long as this object exists.
+   */
+  costmap_2d::Costmap2DROS *get();
+
+  /**
+   * @brief Copies the current content and footprint of the live costmap into the mirror.
+   */
+  void update();
+
+private:
+
+  /**
+   * @brief Copies the given window of the live costmap into the mirror; both costmaps must be locked.
+   * @param costmap The live costmap.
+   * @param mirror The mirror costmap, with the same geometry as the live one.
+   * @param min_x Minimum x of the window, in world coordinates.
+   * @param min_y Minimum y of the window, in world coordinates.
+   * @param max_x Maximum x of the window, in world coordinates.
+   * @param max_y Maximum y of the window, in world coordinates.
+   */
+  static void copyWindow(const costmap_2d::Costmap2D &costmap, costmap_2d::Costmap2D &mirror,
+                         double min_x, double min_y, double max_x, double max_y);
+
+
+  //! the live costmap
+  CostmapPtr costmap_ptr_;
+
+  //! the mirror costmap, handed to the plugins
+  CostmapPtr mirror_ptr_;
+
+  //! tracker of the live costmap updates; empty if the live costmap has none
+  CostmapUpdateTracker::Ptr tracker_ptr_;
+
+  //! last live costmap update copied into the mirror
+  uint64_t seq_;
+
+  //! whether the mirror has been filled at least once
+  bool filled_;
+
+  //! footprint last set on the mirror
+  std::vector<geometry_msgs::Point> footprint_;
+};
+
+} /* namespace mbf_costmap_nav */
+
+#endif /* MBF_COSTMAP_NAV__COSTMAP_MIRROR_H_ */
@@ -41,15 +41,21 @@
 #ifndef MBF_COSTMAP_NAV__COSTMAP_NAVIGATION_SERVER_H_
 #define MBF_COSTMAP_NAV__COSTMAP_NAVIGATION_SERVER_H_
 
+#include <boost/atomic.hpp>
 #include <mbf_abstract_nav/abstract_navigation_server.h>
+#include <mbf_abstract_nav/worker_thread.h>
 
 #include "costmap_planner_execution.h"
 #include "costmap_controller_execution.h"
 #include "costmap_recovery_execution.h"
+#include "costmap_snapshot.h"
+#include "costmap_activation.h"
+#include "footprint_stencil_cache.h"
 
 #include <mbf_costmap_nav/MoveBaseFlexConfig.h>
 #include <std_srvs/Empty.h>
 #include <mbf_msgs/CheckPose.h>
+#include <mbf_msgs/CheckPoses.h>
 
 namespace mbf_costmap_nav
 {
@@ -88,6 +94,28 @@ public:
 
 private:
 
+  /**
+   * @brief Keeps the costmaps active while a service call uses them: it requests their activation on construction
+   *        and, unless someone else still uses them, their deactivation on destruction, on any return path.
+   */
+  class CostmapUseGuard
+  {
+  public:
+    CostmapUseGuard(CostmapNavigationServer &server);
+    ~CostmapUseGuard();
+
+  private:
+    CostmapNavigationServer &server_;
+  };
+
+  /**
+   * @brief Constructs a costmap; used to build both costmaps in parallel on startup.
+   * @param costmap_ptr Shared pointer to set to the new costmap.
+   * @param name Name of the costmap.
+   * @return Always true; the costmap construction waits for the robot transform instead of failing.
+   */
+  bool createCostmap(CostmapPtr &costmap_ptr, const std::string &name);
+
   /**
    * @brief Check whether the costmaps should be activated.
    */
@@ -98,6 +126,19 @@ private:
    */
   void checkDeactivateCostmaps();
 
+  /**
+   * @brief Whether any action or service call is using the costmaps.
+   */
+  bool costmapsInUse();
+
+  /**
+   * @brief Waits until the given costmap is active and current, if costmaps are shut down when not in use.
+   *        Activation must have been requested before with checkActivateCostmaps().
+   * @param activation_ptr Activation of the costmap to wait for.
+   * @param costmap_name Name of the costmap, for logging.
+   */
+  void waitForCostmap(const CostmapActivation::Ptr &activation_ptr, const std::string &costmap_name);
+
   /**
    * @brief Timer-triggered deactivation of both costmaps.
    */
@@ -112,6 +153,48 @@ private:
   bool callServiceCheckPoseCost(mbf_msgs::CheckPose::Request &request,
                                 mbf_msgs::CheckPose::Response &response);
 
+  /**
+   * @brief Callback method for the check_poses_cost service. All the poses are transformed at once and evaluated
+   *        in parallel on the same costmap content.
+   * @param request Request object, see the move_base_flex_msgs/CheckPoses service definition file.
+   * @param response Response object, see the move_base_flex_msgs/CheckPoses service definition file.
+   * @return true, if the service completed successfully, false otherwise
+   */
+  bool callServiceCheckPosesCost(mbf_msgs::CheckPoses::Request &request,
+                                 mbf_msgs::CheckPoses::Response &response);
+
+  /**
+   * @brief Evaluates the footprint placed at the given pose, integrating the cost of all the cells within it.
+   * @param costmap Costmap to evaluate the footprint on; the caller must keep it from changing.
+   * @param footprint Footprint, already padded to the requested safety distance.
+   * @param stencils Precomputed footprint cells to use instead of rasterizing the footprint; can be null.
+   * @param x Pose x coordinate on the costmap frame.
+   * @param y Pose y coordinate on the costmap frame.
+   * @param yaw Pose orientation on the costmap frame.
+   * @param state Pose state, as defined in the move_base_flex_msgs/CheckPose service.
+   * @param cost Total cost of all cells within the footprint.
+   */
+  static void footprintCost(const costmap_2d::Costmap2D &costmap, const std::vector<geometry_msgs::Point> &footprint,
+                            const FootprintStencilCache::Stencils *stencils,
+                            double x, double y, double yaw, uint8_t &state, uint32_t &cost);
+
+  /**
+   * @brief Evaluates the footprint at every step-th pose, starting at the first one; used by the check_poses_cost
+   *        service to split the poses among threads.
+   * @param costmap Costmap to evaluate the footprint on; the caller must keep it from changing.
+   * @param footprint Footprint, already padded to the requested safety distance.
+   * @param stencils Precomputed footprint cells to use instead of rasterizing the footprint; can be null.
+   * @param poses Poses to evaluate, on the costmap frame.
+   * @param first Index of the first pose to evaluate.
+   * @param step Distance between the evaluated poses indices.
+   * @param states Pose states, with the same size as poses.
+   * @param costs Pose costs, with the same size as poses.
+   */
+  static void footprintCosts(const costmap_2d::Costmap2D &costmap, const std::vector<geometry_msgs::Point> &footprint,
+                             const FootprintStencilCache::Stencils *stencils,
+                             const std::vector<geometry_msgs::PoseStamped> &poses, size_t first, size_t step,
+                             std::vector<uint8_t> &states, std::vector<uint32_t> &costs);
+
   /**
    * @brief Callback method for the make_plan service
    * @param request Empty request object.
@@ -144,6 +227,30 @@ private:
    */
   virtual void callActionRecovery(const mbf_msgs::RecoveryGoalConstPtr &goal);
 
+  /**
+   * @brief MoveBase action execution method. This method will be called if the action server receives a goal. It
+   *        extends the base class method by calling the checkActivateCostmaps() and checkDeactivateCostmaps(), so
+   *        the costmaps are kept active along all the planning, controlling and recovery steps.
+   * @param goal SimpleActionServer goal containing all necessary parameters for the action execution. See the action
+   *        definitions in move_base_flex_msgs.
+   */
+  virtual void callActionMoveBase(const mbf_msgs::MoveBaseGoalConstPtr &goal);
+
+  /**
+   * @brief GetPaths service callback. It extends the base class method by keeping the costmaps active during the
+   *        call, see CostmapUseGuard.
+   * @param request GetPaths service request. See the move_base_flex_msgs/GetPaths service definition file.
+   * @param response GetPaths service response. See the move_base_flex_msgs/GetPaths service definition file.
+   * @return true, if the service completed successfully, false otherwise
+   */
+  virtual bool callServiceGetPaths(mbf_msgs::GetPaths::Request &request, mbf_msgs::GetPaths::Response &response);
+
+  /**
+   * @brief Creates a new costmap planner execution on the global costmap, to fill the planner pool.
+   * @return shared pointer to the new planner execution.
+   */
+  virtual mbf_abstract_nav::AbstractPlannerExecution::Ptr newPlannerExecution();
+
   /**
    * @brief Reconfiguration method called by dynamic reconfigure.
    * @param config Configuration parameters. See the MoveBaseFlexConfig definition.
@@ -169,15 +276,48 @@ private:
   //! Shared pointer to the common global costmap
   CostmapPtr global_costmap_ptr_;
 
-  //! true, if the local costmap is active
-  bool local_costmap_active_;
+  //! Snapshots of the local costmap, used by the services instead of locking it
+  CostmapSnapshot::Ptr local_costmap_snapshot_ptr_;
+
+  //! Snapshots of the global costmap, used by the services instead of locking it
+  CostmapSnapshot::Ptr global_costmap_snapshot_ptr_;
 
-  //! true, if the global costmap is active
-  bool global_costmap_active_;
+  //! Footprint cells precomputed for the local costmap; null to rasterize the footprint on every check
+  FootprintStencilCache::Ptr local_footprint_stencil_cache_ptr_;
+
+  //! Footprint cells precomputed for the global costmap; null to rasterize the footprint on every check
+  FootprintStencilCache::Ptr global_footprint_stencil_cache_ptr_;
+
+  //! Maximum age of the costmap snapshots used by the services; negative to lock the live costmaps instead
+  ros::Duration costmap_snapshot_max_age_;
+
+  //! Activation of the local costmap, done asynchronously
+  CostmapActivation::Ptr local_costmap_activation_ptr_;
+
+  //! Activation of the global costmap, done asynchronously
+  CostmapActivation::Ptr global_costmap_activation_ptr_;
+
+  //! Maximum time to wait for a costmap to be active and current before using it
+  ros::Duration costmaps_activation_timeout_;
 
   //! Service Server for the check_pose_cost service
   ros::ServiceServer check_pose_cost_srv_;
 
+  //! Service Server for the check_poses_cost service
+  ros::ServiceServer check_poses_cost_srv_;
+
+  //! Number of threads used by the check_poses_cost service
+  int check_poses_threads_;
+
+  //! Minimum number of poses worth handing to an additional check_poses_cost thread
+  int check_poses_min_chunk_;
+
+  //! Helper threads of the check_poses_cost service, besides the calling one; started once on construction
+  std::vector<boost::shared_ptr<mbf_abstract_nav::WorkerThread> > check_poses_workers_;
+
+  //! Taken by the check_poses_cost call using the helper threads; concurrent calls check their poses by themselves
+  boost::mutex check_poses_mtx_;
+
   //! Service Server for the clear_costmap service
   ros::ServiceServer clear_costmaps_srv_;
 
@@ -186,6 +326,9 @@ private:
   ros::Timer shutdown_costmaps_timer_;    //!< delayed shutdown timer
   ros::Duration shutdown_costmaps_delay_; //!< delayed shutdown delay
 
+  //! Number of service calls using the costmaps; see CostmapUseGuard
+  boost::atomic<unsigned int> active_service_calls_;
+
 };
 
 } /* namespace mbf_costmap_nav */
@@ -41,10 +41,16 @@
 #ifndef MBF_COSTMAP_NAV__COSTMAP_PLANNER_EXECUTION_H_
 #define MBF_COSTMAP_NAV__COSTMAP_PLANNER_EXECUTION_H_
 
+#include <map>
+
+#include <boost/thread/mutex.hpp>
 #include <mbf_abstract_nav/abstract_planner_execution.h>
 #include <mbf_costmap_core/costmap_planner.h>
 #include <costmap_2d/costmap_2d_ros.h>
 
+#include "mbf_costmap_nav/costmap_mirror.h"
+#include "mbf_costmap_nav/plan_cache.h"
+
 namespace mbf_costmap_nav
 {
 /**
@@ -60,10 +66,10 @@ public:
 
   /**
    * @brief Constructor
-   * @param condition Thread sleep condition variable, to wake up connected threads
+   * @param tf_listener_ptr Shared pointer to a common tf listener
    * @param costmap Shared pointer to the costmap.
    */
-  CostmapPlannerExecution(boost::condition_variable &condition, CostmapPtr &costmap);
+  CostmapPlannerExecution(const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr, CostmapPtr &costmap);
 
   /**
    * @brief Destructor
@@ -80,13 +86,32 @@ private:
   virtual mbf_abstract_core::AbstractPlanner::Ptr loadPlannerPlugin(const std::string& planner_type);
 
   /**
-   * @brief Initializes the global planner plugin with its name and pointer to the costmap
+   * @brief Initializes the global planner plugin with its name and pointer to the costmap, or to the mirror of the
+   *        costmap if planner_costmap_mirror is set
+   * @param name The name of the planner plugin.
+   * @param abstract_planner_ptr The planner plugin to initialize.
+   * @return false, if the costmap has not been initialized.
+   */
+  virtual bool initPlugin(const std::string &name, const mbf_abstract_core::AbstractPlanner::Ptr &abstract_planner_ptr);
+
+  /**
+   * @brief Initializes a planner instance of the planner pool or race. With lock_costmap or planner_costmap_mirror set,
+   *        every instance gets its own mirror of the costmap, so the instances plan truly in parallel, without
+   *        locking the costmap but while copying it; otherwise they plan on the costmap itself.
+   * @param name The name of the planner plugin.
+   * @param abstract_planner_ptr The planner instance to initialize.
+   * @return false, if the costmap has not been initialized.
    */
-  virtual void initPlugin();
+  virtual bool initPlannerInstance(const std::string &name,
+                                   const mbf_abstract_core::AbstractPlanner::Ptr &abstract_planner_ptr);
 
   /**
    * @brief calls the planner plugin to make a plan from the start pose to the goal pose with the given tolerance,
-   *        if a goal tolerance is enabled in the planner plugin.
+   *        if a goal tolerance is enabled in the planner plugin. With the plan cache enabled, a still valid cached
+   *        plan of the same planner is returned instead; if lock_costmap is off, the cache never waits for the
+   *        costmap, and it's bypassed while the costmap is locked by someone else.
+   * @param planner_ptr The planner plugin to call
+   * @param planner_name The name of the planner plugin, which the cached plans are kept by
    * @param start The start pose for planning
    * @param goal The goal pose for planning
    * @param tolerance The goal tolerance
@@ -97,6 +122,7 @@ private:
    */
   virtual uint32_t makePlan(
       const mbf_abstract_core::AbstractPlanner::Ptr& planner_ptr,
+      const std::string &planner_name,
       const geometry_msgs::PoseStamped start,
       const geometry_msgs::PoseStamped goal,
       double tolerance,
@@ -104,14 +130,82 @@ private:
       double &cost,
       std::string &message);
 
+  /**
+   * @brief Makes a plan with a planner instance like makePlan(), through the plan cache, on the mirror of the
+   *        instance, if any, which is updated first. See initPlannerInstance().
+   * @param planner_ptr The planner instance to call
+   * @param planner_name The name of the planner plugin, which the cached plans are kept by
+   * @param start The start pose for planning
+   * @param goal The goal pose for planning
+   * @param tolerance The goal tolerance
+   * @param plan The computed plan by the plugin
+   * @param cost The computed costs for the corresponding plan
+   * @param message An optional message which should correspond with the returned outcome
+   * @return An outcome number, see also the action definition in the GetPath.action file
+   */
+  virtual uint32_t makeInstancePlan(
+      const mbf_abstract_core::AbstractPlanner::Ptr& planner_ptr,
+      const std::string &planner_name,
+      const geometry_msgs::PoseStamped start,
+      const geometry_msgs::PoseStamped goal,
+      double tolerance,
+      std::vector<geometry_msgs::PoseStamped> &plan,
+      double &cost,
+      std::string &message);
+
+  /**
+   * @brief Returns the costmap the plugins plan on: the mirror, if any, or the global planner costmap.
+   */
+  costmap_2d::Costmap2DROS *pluginCostmap();
+
+  /**
+   * @brief Creates a new mirror of the costmap, with a name unique within the node.
+   * @return The new mirror.
+   */
+  CostmapMirror::Ptr createMirror();
+
+  /**
+   * @brief Plans on the given costmap, as it is, through the plan cache if enabled. See makePlan() for the other
+   *        parameters.
+   * @param costmap The costmap the planner plans on.
+   * @param mirrored Whether the costmap is a mirror, which nobody writes while planning, or the live costmap.
+   */
+  uint32_t planWithCache(const mbf_abstract_core::AbstractPlanner::Ptr &planner_ptr, const std::string &planner_name,
+                         costmap_2d::Costmap2D *costmap, bool mirrored,
+                         const geometry_msgs::PoseStamped &start, const geometry_msgs::PoseStamped &goal,
+                         double tolerance, std::vector<geometry_msgs::PoseStamped> &plan, double &cost,
+                         std::string &message);
+
+  /**
+   * @brief Checks whether the plan cache can read the costmap guarded by the given lock: always for a mirror, which
+   *        nobody else writes, otherwise if the lock is held or can be taken without waiting.
+   * @param lock Lock on the mutex of the costmap the plugin plans on.
+   * @param mirrored Whether the costmap is a mirror.
+   * @return true, if the plan cache can be used.
+   */
+  bool lockForCache(boost::unique_lock<costmap_2d::Costmap2D::mutex_t> &lock, bool mirrored);
+
   //! Shared pointer to the global planner costmap
   CostmapPtr &costmap_ptr_;
 
+  //! Whether to give the plugins a mirror of the costmap, updated before each plan, instead of the costmap itself
+  bool use_costmap_mirror_;
+
+  //! Mirror of the global planner costmap, created on the first plugin initialization; null if disabled
+  CostmapMirror::Ptr costmap_mirror_ptr_;
+
   //! Whether to lock costmap before calling the planner (see issue #4 for details)
   bool lock_costmap_;
 
-  //! Name of the planner assigned by the class loader
-  std::string planner_name_;
+  //! Mirrors of the planner instances which have their own, by instance
+  std::map<const mbf_abstract_core::AbstractPlanner*, CostmapMirror::Ptr> instance_mirrors_;
+
+  //! Mutex protecting the instance mirrors map; the mirrors themselves are only used by their instance thread
+  boost::mutex instance_mirrors_mtx_;
+
+  //! Cache of the last found plans; null if disabled
+  PlanCache::Ptr plan_cache_ptr_;
+
 };
 
 } /* namespace mbf_costmap_nav */
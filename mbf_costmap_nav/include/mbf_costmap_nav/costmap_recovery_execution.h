@@ -63,13 +63,11 @@ public:
 
   /**
    * @brief Constructor
-   * @param condition Thread sleep condition variable, to wake up connected threads
    * @param tf_listener_ptr Shared pointer to a common tf listener
    * @param global_costmap Shared pointer to the global costmap.
    * @param local_costmap Shared pointer to the local costmap.
    */
-  CostmapRecoveryExecution(boost::condition_variable &condition,
-                            const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr,
+  CostmapRecoveryExecution(const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr,
                             CostmapPtr &global_costmap,
                             CostmapPtr &local_costmap);
 
@@ -90,8 +88,10 @@ private:
 
   /**
    * @brief Initializes a recovery behavior plugin with its name and pointers to the global and local costmaps
+   * @param name The name under which the recovery behavior has been loaded.
+   * @param behavior The recovery behavior plugin to initialize.
    */
-  virtual void initPlugins();
+  virtual void initPlugin(const std::string &name, const mbf_abstract_core::AbstractRecovery::Ptr &behavior);
 
   /**
    * @brief Loads a Recovery plugin associated with given recovery type parameter
@@ -0,0 +1,122 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  costmap_snapshot.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_COSTMAP_NAV__COSTMAP_SNAPSHOT_H_
+#define MBF_COSTMAP_NAV__COSTMAP_SNAPSHOT_H_
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <costmap_2d/costmap_2d_ros.h>
+
+namespace mbf_costmap_nav
+{
+/**
+ * @brief The CostmapSnapshot class provides read-only copies of a costmap, so readers can work on a consistent map
+ *        without holding the costmap mutex, and so without stalling the layer updates. The live costmap is locked
+ *        only while copying it. A snapshot released by all its readers returns its buffer to a spare pool, so the
+ *        next snapshot reuses its memory; the release through the shared pointer reference count orders all the
+ *        readers' accesses before the buffer is written again.
+ *
+ * @ingroup move_base_server
+ */
+class CostmapSnapshot
+{
+public:
+  typedef boost::shared_ptr<CostmapSnapshot> Ptr;
+  typedef boost::shared_ptr<costmap_2d::Costmap2DROS> CostmapPtr;
+  typedef boost::shared_ptr<const costmap_2d::Costmap2D> Costmap2DConstPtr;
+
+  /**
+   * @brief Constructor
+   * @param costmap_ptr Shared pointer to the costmap to copy.
+   */
+  CostmapSnapshot(const CostmapPtr &costmap_ptr);
+
+  /**
+   * @brief Returns a snapshot of the costmap not older than max_age; if the current one is older, a new snapshot is
+   *        taken. The returned costmap stays valid and unchanged as long as the caller holds the pointer.
+   * @param max_age Maximum age of the returned snapshot.
+   * @return Shared pointer to the snapshot.
+   */
+  Costmap2DConstPtr get(const ros::Duration &max_age);
+
+private:
+
+  //! Buffers released by all their readers, ready to be reused; the snapshots still held by readers when it's
+  //! destroyed are freed by their deleters
+  struct Spares
+  {
+    ~Spares();
+    boost::mutex mutex;
+    std::vector<costmap_2d::Costmap2D*> buffers;
+  };
+
+  //! Deleter of the snapshots, returning their buffers to the spares, or freeing them if the spares are gone
+  struct Recycler
+  {
+    boost::weak_ptr<Spares> spares;
+    void operator()(costmap_2d::Costmap2D *buffer) const;
+  };
+
+  //! the live costmap
+  CostmapPtr costmap_ptr_;
+
+  //! mutex protecting the buffers and the stamp
+  boost::mutex mutex_;
+
+  //! mutex to take one snapshot at a time
+  boost::mutex update_mtx_;
+
+  //! the current snapshot
+  boost::shared_ptr<costmap_2d::Costmap2D> front_;
+
+  //! buffers ready to be reused for the next snapshot
+  boost::shared_ptr<Spares> spares_;
+
+  //! time at which the current snapshot has been taken
+  ros::Time stamp_;
+};
+
+} /* namespace mbf_costmap_nav */
+
+#endif /* MBF_COSTMAP_NAV__COSTMAP_SNAPSHOT_H_ */
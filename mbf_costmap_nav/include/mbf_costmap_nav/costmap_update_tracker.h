@@ -0,0 +1,144 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  costmap_update_tracker.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_COSTMAP_NAV__COSTMAP_UPDATE_TRACKER_H_
+#define MBF_COSTMAP_NAV__COSTMAP_UPDATE_TRACKER_H_
+
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <costmap_2d/costmap_2d_ros.h>
+#include <costmap_2d/layer.h>
+#include <tf/transform_listener.h>
+
+namespace mbf_costmap_nav
+{
+/**
+ * @brief The CostmapUpdateTracker class is a layer appended to a live costmap, after all its other layers, which
+ *        records the bounds of every map update without changing the map. The costmap mirrors use it to copy only
+ *        the window of the master grid rewritten since their previous copy. A reset of the layers is recorded as an
+ *        update of the whole map; changes of the map geometry are left to the readers to detect.
+ * @ingroup move_base_server
+ */
+class CostmapUpdateTracker : public costmap_2d::Layer
+{
+public:
+  typedef boost::shared_ptr<CostmapUpdateTracker> Ptr;
+  typedef boost::shared_ptr<costmap_2d::Costmap2DROS> CostmapPtr;
+
+  /**
+   * @brief Constructor
+   */
+  CostmapUpdateTracker();
+
+  /**
+   * @brief Appends a new tracker to the layers of the given costmap, holding its mutex as the map updates do.
+   *        It must be called right after creating the costmap, before other threads use it.
+   * @param costmap_ptr Shared pointer to the costmap.
+   * @param tf_listener TransformListener handed to the layer.
+   * @return The attached tracker.
+   */
+  static Ptr attach(const CostmapPtr &costmap_ptr, tf::TransformListener &tf_listener);
+
+  /**
+   * @brief Looks for the tracker attached to the given costmap.
+   * @param costmap_ptr Shared pointer to the costmap.
+   * @return The attached tracker, or an empty pointer if there is none.
+   */
+  static Ptr find(const CostmapPtr &costmap_ptr);
+
+  /**
+   * @brief Returns the union of the bounds of the map updates recorded since the given one. The caller must hold
+   *        the costmap mutex, so the recorded updates are completely written to the master grid.
+   * @param seq Sequence number of the last update seen by the caller; set to the current one.
+   * @param min_x Minimum x of the updated bounds, in world coordinates; greater than max_x if nothing changed.
+   * @param min_y Minimum y of the updated bounds, in world coordinates; greater than max_y if nothing changed.
+   * @param max_x Maximum x of the updated bounds, in world coordinates.
+   * @param max_y Maximum y of the updated bounds, in world coordinates.
+   * @return false, if the updates since seq are not recorded anymore, so the caller must copy the whole map.
+   */
+  bool getUpdatedBounds(uint64_t &seq, double &min_x, double &min_y, double &max_x, double &max_y);
+
+  /**
+   * @brief Records the bounds of a map update, already expanded by all the previous layers. The map is not changed.
+   */
+  virtual void updateBounds(double robot_x, double robot_y, double robot_yaw,
+                            double *min_x, double *min_y, double *max_x, double *max_y);
+
+  /**
+   * @brief Records a reset of the layers as an update of the whole map.
+   */
+  virtual void reset();
+
+protected:
+
+  /**
+   * @brief Marks the layer as enabled and always current, so it never holds back the costmap.
+   */
+  virtual void onInitialize();
+
+private:
+
+  //! Bounds of a map update, in world coordinates
+  struct Bounds
+  {
+    double min_x, min_y, max_x, max_y;
+  };
+
+  /**
+   * @brief Records the bounds of a map update.
+   */
+  void record(double min_x, double min_y, double max_x, double max_y);
+
+  //! mutex protecting the recorded updates
+  boost::mutex mutex_;
+
+  //! ring buffer with the bounds of the last updates
+  std::vector<Bounds> history_;
+
+  //! number of updates recorded so far
+  uint64_t seq_;
+};
+
+} /* namespace mbf_costmap_nav */
+
+#endif /* MBF_COSTMAP_NAV__COSTMAP_UPDATE_TRACKER_H_ */
@@ -0,0 +1,177 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  footprint_stencil_cache.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_COSTMAP_NAV__FOOTPRINT_STENCIL_CACHE_H_
+#define MBF_COSTMAP_NAV__FOOTPRINT_STENCIL_CACHE_H_
+
+#include <map>
+#include <utility>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <geometry_msgs/Point.h>
+#include <costmap_2d/costmap_2d.h>
+
+namespace mbf_costmap_nav
+{
+/**
+ * @brief The FootprintStencilCache class keeps the costmap cells covered by the robot footprint for a fixed number
+ *        of orientations and of robot positions within a cell, so evaluating the footprint at a pose doesn't need to
+ *        rasterize the footprint polygon again. The cells are stored as row runs relative to the robot cell, and
+ *        rebuilt only when the footprint, the padding or the costmap resolution change. Each costmap needs its own
+ *        cache, as the footprints of the costmaps can differ.
+ *        The cells are those FootprintHelper finds for the pose rounded to the closest orientation bin and to the
+ *        center of the closest sub-cell bin. So a footprint vertex is misplaced by up to half a sub-cell bin,
+ *        i.e. 0.5 * resolution / subcell_bins on each axis, plus up to PI / yaw_bins times its distance to the robot;
+ *        a cell is missed or added only where an edge of the footprint passes within that distance of a cell edge.
+ *
+ * @ingroup move_base_server
+ */
+class FootprintStencilCache
+{
+public:
+  typedef boost::shared_ptr<FootprintStencilCache> Ptr;
+
+  //! Cells within the footprint on one costmap row, relative to the robot cell
+  struct Run
+  {
+    int dy;
+    int dx_min;
+    int dx_max;
+  };
+
+  /**
+   * @brief The Stencils class holds the footprint cells for all the orientation and sub-cell bins of one footprint
+   *        and resolution.
+   *        It is immutable once built, so it can be used from many threads at once.
+   */
+  class Stencils
+  {
+  public:
+    /**
+     * @brief Constructor; rasterizes the footprint for all the orientation and sub-cell bins.
+     * @param footprint Footprint, already padded.
+     * @param resolution Costmap resolution.
+     * @param yaw_bins Number of orientation bins.
+     * @param subcell_bins Number of robot positions within a cell along each axis.
+     */
+    Stencils(const std::vector<geometry_msgs::Point> &footprint, double resolution, unsigned int yaw_bins,
+             unsigned int subcell_bins = 1);
+
+    /**
+     * @brief Integrates the cost of all the cells within the footprint placed at the given pose. The orientation is
+     *        rounded to the closest bin, and the position to the center of the closest sub-cell bin.
+     * @param costmap Costmap to evaluate the footprint on; the caller must keep it from changing.
+     * @param x Pose x coordinate on the costmap frame.
+     * @param y Pose y coordinate on the costmap frame.
+     * @param yaw Pose orientation on the costmap frame.
+     * @param max_cost Highest cost of all cells within the footprint.
+     * @param cost Total cost of all cells within the footprint.
+     * @return false if the footprint is partially or completely outside the map, true otherwise.
+     */
+    bool footprintCost(const costmap_2d::Costmap2D &costmap, double x, double y, double yaw,
+                       unsigned char &max_cost, uint32_t &cost) const;
+
+  private:
+    friend class FootprintStencilCache;
+
+    //! Row runs and bounding box of one orientation and sub-cell bin
+    struct Stencil
+    {
+      std::vector<Run> runs;
+      int dx_min, dx_max, dy_min, dy_max;
+    };
+
+    //! Footprint the stencils were built for
+    std::vector<geometry_msgs::Point> footprint_;
+
+    //! Costmap resolution the stencils were built for
+    double resolution_;
+
+    //! Number of orientation bins
+    unsigned int yaw_bins_;
+
+    //! Number of sub-cell bins along each axis
+    unsigned int subcell_bins_;
+
+    //! One stencil per orientation and sub-cell bin, indexed by (yaw bin * subcell_bins + y bin) * subcell_bins + x bin
+    std::vector<Stencil> stencils_;
+  };
+
+  typedef boost::shared_ptr<const Stencils> StencilsConstPtr;
+
+  /**
+   * @brief Constructor
+   * @param yaw_bins Number of orientation bins in a full turn.
+   * @param subcell_bins Number of robot positions within a cell along each axis; 1 assumes the robot at cell centers.
+   */
+  FootprintStencilCache(unsigned int yaw_bins, unsigned int subcell_bins = 1);
+
+  /**
+   * @brief Returns the stencils for the given footprint padded by padding and costmap resolution, building them if
+   *        not cached yet; a different footprint invalidates all the cached stencils.
+   * @param footprint Unpadded footprint.
+   * @param padding Footprint padding.
+   * @param resolution Costmap resolution.
+   * @return Shared pointer to the stencils.
+   */
+  StencilsConstPtr get(const std::vector<geometry_msgs::Point> &footprint, double padding, double resolution);
+
+private:
+
+  //! Number of orientation bins
+  unsigned int yaw_bins_;
+
+  //! Number of sub-cell bins along each axis
+  unsigned int subcell_bins_;
+
+  //! Mutex protecting the cached stencils
+  boost::mutex mutex_;
+
+  //! Unpadded footprint the cached stencils were built for
+  std::vector<geometry_msgs::Point> footprint_;
+
+  //! Cached stencils for each padding and resolution
+  std::map<std::pair<double, double>, StencilsConstPtr> stencils_;
+};
+
+} /* namespace mbf_costmap_nav */
+
+#endif /* MBF_COSTMAP_NAV__FOOTPRINT_STENCIL_CACHE_H_ */
@@ -0,0 +1,188 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  plan_cache.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_COSTMAP_NAV__PLAN_CACHE_H_
+#define MBF_COSTMAP_NAV__PLAN_CACHE_H_
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <costmap_2d/costmap_2d.h>
+#include <geometry_msgs/Point.h>
+#include <geometry_msgs/PoseStamped.h>
+
+namespace mbf_costmap_nav
+{
+/**
+ * @brief The PlanCache class keeps the most recently found plans in a bounded LRU cache, so repeated requests for
+ *        the same start and goal are answered without calling the planner again. Start and goal are quantized to
+ *        costmap cells and orientation bins. A cached plan is returned only if the costmap geometry and the robot
+ *        footprint are unchanged and none of the cells swept by the footprint along the plan, interpolated at the
+ *        costmap resolution, has become more expensive since the plan was stored.
+ *        The costmap must be locked by the caller while calling lookup and insert.
+ *
+ * @ingroup planner_execution move_base_server
+ */
+class PlanCache
+{
+public:
+  typedef boost::shared_ptr<PlanCache> Ptr;
+
+  /**
+   * @brief Constructor
+   * @param capacity Maximum number of cached plans.
+   * @param angular_resolution Size in radians of the orientation bins used to quantize start and goal.
+   */
+  PlanCache(size_t capacity, double angular_resolution);
+
+  /**
+   * @brief Looks for a still valid plan for the given request; invalid entries are dropped.
+   * @param costmap The costmap the plan is validated against.
+   * @param footprint The padded robot footprint.
+   * @param planner The name of the planner.
+   * @param start The start pose.
+   * @param goal The goal pose.
+   * @param tolerance The goal tolerance.
+   * @param plan The cached plan, restamped with the current time.
+   * @param cost The cost of the cached plan.
+   * @return true, if a valid plan has been found.
+   */
+  bool lookup(const costmap_2d::Costmap2D &costmap, const std::vector<geometry_msgs::Point> &footprint,
+              const std::string &planner,
+              const geometry_msgs::PoseStamped &start, const geometry_msgs::PoseStamped &goal, double tolerance,
+              std::vector<geometry_msgs::PoseStamped> &plan, double &cost);
+
+  /**
+   * @brief Stores a plan found for the given request, evicting the least recently used one if the cache is full.
+   * @param costmap The costmap the plan has been computed on.
+   * @param footprint The padded robot footprint; an empty one checks just the cells traversed by the plan.
+   * @param planner The name of the planner.
+   * @param start The start pose.
+   * @param goal The goal pose.
+   * @param tolerance The goal tolerance.
+   * @param plan The plan found by the planner.
+   * @param cost The cost of the plan.
+   */
+  void insert(const costmap_2d::Costmap2D &costmap, const std::vector<geometry_msgs::Point> &footprint,
+              const std::string &planner,
+              const geometry_msgs::PoseStamped &start, const geometry_msgs::PoseStamped &goal, double tolerance,
+              const std::vector<geometry_msgs::PoseStamped> &plan, double cost);
+
+  /**
+   * @brief Drops all the cached plans.
+   */
+  void clear();
+
+private:
+
+  //! Quantized request
+  struct Key
+  {
+    std::string planner;
+    std::string start_frame_id;
+    std::string goal_frame_id;
+    int start_x, start_y, start_yaw;
+    int goal_x, goal_y, goal_yaw;
+    int tolerance;
+
+    bool operator<(const Key &other) const;
+  };
+
+  //! Costmap geometry the cached plans refer to
+  struct Geometry
+  {
+    unsigned int size_x, size_y;
+    double resolution, origin_x, origin_y;
+
+    bool operator!=(const Geometry &other) const;
+  };
+
+  //! Cached plan, with the costs of the cells swept by the footprint along it at the time it was stored
+  struct Entry
+  {
+    Key key;
+    std::vector<geometry_msgs::PoseStamped> plan;
+    double cost;
+    std::vector<unsigned int> cells;
+    std::vector<unsigned char> cell_costs;
+  };
+
+  typedef std::list<Entry> Entries;
+
+  /**
+   * @brief Quantizes the given request.
+   */
+  Key makeKey(const costmap_2d::Costmap2D &costmap, const std::string &planner,
+              const geometry_msgs::PoseStamped &start, const geometry_msgs::PoseStamped &goal, double tolerance) const;
+
+  /**
+   * @brief Drops all the cached plans if the costmap geometry or the footprint have changed.
+   */
+  void checkGeometry(const costmap_2d::Costmap2D &costmap, const std::vector<geometry_msgs::Point> &footprint);
+
+  //! Maximum number of cached plans
+  const size_t capacity_;
+
+  //! Size in radians of the orientation bins
+  const double angular_resolution_;
+
+  //! mutex protecting the entries
+  boost::mutex mutex_;
+
+  //! cached plans, the most recently used first
+  Entries entries_;
+
+  //! index of the cached plans
+  std::map<Key, Entries::iterator> index_;
+
+  //! costmap geometry of the cached plans
+  Geometry geometry_;
+
+  //! footprint of the cached plans
+  std::vector<geometry_msgs::Point> footprint_;
+};
+
+} /* namespace mbf_costmap_nav */
+
+#endif /* MBF_COSTMAP_NAV__PLAN_CACHE_H_ */
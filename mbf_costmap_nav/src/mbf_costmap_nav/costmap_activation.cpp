@@ -0,0 +1,187 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  costmap_activation.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <mbf_abstract_nav/execution_stats.h>
+#include <mbf_msgs/LatencyStats.h>
+
+#include "mbf_costmap_nav/costmap_activation.h"
+
+namespace mbf_costmap_nav
+{
+
+CostmapActivation::CostmapActivation(const CostmapPtr &costmap_ptr, const std::string &name,
+                                     double standby_frequency)
+  : costmap_ptr_(costmap_ptr), name_(name),
+    standby_period_(standby_frequency > 0.0 ? 1.0 / standby_frequency : 0.0),
+    requested_active_(true), active_(true), shutdown_(false)
+{
+  ros::NodeHandle private_nh("~");
+  activation_latency_pub_ = private_nh.advertise<mbf_msgs::LatencyStats>(name_ + "/activation_latency", 1, true);
+  thread_ = boost::thread(&CostmapActivation::run, this);
+}
+
+CostmapActivation::~CostmapActivation()
+{
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    shutdown_ = true;
+  }
+  condition_.notify_all();
+  thread_.join();
+}
+
+void CostmapActivation::activate()
+{
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    if (requested_active_)
+      return;
+    requested_active_ = true;
+    activation_requested_ = boost::chrono::steady_clock::now();
+  }
+  condition_.notify_all();
+}
+
+void CostmapActivation::deactivate()
+{
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    if (!requested_active_)
+      return;
+    requested_active_ = false;
+  }
+  condition_.notify_all();
+}
+
+bool CostmapActivation::isActive()
+{
+  boost::lock_guard<boost::mutex> guard(mutex_);
+  return requested_active_ || active_;
+}
+
+bool CostmapActivation::waitUntilActive(const ros::Duration &timeout)
+{
+  const boost::chrono::steady_clock::time_point deadline =
+      boost::chrono::steady_clock::now() + boost::chrono::microseconds(timeout.toNSec() / 1000);
+  {
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    while (!(requested_active_ && active_))
+    {
+      if (!requested_active_ || condition_.wait_until(lock, deadline) == boost::cv_status::timeout)
+        return false;
+    }
+  }
+
+  // the layers may still wait for the first observations after restarting the costmap
+  while (!costmap_ptr_->isCurrent())
+  {
+    if (boost::chrono::steady_clock::now() >= deadline)
+      return false;
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+  }
+  return true;
+}
+
+const mbf_abstract_nav::LatencyHistogram &CostmapActivation::getActivationLatency() const
+{
+  return activation_latency_;
+}
+
+void CostmapActivation::run()
+{
+  const bool standby = standby_period_.count() > 0.0;
+
+  boost::unique_lock<boost::mutex> lock(mutex_);
+  while (!shutdown_)
+  {
+    if (requested_active_ && !active_)
+    {
+      lock.unlock();
+      // both calls return after the first map update
+      if (standby)
+        costmap_ptr_->resume();
+      else
+        costmap_ptr_->start();
+      lock.lock();
+
+      active_ = true;
+      boost::chrono::microseconds latency = boost::chrono::duration_cast<boost::chrono::microseconds>(
+          boost::chrono::steady_clock::now() - activation_requested_);
+      activation_latency_.record(latency.count());
+      condition_.notify_all();
+
+      ROS_DEBUG_STREAM("Costmap " << name_ << " activated in " << latency.count() / 1e6 << " s");
+      mbf_msgs::LatencyStats msg;
+      mbf_abstract_nav::ExecutionStats::toMsg(activation_latency_, msg);
+      activation_latency_pub_.publish(msg);
+    }
+    else if (!requested_active_ && active_)
+    {
+      lock.unlock();
+      if (standby)
+        costmap_ptr_->pause();
+      else
+        costmap_ptr_->stop();
+      lock.lock();
+
+      active_ = false;
+      condition_.notify_all();
+      ROS_DEBUG_STREAM("Costmap " << name_ << (standby ? " on standby" : " deactivated"));
+    }
+    else if (!active_ && standby)
+    {
+      // update the map at the standby frequency, unless a transition is requested meanwhile
+      if (condition_.wait_for(lock, standby_period_) == boost::cv_status::timeout &&
+          !shutdown_ && !requested_active_)
+      {
+        lock.unlock();
+        costmap_ptr_->resume();
+        costmap_ptr_->pause();
+        lock.lock();
+      }
+    }
+    else
+    {
+      condition_.wait(lock);
+    }
+  }
+}
+
+} /* namespace mbf_costmap_nav */
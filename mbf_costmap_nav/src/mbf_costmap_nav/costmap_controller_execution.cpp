@@ -44,15 +44,19 @@ namespace mbf_costmap_nav
 {
 
 CostmapControllerExecution::CostmapControllerExecution(
-    boost::condition_variable &condition, const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr,
+    const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr,
     CostmapPtr &costmap_ptr) :
-    AbstractControllerExecution(condition, tf_listener_ptr),
+    AbstractControllerExecution(tf_listener_ptr),
     costmap_ptr_(costmap_ptr)
 {
+  ros::NodeHandle private_nh("~");
+  private_nh.param("controller_lock_costmap", lock_costmap_, true);
+  private_nh.param("controller_costmap_mirror", use_costmap_mirror_, false);
 }
 
 CostmapControllerExecution::~CostmapControllerExecution()
 {
+  terminate();
 }
 
 mbf_abstract_core::AbstractController::Ptr CostmapControllerExecution::loadControllerPlugin(const std::string& controller_type)
@@ -65,8 +69,8 @@ mbf_abstract_core::AbstractController::Ptr CostmapControllerExecution::loadContr
   try
   {
     controller_ptr = class_loader.createInstance(controller_type);
-    controller_name_ = class_loader.getName(controller_type);
-    ROS_INFO_STREAM("MBF_core-based local planner plugin " << controller_name_ << " loaded");
+    std::string controller_name = class_loader.getName(controller_type);
+    ROS_INFO_STREAM("MBF_core-based local planner plugin " << controller_name << " loaded");
   }
   catch (const pluginlib::PluginlibException &ex)
   {
@@ -80,8 +84,8 @@ mbf_abstract_core::AbstractController::Ptr CostmapControllerExecution::loadContr
       boost::shared_ptr<nav_core::BaseLocalPlanner> nav_core_controller_ptr
           = nav_core_class_loader.createInstance(controller_type);
       controller_ptr = boost::make_shared<mbf_nav_core_wrapper::WrapperLocalPlanner>(nav_core_controller_ptr);
-      controller_name_ = nav_core_class_loader.getName(controller_type);
-      ROS_INFO_STREAM("Nav_core-based local planner plugin " << controller_name_ << " loaded");
+      std::string controller_name = nav_core_class_loader.getName(controller_type);
+      ROS_INFO_STREAM("Nav_core-based local planner plugin " << controller_name << " loaded");
     }
     catch (const pluginlib::PluginlibException &ex)
     {
@@ -93,29 +97,33 @@ mbf_abstract_core::AbstractController::Ptr CostmapControllerExecution::loadContr
   return controller_ptr;
 }
 
-void CostmapControllerExecution::initPlugin()
+bool CostmapControllerExecution::initPlugin(const std::string &name, const mbf_abstract_core::AbstractController::Ptr &abstract_controller_ptr)
 {
-  ROS_INFO_STREAM("Initialize controller \"" << controller_name_ << "\".");
+  ROS_INFO_STREAM("Initialize controller \"" << name << "\".");
 
   if (!tf_listener_ptr)
   {
     ROS_ERROR_STREAM("The tf listener pointer has not been initialized!");
-    exit(1);
+    return false;
   }
 
   if (!costmap_ptr_)
   {
     ROS_ERROR_STREAM("The costmap pointer has not been initialized!");
-    exit(1);
+    return false;
   }
 
-  ros::NodeHandle private_nh("~");
-  private_nh.param("controller_lock_costmap", lock_costmap_, true);
-
   mbf_costmap_core::CostmapController::Ptr controller_ptr
-      = boost::static_pointer_cast<mbf_costmap_core::CostmapController>(controller_);
-  controller_ptr->initialize(controller_name_, tf_listener_ptr.get(), costmap_ptr_.get());
-  ROS_INFO_STREAM("Controller plugin \"" << controller_name_ << "\" initialized.");
+      = boost::static_pointer_cast<mbf_costmap_core::CostmapController>(abstract_controller_ptr);
+  if (use_costmap_mirror_ && !costmap_mirror_ptr_)
+  {
+    costmap_mirror_ptr_.reset(new CostmapMirror(costmap_ptr_, costmap_ptr_->getName() + "_controller_mirror",
+                                                *tf_listener_ptr));
+  }
+  controller_ptr->initialize(name, tf_listener_ptr.get(),
+                             costmap_mirror_ptr_ ? costmap_mirror_ptr_->get() : costmap_ptr_.get());
+  ROS_INFO_STREAM("Controller plugin \"" << name << "\" initialized.");
+  return true;
 }
 
 uint32_t CostmapControllerExecution::computeVelocityCmd(const geometry_msgs::PoseStamped& robot_pose,
@@ -123,6 +131,13 @@ uint32_t CostmapControllerExecution::computeVelocityCmd(const geometry_msgs::Pos
                                                         geometry_msgs::TwistStamped& vel_cmd,
                                                         std::string& message)
 {
+  if (costmap_mirror_ptr_)
+  {
+    // the mirror is written only here, so the controller needs no lock
+    costmap_mirror_ptr_->update();
+    return controller_->computeVelocityCommands(robot_pose, robot_velocity, vel_cmd, message);
+  }
+
   // Lock the costmap while planning, but following issue #4, we allow to move the responsibility to the planner itself
   if (lock_costmap_)
   {
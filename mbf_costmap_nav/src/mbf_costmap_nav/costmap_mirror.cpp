@@ -0,0 +1,150 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  costmap_mirror.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include <XmlRpcValue.h>
+
+#include "mbf_costmap_nav/costmap_mirror.h"
+
+namespace mbf_costmap_nav
+{
+
+CostmapMirror::CostmapMirror(const CostmapPtr &costmap_ptr, const std::string &name,
+                             tf::TransformListener &tf_listener) :
+    costmap_ptr_(costmap_ptr), tracker_ptr_(CostmapUpdateTracker::find(costmap_ptr)), seq_(0), filled_(false)
+{
+  // same frames, footprint and size parameters as the live costmap, but no layers and no update or publish cycles
+  ros::NodeHandle private_nh("~");
+  XmlRpc::XmlRpcValue params;
+  private_nh.getParam(costmap_ptr_->getName(), params);
+  params["plugins"].setSize(0);
+  params["update_frequency"] = XmlRpc::XmlRpcValue(0.0);
+  params["publish_frequency"] = XmlRpc::XmlRpcValue(0.0);
+  private_nh.setParam(name, params);
+
+  mirror_ptr_.reset(new costmap_2d::Costmap2DROS(name, tf_listener));
+  update();
+  ROS_INFO_STREAM("Costmap \"" << name << "\" mirrors the costmap \"" << costmap_ptr_->getName() << "\"");
+  if (!tracker_ptr_)
+  {
+    ROS_WARN_STREAM("Costmap \"" << costmap_ptr_->getName() << "\" has no update tracker; its mirror \"" << name
+                    << "\" will copy the whole map on every update");
+  }
+}
+
+costmap_2d::Costmap2DROS *CostmapMirror::get()
+{
+  return mirror_ptr_.get();
+}
+
+static bool sameFootprint(const std::vector<geometry_msgs::Point> &a, const std::vector<geometry_msgs::Point> &b)
+{
+  if (a.size() != b.size())
+    return false;
+  for (size_t i = 0; i < a.size(); ++i)
+  {
+    if (a[i].x != b[i].x || a[i].y != b[i].y || a[i].z != b[i].z)
+      return false;
+  }
+  return true;
+}
+
+void CostmapMirror::update()
+{
+  costmap_2d::Costmap2D *mirror = mirror_ptr_->getCostmap();
+  boost::unique_lock<costmap_2d::Costmap2D::mutex_t> mirror_lock(*(mirror->getMutex()));
+  {
+    costmap_2d::Costmap2D *costmap = costmap_ptr_->getCostmap();
+    boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*(costmap->getMutex()));
+
+    double min_x, min_y, max_x, max_y;
+    bool tracked = tracker_ptr_ && tracker_ptr_->getUpdatedBounds(seq_, min_x, min_y, max_x, max_y);
+    bool same_geometry = mirror->getSizeInCellsX() == costmap->getSizeInCellsX() &&
+                         mirror->getSizeInCellsY() == costmap->getSizeInCellsY() &&
+                         mirror->getResolution() == costmap->getResolution() &&
+                         mirror->getOriginX() == costmap->getOriginX() &&
+                         mirror->getOriginY() == costmap->getOriginY();
+    if (!filled_ || !tracked || !same_geometry)
+    {
+      *mirror = *costmap;
+      filled_ = true;
+    }
+    else if (min_x <= max_x && min_y <= max_y)
+    {
+      copyWindow(*costmap, *mirror, min_x, min_y, max_x, max_y);
+    }
+  }
+  // the footprint can change at runtime, e.g. when the robot picks a load
+  std::vector<geometry_msgs::Point> footprint = costmap_ptr_->getUnpaddedRobotFootprint();
+  if (!sameFootprint(footprint, footprint_))
+  {
+    mirror_ptr_->setUnpaddedRobotFootprint(footprint);
+    footprint_.swap(footprint);
+  }
+}
+
+void CostmapMirror::copyWindow(const costmap_2d::Costmap2D &costmap, costmap_2d::Costmap2D &mirror,
+                               double min_x, double min_y, double max_x, double max_y)
+{
+  // same cells as the layered costmap rewrites for these bounds
+  int x0, y0, xn, yn;
+  costmap.worldToMapEnforceBounds(min_x, min_y, x0, y0);
+  costmap.worldToMapEnforceBounds(max_x, max_y, xn, yn);
+  int size_x = costmap.getSizeInCellsX();
+  int size_y = costmap.getSizeInCellsY();
+  x0 = std::max(0, x0);
+  y0 = std::max(0, y0);
+  xn = std::min(size_x, xn + 1);
+  yn = std::min(size_y, yn + 1);
+  if (x0 >= xn || y0 >= yn)
+    return;
+
+  const unsigned char *source = costmap.getCharMap();
+  unsigned char *target = mirror.getCharMap();
+  for (int y = y0; y < yn; ++y)
+  {
+    size_t offset = static_cast<size_t>(y) * size_x + x0;
+    std::memcpy(target + offset, source + offset, xn - x0);
+  }
+}
+
+} /* namespace mbf_costmap_nav */
@@ -38,15 +38,16 @@
  *
  */
 
+#include <boost/lexical_cast.hpp>
 #include <nav_msgs/Path.h>
 #include <geometry_msgs/PoseArray.h>
 #include <costmap_2d/costmap_2d_ros.h>
 #include <base_local_planner/footprint_helper.h>
 #include <mbf_msgs/MoveBaseAction.h>
 #include <mbf_abstract_nav/MoveBaseFlexConfig.h>
-#include <actionlib/client/simple_action_client.h>
 
 #include "mbf_costmap_nav/costmap_navigation_server.h"
+#include "mbf_costmap_nav/costmap_update_tracker.h"
 
 namespace mbf_costmap_nav
 {
@@ -55,37 +56,88 @@ namespace mbf_costmap_nav
 CostmapNavigationServer::CostmapNavigationServer(const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr) :
   AbstractNavigationServer(tf_listener_ptr,
                            CostmapPlannerExecution::Ptr(
-                                new CostmapPlannerExecution(condition_, global_costmap_ptr_)),
+                                new CostmapPlannerExecution(tf_listener_ptr, global_costmap_ptr_)),
                            CostmapControllerExecution::Ptr(
-                                new CostmapControllerExecution(condition_, tf_listener_ptr,
-                                                               local_costmap_ptr_)),
+                                new CostmapControllerExecution(tf_listener_ptr, local_costmap_ptr_)),
                            CostmapRecoveryExecution::Ptr(
-                                new CostmapRecoveryExecution(condition_, tf_listener_ptr,
+                                new CostmapRecoveryExecution(tf_listener_ptr,
                                                              global_costmap_ptr_,
                                                              local_costmap_ptr_))),
-    global_costmap_ptr_(new costmap_2d::Costmap2DROS("global_costmap", *tf_listener_ptr_)),
-    local_costmap_ptr_(new costmap_2d::Costmap2DROS("local_costmap", *tf_listener_ptr_))
+  setup_reconfigure_(false), active_service_calls_(0)
 {
+  // the executions hold references to the costmap pointers, so we can build the costmaps here, in parallel if
+  // parallel_startup is true; most of their construction time is spent waiting for the robot transform
+  std::vector<StartupStep> costmap_steps;
+  costmap_steps.push_back(StartupStep("global_costmap", boost::bind(&CostmapNavigationServer::createCostmap, this,
+                                                                    boost::ref(global_costmap_ptr_),
+                                                                    std::string("global_costmap"))));
+  costmap_steps.push_back(StartupStep("local_costmap", boost::bind(&CostmapNavigationServer::createCostmap, this,
+                                                                   boost::ref(local_costmap_ptr_),
+                                                                   std::string("local_costmap"))));
+  runStartupSteps(costmap_steps);
+
   // even if shutdown_costmaps is a dynamically reconfigurable parameter, we
   // need it here to decide weather to start or not the costmaps on starting up
   private_nh_.param("shutdown_costmaps", shutdown_costmaps_, false);
 
-  // initialize costmaps (stopped if shutdown_costmaps is true)
-  if (!shutdown_costmaps_)
+  // services read consistent costmap snapshots, instead of locking the costmaps, if a maximum age is given
+  double costmap_snapshot_max_age;
+  private_nh_.param("costmap_snapshot_max_age", costmap_snapshot_max_age, -1.0);
+  costmap_snapshot_max_age_ = ros::Duration(costmap_snapshot_max_age);
+  local_costmap_snapshot_ptr_ = boost::make_shared<CostmapSnapshot>(local_costmap_ptr_);
+  global_costmap_snapshot_ptr_ = boost::make_shared<CostmapSnapshot>(global_costmap_ptr_);
+
+  // check_poses_cost service uses as many threads as cores by default
+  private_nh_.param("check_poses_threads", check_poses_threads_, 0);
+  if (check_poses_threads_ <= 0)
+    check_poses_threads_ = std::max(1u, boost::thread::hardware_concurrency());
+  for (int t = 1; t < check_poses_threads_; ++t)
+    check_poses_workers_.push_back(boost::make_shared<mbf_abstract_nav::WorkerThread>(
+        "check_poses_" + boost::lexical_cast<std::string>(t)));
+
+  // few poses are not worth the cost of waking up another thread
+  private_nh_.param("check_poses_min_chunk", check_poses_min_chunk_, 32);
+  check_poses_min_chunk_ = std::max(check_poses_min_chunk_, 1);
+
+  // pose checks use footprint cells precomputed for this number of orientations; 0 to rasterize it every time;
+  // more sub-cell bins reduce the error of assuming the robot at a few positions within its cell
+  int footprint_stencil_yaw_bins, footprint_stencil_subcell_bins;
+  private_nh_.param("footprint_stencil_yaw_bins", footprint_stencil_yaw_bins, 0);
+  private_nh_.param("footprint_stencil_subcell_bins", footprint_stencil_subcell_bins, 1);
+  if (footprint_stencil_yaw_bins > 0)
   {
-    local_costmap_active_ = true;
-    global_costmap_active_ = true;
+    footprint_stencil_subcell_bins = std::max(footprint_stencil_subcell_bins, 1);
+    local_footprint_stencil_cache_ptr_ =
+        boost::make_shared<FootprintStencilCache>(footprint_stencil_yaw_bins, footprint_stencil_subcell_bins);
+    global_footprint_stencil_cache_ptr_ =
+        boost::make_shared<FootprintStencilCache>(footprint_stencil_yaw_bins, footprint_stencil_subcell_bins);
   }
-  else
+
+  // costmaps are activated in the background; with a standby frequency, inactive costmaps keep their layers
+  // subscribed and update the map at that rate, instead of stopping, so activation doesn't need to warm them up
+  double costmaps_standby_frequency, costmaps_activation_timeout;
+  private_nh_.param("costmaps_standby_frequency", costmaps_standby_frequency, 0.0);
+  private_nh_.param("costmaps_activation_timeout", costmaps_activation_timeout, 2.0);
+  costmaps_activation_timeout_ = ros::Duration(costmaps_activation_timeout);
+  local_costmap_activation_ptr_ =
+      boost::make_shared<CostmapActivation>(local_costmap_ptr_, "local_costmap", costmaps_standby_frequency);
+  global_costmap_activation_ptr_ =
+      boost::make_shared<CostmapActivation>(global_costmap_ptr_, "global_costmap", costmaps_standby_frequency);
+
+  // initialize costmaps (stopped or on standby if shutdown_costmaps is true)
+  if (shutdown_costmaps_)
   {
-    local_costmap_ptr_->stop();
-    global_costmap_ptr_->stop();
-    local_costmap_active_ = false;
-    global_costmap_active_ = false;
+    local_costmap_activation_ptr_->deactivate();
+    global_costmap_activation_ptr_->deactivate();
   }
 
-  // initialize all plugins
-  initializeServerComponents();
+  // initialize all plugins; the server can't work without its planner and controller
+  if (!initializeServerComponents())
+  {
+    ROS_FATAL_STREAM("Could not initialize the navigation server; shutting down");
+    ros::shutdown();
+    return;
+  }
 
   // start all action servers
   startActionServers();
@@ -93,6 +145,8 @@ CostmapNavigationServer::CostmapNavigationServer(const boost::shared_ptr<tf::Tra
   // advertise services and current goal topic
   check_pose_cost_srv_ = private_nh_.advertiseService("check_pose_cost",
                                                       &CostmapNavigationServer::callServiceCheckPoseCost, this);
+  check_poses_cost_srv_ = private_nh_.advertiseService("check_poses_cost",
+                                                       &CostmapNavigationServer::callServiceCheckPosesCost, this);
   clear_costmaps_srv_ = private_nh_.advertiseService("clear_costmaps",
                                                      &CostmapNavigationServer::callServiceClearCostmaps, this);
 
@@ -105,10 +159,21 @@ CostmapNavigationServer::CostmapNavigationServer(const boost::shared_ptr<tf::Tra
 
 CostmapNavigationServer::~CostmapNavigationServer()
 {
+  // finish pending transitions before stopping the costmaps
+  local_costmap_activation_ptr_.reset();
+  global_costmap_activation_ptr_.reset();
   local_costmap_ptr_->stop();
   global_costmap_ptr_->stop();
 }
 
+bool CostmapNavigationServer::createCostmap(CostmapPtr &costmap_ptr, const std::string &name)
+{
+  costmap_ptr.reset(new costmap_2d::Costmap2DROS(name, *tf_listener_ptr_));
+  // record the updated windows, so the costmap mirrors copy just them
+  CostmapUpdateTracker::attach(costmap_ptr, *tf_listener_ptr_);
+  return true;
+}
+
 void CostmapNavigationServer::reconfigure(mbf_costmap_nav::MoveBaseFlexConfig &config, uint32_t level)
 {
   boost::recursive_mutex::scoped_lock sl(configuration_mutex_);
@@ -167,15 +232,24 @@ bool CostmapNavigationServer::callServiceCheckPoseCost(mbf_msgs::CheckPose::Requ
 {
   // selecting the requested costmap
   CostmapPtr costmap;
+  CostmapSnapshot::Ptr costmap_snapshot;
+  FootprintStencilCache::Ptr footprint_stencil_cache;
+  CostmapActivation::Ptr costmap_activation;
   std::string costmap_name;
   switch (request.costmap)
   {
     case mbf_msgs::CheckPose::Request::LOCAL_COSTMAP:
       costmap = local_costmap_ptr_;
+      costmap_snapshot = local_costmap_snapshot_ptr_;
+      footprint_stencil_cache = local_footprint_stencil_cache_ptr_;
+      costmap_activation = local_costmap_activation_ptr_;
       costmap_name = "local costmap";
       break;
     case mbf_msgs::CheckPose::Request::GLOBAL_COSTMAP:
       costmap = global_costmap_ptr_;
+      costmap_snapshot = global_costmap_snapshot_ptr_;
+      footprint_stencil_cache = global_footprint_stencil_cache_ptr_;
+      costmap_activation = global_costmap_activation_ptr_;
       costmap_name = "global costmap";
       break;
     default:
@@ -191,7 +265,10 @@ bool CostmapNavigationServer::callServiceCheckPoseCost(mbf_msgs::CheckPose::Requ
   geometry_msgs::PoseStamped pose;
   if (request.current_pose)
   {
-    if (! mbf_abstract_nav::getRobotPose(*tf_listener_ptr_, robot_frame_, costmap_frame, ros::Duration(0.5), pose))
+    // the tracked robot pose is in the global frame; only for costmaps on other frames we must query TF
+    bool pose_ok = costmap_frame == global_frame_ ? getRobotPose(pose) :
+        mbf_abstract_nav::getRobotPose(*tf_listener_ptr_, robot_frame_, costmap_frame, ros::Duration(0.5), pose);
+    if (!pose_ok)
     {
       ROS_ERROR_STREAM("Get robot pose on " << costmap_name << " frame '" << costmap_frame << "' failed");
       return false;
@@ -211,51 +288,31 @@ bool CostmapNavigationServer::callServiceCheckPoseCost(mbf_msgs::CheckPose::Requ
   double y = pose.pose.position.y;
   double yaw = tf::getYaw(pose.pose.orientation);
 
-  // lock costmap so content doesn't change while adding cell costs
-  boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*(costmap->getCostmap()->getMutex()));
+  // ensure it's active so cost reflects latest sensor readings, and keep it active until we are done
+  CostmapUseGuard costmap_use(*this);
+  waitForCostmap(costmap_activation, costmap_name);
 
-  // ensure it's active so cost reflects latest sensor readings
-  checkActivateCostmaps();
-
-  // pad raw footprint to the requested safety distance; note that we discard footprint_padding parameter effect
-  std::vector<geometry_msgs::Point> footprint = costmap->getUnpaddedRobotFootprint();
-  costmap_2d::padFootprint(footprint, request.safety_dist);
-
-  // use a footprint helper instance to get all the cells totally or partially within footprint polygon
-  base_local_planner::FootprintHelper fph;
-  std::vector<base_local_planner::Position2DInt> footprint_cells =
-    fph.getFootprintCells(Eigen::Vector3f(x, y, yaw), footprint, *costmap->getCostmap(), true);
-  response.state = mbf_msgs::CheckPose::Response::FREE;
-  if (footprint_cells.empty())
+  // use a recent enough snapshot or lock costmap, so content doesn't change while adding cell costs
+  CostmapSnapshot::Costmap2DConstPtr snapshot;
+  boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*(costmap->getCostmap()->getMutex()), boost::defer_lock);
+  if (costmap_snapshot_max_age_ >= ros::Duration(0))
   {
-    // no cells within footprint polygon must mean that robot is completely outside of the map
-    response.state = std::max(response.state, static_cast<uint8_t>(mbf_msgs::CheckPose::Response::OUTSIDE));
+    snapshot = costmap_snapshot->get(costmap_snapshot_max_age_);
   }
   else
   {
-    // integrate the cost of all cells; state value precedence is UNKNOWN > LETHAL > INSCRIBED > FREE
-    for (int i = 0; i < footprint_cells.size(); ++i)
-    {
-      unsigned char cost = costmap->getCostmap()->getCost(footprint_cells[i].x, footprint_cells[i].y);
-      switch (cost)
-      {
-        case costmap_2d::NO_INFORMATION:
-          response.state = std::max(response.state, static_cast<uint8_t>(mbf_msgs::CheckPose::Response::UNKNOWN));
-          response.cost += cost;
-          break;
-        case costmap_2d::LETHAL_OBSTACLE:
-          response.state = std::max(response.state, static_cast<uint8_t>(mbf_msgs::CheckPose::Response::LETHAL));
-          response.cost += cost;
-          break;
-        case costmap_2d::INSCRIBED_INFLATED_OBSTACLE:
-          response.state = std::max(response.state, static_cast<uint8_t>(mbf_msgs::CheckPose::Response::INSCRIBED));
-          response.cost += cost;
-          break;
-        default:response.cost += cost;
-          break;
-      }
-    }
+    lock.lock();
   }
+  const costmap_2d::Costmap2D &costmap_2d = snapshot ? *snapshot : *costmap->getCostmap();
+
+  // pad raw footprint to the requested safety distance; note that we discard footprint_padding parameter effect
+  std::vector<geometry_msgs::Point> footprint = costmap->getUnpaddedRobotFootprint();
+  FootprintStencilCache::StencilsConstPtr stencils;
+  if (footprint_stencil_cache)
+    stencils = footprint_stencil_cache->get(footprint, request.safety_dist, costmap_2d.getResolution());
+  costmap_2d::padFootprint(footprint, request.safety_dist);
+
+  footprintCost(costmap_2d, footprint, stencils.get(), x, y, yaw, response.state, response.cost);
 
   // Provide some details of the outcome
   switch (response.state)
@@ -282,11 +339,175 @@ bool CostmapNavigationServer::callServiceCheckPoseCost(mbf_msgs::CheckPose::Requ
       break;
   }
 
-  checkDeactivateCostmaps();
+  return true;
+}
+
+bool CostmapNavigationServer::callServiceCheckPosesCost(mbf_msgs::CheckPoses::Request &request,
+                                                        mbf_msgs::CheckPoses::Response &response)
+{
+  // selecting the requested costmap
+  CostmapPtr costmap;
+  CostmapSnapshot::Ptr costmap_snapshot;
+  FootprintStencilCache::Ptr footprint_stencil_cache;
+  CostmapActivation::Ptr costmap_activation;
+  std::string costmap_name;
+  switch (request.costmap)
+  {
+    case mbf_msgs::CheckPoses::Request::LOCAL_COSTMAP:
+      costmap = local_costmap_ptr_;
+      costmap_snapshot = local_costmap_snapshot_ptr_;
+      footprint_stencil_cache = local_footprint_stencil_cache_ptr_;
+      costmap_activation = local_costmap_activation_ptr_;
+      costmap_name = "local costmap";
+      break;
+    case mbf_msgs::CheckPoses::Request::GLOBAL_COSTMAP:
+      costmap = global_costmap_ptr_;
+      costmap_snapshot = global_costmap_snapshot_ptr_;
+      footprint_stencil_cache = global_footprint_stencil_cache_ptr_;
+      costmap_activation = global_costmap_activation_ptr_;
+      costmap_name = "global costmap";
+      break;
+    default:
+      ROS_ERROR_STREAM("No valid costmap provided; options are "
+                       << mbf_msgs::CheckPoses::Request::LOCAL_COSTMAP << ": local costmap, "
+                       << mbf_msgs::CheckPoses::Request::GLOBAL_COSTMAP << ": global costmap");
+      return false;
+  }
+
+  // transform all the poses at once; poses sharing frame and stamp need a single lookup
+  std::string costmap_frame = costmap->getGlobalFrameID();
+
+  std::vector<geometry_msgs::PoseStamped> poses;
+  if (!mbf_abstract_nav::transformPlan(*tf_listener_ptr_, costmap_frame, ros::Duration(0.5), request.poses, poses))
+  {
+    ROS_ERROR_STREAM("Transform poses to " << costmap_name << " frame '" << costmap_frame << "' failed");
+    return false;
+  }
+
+  // ensure it's active so cost reflects latest sensor readings, and keep it active until we are done
+  CostmapUseGuard costmap_use(*this);
+  waitForCostmap(costmap_activation, costmap_name);
+
+  // use a recent enough snapshot or lock costmap, so content doesn't change while adding cell costs
+  CostmapSnapshot::Costmap2DConstPtr snapshot;
+  boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*(costmap->getCostmap()->getMutex()), boost::defer_lock);
+  if (costmap_snapshot_max_age_ >= ros::Duration(0))
+  {
+    snapshot = costmap_snapshot->get(costmap_snapshot_max_age_);
+  }
+  else
+  {
+    lock.lock();
+  }
+  const costmap_2d::Costmap2D &costmap_2d = snapshot ? *snapshot : *costmap->getCostmap();
+
+  // pad raw footprint to the requested safety distance only once for all the poses
+  std::vector<geometry_msgs::Point> footprint = costmap->getUnpaddedRobotFootprint();
+  FootprintStencilCache::StencilsConstPtr stencils;
+  if (footprint_stencil_cache)
+    stencils = footprint_stencil_cache->get(footprint, request.safety_dist, costmap_2d.getResolution());
+  costmap_2d::padFootprint(footprint, request.safety_dist);
+
+  response.states.resize(poses.size());
+  response.costs.resize(poses.size());
+
+  // spread the poses among the helper threads, if no other call is using them
+  boost::unique_lock<boost::mutex> workers_lock(check_poses_mtx_, boost::try_to_lock);
+  size_t threads = 1;
+  if (workers_lock.owns_lock())
+    threads = std::min(check_poses_workers_.size() + 1, poses.size() / check_poses_min_chunk_ + 1);
+
+  for (size_t t = 1; t < threads; ++t)
+  {
+    check_poses_workers_[t - 1]->post(boost::bind(&CostmapNavigationServer::footprintCosts, boost::cref(costmap_2d),
+                                                  boost::cref(footprint), stencils.get(), boost::cref(poses), t,
+                                                  threads, boost::ref(response.states), boost::ref(response.costs)));
+  }
+  footprintCosts(costmap_2d, footprint, stencils.get(), poses, 0, threads, response.states, response.costs);
+  for (size_t t = 1; t < threads; ++t)
+    check_poses_workers_[t - 1]->waitUntilIdle();
+  workers_lock.unlock();
+
+  ROS_DEBUG_STREAM("Checked " << poses.size() << " poses on " << costmap_name << " using " << threads
+                   << " threads (safety distance = " << request.safety_dist << ")");
 
   return true;
 }
 
+void CostmapNavigationServer::footprintCost(const costmap_2d::Costmap2D &costmap,
+                                            const std::vector<geometry_msgs::Point> &footprint,
+                                            const FootprintStencilCache::Stencils *stencils,
+                                            double x, double y, double yaw, uint8_t &state, uint32_t &cost)
+{
+  if (stencils)
+  {
+    // state value precedence UNKNOWN > LETHAL > INSCRIBED > FREE follows the cell costs, so the highest one is enough
+    unsigned char max_cost;
+    if (!stencils->footprintCost(costmap, x, y, yaw, max_cost, cost))
+      state = mbf_msgs::CheckPose::Response::OUTSIDE;
+    else if (max_cost == costmap_2d::NO_INFORMATION)
+      state = mbf_msgs::CheckPose::Response::UNKNOWN;
+    else if (max_cost == costmap_2d::LETHAL_OBSTACLE)
+      state = mbf_msgs::CheckPose::Response::LETHAL;
+    else if (max_cost == costmap_2d::INSCRIBED_INFLATED_OBSTACLE)
+      state = mbf_msgs::CheckPose::Response::INSCRIBED;
+    else
+      state = mbf_msgs::CheckPose::Response::FREE;
+    return;
+  }
+
+  // use a footprint helper instance to get all the cells totally or partially within footprint polygon
+  base_local_planner::FootprintHelper fph;
+  std::vector<base_local_planner::Position2DInt> footprint_cells =
+    fph.getFootprintCells(Eigen::Vector3f(x, y, yaw), footprint, costmap, true);
+  state = mbf_msgs::CheckPose::Response::FREE;
+  cost = 0;
+  if (footprint_cells.empty())
+  {
+    // no cells within footprint polygon must mean that robot is completely outside of the map
+    state = std::max(state, static_cast<uint8_t>(mbf_msgs::CheckPose::Response::OUTSIDE));
+  }
+  else
+  {
+    // integrate the cost of all cells; state value precedence is UNKNOWN > LETHAL > INSCRIBED > FREE
+    for (int i = 0; i < footprint_cells.size(); ++i)
+    {
+      unsigned char cell_cost = costmap.getCost(footprint_cells[i].x, footprint_cells[i].y);
+      switch (cell_cost)
+      {
+        case costmap_2d::NO_INFORMATION:
+          state = std::max(state, static_cast<uint8_t>(mbf_msgs::CheckPose::Response::UNKNOWN));
+          cost += cell_cost;
+          break;
+        case costmap_2d::LETHAL_OBSTACLE:
+          state = std::max(state, static_cast<uint8_t>(mbf_msgs::CheckPose::Response::LETHAL));
+          cost += cell_cost;
+          break;
+        case costmap_2d::INSCRIBED_INFLATED_OBSTACLE:
+          state = std::max(state, static_cast<uint8_t>(mbf_msgs::CheckPose::Response::INSCRIBED));
+          cost += cell_cost;
+          break;
+        default:cost += cell_cost;
+          break;
+      }
+    }
+  }
+}
+
+void CostmapNavigationServer::footprintCosts(const costmap_2d::Costmap2D &costmap,
+                                             const std::vector<geometry_msgs::Point> &footprint,
+                                             const FootprintStencilCache::Stencils *stencils,
+                                             const std::vector<geometry_msgs::PoseStamped> &poses,
+                                             size_t first, size_t step,
+                                             std::vector<uint8_t> &states, std::vector<uint32_t> &costs)
+{
+  for (size_t i = first; i < poses.size(); i += step)
+  {
+    footprintCost(costmap, footprint, stencils, poses[i].pose.position.x, poses[i].pose.position.y,
+                  tf::getYaw(poses[i].pose.orientation), states[i], costs[i]);
+  }
+}
+
 bool CostmapNavigationServer::callServiceClearCostmaps(std_srvs::Empty::Request &request,
                                                        std_srvs::Empty::Response &response)
 {
@@ -299,26 +520,34 @@ void CostmapNavigationServer::checkActivateCostmaps()
 {
   shutdown_costmaps_timer_.stop();
 
-  // Activate costmaps if we shutdown them when not moving and they are not already active
-  if (shutdown_costmaps_ && !local_costmap_active_)
+  // Activate costmaps if we shutdown them when not moving; both get activated in parallel in the background,
+  // and each caller waits only for the costmap it needs
+  if (shutdown_costmaps_)
   {
-    local_costmap_ptr_->start();
-    local_costmap_active_ = true;
-    ROS_DEBUG_STREAM("Local costmap activated.");
+    local_costmap_activation_ptr_->activate();
+    global_costmap_activation_ptr_->activate();
   }
+}
 
-  if (shutdown_costmaps_ && !global_costmap_active_)
+void CostmapNavigationServer::waitForCostmap(const CostmapActivation::Ptr &activation_ptr,
+                                             const std::string &costmap_name)
+{
+  if (shutdown_costmaps_ && !activation_ptr->waitUntilActive(costmaps_activation_timeout_))
   {
-    global_costmap_ptr_->start();
-    global_costmap_active_ = true;
-    ROS_DEBUG_STREAM("Global costmap activated.");
+    ROS_WARN_STREAM("The " << costmap_name << " is not current after " << costmaps_activation_timeout_.toSec()
+                    << " s since activation; using it anyway");
   }
 }
 
+bool CostmapNavigationServer::costmapsInUse()
+{
+  return active_planning_ || active_moving_ || active_recovery_ || active_service_calls_ > 0;
+}
+
 void CostmapNavigationServer::checkDeactivateCostmaps()
 {
   if (!ros::ok() ||
-      ((local_costmap_active_ || global_costmap_active_) && !(active_planning_ || active_moving_ || active_recovery_)))
+      ((local_costmap_activation_ptr_->isActive() || global_costmap_activation_ptr_->isActive()) && !costmapsInUse()))
   {
     // Delay costmaps shutdown by shutdown_costmaps_delay so we don't need to enable at each step of a normal
     // navigation sequence, what is terribly inneficient; the timer is stopped on costmaps re-activation and
@@ -330,17 +559,18 @@ void CostmapNavigationServer::checkDeactivateCostmaps()
 
 void CostmapNavigationServer::deactivateCostmaps(const ros::TimerEvent &event)
 {
-  local_costmap_ptr_->stop();
-  local_costmap_active_ = false;
-  ROS_DEBUG_STREAM("Local costmap deactivated.");
-  global_costmap_ptr_->stop();
-  global_costmap_active_ = false;
-  ROS_DEBUG_STREAM("Global costmap deactivated.");
+  if (costmapsInUse() && ros::ok())
+  {
+    return;  // someone started using the costmaps while the timer was running
+  }
+  local_costmap_activation_ptr_->deactivate();
+  global_costmap_activation_ptr_->deactivate();
 }
 
 void CostmapNavigationServer::callActionGetPath(const mbf_msgs::GetPathGoalConstPtr &goal)
 {
   checkActivateCostmaps();
+  waitForCostmap(global_costmap_activation_ptr_, "global costmap");
   AbstractNavigationServer::callActionGetPath(goal);
   checkDeactivateCostmaps();
 }
@@ -348,6 +578,7 @@ void CostmapNavigationServer::callActionGetPath(const mbf_msgs::GetPathGoalConst
 void CostmapNavigationServer::callActionExePath(const mbf_msgs::ExePathGoalConstPtr &goal)
 {
   checkActivateCostmaps();
+  waitForCostmap(local_costmap_activation_ptr_, "local costmap");
   AbstractNavigationServer::callActionExePath(goal);
   checkDeactivateCostmaps();
 }
@@ -355,8 +586,44 @@ void CostmapNavigationServer::callActionExePath(const mbf_msgs::ExePathGoalConst
 void CostmapNavigationServer::callActionRecovery(const mbf_msgs::RecoveryGoalConstPtr &goal)
 {
   checkActivateCostmaps();
+  waitForCostmap(local_costmap_activation_ptr_, "local costmap");
+  waitForCostmap(global_costmap_activation_ptr_, "global costmap");
   AbstractNavigationServer::callActionRecovery(goal);
   checkDeactivateCostmaps();
 }
 
+void CostmapNavigationServer::callActionMoveBase(const mbf_msgs::MoveBaseGoalConstPtr &goal)
+{
+  checkActivateCostmaps();
+  waitForCostmap(global_costmap_activation_ptr_, "global costmap");
+  waitForCostmap(local_costmap_activation_ptr_, "local costmap");
+  AbstractNavigationServer::callActionMoveBase(goal);
+  checkDeactivateCostmaps();
+}
+
+bool CostmapNavigationServer::callServiceGetPaths(mbf_msgs::GetPaths::Request &request,
+                                                  mbf_msgs::GetPaths::Response &response)
+{
+  CostmapUseGuard costmap_use(*this);
+  waitForCostmap(global_costmap_activation_ptr_, "global costmap");
+  return AbstractNavigationServer::callServiceGetPaths(request, response);
+}
+
+CostmapNavigationServer::CostmapUseGuard::CostmapUseGuard(CostmapNavigationServer &server) : server_(server)
+{
+  ++server_.active_service_calls_;
+  server_.checkActivateCostmaps();
+}
+
+CostmapNavigationServer::CostmapUseGuard::~CostmapUseGuard()
+{
+  --server_.active_service_calls_;
+  server_.checkDeactivateCostmaps();
+}
+
+mbf_abstract_nav::AbstractPlannerExecution::Ptr CostmapNavigationServer::newPlannerExecution()
+{
+  return CostmapPlannerExecution::Ptr(new CostmapPlannerExecution(tf_listener_ptr_, global_costmap_ptr_));
+}
+
 } /* namespace mbf_costmap_nav */
@@ -37,6 +37,8 @@
  *    Jorge Santos Simón <santos@magazino.eu>
  *
  */
+#include <boost/atomic.hpp>
+#include <boost/lexical_cast.hpp>
 #include <nav_core/base_global_planner.h>
 #include <nav_core_wrapper/wrapper_global_planner.h>
 
@@ -45,13 +47,29 @@
 namespace mbf_costmap_nav
 {
 
-CostmapPlannerExecution::CostmapPlannerExecution(boost::condition_variable &condition, CostmapPtr &costmap_ptr) :
-    AbstractPlannerExecution(condition), costmap_ptr_(costmap_ptr)
+CostmapPlannerExecution::CostmapPlannerExecution(const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr,
+                                                 CostmapPtr &costmap_ptr) :
+    AbstractPlannerExecution(tf_listener_ptr), costmap_ptr_(costmap_ptr)
 {
+  // TODO check this
+  ros::NodeHandle private_nh("~");
+  private_nh.param("planner_lock_costmap", lock_costmap_, true);
+  private_nh.param("planner_costmap_mirror", use_costmap_mirror_, false);
+
+  // plans are cached per planner plugin, so they survive plugin switches
+  int plan_cache_size;
+  double plan_cache_angular_resolution;
+  private_nh.param("plan_cache_size", plan_cache_size, 0);
+  private_nh.param("plan_cache_angular_resolution", plan_cache_angular_resolution, 0.1);
+  if (plan_cache_size > 0 && plan_cache_angular_resolution > 0.0)
+  {
+    plan_cache_ptr_.reset(new PlanCache(plan_cache_size, plan_cache_angular_resolution));
+  }
 }
 
 CostmapPlannerExecution::~CostmapPlannerExecution()
 {
+  terminate();
 }
 
 mbf_abstract_core::AbstractPlanner::Ptr CostmapPlannerExecution::loadPlannerPlugin(const std::string& planner_type)
@@ -65,8 +83,8 @@ mbf_abstract_core::AbstractPlanner::Ptr CostmapPlannerExecution::loadPlannerPlug
   {
     planner_ptr = boost::static_pointer_cast<mbf_abstract_core::AbstractPlanner>(
         class_loader.createInstance(planner_type));
-    planner_name_ = class_loader.getName(planner_type);
-    ROS_INFO_STREAM("MBF_core-based global planner plugin " << planner_name_ << " loaded");
+    std::string planner_name = class_loader.getName(planner_type);
+    ROS_INFO_STREAM("MBF_core-based global planner plugin " << planner_name << " loaded");
   }
   catch (const pluginlib::PluginlibException &ex)
   {
@@ -79,8 +97,8 @@ mbf_abstract_core::AbstractPlanner::Ptr CostmapPlannerExecution::loadPlannerPlug
           nav_core_class_loader("nav_core", "nav_core::BaseGlobalPlanner");
       boost::shared_ptr<nav_core::BaseGlobalPlanner> nav_core_planner_ptr = nav_core_class_loader.createInstance(planner_type);
       planner_ptr = boost::make_shared<mbf_nav_core_wrapper::WrapperGlobalPlanner>(nav_core_planner_ptr);
-      planner_name_ = nav_core_class_loader.getName(planner_type);
-      ROS_INFO_STREAM("Nav_core-based global planner plugin " << planner_name_ << " loaded");
+      std::string planner_name = nav_core_class_loader.getName(planner_type);
+      ROS_INFO_STREAM("Nav_core-based global planner plugin " << planner_name << " loaded");
     }
     catch (const pluginlib::PluginlibException &ex)
     {
@@ -92,28 +110,78 @@ mbf_abstract_core::AbstractPlanner::Ptr CostmapPlannerExecution::loadPlannerPlug
   return planner_ptr;
 }
 
-void CostmapPlannerExecution::initPlugin()
+bool CostmapPlannerExecution::initPlugin(const std::string &name, const mbf_abstract_core::AbstractPlanner::Ptr &abstract_planner_ptr)
 {
   mbf_costmap_core::CostmapPlanner::Ptr planner_ptr
-      = boost::static_pointer_cast<mbf_costmap_core::CostmapPlanner>(planner_);
-  ROS_INFO_STREAM("Initialize planner \"" << planner_name_ << "\".");
+      = boost::static_pointer_cast<mbf_costmap_core::CostmapPlanner>(abstract_planner_ptr);
+  ROS_INFO_STREAM("Initialize planner \"" << name << "\".");
 
   if (!costmap_ptr_)
   {
     ROS_ERROR_STREAM("The costmap pointer has not been initialized!");
-    exit(1);
+    return false;
   }
 
-  // TODO check this
-  ros::NodeHandle private_nh("~");
-  private_nh.param("planner_lock_costmap", lock_costmap_, true);
+  if (use_costmap_mirror_ && !costmap_mirror_ptr_ && !tf_listener_ptr_)
+  {
+    ROS_ERROR_STREAM("The tf listener pointer has not been initialized; planning on the costmap instead of a mirror");
+    use_costmap_mirror_ = false;
+  }
+  if (use_costmap_mirror_ && !costmap_mirror_ptr_)
+  {
+    costmap_mirror_ptr_ = createMirror();
+  }
 
-  planner_ptr->initialize(planner_name_, costmap_ptr_.get());
+  planner_ptr->initialize(name, pluginCostmap());
 
   ROS_INFO("Global planner plugin initialized.");
+  return true;
+}
+
+bool CostmapPlannerExecution::initPlannerInstance(const std::string &name,
+                                                  const mbf_abstract_core::AbstractPlanner::Ptr &abstract_planner_ptr)
+{
+  mbf_costmap_core::CostmapPlanner::Ptr planner_ptr
+      = boost::static_pointer_cast<mbf_costmap_core::CostmapPlanner>(abstract_planner_ptr);
+  ROS_INFO_STREAM("Initialize an instance of the planner \"" << name << "\".");
+
+  if (!costmap_ptr_)
+  {
+    ROS_ERROR_STREAM("The costmap pointer has not been initialized!");
+    return false;
+  }
+
+  if (!(lock_costmap_ || use_costmap_mirror_) || !tf_listener_ptr_)
+  {
+    ROS_WARN_STREAM_COND(lock_costmap_, "The tf listener pointer has not been initialized; the instance of the planner"
+                         << " \"" << name << "\" plans on the costmap, locking it");
+    planner_ptr->initialize(name, costmap_ptr_.get());
+    return true;
+  }
+
+  CostmapMirror::Ptr mirror = createMirror();
+  planner_ptr->initialize(name, mirror->get());
+  boost::lock_guard<boost::mutex> guard(instance_mirrors_mtx_);
+  instance_mirrors_[abstract_planner_ptr.get()] = mirror;
+  return true;
+}
+
+costmap_2d::Costmap2DROS *CostmapPlannerExecution::pluginCostmap()
+{
+  return costmap_mirror_ptr_ ? costmap_mirror_ptr_->get() : costmap_ptr_.get();
+}
+
+CostmapMirror::Ptr CostmapPlannerExecution::createMirror()
+{
+  // every planner execution and planner instance plans on its own mirror
+  static boost::atomic<unsigned int> mirror_count(0);
+  std::string mirror_name = costmap_ptr_->getName() + "_planner_mirror_"
+      + boost::lexical_cast<std::string>(mirror_count++);
+  return CostmapMirror::Ptr(new CostmapMirror(costmap_ptr_, mirror_name, *tf_listener_ptr_));
 }
 
 uint32_t CostmapPlannerExecution::makePlan(const mbf_abstract_core::AbstractPlanner::Ptr &planner_ptr,
+                                           const std::string &planner_name,
                                            const geometry_msgs::PoseStamped start,
                                            const geometry_msgs::PoseStamped goal,
                                            double tolerance,
@@ -121,12 +189,91 @@ uint32_t CostmapPlannerExecution::makePlan(const mbf_abstract_core::AbstractPlan
                                            double &cost,
                                            std::string &message)
 {
-  if (lock_costmap_)
+  // the mirror is written only here, so neither the cache nor the planner need to lock it
+  if (costmap_mirror_ptr_)
+  {
+    costmap_mirror_ptr_->update();
+  }
+  return planWithCache(planner_ptr, planner_name, pluginCostmap()->getCostmap(), costmap_mirror_ptr_.get() != NULL,
+                       start, goal, tolerance, plan, cost, message);
+}
+
+uint32_t CostmapPlannerExecution::makeInstancePlan(const mbf_abstract_core::AbstractPlanner::Ptr &planner_ptr,
+                                                   const std::string &planner_name,
+                                                   const geometry_msgs::PoseStamped start,
+                                                   const geometry_msgs::PoseStamped goal,
+                                                   double tolerance,
+                                                   std::vector<geometry_msgs::PoseStamped> &plan,
+                                                   double &cost,
+                                                   std::string &message)
+{
+  CostmapMirror::Ptr mirror;
+  {
+    boost::lock_guard<boost::mutex> guard(instance_mirrors_mtx_);
+    std::map<const mbf_abstract_core::AbstractPlanner*, CostmapMirror::Ptr>::iterator iter =
+        instance_mirrors_.find(planner_ptr.get());
+    if (iter != instance_mirrors_.end())
+      mirror = iter->second;
+  }
+  if (!mirror)
+  {
+    return planWithCache(planner_ptr, planner_name, costmap_ptr_->getCostmap(), false,
+                         start, goal, tolerance, plan, cost, message);
+  }
+  // only this instance reads its mirror, and only from the calling thread
+  mirror->update();
+  return planWithCache(planner_ptr, planner_name, mirror->get()->getCostmap(), true,
+                       start, goal, tolerance, plan, cost, message);
+}
+
+uint32_t CostmapPlannerExecution::planWithCache(const mbf_abstract_core::AbstractPlanner::Ptr &planner_ptr,
+                                                const std::string &planner_name,
+                                                costmap_2d::Costmap2D *costmap,
+                                                bool mirrored,
+                                                const geometry_msgs::PoseStamped &start,
+                                                const geometry_msgs::PoseStamped &goal,
+                                                double tolerance,
+                                                std::vector<geometry_msgs::PoseStamped> &plan,
+                                                double &cost,
+                                                std::string &message)
+{
+  const bool lock_costmap = lock_costmap_ && !mirrored;
+  boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*(costmap->getMutex()), boost::defer_lock);
+  if (lock_costmap)
+  {
+    lock.lock();
+  }
+
+  if (!plan_cache_ptr_)
   {
-    boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*(costmap_ptr_->getCostmap()->getMutex()));
     return planner_ptr->makePlan(start, goal, tolerance, plan, cost, message);
   }
-  return planner_ptr->makePlan(start, goal, tolerance, plan, cost, message);
+
+  // cached plans are validated along the footprint; mirrors have the same padded footprint as the live costmap
+  const std::vector<geometry_msgs::Point> footprint = costmap_ptr_->getRobotFootprint();
+  if (lockForCache(lock, mirrored) &&
+      plan_cache_ptr_->lookup(*costmap, footprint, planner_name, start, goal, tolerance, plan, cost))
+  {
+    message = "Plan taken from the plan cache";
+    return 0;  // SUCCESS
+  }
+
+  if (!lock_costmap && lock.owns_lock())
+  {
+    lock.unlock();
+  }
+
+  uint32_t outcome = planner_ptr->makePlan(start, goal, tolerance, plan, cost, message);
+  if (outcome < 10 && lockForCache(lock, mirrored))  // success outcomes, see GetPath.action
+  {
+    plan_cache_ptr_->insert(*costmap, footprint, planner_name, start, goal, tolerance, plan, cost);
+  }
+  return outcome;
+}
+
+bool CostmapPlannerExecution::lockForCache(boost::unique_lock<costmap_2d::Costmap2D::mutex_t> &lock, bool mirrored)
+{
+  return mirrored || lock.owns_lock() || lock.try_lock();
 }
 
 } /* namespace mbf_costmap_nav */
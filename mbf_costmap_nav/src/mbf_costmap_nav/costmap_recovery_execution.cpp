@@ -45,16 +45,16 @@
 namespace mbf_costmap_nav
 {
 
-CostmapRecoveryExecution::CostmapRecoveryExecution(boost::condition_variable &condition,
-                                                     const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr,
+CostmapRecoveryExecution::CostmapRecoveryExecution(const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr,
                                                      CostmapPtr &global_costmap, CostmapPtr &local_costmap) :
-    AbstractRecoveryExecution(condition, tf_listener_ptr),
+    AbstractRecoveryExecution(tf_listener_ptr),
     global_costmap_(global_costmap), local_costmap_(local_costmap)
 {
 }
 
 CostmapRecoveryExecution::~CostmapRecoveryExecution()
 {
+  terminate();
 }
 
 mbf_abstract_core::AbstractRecovery::Ptr CostmapRecoveryExecution::loadRecoveryPlugin(
@@ -94,17 +94,13 @@ mbf_abstract_core::AbstractRecovery::Ptr CostmapRecoveryExecution::loadRecoveryP
   return recovery_ptr;
 }
 
-void CostmapRecoveryExecution::initPlugins()
+void CostmapRecoveryExecution::initPlugin(const std::string &name,
+                                          const mbf_abstract_core::AbstractRecovery::Ptr &behavior)
 {
-  for (std::map<std::string, mbf_abstract_core::AbstractRecovery::Ptr>::iterator iter =
-      recovery_behaviors_.begin(); iter != recovery_behaviors_.end(); ++iter)
-  {
-    mbf_costmap_core::CostmapRecovery::Ptr behavior =
-        boost::static_pointer_cast<mbf_costmap_core::CostmapRecovery>(iter->second);
-    std::string name = iter->first;
+  mbf_costmap_core::CostmapRecovery::Ptr costmap_behavior =
+      boost::static_pointer_cast<mbf_costmap_core::CostmapRecovery>(behavior);
 
-    behavior->initialize(name, tf_listener_ptr_.get(), global_costmap_.get(), local_costmap_.get());
-  }
+  costmap_behavior->initialize(name, tf_listener_ptr_.get(), global_costmap_.get(), local_costmap_.get());
 }
 
 } /* namespace mbf_costmap_nav */
@@ -0,0 +1,126 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  costmap_snapshot.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include "mbf_costmap_nav/costmap_snapshot.h"
+
+namespace mbf_costmap_nav
+{
+
+//! the current snapshot is taken from the live costmap, so a single spare buffer is enough to alternate them
+static const size_t MAX_SPARE_BUFFERS = 1;
+
+CostmapSnapshot::CostmapSnapshot(const CostmapPtr &costmap_ptr) : costmap_ptr_(costmap_ptr), spares_(new Spares())
+{
+}
+
+CostmapSnapshot::Spares::~Spares()
+{
+  for (size_t i = 0; i < buffers.size(); ++i)
+  {
+    delete buffers[i];
+  }
+}
+
+void CostmapSnapshot::Recycler::operator()(costmap_2d::Costmap2D *buffer) const
+{
+  // called by the last owner, once the reference count release has ordered all the readers' accesses before us
+  boost::shared_ptr<Spares> spares_ptr = spares.lock();
+  if (spares_ptr)
+  {
+    boost::lock_guard<boost::mutex> guard(spares_ptr->mutex);
+    if (spares_ptr->buffers.size() < MAX_SPARE_BUFFERS)
+    {
+      spares_ptr->buffers.push_back(buffer);
+      return;
+    }
+  }
+  delete buffer;
+}
+
+CostmapSnapshot::Costmap2DConstPtr CostmapSnapshot::get(const ros::Duration &max_age)
+{
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    if (front_ && ros::Time::now() - stamp_ <= max_age)
+    {
+      return front_;
+    }
+  }
+
+  boost::lock_guard<boost::mutex> update_guard(update_mtx_);
+
+  {
+    boost::lock_guard<boost::mutex> guard(mutex_);
+    // another reader could have taken a new snapshot while we were waiting
+    if (front_ && ros::Time::now() - stamp_ <= max_age)
+    {
+      return front_;
+    }
+  }
+
+  // reuse a buffer released by all its readers, if any
+  costmap_2d::Costmap2D *spare = NULL;
+  {
+    boost::lock_guard<boost::mutex> guard(spares_->mutex);
+    if (!spares_->buffers.empty())
+    {
+      spare = spares_->buffers.back();
+      spares_->buffers.pop_back();
+    }
+  }
+  Recycler recycler;
+  recycler.spares = spares_;
+  boost::shared_ptr<costmap_2d::Costmap2D> buffer(spare ? spare : new costmap_2d::Costmap2D(), recycler);
+
+  ros::Time stamp = ros::Time::now();
+  {
+    costmap_2d::Costmap2D *costmap = costmap_ptr_->getCostmap();
+    boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*(costmap->getMutex()));
+    *buffer = *costmap;
+  }
+
+  // the previous snapshot is recycled once its last reader releases it
+  boost::lock_guard<boost::mutex> guard(mutex_);
+  front_ = buffer;
+  stamp_ = stamp;
+  return front_;
+}
+
+} /* namespace mbf_costmap_nav */
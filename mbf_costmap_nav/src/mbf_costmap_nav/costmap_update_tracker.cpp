@@ -0,0 +1,136 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  costmap_update_tracker.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <algorithm>
+
+#include <costmap_2d/layered_costmap.h>
+
+#include "mbf_costmap_nav/costmap_update_tracker.h"
+
+namespace mbf_costmap_nav
+{
+
+//! number of recorded updates; a reader missing more than these, e.g. a planner idle for long, copies the whole map
+static const size_t HISTORY_SIZE = 64;
+
+//! bounds covering any map, as used by the layered costmap to start each update
+static const double NO_BOUND = 1e30;
+
+CostmapUpdateTracker::CostmapUpdateTracker() : history_(HISTORY_SIZE), seq_(0)
+{
+}
+
+CostmapUpdateTracker::Ptr CostmapUpdateTracker::attach(const CostmapPtr &costmap_ptr,
+                                                       tf::TransformListener &tf_listener)
+{
+  Ptr tracker(new CostmapUpdateTracker());
+  costmap_2d::LayeredCostmap *layered_costmap = costmap_ptr->getLayeredCostmap();
+  tracker->initialize(layered_costmap, "mbf_update_tracker", &tf_listener);
+
+  // the map updates iterate the layers holding the costmap mutex
+  boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*(costmap_ptr->getCostmap()->getMutex()));
+  layered_costmap->addPlugin(tracker);
+  return tracker;
+}
+
+CostmapUpdateTracker::Ptr CostmapUpdateTracker::find(const CostmapPtr &costmap_ptr)
+{
+  std::vector<boost::shared_ptr<costmap_2d::Layer> > *layers = costmap_ptr->getLayeredCostmap()->getPlugins();
+  for (size_t i = 0; i < layers->size(); ++i)
+  {
+    Ptr tracker = boost::dynamic_pointer_cast<CostmapUpdateTracker>((*layers)[i]);
+    if (tracker)
+      return tracker;
+  }
+  return Ptr();
+}
+
+bool CostmapUpdateTracker::getUpdatedBounds(uint64_t &seq, double &min_x, double &min_y, double &max_x,
+                                            double &max_y)
+{
+  boost::lock_guard<boost::mutex> guard(mutex_);
+  min_x = min_y = NO_BOUND;
+  max_x = max_y = -NO_BOUND;
+  if (seq > seq_ || seq_ - seq > HISTORY_SIZE)
+  {
+    seq = seq_;
+    return false;
+  }
+  for (; seq < seq_; ++seq)
+  {
+    const Bounds &bounds = history_[seq % HISTORY_SIZE];
+    min_x = std::min(min_x, bounds.min_x);
+    min_y = std::min(min_y, bounds.min_y);
+    max_x = std::max(max_x, bounds.max_x);
+    max_y = std::max(max_y, bounds.max_y);
+  }
+  return true;
+}
+
+void CostmapUpdateTracker::updateBounds(double robot_x, double robot_y, double robot_yaw,
+                                        double *min_x, double *min_y, double *max_x, double *max_y)
+{
+  // as the last layer, we see the bounds of the whole update; the master grid is rewritten only within them
+  record(*min_x, *min_y, *max_x, *max_y);
+}
+
+void CostmapUpdateTracker::reset()
+{
+  record(-NO_BOUND, -NO_BOUND, NO_BOUND, NO_BOUND);
+}
+
+void CostmapUpdateTracker::onInitialize()
+{
+  current_ = true;
+  enabled_ = true;
+}
+
+void CostmapUpdateTracker::record(double min_x, double min_y, double max_x, double max_y)
+{
+  boost::lock_guard<boost::mutex> guard(mutex_);
+  Bounds &bounds = history_[seq_ % HISTORY_SIZE];
+  bounds.min_x = min_x;
+  bounds.min_y = min_y;
+  bounds.max_x = max_x;
+  bounds.max_y = max_y;
+  ++seq_;
+}
+
+} /* namespace mbf_costmap_nav */
@@ -0,0 +1,227 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  footprint_stencil_cache.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <costmap_2d/footprint.h>
+
+#include "mbf_costmap_nav/footprint_stencil_cache.h"
+
+namespace mbf_costmap_nav
+{
+
+//! Maximum number of paddings and resolutions cached at once; the cache is emptied when exceeded
+static const size_t MAX_CACHED_PADDINGS = 16;
+
+static bool sameFootprint(const std::vector<geometry_msgs::Point> &a, const std::vector<geometry_msgs::Point> &b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  for (size_t i = 0; i < a.size(); ++i)
+  {
+    if (a[i].x != b[i].x || a[i].y != b[i].y)
+      return false;
+  }
+  return true;
+}
+
+FootprintStencilCache::Stencils::Stencils(const std::vector<geometry_msgs::Point> &footprint, double resolution,
+                                          unsigned int yaw_bins, unsigned int subcell_bins)
+  : footprint_(footprint), resolution_(resolution), yaw_bins_(yaw_bins), subcell_bins_(subcell_bins),
+    stencils_(yaw_bins * subcell_bins * subcell_bins)
+{
+  for (size_t index = 0; index < stencils_.size(); ++index)
+  {
+    unsigned int bin = index / (subcell_bins * subcell_bins);
+    double yaw = 2.0 * M_PI * bin / yaw_bins;
+    double cos_yaw = std::cos(yaw);
+    double sin_yaw = std::sin(yaw);
+
+    // robot position within its cell, in cells; with a single bin, the robot is assumed to be at the cell center
+    double fx = ((index % subcell_bins) + 0.5) / subcell_bins;
+    double fy = ((index / subcell_bins % subcell_bins) + 0.5) / subcell_bins;
+
+    // footprint vertices in cells, relative to the robot cell
+    std::vector<int> cx(footprint.size()), cy(footprint.size());
+    for (size_t i = 0; i < footprint.size(); ++i)
+    {
+      cx[i] = static_cast<int>(std::floor((footprint[i].x * cos_yaw - footprint[i].y * sin_yaw) / resolution + fx));
+      cy[i] = static_cast<int>(std::floor((footprint[i].x * sin_yaw + footprint[i].y * cos_yaw) / resolution + fy));
+    }
+
+    // trace the outline as FootprintHelper does, keeping the leftmost and rightmost cell of each row
+    std::map<int, std::pair<int, int> > rows;
+    for (size_t i = 0; i < footprint.size(); ++i)
+    {
+      size_t j = (i + 1) % footprint.size();
+      int x = cx[i], y = cy[i];
+      int dx = std::abs(cx[j] - x), dy = -std::abs(cy[j] - y);
+      int sx = x < cx[j] ? 1 : -1, sy = y < cy[j] ? 1 : -1;
+      int error = dx + dy;
+      while (true)
+      {
+        std::map<int, std::pair<int, int> >::iterator row = rows.find(y);
+        if (row == rows.end())
+        {
+          rows[y] = std::make_pair(x, x);
+        }
+        else
+        {
+          row->second.first = std::min(row->second.first, x);
+          row->second.second = std::max(row->second.second, x);
+        }
+
+        if (x == cx[j] && y == cy[j])
+          break;
+
+        int error2 = 2 * error;
+        if (error2 >= dy)
+        {
+          error += dy;
+          x += sx;
+        }
+        if (error2 <= dx)
+        {
+          error += dx;
+          y += sy;
+        }
+      }
+    }
+
+    // fill the rows between the outline cells; the footprint is assumed to be convex, as for FootprintHelper
+    Stencil &stencil = stencils_[index];
+    stencil.dx_min = stencil.dy_min = 0;
+    stencil.dx_max = stencil.dy_max = 0;
+    for (std::map<int, std::pair<int, int> >::const_iterator row = rows.begin(); row != rows.end(); ++row)
+    {
+      Run run;
+      run.dy = row->first;
+      run.dx_min = row->second.first;
+      run.dx_max = row->second.second;
+      stencil.runs.push_back(run);
+
+      stencil.dx_min = std::min(stencil.dx_min, run.dx_min);
+      stencil.dx_max = std::max(stencil.dx_max, run.dx_max);
+      stencil.dy_min = std::min(stencil.dy_min, run.dy);
+      stencil.dy_max = std::max(stencil.dy_max, run.dy);
+    }
+  }
+}
+
+bool FootprintStencilCache::Stencils::footprintCost(const costmap_2d::Costmap2D &costmap, double x, double y,
+                                                    double yaw, unsigned char &max_cost, uint32_t &cost) const
+{
+  max_cost = 0;
+  cost = 0;
+
+  double bins = yaw * yaw_bins_ / (2.0 * M_PI);
+  int bin = static_cast<int>(std::floor(bins - yaw_bins_ * std::floor(bins / yaw_bins_) + 0.5));
+  bin %= yaw_bins_;
+
+  // robot cell and sub-cell bin within it
+  double gx = (x - costmap.getOriginX()) / costmap.getResolution();
+  double gy = (y - costmap.getOriginY()) / costmap.getResolution();
+  double cell_x = std::floor(gx);
+  double cell_y = std::floor(gy);
+  unsigned int bin_x = std::min(static_cast<unsigned int>((gx - cell_x) * subcell_bins_), subcell_bins_ - 1);
+  unsigned int bin_y = std::min(static_cast<unsigned int>((gy - cell_y) * subcell_bins_), subcell_bins_ - 1);
+  const Stencil &stencil = stencils_[(bin * subcell_bins_ + bin_y) * subcell_bins_ + bin_x];
+
+  // as FootprintHelper, consider the robot outside of the map if any footprint cell is out of it
+  int size_x = costmap.getSizeInCellsX();
+  int size_y = costmap.getSizeInCellsY();
+  if (cell_x < -size_x || cell_x > 2 * size_x || cell_y < -size_y || cell_y > 2 * size_y)
+    return false;  // far enough to be out of the map with any footprint, and to overflow the cell indices
+
+  int mx = static_cast<int>(cell_x);
+  int my = static_cast<int>(cell_y);
+  if (mx + stencil.dx_min < 0 || mx + stencil.dx_max >= size_x ||
+      my + stencil.dy_min < 0 || my + stencil.dy_max >= size_y)
+  {
+    return false;
+  }
+
+  // cells of each run are contiguous on the costmap array, so this loop needs no index computations
+  const unsigned char *char_map = costmap.getCharMap();
+  for (std::vector<Run>::const_iterator run = stencil.runs.begin(); run != stencil.runs.end(); ++run)
+  {
+    const unsigned char *row = char_map + (my + run->dy) * size_x + mx;
+    unsigned char row_max = 0;
+    uint32_t row_cost = 0;
+    for (int dx = run->dx_min; dx <= run->dx_max; ++dx)
+    {
+      row_max = std::max(row_max, row[dx]);
+      row_cost += row[dx];
+    }
+    max_cost = std::max(max_cost, row_max);
+    cost += row_cost;
+  }
+  return true;
+}
+
+FootprintStencilCache::FootprintStencilCache(unsigned int yaw_bins, unsigned int subcell_bins)
+  : yaw_bins_(yaw_bins), subcell_bins_(std::max(subcell_bins, 1u))
+{
+}
+
+FootprintStencilCache::StencilsConstPtr FootprintStencilCache::get(const std::vector<geometry_msgs::Point> &footprint,
+                                                                   double padding, double resolution)
+{
+  boost::lock_guard<boost::mutex> guard(mutex_);
+
+  // a different footprint invalidates all the cached paddings
+  if (!sameFootprint(footprint, footprint_) || stencils_.size() >= MAX_CACHED_PADDINGS)
+  {
+    footprint_ = footprint;
+    stencils_.clear();
+  }
+
+  StencilsConstPtr &stencils = stencils_[std::make_pair(padding, resolution)];
+  if (!stencils)
+  {
+    std::vector<geometry_msgs::Point> padded_footprint = footprint;
+    costmap_2d::padFootprint(padded_footprint, padding);
+    stencils.reset(new Stencils(padded_footprint, resolution, yaw_bins_, subcell_bins_));
+  }
+  return stencils;
+}
+
+} /* namespace mbf_costmap_nav */
@@ -0,0 +1,289 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  plan_cache.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <base_local_planner/footprint_helper.h>
+#include <tf/transform_datatypes.h>
+
+#include "mbf_costmap_nav/plan_cache.h"
+
+namespace mbf_costmap_nav
+{
+
+bool PlanCache::Key::operator<(const Key &other) const
+{
+  if (start_x != other.start_x) return start_x < other.start_x;
+  if (start_y != other.start_y) return start_y < other.start_y;
+  if (goal_x != other.goal_x) return goal_x < other.goal_x;
+  if (goal_y != other.goal_y) return goal_y < other.goal_y;
+  if (start_yaw != other.start_yaw) return start_yaw < other.start_yaw;
+  if (goal_yaw != other.goal_yaw) return goal_yaw < other.goal_yaw;
+  if (tolerance != other.tolerance) return tolerance < other.tolerance;
+  if (start_frame_id != other.start_frame_id) return start_frame_id < other.start_frame_id;
+  if (goal_frame_id != other.goal_frame_id) return goal_frame_id < other.goal_frame_id;
+  return planner < other.planner;
+}
+
+static bool sameFootprint(const std::vector<geometry_msgs::Point> &a, const std::vector<geometry_msgs::Point> &b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  for (size_t i = 0; i < a.size(); ++i)
+  {
+    if (a[i].x != b[i].x || a[i].y != b[i].y)
+      return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Appends the indices of the cells covered by the footprint at the given pose, or of the pose cell if the
+ *        footprint is not a polygon.
+ * @return false, if the footprint is partially or completely outside the map.
+ */
+static bool addFootprintCells(const costmap_2d::Costmap2D &costmap, const std::vector<geometry_msgs::Point> &footprint,
+                              double x, double y, double yaw, std::vector<unsigned int> &cells)
+{
+  if (footprint.size() < 3)
+  {
+    unsigned int mx, my;
+    if (!costmap.worldToMap(x, y, mx, my))
+      return false;
+    cells.push_back(costmap.getIndex(mx, my));
+    return true;
+  }
+
+  // same cells as the pose checks without stencils; none if any vertex is out of the map
+  base_local_planner::FootprintHelper fph;
+  std::vector<base_local_planner::Position2DInt> footprint_cells =
+      fph.getFootprintCells(Eigen::Vector3f(x, y, yaw), footprint, costmap, true);
+  for (size_t i = 0; i < footprint_cells.size(); ++i)
+    cells.push_back(costmap.getIndex(footprint_cells[i].x, footprint_cells[i].y));
+  return !footprint_cells.empty();
+}
+
+/**
+ * @brief Collects the cells swept by the footprint along the plan, interpolating the poses so neither the robot
+ *        position nor any footprint vertex move more than a cell between consecutive ones.
+ * @return false, if the footprint leaves the map somewhere along the plan.
+ */
+static bool sweptCells(const costmap_2d::Costmap2D &costmap, const std::vector<geometry_msgs::Point> &footprint,
+                       const std::vector<geometry_msgs::PoseStamped> &plan, std::vector<unsigned int> &cells)
+{
+  double radius = 0.0;
+  for (size_t i = 0; i < footprint.size(); ++i)
+    radius = std::max(radius, std::sqrt(footprint[i].x * footprint[i].x + footprint[i].y * footprint[i].y));
+
+  const double resolution = costmap.getResolution();
+  for (size_t i = 0; i < plan.size(); ++i)
+  {
+    double x = plan[i].pose.position.x;
+    double y = plan[i].pose.position.y;
+    double yaw = tf::getYaw(plan[i].pose.orientation);
+    if (!addFootprintCells(costmap, footprint, x, y, yaw, cells))
+      return false;
+
+    if (i + 1 == plan.size())
+      break;
+
+    double dx = plan[i + 1].pose.position.x - x;
+    double dy = plan[i + 1].pose.position.y - y;
+    double dyaw = tf::getYaw(plan[i + 1].pose.orientation) - yaw;
+    dyaw = std::atan2(std::sin(dyaw), std::cos(dyaw));
+    int steps = static_cast<int>(std::ceil(std::max(std::sqrt(dx * dx + dy * dy), std::fabs(dyaw) * radius)
+                                           / resolution));
+    for (int step = 1; step < steps; ++step)
+    {
+      double ratio = static_cast<double>(step) / steps;
+      if (!addFootprintCells(costmap, footprint, x + dx * ratio, y + dy * ratio, yaw + dyaw * ratio, cells))
+        return false;
+    }
+  }
+
+  std::sort(cells.begin(), cells.end());
+  cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+  return true;
+}
+
+bool PlanCache::Geometry::operator!=(const Geometry &other) const
+{
+  return size_x != other.size_x || size_y != other.size_y || resolution != other.resolution
+      || origin_x != other.origin_x || origin_y != other.origin_y;
+}
+
+PlanCache::PlanCache(size_t capacity, double angular_resolution)
+    : capacity_(capacity), angular_resolution_(angular_resolution)
+{
+  geometry_.size_x = geometry_.size_y = 0;
+  geometry_.resolution = geometry_.origin_x = geometry_.origin_y = 0.0;
+}
+
+PlanCache::Key PlanCache::makeKey(const costmap_2d::Costmap2D &costmap, const std::string &planner,
+                                  const geometry_msgs::PoseStamped &start, const geometry_msgs::PoseStamped &goal,
+                                  double tolerance) const
+{
+  Key key;
+  key.planner = planner;
+  key.start_frame_id = start.header.frame_id;
+  key.goal_frame_id = goal.header.frame_id;
+  costmap.worldToMapNoBounds(start.pose.position.x, start.pose.position.y, key.start_x, key.start_y);
+  costmap.worldToMapNoBounds(goal.pose.position.x, goal.pose.position.y, key.goal_x, key.goal_y);
+  key.start_yaw = static_cast<int>(std::floor(tf::getYaw(start.pose.orientation) / angular_resolution_));
+  key.goal_yaw = static_cast<int>(std::floor(tf::getYaw(goal.pose.orientation) / angular_resolution_));
+  key.tolerance = static_cast<int>(std::floor(tolerance / costmap.getResolution()));
+  return key;
+}
+
+void PlanCache::checkGeometry(const costmap_2d::Costmap2D &costmap, const std::vector<geometry_msgs::Point> &footprint)
+{
+  Geometry geometry;
+  geometry.size_x = costmap.getSizeInCellsX();
+  geometry.size_y = costmap.getSizeInCellsY();
+  geometry.resolution = costmap.getResolution();
+  geometry.origin_x = costmap.getOriginX();
+  geometry.origin_y = costmap.getOriginY();
+
+  // cells refer to a different area after resizing or moving a rolling costmap, and a new footprint sweeps others
+  if (geometry != geometry_ || !sameFootprint(footprint, footprint_))
+  {
+    entries_.clear();
+    index_.clear();
+    geometry_ = geometry;
+    footprint_ = footprint;
+  }
+}
+
+bool PlanCache::lookup(const costmap_2d::Costmap2D &costmap, const std::vector<geometry_msgs::Point> &footprint,
+                       const std::string &planner,
+                       const geometry_msgs::PoseStamped &start, const geometry_msgs::PoseStamped &goal,
+                       double tolerance, std::vector<geometry_msgs::PoseStamped> &plan, double &cost)
+{
+  boost::lock_guard<boost::mutex> guard(mutex_);
+  checkGeometry(costmap, footprint);
+
+  std::map<Key, Entries::iterator>::iterator it = index_.find(makeKey(costmap, planner, start, goal, tolerance));
+  if (it == index_.end())
+  {
+    return false;
+  }
+
+  Entries::iterator entry = it->second;
+  const unsigned char *char_map = costmap.getCharMap();
+  for (size_t i = 0; i < entry->cells.size(); ++i)
+  {
+    if (char_map[entry->cells[i]] > entry->cell_costs[i])
+    {
+      ROS_DEBUG_STREAM("Cached plan of " << planner << " invalidated by a costmap change");
+      index_.erase(it);
+      entries_.erase(entry);
+      return false;
+    }
+  }
+
+  // move to the front, as the most recently used
+  entries_.splice(entries_.begin(), entries_, entry);
+
+  plan = entry->plan;
+  cost = entry->cost;
+  const ros::Time now = ros::Time::now();
+  for (size_t i = 0; i < plan.size(); ++i)
+  {
+    plan[i].header.stamp = now;
+  }
+  return true;
+}
+
+void PlanCache::insert(const costmap_2d::Costmap2D &costmap, const std::vector<geometry_msgs::Point> &footprint,
+                       const std::string &planner,
+                       const geometry_msgs::PoseStamped &start, const geometry_msgs::PoseStamped &goal,
+                       double tolerance, const std::vector<geometry_msgs::PoseStamped> &plan, double cost)
+{
+  if (capacity_ == 0 || plan.empty())
+  {
+    return;
+  }
+
+  Entry entry;
+  entry.key = makeKey(costmap, planner, start, goal, tolerance);
+  entry.plan = plan;
+  entry.cost = cost;
+
+  if (!sweptCells(costmap, footprint, plan, entry.cells))
+  {
+    // we cannot validate plans leaving the costmap
+    return;
+  }
+  entry.cell_costs.reserve(entry.cells.size());
+  const unsigned char *char_map = costmap.getCharMap();
+  for (size_t i = 0; i < entry.cells.size(); ++i)
+  {
+    entry.cell_costs.push_back(char_map[entry.cells[i]]);
+  }
+
+  boost::lock_guard<boost::mutex> guard(mutex_);
+  checkGeometry(costmap, footprint);
+
+  std::map<Key, Entries::iterator>::iterator it = index_.find(entry.key);
+  if (it != index_.end())
+  {
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+  else if (entries_.size() >= capacity_)
+  {
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+  }
+
+  entries_.push_front(entry);
+  index_[entry.key] = entries_.begin();
+}
+
+void PlanCache::clear()
+{
+  boost::lock_guard<boost::mutex> guard(mutex_);
+  entries_.clear();
+  index_.clear();
+}
+
+} /* namespace mbf_costmap_nav */
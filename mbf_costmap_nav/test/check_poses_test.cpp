@@ -0,0 +1,230 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  check_poses_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include <mbf_msgs/CheckPose.h>
+#include <mbf_msgs/CheckPoses.h>
+#include <nav_msgs/OccupancyGrid.h>
+
+// the map published to the costmaps static layers, 10 x 10 m with 0.1 m cells, centered on the map frame; it has
+// an obstacle around (1.25, 1.25) and an unknown area around (-3.5, -3.5)
+static const double LETHAL_X = 1.25, LETHAL_Y = 1.25;
+static const double UNKNOWN_X = -3.5, UNKNOWN_Y = -3.5;
+static const double FREE_X = -1.0, FREE_Y = 1.0;
+static const double OUTSIDE_X = 20.0, OUTSIDE_Y = 20.0;
+
+static const std::string CHECK_POSE_SERVICE = "move_base_flex/check_pose_cost";
+static const std::string CHECK_POSES_SERVICE = "move_base_flex/check_poses_cost";
+
+nav_msgs::OccupancyGrid createMap()
+{
+  nav_msgs::OccupancyGrid map;
+  map.header.frame_id = "map";
+  map.header.stamp = ros::Time::now();
+  map.info.resolution = 0.1;
+  map.info.width = 100;
+  map.info.height = 100;
+  map.info.origin.position.x = -5.0;
+  map.info.origin.position.y = -5.0;
+  map.info.origin.orientation.w = 1.0;
+  map.data.assign(map.info.width * map.info.height, 0);
+  for (unsigned int y = 0; y < map.info.height; ++y)
+  {
+    for (unsigned int x = 0; x < map.info.width; ++x)
+    {
+      if (x >= 60 && x < 65 && y >= 60 && y < 65)
+        map.data[y * map.info.width + x] = 100;
+      else if (x >= 10 && x < 20 && y >= 10 && y < 20)
+        map.data[y * map.info.width + x] = -1;
+    }
+  }
+  return map;
+}
+
+geometry_msgs::PoseStamped createPose(double x, double y, const std::string &frame = "map")
+{
+  geometry_msgs::PoseStamped pose;
+  pose.header.frame_id = frame;
+  pose.pose.position.x = x;
+  pose.pose.position.y = y;
+  pose.pose.orientation.w = 1.0;
+  return pose;
+}
+
+//! checks a single pose with the check_pose_cost service
+bool checkPose(const geometry_msgs::PoseStamped &pose, uint8_t costmap, uint8_t &state, uint32_t &cost)
+{
+  mbf_msgs::CheckPose check_pose;
+  check_pose.request.pose = pose;
+  check_pose.request.costmap = costmap;
+  check_pose.request.safety_dist = 0.1;
+  if (!ros::service::call(CHECK_POSE_SERVICE, check_pose))
+    return false;
+  state = check_pose.response.state;
+  cost = check_pose.response.cost;
+  return true;
+}
+
+class CheckPosesTest : public testing::TestWithParam<uint8_t>
+{
+protected:
+  virtual void SetUp()
+  {
+    ASSERT_TRUE(ros::service::waitForService(CHECK_POSES_SERVICE, ros::Duration(30.0)));
+
+    // the static layer gets the map asynchronously
+    uint8_t state = mbf_msgs::CheckPose::Response::FREE;
+    uint32_t cost;
+    ros::Time timeout = ros::Time::now() + ros::Duration(30.0);
+    while (ros::ok() && ros::Time::now() < timeout && state != mbf_msgs::CheckPose::Response::LETHAL)
+    {
+      ASSERT_TRUE(checkPose(createPose(LETHAL_X, LETHAL_Y), GetParam(), state, cost));
+      ros::Duration(0.1).sleep();
+    }
+    ASSERT_EQ(mbf_msgs::CheckPose::Response::LETHAL, state);
+
+    check_poses_.request.costmap = GetParam();
+    check_poses_.request.safety_dist = 0.1;
+  }
+
+  mbf_msgs::CheckPoses check_poses_;
+};
+
+TEST_P(CheckPosesTest, statesOfTheCheckedPoses)
+{
+  check_poses_.request.poses.push_back(createPose(FREE_X, FREE_Y));
+  check_poses_.request.poses.push_back(createPose(LETHAL_X, LETHAL_Y));
+  check_poses_.request.poses.push_back(createPose(UNKNOWN_X, UNKNOWN_Y));
+  check_poses_.request.poses.push_back(createPose(OUTSIDE_X, OUTSIDE_Y));
+  ASSERT_TRUE(ros::service::call(CHECK_POSES_SERVICE, check_poses_));
+  ASSERT_EQ(4u, check_poses_.response.states.size());
+  ASSERT_EQ(4u, check_poses_.response.costs.size());
+  EXPECT_EQ(mbf_msgs::CheckPoses::Response::FREE, check_poses_.response.states[0]);
+  EXPECT_EQ(0u, check_poses_.response.costs[0]);
+  EXPECT_EQ(mbf_msgs::CheckPoses::Response::LETHAL, check_poses_.response.states[1]);
+  EXPECT_GT(check_poses_.response.costs[1], 0u);
+  EXPECT_EQ(mbf_msgs::CheckPoses::Response::UNKNOWN, check_poses_.response.states[2]);
+  EXPECT_EQ(mbf_msgs::CheckPoses::Response::OUTSIDE, check_poses_.response.states[3]);
+}
+
+TEST_P(CheckPosesTest, sameResultsAsSinglePoseChecks)
+{
+  // a path crossing the obstacle and the unknown area, long enough to be split among the helper threads
+  for (int i = 0; i < 1000; ++i)
+  {
+    double d = -4.5 + 0.009 * i;
+    check_poses_.request.poses.push_back(createPose(d, d));
+    check_poses_.request.poses.back().pose.orientation.z = std::sin(0.005 * i);
+    check_poses_.request.poses.back().pose.orientation.w = std::cos(0.005 * i);
+  }
+  ASSERT_TRUE(ros::service::call(CHECK_POSES_SERVICE, check_poses_));
+  ASSERT_EQ(check_poses_.request.poses.size(), check_poses_.response.states.size());
+  ASSERT_EQ(check_poses_.request.poses.size(), check_poses_.response.costs.size());
+
+  int lethal = 0, unknown = 0;
+  for (size_t i = 0; i < check_poses_.request.poses.size(); ++i)
+  {
+    lethal += check_poses_.response.states[i] == mbf_msgs::CheckPoses::Response::LETHAL;
+    unknown += check_poses_.response.states[i] == mbf_msgs::CheckPoses::Response::UNKNOWN;
+    if (i % 25 == 0)
+    {
+      uint8_t state;
+      uint32_t cost;
+      ASSERT_TRUE(checkPose(check_poses_.request.poses[i], GetParam(), state, cost));
+      EXPECT_EQ(state, check_poses_.response.states[i]) << "pose " << i;
+      EXPECT_EQ(cost, check_poses_.response.costs[i]) << "pose " << i;
+    }
+  }
+  EXPECT_GT(lethal, 0);
+  EXPECT_GT(unknown, 0);
+}
+
+TEST_P(CheckPosesTest, posesOnOtherFrames)
+{
+  // the robot sits at the map origin
+  check_poses_.request.poses.push_back(createPose(LETHAL_X, LETHAL_Y, "base_link"));
+  check_poses_.request.poses.push_back(createPose(FREE_X, FREE_Y, "map"));
+  ASSERT_TRUE(ros::service::call(CHECK_POSES_SERVICE, check_poses_));
+  ASSERT_EQ(2u, check_poses_.response.states.size());
+  EXPECT_EQ(mbf_msgs::CheckPoses::Response::LETHAL, check_poses_.response.states[0]);
+  EXPECT_EQ(mbf_msgs::CheckPoses::Response::FREE, check_poses_.response.states[1]);
+}
+
+TEST_P(CheckPosesTest, noPoses)
+{
+  ASSERT_TRUE(ros::service::call(CHECK_POSES_SERVICE, check_poses_));
+  EXPECT_TRUE(check_poses_.response.states.empty());
+  EXPECT_TRUE(check_poses_.response.costs.empty());
+}
+
+TEST_P(CheckPosesTest, unknownFrameFails)
+{
+  check_poses_.request.poses.push_back(createPose(FREE_X, FREE_Y));
+  check_poses_.request.poses.push_back(createPose(FREE_X, FREE_Y, "nowhere"));
+  EXPECT_FALSE(ros::service::call(CHECK_POSES_SERVICE, check_poses_));
+}
+
+TEST(CheckPosesCostmapTest, unknownCostmapFails)
+{
+  mbf_msgs::CheckPoses check_poses;
+  check_poses.request.costmap = 0;
+  check_poses.request.poses.push_back(createPose(FREE_X, FREE_Y));
+  ASSERT_TRUE(ros::service::waitForService(CHECK_POSES_SERVICE, ros::Duration(30.0)));
+  EXPECT_FALSE(ros::service::call(CHECK_POSES_SERVICE, check_poses));
+}
+
+INSTANTIATE_TEST_CASE_P(Costmaps, CheckPosesTest,
+                        testing::Values(static_cast<uint8_t>(mbf_msgs::CheckPoses::Request::LOCAL_COSTMAP),
+                                        static_cast<uint8_t>(mbf_msgs::CheckPoses::Request::GLOBAL_COSTMAP)));
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "check_poses_test");
+  ros::NodeHandle nh;
+
+  // latched, so the costmaps get it whenever they subscribe
+  ros::Publisher map_pub = nh.advertise<nav_msgs::OccupancyGrid>("map", 1, true);
+  map_pub.publish(createMap());
+  return RUN_ALL_TESTS();
+}
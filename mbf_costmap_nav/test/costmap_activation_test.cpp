@@ -0,0 +1,144 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  costmap_activation_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include <tf/transform_listener.h>
+
+#include "mbf_costmap_nav/costmap_activation.h"
+
+using mbf_costmap_nav::CostmapActivation;
+
+class CostmapActivationTest : public testing::TestWithParam<double>
+{
+protected:
+  virtual void SetUp()
+  {
+    // the costmap waits for the robot pose on construction
+    tf::StampedTransform robot_pose(tf::Transform(tf::Quaternion(0.0, 0.0, 0.0, 1.0), tf::Vector3(0.0, 0.0, 0.0)),
+                                    ros::Time::now(), "map", "base_link");
+    tf_listener_.setTransform(robot_pose);
+    costmap_ptr_.reset(new costmap_2d::Costmap2DROS("live_costmap", tf_listener_));
+    activation_ptr_.reset(new CostmapActivation(costmap_ptr_, "live_costmap", GetParam()));
+  }
+
+  virtual void TearDown()
+  {
+    activation_ptr_.reset();
+  }
+
+  //! waits until the costmap is deactivated; false if it isn't within two seconds
+  bool waitUntilInactive()
+  {
+    for (int i = 0; i < 200 && activation_ptr_->isActive(); ++i)
+    {
+      boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+    }
+    return !activation_ptr_->isActive();
+  }
+
+  tf::TransformListener tf_listener_;
+  boost::shared_ptr<costmap_2d::Costmap2DROS> costmap_ptr_;
+  boost::shared_ptr<CostmapActivation> activation_ptr_;
+};
+
+TEST_P(CostmapActivationTest, activeOnCreation)
+{
+  EXPECT_TRUE(activation_ptr_->isActive());
+  EXPECT_TRUE(activation_ptr_->waitUntilActive(ros::Duration(1.0)));
+  EXPECT_EQ(0u, activation_ptr_->getActivationLatency().count());
+}
+
+TEST_P(CostmapActivationTest, transitionsDontBlock)
+{
+  const boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  activation_ptr_->deactivate();
+  activation_ptr_->activate();
+  activation_ptr_->deactivate();
+  EXPECT_LT(boost::chrono::steady_clock::now() - start, boost::chrono::milliseconds(10));
+  EXPECT_TRUE(waitUntilInactive());
+}
+
+TEST_P(CostmapActivationTest, activationMeasured)
+{
+  activation_ptr_->deactivate();
+  ASSERT_TRUE(waitUntilInactive());
+
+  // active as soon as requested, so it's not deactivated again meanwhile; usable once the costmap is restarted
+  activation_ptr_->activate();
+  EXPECT_TRUE(activation_ptr_->isActive());
+  ASSERT_TRUE(activation_ptr_->waitUntilActive(ros::Duration(2.0)));
+  EXPECT_EQ(1u, activation_ptr_->getActivationLatency().count());
+
+  // a repeated request doesn't count as another activation
+  activation_ptr_->activate();
+  ASSERT_TRUE(activation_ptr_->waitUntilActive(ros::Duration(2.0)));
+  EXPECT_EQ(1u, activation_ptr_->getActivationLatency().count());
+}
+
+TEST_P(CostmapActivationTest, noWaitingForAnInactiveCostmap)
+{
+  activation_ptr_->deactivate();
+  const boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  EXPECT_FALSE(activation_ptr_->waitUntilActive(ros::Duration(2.0)));
+  EXPECT_LT(boost::chrono::steady_clock::now() - start, boost::chrono::milliseconds(100));
+}
+
+TEST_P(CostmapActivationTest, destroyedWhileInactive)
+{
+  activation_ptr_->deactivate();
+  ASSERT_TRUE(waitUntilInactive());
+  // stay a few standby periods, if any, before destroying it
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(200));
+  const boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  activation_ptr_.reset();
+  EXPECT_LT(boost::chrono::steady_clock::now() - start, boost::chrono::milliseconds(500));
+}
+
+// stopping the costmap when inactive, or keeping it on standby at 20 Hz
+INSTANTIATE_TEST_CASE_P(StandbyFrequencies, CostmapActivationTest, testing::Values(0.0, 20.0));
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "costmap_activation_test");
+  ros::NodeHandle nh;
+  return RUN_ALL_TESTS();
+}
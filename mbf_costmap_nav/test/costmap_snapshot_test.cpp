@@ -0,0 +1,235 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  costmap_snapshot_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include <tf/transform_listener.h>
+
+#include "mbf_costmap_nav/costmap_mirror.h"
+#include "mbf_costmap_nav/costmap_snapshot.h"
+#include "mbf_costmap_nav/costmap_update_tracker.h"
+
+using namespace mbf_costmap_nav;
+
+typedef boost::shared_ptr<costmap_2d::Costmap2DROS> CostmapPtr;
+
+//! sets a cost on the live costmap, as a layer update would do
+void setCost(const CostmapPtr &costmap_ptr, unsigned int mx, unsigned int my, unsigned char cost)
+{
+  costmap_2d::Costmap2D *costmap = costmap_ptr->getCostmap();
+  boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*(costmap->getMutex()));
+  costmap->setCost(mx, my, cost);
+}
+
+//! takes a new snapshot, older snapshots being always too old
+CostmapSnapshot::Costmap2DConstPtr takeNew(CostmapSnapshot &snapshot)
+{
+  ros::Duration(0.001).sleep();
+  return snapshot.get(ros::Duration(0.0));
+}
+
+class CostmapSnapshotTest : public testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    // the costmap waits for the robot pose on construction
+    tf::StampedTransform robot_pose(tf::Transform(tf::Quaternion(0.0, 0.0, 0.0, 1.0), tf::Vector3(0.0, 0.0, 0.0)),
+                                    ros::Time::now(), "map", "base_link");
+    tf_listener_.setTransform(robot_pose);
+    costmap_ptr_.reset(new costmap_2d::Costmap2DROS("live_costmap", tf_listener_));
+  }
+
+  //! records an update of the live costmap covering just the given cell, as the layered costmap does
+  void recordUpdate(const CostmapUpdateTracker::Ptr &tracker_ptr, unsigned int mx, unsigned int my)
+  {
+    double wx, wy;
+    costmap_ptr_->getCostmap()->mapToWorld(mx, my, wx, wy);
+    double min_x = wx, min_y = wy, max_x = wx, max_y = wy;
+    tracker_ptr->updateBounds(0.0, 0.0, 0.0, &min_x, &min_y, &max_x, &max_y);
+  }
+
+  tf::TransformListener tf_listener_;
+  CostmapPtr costmap_ptr_;
+};
+
+TEST_F(CostmapSnapshotTest, snapshotReusedWithinMaxAge)
+{
+  CostmapSnapshot snapshot(costmap_ptr_);
+  CostmapSnapshot::Costmap2DConstPtr first = snapshot.get(ros::Duration(60.0));
+  CostmapSnapshot::Costmap2DConstPtr second = snapshot.get(ros::Duration(60.0));
+  EXPECT_EQ(first.get(), second.get());
+  EXPECT_NE(first.get(), takeNew(snapshot).get());
+}
+
+TEST_F(CostmapSnapshotTest, snapshotUnchangedByTheLiveCostmap)
+{
+  CostmapSnapshot snapshot(costmap_ptr_);
+  setCost(costmap_ptr_, 10, 20, costmap_2d::FREE_SPACE);
+  CostmapSnapshot::Costmap2DConstPtr old_snapshot = snapshot.get(ros::Duration(60.0));
+
+  setCost(costmap_ptr_, 10, 20, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_EQ(costmap_2d::FREE_SPACE, old_snapshot->getCost(10, 20));
+  // a reader accepting an old snapshot doesn't see the change
+  EXPECT_EQ(costmap_2d::FREE_SPACE, snapshot.get(ros::Duration(60.0))->getCost(10, 20));
+
+  CostmapSnapshot::Costmap2DConstPtr new_snapshot = takeNew(snapshot);
+  EXPECT_EQ(costmap_2d::LETHAL_OBSTACLE, new_snapshot->getCost(10, 20));
+  EXPECT_EQ(costmap_2d::FREE_SPACE, old_snapshot->getCost(10, 20));
+}
+
+TEST_F(CostmapSnapshotTest, releasedBufferReused)
+{
+  CostmapSnapshot snapshot(costmap_ptr_);
+  CostmapSnapshot::Costmap2DConstPtr first = takeNew(snapshot);
+  const costmap_2d::Costmap2D *first_buffer = first.get();
+  first.reset();
+
+  // the first snapshot is still the current one, so its buffer is recycled only once replaced
+  CostmapSnapshot::Costmap2DConstPtr second = takeNew(snapshot);
+  EXPECT_NE(first_buffer, second.get());
+  CostmapSnapshot::Costmap2DConstPtr third = takeNew(snapshot);
+  EXPECT_EQ(first_buffer, third.get());
+}
+
+TEST_F(CostmapSnapshotTest, heldBufferNotReused)
+{
+  CostmapSnapshot snapshot(costmap_ptr_);
+  setCost(costmap_ptr_, 10, 20, costmap_2d::FREE_SPACE);
+  CostmapSnapshot::Costmap2DConstPtr first = takeNew(snapshot);
+  CostmapSnapshot::Costmap2DConstPtr second = takeNew(snapshot);
+  setCost(costmap_ptr_, 10, 20, costmap_2d::LETHAL_OBSTACLE);
+  CostmapSnapshot::Costmap2DConstPtr third = takeNew(snapshot);
+  EXPECT_NE(first.get(), third.get());
+  EXPECT_NE(second.get(), third.get());
+  EXPECT_EQ(costmap_2d::FREE_SPACE, first->getCost(10, 20));
+  EXPECT_EQ(costmap_2d::FREE_SPACE, second->getCost(10, 20));
+}
+
+TEST_F(CostmapSnapshotTest, snapshotOutlivesItsSource)
+{
+  CostmapSnapshot::Costmap2DConstPtr held;
+  {
+    CostmapSnapshot snapshot(costmap_ptr_);
+    setCost(costmap_ptr_, 10, 20, costmap_2d::LETHAL_OBSTACLE);
+    held = takeNew(snapshot);
+  }
+  EXPECT_EQ(costmap_2d::LETHAL_OBSTACLE, held->getCost(10, 20));
+}
+
+TEST_F(CostmapSnapshotTest, trackerAttachedToTheLiveCostmap)
+{
+  EXPECT_FALSE(CostmapUpdateTracker::find(costmap_ptr_));
+  CostmapUpdateTracker::Ptr tracker_ptr = CostmapUpdateTracker::attach(costmap_ptr_, tf_listener_);
+  EXPECT_EQ(tracker_ptr, CostmapUpdateTracker::find(costmap_ptr_));
+}
+
+TEST_F(CostmapSnapshotTest, mirrorFilledOnCreation)
+{
+  setCost(costmap_ptr_, 10, 20, costmap_2d::LETHAL_OBSTACLE);
+  CostmapMirror mirror(costmap_ptr_, "live_costmap_mirror", tf_listener_);
+  EXPECT_NE(costmap_ptr_.get(), mirror.get());
+  EXPECT_EQ(costmap_2d::LETHAL_OBSTACLE, mirror.get()->getCostmap()->getCost(10, 20));
+}
+
+TEST_F(CostmapSnapshotTest, mirrorChangesOnlyOnUpdate)
+{
+  CostmapUpdateTracker::Ptr tracker_ptr = CostmapUpdateTracker::attach(costmap_ptr_, tf_listener_);
+  setCost(costmap_ptr_, 10, 20, costmap_2d::FREE_SPACE);
+  CostmapMirror mirror(costmap_ptr_, "live_costmap_mirror", tf_listener_);
+
+  setCost(costmap_ptr_, 10, 20, costmap_2d::LETHAL_OBSTACLE);
+  recordUpdate(tracker_ptr, 10, 20);
+  EXPECT_EQ(costmap_2d::FREE_SPACE, mirror.get()->getCostmap()->getCost(10, 20));
+  mirror.update();
+  EXPECT_EQ(costmap_2d::LETHAL_OBSTACLE, mirror.get()->getCostmap()->getCost(10, 20));
+}
+
+TEST_F(CostmapSnapshotTest, mirrorCopiesOnlyTheUpdatedWindow)
+{
+  CostmapUpdateTracker::Ptr tracker_ptr = CostmapUpdateTracker::attach(costmap_ptr_, tf_listener_);
+  setCost(costmap_ptr_, 10, 20, costmap_2d::FREE_SPACE);
+  setCost(costmap_ptr_, 50, 60, costmap_2d::FREE_SPACE);
+  CostmapMirror mirror(costmap_ptr_, "live_costmap_mirror", tf_listener_);
+
+  // a change outside the recorded bounds is not copied; the layered costmap would never do that
+  setCost(costmap_ptr_, 10, 20, costmap_2d::LETHAL_OBSTACLE);
+  setCost(costmap_ptr_, 50, 60, costmap_2d::LETHAL_OBSTACLE);
+  recordUpdate(tracker_ptr, 10, 20);
+  mirror.update();
+  EXPECT_EQ(costmap_2d::LETHAL_OBSTACLE, mirror.get()->getCostmap()->getCost(10, 20));
+  EXPECT_EQ(costmap_2d::FREE_SPACE, mirror.get()->getCostmap()->getCost(50, 60));
+
+  // but a reset of the layers covers the whole map
+  tracker_ptr->reset();
+  mirror.update();
+  EXPECT_EQ(costmap_2d::LETHAL_OBSTACLE, mirror.get()->getCostmap()->getCost(50, 60));
+}
+
+TEST_F(CostmapSnapshotTest, untrackedMirrorCopiesTheWholeMap)
+{
+  setCost(costmap_ptr_, 50, 60, costmap_2d::FREE_SPACE);
+  CostmapMirror mirror(costmap_ptr_, "live_costmap_mirror", tf_listener_);
+  setCost(costmap_ptr_, 50, 60, costmap_2d::LETHAL_OBSTACLE);
+  mirror.update();
+  EXPECT_EQ(costmap_2d::LETHAL_OBSTACLE, mirror.get()->getCostmap()->getCost(50, 60));
+}
+
+TEST_F(CostmapSnapshotTest, mirrorFollowsTheFootprint)
+{
+  CostmapMirror mirror(costmap_ptr_, "live_costmap_mirror", tf_listener_);
+  std::vector<geometry_msgs::Point> footprint(3);
+  footprint[1].x = 0.5;
+  footprint[2].y = 0.5;
+  costmap_ptr_->setUnpaddedRobotFootprint(footprint);
+  mirror.update();
+  std::vector<geometry_msgs::Point> mirror_footprint = mirror.get()->getUnpaddedRobotFootprint();
+  ASSERT_EQ(3u, mirror_footprint.size());
+  EXPECT_DOUBLE_EQ(0.5, mirror_footprint[1].x);
+  EXPECT_DOUBLE_EQ(0.5, mirror_footprint[2].y);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "costmap_snapshot_test");
+  ros::NodeHandle nh;
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,143 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  costmap_update_tracker_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+
+#include "mbf_costmap_nav/costmap_update_tracker.h"
+
+using mbf_costmap_nav::CostmapUpdateTracker;
+
+class CostmapUpdateTrackerTest : public testing::Test
+{
+protected:
+  CostmapUpdateTrackerTest() : seq_(0)
+  {
+  }
+
+  //! records a map update with the given bounds, as the layered costmap does after all the other layers
+  void update(double min_x, double min_y, double max_x, double max_y)
+  {
+    tracker_.updateBounds(0.0, 0.0, 0.0, &min_x, &min_y, &max_x, &max_y);
+  }
+
+  //! reads the updates since the last read
+  bool read()
+  {
+    return tracker_.getUpdatedBounds(seq_, min_x_, min_y_, max_x_, max_y_);
+  }
+
+  CostmapUpdateTracker tracker_;
+  uint64_t seq_;
+  double min_x_, min_y_, max_x_, max_y_;
+};
+
+TEST_F(CostmapUpdateTrackerTest, nothingUpdated)
+{
+  ASSERT_TRUE(read());
+  EXPECT_GT(min_x_, max_x_);
+  EXPECT_GT(min_y_, max_y_);
+  EXPECT_EQ(0u, seq_);
+}
+
+TEST_F(CostmapUpdateTrackerTest, unionOfTheUpdatesSinceTheLastRead)
+{
+  update(1.0, 2.0, 3.0, 4.0);
+  update(-1.0, 3.0, 2.0, 5.0);
+  ASSERT_TRUE(read());
+  EXPECT_DOUBLE_EQ(-1.0, min_x_);
+  EXPECT_DOUBLE_EQ(2.0, min_y_);
+  EXPECT_DOUBLE_EQ(3.0, max_x_);
+  EXPECT_DOUBLE_EQ(5.0, max_y_);
+  EXPECT_EQ(2u, seq_);
+
+  // the next read only gets the newer updates
+  update(7.0, 8.0, 9.0, 10.0);
+  ASSERT_TRUE(read());
+  EXPECT_DOUBLE_EQ(7.0, min_x_);
+  EXPECT_DOUBLE_EQ(8.0, min_y_);
+  EXPECT_DOUBLE_EQ(9.0, max_x_);
+  EXPECT_DOUBLE_EQ(10.0, max_y_);
+  EXPECT_EQ(3u, seq_);
+
+  ASSERT_TRUE(read());
+  EXPECT_GT(min_x_, max_x_);
+}
+
+TEST_F(CostmapUpdateTrackerTest, resetUpdatesTheWholeMap)
+{
+  update(1.0, 2.0, 3.0, 4.0);
+  tracker_.reset();
+  ASSERT_TRUE(read());
+  EXPECT_LT(min_x_, -1e6);
+  EXPECT_LT(min_y_, -1e6);
+  EXPECT_GT(max_x_, 1e6);
+  EXPECT_GT(max_y_, 1e6);
+}
+
+TEST_F(CostmapUpdateTrackerTest, tooManyMissedUpdates)
+{
+  // a reader missing more updates than recorded must copy the whole map; then it's back on track
+  for (int i = 0; i < 1000; ++i)
+  {
+    update(i, i, i + 1.0, i + 1.0);
+  }
+  EXPECT_FALSE(read());
+  EXPECT_EQ(1000u, seq_);
+
+  update(1.0, 2.0, 3.0, 4.0);
+  ASSERT_TRUE(read());
+  EXPECT_DOUBLE_EQ(1.0, min_x_);
+  EXPECT_DOUBLE_EQ(4.0, max_y_);
+}
+
+TEST_F(CostmapUpdateTrackerTest, unknownSequenceNumber)
+{
+  update(1.0, 2.0, 3.0, 4.0);
+  seq_ = 5;
+  EXPECT_FALSE(read());
+  EXPECT_EQ(1u, seq_);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
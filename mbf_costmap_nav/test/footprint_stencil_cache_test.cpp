@@ -0,0 +1,291 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  footprint_stencil_cache_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <set>
+#include <cmath>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <base_local_planner/footprint_helper.h>
+#include <costmap_2d/footprint.h>
+
+#include "mbf_costmap_nav/footprint_stencil_cache.h"
+
+using mbf_costmap_nav::FootprintStencilCache;
+
+class FootprintStencilCacheTest : public ::testing::Test
+{
+protected:
+  FootprintStencilCacheTest() : costmap_(200, 200, 0.05, 0.0, 0.0)
+  {
+    // pseudo-random costs, below the special values, so the cost sums tell apart different cell sets
+    srand(42);
+    for (unsigned int my = 0; my < costmap_.getSizeInCellsY(); ++my)
+      for (unsigned int mx = 0; mx < costmap_.getSizeInCellsX(); ++mx)
+        costmap_.setCost(mx, my, rand() % costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+
+    const double rectangle[4][2] = {{0.52, 0.31}, {-0.43, 0.31}, {-0.43, -0.31}, {0.52, -0.31}};
+    for (int i = 0; i < 4; ++i)
+    {
+      geometry_msgs::Point point;
+      point.x = rectangle[i][0];
+      point.y = rectangle[i][1];
+      footprint_.push_back(point);
+    }
+  }
+
+  /**
+   * @brief Integrates the cost of the cells FootprintHelper finds within the footprint, counting each cell once.
+   * @return false, if the footprint is outside the map.
+   */
+  bool helperCost(const std::vector<geometry_msgs::Point> &footprint, double x, double y, double yaw,
+                  unsigned char &max_cost, uint32_t &cost, size_t &cells)
+  {
+    base_local_planner::FootprintHelper fph;
+    std::vector<base_local_planner::Position2DInt> footprint_cells =
+        fph.getFootprintCells(Eigen::Vector3f(x, y, yaw), footprint, costmap_, true);
+    std::set<std::pair<long, long> > unique_cells;
+    for (size_t i = 0; i < footprint_cells.size(); ++i)
+      unique_cells.insert(std::make_pair(footprint_cells[i].x, footprint_cells[i].y));
+
+    max_cost = 0;
+    cost = 0;
+    std::set<std::pair<long, long> >::const_iterator cell = unique_cells.begin();
+    for (; cell != unique_cells.end(); ++cell)
+    {
+      unsigned char cell_cost = costmap_.getCost(cell->first, cell->second);
+      max_cost = std::max(max_cost, cell_cost);
+      cost += cell_cost;
+    }
+    cells = unique_cells.size();
+    return !unique_cells.empty();
+  }
+
+  /**
+   * @brief Checks that the stencils integrate the same cells as FootprintHelper on many cells and on every bin.
+   *        The stencils are evaluated off the bin centers, by less than half a bin, and FootprintHelper on them.
+   */
+  void expectSameCellsAsFootprintHelper(const std::vector<geometry_msgs::Point> &footprint, unsigned int yaw_bins,
+                                        unsigned int subcell_bins = 1)
+  {
+    FootprintStencilCache cache(yaw_bins, subcell_bins);
+    FootprintStencilCache::StencilsConstPtr stencils = cache.get(footprint, 0.0, costmap_.getResolution());
+
+    const double resolution = costmap_.getResolution();
+    const double subcell_offset = 0.4 * resolution / subcell_bins;
+    const double yaw_offset = 0.4 * M_PI / yaw_bins;
+    for (unsigned int mx = 40; mx < 160; mx += 13)
+    {
+      for (unsigned int my = 40; my < 160; my += 17)
+      {
+        for (unsigned int bin_x = 0; bin_x < subcell_bins; ++bin_x)
+        {
+          for (unsigned int bin_y = 0; bin_y < subcell_bins; ++bin_y)
+          {
+            double x = costmap_.getOriginX() + (mx + (bin_x + 0.5) / subcell_bins) * resolution;
+            double y = costmap_.getOriginY() + (my + (bin_y + 0.5) / subcell_bins) * resolution;
+            for (unsigned int bin = 0; bin < yaw_bins; ++bin)
+            {
+              double yaw = 2.0 * M_PI * bin / yaw_bins;
+              int sign = (mx + my + bin) % 2 ? 1 : -1;
+              unsigned char stencil_max, helper_max;
+              uint32_t stencil_cost, helper_cost;
+              size_t cells;
+              ASSERT_TRUE(helperCost(footprint, x, y, yaw, helper_max, helper_cost, cells));
+              ASSERT_TRUE(stencils->footprintCost(costmap_, x + sign * subcell_offset, y - sign * subcell_offset,
+                                                  yaw + sign * yaw_offset, stencil_max, stencil_cost));
+              EXPECT_EQ(helper_max, stencil_max) << "at cell " << mx << ", " << my << ", sub-cell " << bin_x << ", "
+                                                 << bin_y << ", bin " << bin;
+              EXPECT_EQ(helper_cost, stencil_cost) << "at cell " << mx << ", " << my << ", sub-cell " << bin_x
+                                                   << ", " << bin_y << ", bin " << bin;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  costmap_2d::Costmap2D costmap_;
+  std::vector<geometry_msgs::Point> footprint_;
+};
+
+TEST_F(FootprintStencilCacheTest, sameCellsAsFootprintHelper)
+{
+  expectSameCellsAsFootprintHelper(footprint_, 16);
+
+  // a convex footprint with oblique edges
+  std::vector<geometry_msgs::Point> hexagon;
+  for (int i = 0; i < 6; ++i)
+  {
+    geometry_msgs::Point point;
+    point.x = 0.37 * std::cos(i * M_PI / 3.0 + 0.1);
+    point.y = 0.29 * std::sin(i * M_PI / 3.0 + 0.1);
+    hexagon.push_back(point);
+  }
+  expectSameCellsAsFootprintHelper(hexagon, 36);
+}
+
+TEST_F(FootprintStencilCacheTest, offCenterPoses)
+{
+  expectSameCellsAsFootprintHelper(footprint_, 16, 4);
+
+  // off-center poses rounded to a single bin differ from FootprintHelper at most by the documented error bound:
+  // vertices misplaced by half a cell, so just the cells along the footprint outline can be missed or added
+  FootprintStencilCache cache(16);
+  FootprintStencilCache::StencilsConstPtr stencils = cache.get(footprint_, 0.0, costmap_.getResolution());
+  const double offsets[][2] = {{0.01, 0.01}, {0.024, 0.002}, {0.049, 0.049}, {0.003, 0.037}};
+  for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); ++i)
+  {
+    double x = costmap_.getOriginX() + 100 * costmap_.getResolution() + offsets[i][0];
+    double y = costmap_.getOriginY() + 100 * costmap_.getResolution() + offsets[i][1];
+    unsigned char max_cost, helper_max;
+    uint32_t cost, helper_cost;
+    size_t cells;
+    ASSERT_TRUE(helperCost(footprint_, x, y, 0.0, helper_max, helper_cost, cells));
+    ASSERT_TRUE(stencils->footprintCost(costmap_, x, y, 0.0, max_cost, cost));
+
+    // the footprint spans 19 x 13 cells; rows and columns on the outline hold all the potential differences
+    const uint32_t outline_cells = 2 * (20 + 14);
+    EXPECT_LE(std::abs(static_cast<long>(cost) - static_cast<long>(helper_cost)),
+              static_cast<long>(outline_cells * costmap_2d::INSCRIBED_INFLATED_OBSTACLE)) << "offset " << i;
+  }
+}
+
+TEST_F(FootprintStencilCacheTest, yawRoundedToClosestBin)
+{
+  FootprintStencilCache cache(16);
+  FootprintStencilCache::StencilsConstPtr stencils = cache.get(footprint_, 0.0, costmap_.getResolution());
+
+  double x, y;
+  costmap_.mapToWorld(100, 100, x, y);
+  const double bin_width = 2.0 * M_PI / 16;
+  unsigned char max_cost, bin_max_cost;
+  uint32_t cost, bin_cost;
+  for (int bin = 0; bin < 16; ++bin)
+  {
+    ASSERT_TRUE(stencils->footprintCost(costmap_, x, y, bin * bin_width, bin_max_cost, bin_cost));
+
+    // also on the negative side and on further turns
+    const double offsets[] = {-0.4 * bin_width, 0.4 * bin_width, -2.0 * M_PI, 4.0 * M_PI};
+    for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); ++i)
+    {
+      ASSERT_TRUE(stencils->footprintCost(costmap_, x, y, bin * bin_width + offsets[i], max_cost, cost));
+      EXPECT_EQ(bin_max_cost, max_cost) << "bin " << bin << ", offset " << offsets[i];
+      EXPECT_EQ(bin_cost, cost) << "bin " << bin << ", offset " << offsets[i];
+    }
+  }
+}
+
+TEST_F(FootprintStencilCacheTest, outsideTheMap)
+{
+  FootprintStencilCache cache(16);
+  FootprintStencilCache::StencilsConstPtr stencils = cache.get(footprint_, 0.0, costmap_.getResolution());
+
+  // the robot cell is within the map, but the footprint is partially out of it
+  const unsigned int cells[4][2] = {{2, 100}, {197, 100}, {100, 2}, {100, 197}};
+  for (int i = 0; i < 4; ++i)
+  {
+    double x, y;
+    costmap_.mapToWorld(cells[i][0], cells[i][1], x, y);
+    unsigned char max_cost;
+    uint32_t cost;
+    EXPECT_FALSE(stencils->footprintCost(costmap_, x, y, 0.0, max_cost, cost));
+  }
+
+  // the robot itself is out of the map
+  unsigned char max_cost;
+  uint32_t cost;
+  EXPECT_FALSE(stencils->footprintCost(costmap_, -1.0, 5.0, 0.0, max_cost, cost));
+  EXPECT_FALSE(stencils->footprintCost(costmap_, 5.0, 11.0, 0.0, max_cost, cost));
+}
+
+TEST_F(FootprintStencilCacheTest, stencilsRebuiltOnlyOnChanges)
+{
+  FootprintStencilCache cache(16);
+  FootprintStencilCache::StencilsConstPtr stencils = cache.get(footprint_, 0.1, 0.05);
+  EXPECT_EQ(stencils, cache.get(footprint_, 0.1, 0.05));
+
+  // another padding is cached besides the first one
+  FootprintStencilCache::StencilsConstPtr padded = cache.get(footprint_, 0.2, 0.05);
+  EXPECT_NE(stencils, padded);
+  EXPECT_EQ(stencils, cache.get(footprint_, 0.1, 0.05));
+  EXPECT_EQ(padded, cache.get(footprint_, 0.2, 0.05));
+
+  // a new resolution builds other stencils, while keeping the previous ones; a new footprint rebuilds them all
+  FootprintStencilCache::StencilsConstPtr coarse = cache.get(footprint_, 0.1, 0.1);
+  EXPECT_NE(stencils, coarse);
+  EXPECT_EQ(stencils, cache.get(footprint_, 0.1, 0.05));
+  EXPECT_EQ(coarse, cache.get(footprint_, 0.1, 0.1));
+  std::vector<geometry_msgs::Point> footprint = footprint_;
+  footprint[0].x += 0.1;
+  FootprintStencilCache::StencilsConstPtr changed = cache.get(footprint, 0.2, 0.05);
+  EXPECT_NE(padded, changed);
+  EXPECT_EQ(changed, cache.get(footprint, 0.2, 0.05));
+}
+
+TEST_F(FootprintStencilCacheTest, paddedFootprint)
+{
+  // the padding is applied as costmap_2d::padFootprint does
+  FootprintStencilCache cache(16);
+  std::vector<geometry_msgs::Point> padded_footprint = footprint_;
+  costmap_2d::padFootprint(padded_footprint, 0.12);
+  FootprintStencilCache::Stencils stencils(padded_footprint, costmap_.getResolution(), 16);
+
+  double x, y;
+  costmap_.mapToWorld(100, 100, x, y);
+  unsigned char max_cost, cached_max_cost;
+  uint32_t cost, cached_cost;
+  ASSERT_TRUE(stencils.footprintCost(costmap_, x, y, 0.3, max_cost, cost));
+  ASSERT_TRUE(cache.get(footprint_, 0.12, costmap_.getResolution())->footprintCost(costmap_, x, y, 0.3,
+                                                                                    cached_max_cost, cached_cost));
+  EXPECT_EQ(max_cost, cached_max_cost);
+  EXPECT_EQ(cost, cached_cost);
+
+  unsigned char unpadded_max_cost;
+  uint32_t unpadded_cost;
+  ASSERT_TRUE(cache.get(footprint_, 0.0, costmap_.getResolution())->footprintCost(costmap_, x, y, 0.3,
+                                                                                   unpadded_max_cost, unpadded_cost));
+  EXPECT_GT(cost, unpadded_cost);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,305 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  plan_cache_test.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <cmath>
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include <tf/transform_datatypes.h>
+
+#include "mbf_costmap_nav/plan_cache.h"
+
+using mbf_costmap_nav::PlanCache;
+
+class PlanCacheTest : public ::testing::Test
+{
+protected:
+  PlanCacheTest() : costmap_(100, 100, 0.1, 0.0, 0.0)
+  {
+    start_ = pose(1.05, 1.05, 0.0);
+    goal_ = pose(5.05, 1.05, 0.0);
+    plan_ = straightPlan(start_, goal_);
+
+    const double rectangle[4][2] = {{0.25, 0.15}, {-0.25, 0.15}, {-0.25, -0.15}, {0.25, -0.15}};
+    for (int i = 0; i < 4; ++i)
+    {
+      geometry_msgs::Point point;
+      point.x = rectangle[i][0];
+      point.y = rectangle[i][1];
+      footprint_.push_back(point);
+    }
+  }
+
+  static geometry_msgs::PoseStamped pose(double x, double y, double yaw)
+  {
+    geometry_msgs::PoseStamped pose;
+    pose.header.frame_id = "map";
+    pose.pose.position.x = x;
+    pose.pose.position.y = y;
+    pose.pose.orientation = tf::createQuaternionMsgFromYaw(yaw);
+    return pose;
+  }
+
+  //! Straight plan from start to goal, with a pose every 5 cm
+  static std::vector<geometry_msgs::PoseStamped> straightPlan(const geometry_msgs::PoseStamped &start,
+                                                              const geometry_msgs::PoseStamped &goal)
+  {
+    double dx = goal.pose.position.x - start.pose.position.x;
+    double dy = goal.pose.position.y - start.pose.position.y;
+    int steps = static_cast<int>(std::sqrt(dx * dx + dy * dy) / 0.05);
+    std::vector<geometry_msgs::PoseStamped> plan;
+    for (int i = 0; i <= steps; ++i)
+    {
+      plan.push_back(pose(start.pose.position.x + dx * i / steps, start.pose.position.y + dy * i / steps, 0.0));
+    }
+    return plan;
+  }
+
+  bool lookup(PlanCache &cache, const std::string &planner, const geometry_msgs::PoseStamped &start,
+              const geometry_msgs::PoseStamped &goal, double tolerance = 0.0)
+  {
+    std::vector<geometry_msgs::PoseStamped> plan;
+    double cost;
+    return cache.lookup(costmap_, footprint_, planner, start, goal, tolerance, plan, cost);
+  }
+
+  costmap_2d::Costmap2D costmap_;
+  geometry_msgs::PoseStamped start_;
+  geometry_msgs::PoseStamped goal_;
+  std::vector<geometry_msgs::PoseStamped> plan_;
+  std::vector<geometry_msgs::Point> footprint_;
+};
+
+TEST_F(PlanCacheTest, hit)
+{
+  PlanCache cache(4, 0.1);
+  EXPECT_FALSE(lookup(cache, "navfn", start_, goal_));
+
+  cache.insert(costmap_, footprint_, "navfn", start_, goal_, 0.0, plan_, 42.0);
+  std::vector<geometry_msgs::PoseStamped> plan;
+  double cost = 0.0;
+  ASSERT_TRUE(cache.lookup(costmap_, footprint_, "navfn", start_, goal_, 0.0, plan, cost));
+  EXPECT_EQ(42.0, cost);
+  ASSERT_EQ(plan_.size(), plan.size());
+  for (size_t i = 0; i < plan.size(); ++i)
+  {
+    EXPECT_EQ(plan_[i].pose.position.x, plan[i].pose.position.x);
+    EXPECT_EQ(plan_[i].pose.position.y, plan[i].pose.position.y);
+  }
+
+  // the cached plan is restamped
+  EXPECT_NE(plan_.front().header.stamp, plan.front().header.stamp);
+
+  // the same cells and orientation bins give the same plan; bins start at zero yaw
+  EXPECT_TRUE(lookup(cache, "navfn", pose(1.01, 1.09, 0.05), pose(5.09, 1.01, 0.09)));
+}
+
+TEST_F(PlanCacheTest, missOnDifferentRequests)
+{
+  PlanCache cache(4, 0.1);
+  cache.insert(costmap_, footprint_, "navfn", start_, goal_, 0.0, plan_, 42.0);
+
+  EXPECT_FALSE(lookup(cache, "global_planner", start_, goal_));
+  EXPECT_FALSE(lookup(cache, "navfn", pose(1.15, 1.05, 0.0), goal_));
+  EXPECT_FALSE(lookup(cache, "navfn", start_, pose(5.05, 1.15, 0.0)));
+  EXPECT_FALSE(lookup(cache, "navfn", pose(1.05, 1.05, 0.3), goal_));
+  EXPECT_FALSE(lookup(cache, "navfn", start_, pose(5.05, 1.05, -0.3)));
+  EXPECT_FALSE(lookup(cache, "navfn", start_, goal_, 0.5));
+
+  geometry_msgs::PoseStamped goal = goal_;
+  goal.header.frame_id = "odom";
+  EXPECT_FALSE(lookup(cache, "navfn", start_, goal));
+  geometry_msgs::PoseStamped start = start_;
+  start.header.frame_id = "odom";
+  EXPECT_FALSE(lookup(cache, "navfn", start, goal_));
+
+  // the misses didn't drop the entry
+  EXPECT_TRUE(lookup(cache, "navfn", start_, goal_));
+}
+
+TEST_F(PlanCacheTest, evictLeastRecentlyUsed)
+{
+  PlanCache cache(2, 0.1);
+  geometry_msgs::PoseStamped goal_b = pose(5.05, 3.05, 0.0);
+  geometry_msgs::PoseStamped goal_c = pose(5.05, 5.05, 0.0);
+
+  cache.insert(costmap_, footprint_, "navfn", start_, goal_, 0.0, plan_, 1.0);
+  cache.insert(costmap_, footprint_, "navfn", start_, goal_b, 0.0, straightPlan(start_, goal_b), 2.0);
+
+  // the first plan becomes the most recently used, so the second one is evicted
+  EXPECT_TRUE(lookup(cache, "navfn", start_, goal_));
+  cache.insert(costmap_, footprint_, "navfn", start_, goal_c, 0.0, straightPlan(start_, goal_c), 3.0);
+  EXPECT_TRUE(lookup(cache, "navfn", start_, goal_));
+  EXPECT_FALSE(lookup(cache, "navfn", start_, goal_b));
+  EXPECT_TRUE(lookup(cache, "navfn", start_, goal_c));
+
+  // storing again a cached request replaces its plan without evicting any other
+  cache.insert(costmap_, footprint_, "navfn", start_, goal_c, 0.0, straightPlan(start_, goal_c), 4.0);
+  std::vector<geometry_msgs::PoseStamped> plan;
+  double cost;
+  ASSERT_TRUE(cache.lookup(costmap_, footprint_, "navfn", start_, goal_c, 0.0, plan, cost));
+  EXPECT_EQ(4.0, cost);
+  EXPECT_TRUE(lookup(cache, "navfn", start_, goal_));
+}
+
+TEST_F(PlanCacheTest, invalidateOnCostIncrease)
+{
+  PlanCache cache(4, 0.1);
+  cache.insert(costmap_, footprint_, "navfn", start_, goal_, 0.0, plan_, 42.0);
+
+  // cheaper cells on the plan, or more expensive ones out of it, keep the plan valid
+  costmap_.setCost(30, 10, 100);
+  costmap_.setCost(30, 50, costmap_2d::LETHAL_OBSTACLE);
+  cache.insert(costmap_, footprint_, "navfn", start_, goal_, 0.0, plan_, 42.0);
+  costmap_.setCost(30, 10, 50);
+  EXPECT_TRUE(lookup(cache, "navfn", start_, goal_));
+
+  // a more expensive cell on the plan drops it for good
+  costmap_.setCost(30, 10, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_FALSE(lookup(cache, "navfn", start_, goal_));
+  costmap_.setCost(30, 10, 0);
+  EXPECT_FALSE(lookup(cache, "navfn", start_, goal_));
+}
+
+TEST_F(PlanCacheTest, invalidateAlongTheFootprint)
+{
+  PlanCache cache(4, 0.1);
+  cache.insert(costmap_, footprint_, "navfn", start_, goal_, 0.0, plan_, 42.0);
+
+  // cells out of the plan but within the footprint sweep invalidate it; cells beyond it don't
+  costmap_.setCost(30, 14, costmap_2d::LETHAL_OBSTACLE);
+  costmap_.setCost(55, 10, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_TRUE(lookup(cache, "navfn", start_, goal_));
+  costmap_.setCost(30, 11, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_FALSE(lookup(cache, "navfn", start_, goal_));
+  costmap_.setCost(30, 11, 0);
+
+  // also the rear of the footprint at the start and its front at the goal
+  cache.insert(costmap_, footprint_, "navfn", start_, goal_, 0.0, plan_, 42.0);
+  costmap_.setCost(9, 10, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_FALSE(lookup(cache, "navfn", start_, goal_));
+  costmap_.setCost(9, 10, 0);
+  cache.insert(costmap_, footprint_, "navfn", start_, goal_, 0.0, plan_, 42.0);
+  costmap_.setCost(52, 10, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_FALSE(lookup(cache, "navfn", start_, goal_));
+}
+
+TEST_F(PlanCacheTest, invalidateBetweenSparsePoses)
+{
+  // a plan with just its endpoints is interpolated, so cells between them are swept too
+  PlanCache cache(4, 0.1);
+  std::vector<geometry_msgs::PoseStamped> plan;
+  plan.push_back(start_);
+  plan.push_back(goal_);
+  cache.insert(costmap_, footprint_, "navfn", start_, goal_, 0.0, plan, 42.0);
+  EXPECT_TRUE(lookup(cache, "navfn", start_, goal_));
+  costmap_.setCost(30, 9, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_FALSE(lookup(cache, "navfn", start_, goal_));
+  costmap_.setCost(30, 9, 0);
+
+  // the same for rotations in place, that sweep the footprint corners
+  std::vector<geometry_msgs::PoseStamped> turn;
+  turn.push_back(start_);
+  turn.push_back(pose(1.05, 1.05, M_PI / 2.0));
+  cache.insert(costmap_, footprint_, "navfn", start_, turn.back(), 0.0, turn, 42.0);
+  EXPECT_TRUE(lookup(cache, "navfn", start_, turn.back()));
+  costmap_.setCost(12, 12, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_FALSE(lookup(cache, "navfn", start_, turn.back()));
+}
+
+TEST_F(PlanCacheTest, invalidateOnFootprintChange)
+{
+  PlanCache cache(4, 0.1);
+  cache.insert(costmap_, footprint_, "navfn", start_, goal_, 0.0, plan_, 42.0);
+
+  // a bigger footprint sweeps cells whose costs were never stored
+  std::vector<geometry_msgs::Point> footprint = footprint_;
+  footprint[0].y += 0.1;
+  std::vector<geometry_msgs::PoseStamped> plan;
+  double cost;
+  EXPECT_FALSE(cache.lookup(costmap_, footprint, "navfn", start_, goal_, 0.0, plan, cost));
+  EXPECT_FALSE(lookup(cache, "navfn", start_, goal_));
+}
+
+TEST_F(PlanCacheTest, invalidateOnGeometryChange)
+{
+  PlanCache cache(4, 0.1);
+  cache.insert(costmap_, footprint_, "navfn", start_, goal_, 0.0, plan_, 42.0);
+
+  // cells refer to another area after moving the costmap
+  costmap_.resizeMap(100, 100, 0.1, 1.0, 0.0);
+  EXPECT_FALSE(lookup(cache, "navfn", start_, goal_));
+  costmap_.resizeMap(100, 100, 0.1, 0.0, 0.0);
+  EXPECT_FALSE(lookup(cache, "navfn", start_, goal_));
+}
+
+TEST_F(PlanCacheTest, uncachablePlans)
+{
+  PlanCache cache(4, 0.1);
+
+  // empty plans, and plans whose footprint leaves the costmap, can't be validated
+  cache.insert(costmap_, footprint_, "navfn", start_, goal_, 0.0, std::vector<geometry_msgs::PoseStamped>(), 0.0);
+  EXPECT_FALSE(lookup(cache, "navfn", start_, goal_));
+
+  geometry_msgs::PoseStamped outside = pose(12.0, 1.05, 0.0);
+  cache.insert(costmap_, footprint_, "navfn", start_, outside, 0.0, straightPlan(start_, outside), 42.0);
+  EXPECT_FALSE(lookup(cache, "navfn", start_, outside));
+  geometry_msgs::PoseStamped border = pose(9.85, 1.05, 0.0);
+  cache.insert(costmap_, footprint_, "navfn", start_, border, 0.0, straightPlan(start_, border), 42.0);
+  EXPECT_FALSE(lookup(cache, "navfn", start_, border));
+
+  PlanCache disabled(0, 0.1);
+  disabled.insert(costmap_, footprint_, "navfn", start_, goal_, 0.0, plan_, 42.0);
+  EXPECT_FALSE(lookup(disabled, "navfn", start_, goal_));
+}
+
+TEST_F(PlanCacheTest, clear)
+{
+  PlanCache cache(4, 0.1);
+  cache.insert(costmap_, footprint_, "navfn", start_, goal_, 0.0, plan_, 42.0);
+  cache.clear();
+  EXPECT_FALSE(lookup(cache, "navfn", start_, goal_));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::Time::init();
+  return RUN_ALL_TESTS();
+}
@@ -59,11 +59,9 @@ public:
 
   /**
    * @brief Constructor
-   * @param condition Condition variable for waking up all listeners, e.g. the navigation server, due to a state change
    * @param tf_listener_ptr Shared pointer to a common TransformListener
    */
-  SimpleControllerExecution(boost::condition_variable &condition,
-                            const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr);
+  SimpleControllerExecution(const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr);
 
   /**
    * @brief Destructor
@@ -83,7 +81,7 @@ private:
   /**
    * @brief Empty init method. Nothing to initialize.
    */
-  virtual void initPlugin();
+  virtual bool initPlugin(const std::string &name, const mbf_abstract_core::AbstractController::Ptr &controller_ptr);
 
 };
 
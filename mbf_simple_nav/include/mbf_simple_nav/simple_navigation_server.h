@@ -75,6 +75,14 @@ public:
    * @brief Destructor
    */
   virtual ~SimpleNavigationServer();
+
+protected:
+
+  /**
+   * @brief Creates a new simple planner execution, to fill the planner pool.
+   * @return shared pointer to the new planner execution.
+   */
+  virtual mbf_abstract_nav::AbstractPlannerExecution::Ptr newPlannerExecution();
 };
 
 } /* namespace mbf_simple_nav */
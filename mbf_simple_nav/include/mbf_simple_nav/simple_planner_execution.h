@@ -58,9 +58,8 @@ class SimplePlannerExecution : public mbf_abstract_nav::AbstractPlannerExecution
 public:
   /**
    * @brief Constructor
-   * @param condition Condition variable for waking up all listeners, e.g. the navigation server, due to a state change
    */
-  SimplePlannerExecution(boost::condition_variable &condition);
+  SimplePlannerExecution();
 
   /**
    * @brief Destructor
@@ -79,7 +78,7 @@ private:
   /**
    * @brief Empty init method. Nothing to initialize.
    */
-  virtual void initPlugin();
+  virtual bool initPlugin(const std::string &name, const mbf_abstract_core::AbstractPlanner::Ptr &planner_ptr);
 };
 
 } /* namespace mbf_simple_nav */
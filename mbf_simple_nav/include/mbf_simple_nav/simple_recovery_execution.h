@@ -61,11 +61,9 @@ public:
 
   /**
    * @brief Constructor
-   * @param condition Condition variable for waking up all listeners, e.g. the navigation server, due to a state change
    * @param tf_listener_ptr Shared pointer to a common TransformListener
    */
-  SimpleRecoveryExecution(boost::condition_variable &condition,
-                          const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr);
+  SimpleRecoveryExecution(const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr);
 
   /**
    * @brief Destructor
@@ -84,7 +82,7 @@ private:
   /**
    * @brief Empty init method. Nothing to initialize.
    */
-  virtual void initPlugins();
+  virtual void initPlugin(const std::string &name, const mbf_abstract_core::AbstractRecovery::Ptr &behavior);
 
 };
 
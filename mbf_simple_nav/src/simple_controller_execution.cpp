@@ -43,9 +43,8 @@
 namespace mbf_simple_nav
 {
 
-SimpleControllerExecution::SimpleControllerExecution(boost::condition_variable &condition,
-                                                     const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr) :
-    mbf_abstract_nav::AbstractControllerExecution(condition, tf_listener_ptr)
+SimpleControllerExecution::SimpleControllerExecution(const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr) :
+    mbf_abstract_nav::AbstractControllerExecution(tf_listener_ptr)
 {
 }
 
@@ -70,12 +69,14 @@ mbf_abstract_core::AbstractController::Ptr SimpleControllerExecution::loadContro
   return controller_ptr;
 }
 
-void SimpleControllerExecution::initPlugin()
+bool SimpleControllerExecution::initPlugin(const std::string &name, const mbf_abstract_core::AbstractController::Ptr &controller_ptr)
 {
+  return true;
 }
 
 SimpleControllerExecution::~SimpleControllerExecution()
 {
+  terminate();
 }
 
 } /* namespace move_base_nav_moving */
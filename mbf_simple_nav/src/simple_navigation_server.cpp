@@ -44,12 +44,17 @@ namespace mbf_simple_nav
 {
 
 SimpleNavigationServer::SimpleNavigationServer(const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr) :
-    mbf_abstract_nav::AbstractNavigationServer(tf_listener_ptr, SimplePlannerExecution::Ptr(new SimplePlannerExecution(condition_)),
-                             SimpleControllerExecution::Ptr(new SimpleControllerExecution(condition_, tf_listener_ptr)),
-                             SimpleRecoveryExecution::Ptr(new SimpleRecoveryExecution(condition_, tf_listener_ptr)))
+    mbf_abstract_nav::AbstractNavigationServer(tf_listener_ptr, SimplePlannerExecution::Ptr(new SimplePlannerExecution()),
+                             SimpleControllerExecution::Ptr(new SimpleControllerExecution(tf_listener_ptr)),
+                             SimpleRecoveryExecution::Ptr(new SimpleRecoveryExecution(tf_listener_ptr)))
 {
-  // initialize all plugins
-  initializeServerComponents();
+  // initialize all plugins; the server can't work without its planner and controller
+  if (!initializeServerComponents())
+  {
+    ROS_FATAL_STREAM("Could not initialize the navigation server; shutting down");
+    ros::shutdown();
+    return;
+  }
 
   // start all action servers
   startActionServers();
@@ -59,4 +64,9 @@ SimpleNavigationServer::~SimpleNavigationServer()
 {
 }
 
+mbf_abstract_nav::AbstractPlannerExecution::Ptr SimpleNavigationServer::newPlannerExecution()
+{
+  return SimplePlannerExecution::Ptr(new SimplePlannerExecution());
+}
+
 } /* namespace mbf_simple_nav */
@@ -43,13 +43,14 @@
 namespace mbf_simple_nav
 {
 
-SimplePlannerExecution::SimplePlannerExecution(boost::condition_variable &condition) :
-    mbf_abstract_nav::AbstractPlannerExecution(condition)
+SimplePlannerExecution::SimplePlannerExecution() :
+    mbf_abstract_nav::AbstractPlannerExecution()
 {
 }
 
 SimplePlannerExecution::~SimplePlannerExecution()
 {
+  terminate();
 }
 
 mbf_abstract_core::AbstractPlanner::Ptr SimplePlannerExecution::loadPlannerPlugin(const std::string& planner_type)
@@ -72,8 +73,9 @@ mbf_abstract_core::AbstractPlanner::Ptr SimplePlannerExecution::loadPlannerPlugi
   return planner_ptr;
 }
 
-void SimplePlannerExecution::initPlugin()
+bool SimplePlannerExecution::initPlugin(const std::string &name, const mbf_abstract_core::AbstractPlanner::Ptr &planner_ptr)
 {
+  return true;
 }
 
 } /* namespace mbf_simple_nav */
@@ -43,14 +43,14 @@
 namespace mbf_simple_nav
 {
 
-SimpleRecoveryExecution::SimpleRecoveryExecution(boost::condition_variable &condition,
-                                                 const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr) :
-    mbf_abstract_nav::AbstractRecoveryExecution(condition, tf_listener_ptr)
+SimpleRecoveryExecution::SimpleRecoveryExecution(const boost::shared_ptr<tf::TransformListener> &tf_listener_ptr) :
+    mbf_abstract_nav::AbstractRecoveryExecution(tf_listener_ptr)
 {
 }
 
 SimpleRecoveryExecution::~SimpleRecoveryExecution()
 {
+  terminate();
 }
 
 
@@ -74,7 +74,8 @@ mbf_abstract_core::AbstractRecovery::Ptr SimpleRecoveryExecution::loadRecoveryPl
   return recovery_ptr;
 }
 
-void SimpleRecoveryExecution::initPlugins()
+void SimpleRecoveryExecution::initPlugin(const std::string &name,
+                                         const mbf_abstract_core::AbstractRecovery::Ptr &behavior)
 {
 }
 